@@ -5,6 +5,14 @@
  * @brief Class for generating toy data from a PDF.
  *        Can inherit from this to implement preselection for a particular PDF.
  *
+ * Trials are drawn in blocks into one column per Observable and the PDF is evaluated for the whole block with EvaluateBatch,
+ * split between threads if requested. The Observables and test value of each trial are drawn in the same order as
+ * the original one-trial-at-a-time implementation, so the same events are accepted.
+ *
+ * If a trial is found above the expected maximum the maximum is raised, the events accepted so far are thinned by the
+ * ratio of the old and new maxima (which is equivalent to having used the new maximum from the start) and only the
+ * affected block is accepted again, rather than throwing away everything and starting again.
+ *
  * @author Benjamin M Wynne bwynne@cern.ch
  */
 
@@ -20,6 +28,11 @@
 #include "IPDF.h"
 #include "PhaseSpaceBoundary.h"
 #include "IDataSet.h"
+#include "ColumnarDataSet.h"
+#include "ThreadPool.h"
+///	System Headers
+#include <vector>
+#include <string>
 
 using namespace::std;
 
@@ -51,6 +64,17 @@ class AcceptReject : public IDataGenerator
 		 */
 		virtual int GenerateData( int Input );
 
+		/*!
+		 * @brief The original implementation which creates and evaluates one DataPoint per trial
+		 *
+		 * This is only kept as a reference for the benchmark in --benchmarkAcceptReject
+		 *
+		 * @param Input the number of DataPoints requested
+		 *
+		 * @return the Number DataPoints created
+		 */
+		int GenerateDataUnbatched( int Input );
+
 		/*!
 		 * @brief Interface Function to get a pointer to this dataset that has been generated
 		 * 
@@ -60,6 +84,15 @@ class AcceptReject : public IDataGenerator
 		 */
 		virtual IDataSet * GetDataSet() const;
 
+		/*!
+		 * @brief Interface Function to set the number of threads used to evaluate each block of trials
+		 *
+		 * Each thread uses its own copy of the PDF, the trials themselves are always drawn in a single thread
+		 *
+		 * @param Input   Number of threads, 0 or 1 to evaluate the PDF in the calling thread
+		 */
+		virtual void SetNumberThreads( unsigned int Input );
+
 	protected:
 		/*!
 		 * Don't Copy the class this way!
@@ -73,15 +106,54 @@ class AcceptReject : public IDataGenerator
 
 		virtual bool Preselection( DataPoint*, double );	/*!	Undocumented!	*/
 
+		/*!
+		 * @brief Range of trials evaluated by one thread
+		 */
+		struct EvaluationTask
+		{
+			IPDF* function;
+			IDataSet* trials;
+			unsigned int begin;
+			unsigned int end;
+			double* output;
+		};
+
+		/*!
+		 * @brief Evaluate the PDF for every trial in the block, using the worker threads if there are more than one
+		 */
+		void EvaluateTrials( ColumnarDataSet* Trials, double* Output );
+
+		/*!
+		 * @brief Evaluate one EvaluationTask, this is run on the ThreadPool
+		 */
+		static void* EvaluateTask( void* Input );
+
+		/*!
+		 * @brief Keep each accepted event with probability Fraction, used when the expected maximum has been raised
+		 */
+		void ThinAccepted( const double Fraction );
+
+		/*!
+		 * @brief Replace the contents of newDataSet with the accepted events
+		 */
+		void FillDataSet();
+
 		IPDF * generationFunction;			/*!	Pointer to the PDF given at construction	*/
 		PhaseSpaceBoundary * generationBoundary;	/*!	Pointer to PhaseSpaceBoundary given at constructtion	*/
 
 		int dataNumber;					/*!	Number of DataPoints in newDataSet	*/
 		MemoryDataSet * newDataSet;			/*!	Pointer to internally stored dataset	*/
-		TRandom3 * rootRandom;		/*!	Pointer to the TRandom3 object stored in generationFunction	*/
+		TRandom * rootRandom;		/*!	Pointer to the random number generator from RapidFitRandom	*/
 
 		double moreThanMaximum;		/*!	Undocumented!	*/
 		int numberAttempts;		/*!	Undocumented!	*/
+
+		vector<string> allNames;			/*!	Names of the Observables in the PhaseSpaceBoundary		*/
+		vector<vector<double> > acceptedColumns;	/*!	Every event accepted so far, one column per Observable in allNames	*/
+
+		unsigned int numberThreads;		/*!	Number of threads used to evaluate the PDF			*/
+		ThreadPool* workerPool;			/*!	Workers evaluating the PDF, created on first use		*/
+		vector<IPDF*> threadFunctions;		/*!	Copy of the PDF for each worker					*/
 };
 
 #endif
@@ -0,0 +1,57 @@
+/*!
+ * @class AngularAcceptanceColumn
+ *
+ * @brief A DerivedColumn holding the per-event weight from an AngularAcceptance
+ */
+
+#pragma once
+#ifndef RAPIDFIT_ANGULAR_ACCEPTANCE_COLUMN_H
+#define RAPIDFIT_ANGULAR_ACCEPTANCE_COLUMN_H
+
+///	RapidFit Headers
+#include "DerivedColumn.h"
+#include "AngularAcceptance.h"
+#include "ObservableRef.h"
+///	System Headers
+#include <string>
+
+using namespace::std;
+
+class AngularAcceptanceColumn : public DerivedColumn
+{
+	public:
+		/*!
+		 * @brief Constructor
+		 *
+		 * @param Name        Unique name describing this acceptance, this should include the acceptance file and basis used
+		 * @param Acceptance  Acceptance to evaluate, this is NOT owned by this class
+		 * @param first       First Observable passed to AngularAcceptance::getValue
+		 * @param second      Second Observable passed to AngularAcceptance::getValue
+		 * @param third       Third Observable passed to AngularAcceptance::getValue
+		 */
+		AngularAcceptanceColumn( const string Name, AngularAcceptance* Acceptance, const string first, const string second, const string third );
+
+		~AngularAcceptanceColumn();
+
+	protected:
+		void Calculate( DataPoint* input, double* output ) const;
+
+	private:
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		AngularAcceptanceColumn( const AngularAcceptanceColumn& );
+
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		AngularAcceptanceColumn& operator= ( const AngularAcceptanceColumn& );
+
+		AngularAcceptance* acceptance;		/*!	Acceptance evaluated for each event			*/
+		ObservableRef firstName;		/*!	Observables passed to the acceptance, in order		*/
+		ObservableRef secondName;
+		ObservableRef thirdName;
+};
+
+#endif
+
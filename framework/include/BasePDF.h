@@ -94,6 +94,8 @@
 #include "ParameterSet.h"
 ///	System Headers
 #include <vector>
+#include <list>
+#include <map>
 #include <cmath>
 #include <pthread.h>
 
@@ -202,11 +204,46 @@ class BasePDF : public BasePDF_Framework, public BasePDF_MCCaching, public IPDF
 		 * @brief Externally invalidate the Normalisation Cache
 		 *
 		 * This sets the cacheValid = true and the value of the stored normalisation cache to -1.
+		 * Any Normalisations kept by SetNormalisationCacheSize are dropped as well.
 		 *
 		 * @return Void
 		 */
 		void UnsetCache();
 
+		/*!
+		 * @brief Keep the Normalisation Caches for up to this many parameter points
+		 *
+		 * When the parameters of the PDF change the current Normalisation Caches are stored keyed on the parameters the PDF declares
+		 * in GetPrototypeParameterSet (or those given to SetCacheDependencies), and are restored rather than re-calculated if these parameters
+		 * return to a stored point. This is useful when the Normalisation is numerical and Minuit revisits points in Hesse, Minos or scans.
+		 *
+		 * The least recently used point is dropped when the cache is full.
+		 *
+		 * @param Input   Maximum number of parameter points to keep, 0 disables the cache (the default)
+		 *
+		 * @return Void
+		 */
+		void SetNormalisationCacheSize( const unsigned int Input );
+
+		unsigned int GetNormalisationCacheSize() const;
+
+		/*!
+		 * @brief Number of parameter changes for which the Normalisation Caches were restored from the parameter-keyed cache
+		 */
+		unsigned int GetNormalisationCacheHits() const;
+
+		/*!
+		 * @brief Number of parameter changes for which the Normalisation Caches had to be re-calculated
+		 */
+		unsigned int GetNormalisationCacheMisses() const;
+
+		/*!
+		 * @brief Names of the PhysicsParameters the Normalisation Caches depend on
+		 *
+		 * @return The names given to SetCacheDependencies, or all of GetPrototypeParameterSet if the PDF hasn't declared any
+		 */
+		vector<string> GetCacheDependencies();
+
 		/*!
 		 * @brief   Interface Function:  Return the function value at the given point
 		 *
@@ -358,8 +395,104 @@ class BasePDF : public BasePDF_Framework, public BasePDF_MCCaching, public IPDF
 		 */
 		virtual double EvaluateComponent( DataPoint* InputDataPoint, ComponentRef* InputRef = NULL );
 
+		/*!
+		 * @brief Interface Function: Evaluate the PDF for a contiguous range of events in a DataSet
+		 *
+		 * In BasePDF this loops over Evaluate for each DataPoint in the range
+		 *
+		 * PDFs which can evaluate many events more efficiently at once (i.e. reading whole columns from a ColumnarDataSet) should overload this
+		 *
+		 * @param InputData   DataSet containing the events
+		 * @param begin       Index of the first event to Evaluate
+		 * @param end         Index one past the last event to Evaluate
+		 * @param output      Array of at least end-begin doubles, output[i-begin] is the value for event i
+		 *
+		 * @return Void
+		 */
+		virtual void EvaluateBatch( IDataSet* InputData, const unsigned int begin, const unsigned int end, double* output );
+
+		/*!
+		 * @brief Interface Function: Return the Integral of the PDF for a contiguous range of events in a DataSet
+		 *
+		 * In BasePDF this loops over Integral for each DataPoint in the range and so makes full use of the Normalisation Caches
+		 *
+		 * @param InputData   DataSet containing the events
+		 * @param begin       Index of the first event
+		 * @param end         Index one past the last event
+		 * @param InputPhaseSpace  PhaseSpaceBoundary the PDF is to be Normalised within
+		 * @param output      Array of at least end-begin doubles, output[i-begin] is the Integral for event i
+		 *
+		 * @return Void
+		 */
+		virtual void NormalisationBatch( IDataSet* InputData, const unsigned int begin, const unsigned int end, PhaseSpaceBoundary* InputPhaseSpace, double* output );
+
+		/*!
+		 * @brief Interface Function: Calculate the parameter independent per-event quantities used by this PDF for a whole DataSet
+		 *
+		 * In BasePDF this does nothing, PDFs which use DerivedColumns should overload this and call DerivedColumn::Precompute
+		 *
+		 * @param InputData   DataSet which is about to be fitted
+		 *
+		 * @return Void
+		 */
+		virtual void PrecomputeDerivedColumns( IDataSet* InputData );
+
+		/*!
+		 * @brief Interface Function: Names of the PhysicsParameters which this PDF can differentiate analytically
+		 *
+		 * In BasePDF this is empty and the fit falls back to numerical derivatives
+		 *
+		 * PDFs which overload this MUST also overload both EvaluateGradient and IntegralGradient
+		 *
+		 * @return names of the PhysicsParameters with analytic derivatives
+		 */
+		virtual vector<string> GetAnalyticGradientParameters();
+
+		/*!
+		 * @brief Interface Function: Derivative of Evaluate wrt the named PhysicsParameters
+		 *
+		 * In BasePDF this only succeeds if the PDF doesn't depend on any of the requested PhysicsParameters
+		 *
+		 * @param InputPoint  DataPoint to Evaluate the derivatives at
+		 * @param Names       Names of the PhysicsParameters
+		 * @param output      Array of at least Names.size() doubles, output[i] is the derivative wrt Names[i]
+		 *
+		 * @return true if every derivative was calculated
+		 */
+		virtual bool EvaluateGradient( DataPoint* InputPoint, const vector<string>& Names, double* output );
+
+		/*!
+		 * @brief Interface Function: Derivative of Integral wrt the named PhysicsParameters
+		 *
+		 * In BasePDF this only succeeds if the PDF doesn't depend on any of the requested PhysicsParameters
+		 *
+		 * @param InputPoint  DataPoint to calculate the derivatives at
+		 * @param InputPhaseSpace  PhaseSpaceBoundary the PDF is Normalised within
+		 * @param Names       Names of the PhysicsParameters
+		 * @param output      Array of at least Names.size() doubles, output[i] is the derivative wrt Names[i]
+		 *
+		 * @return true if every derivative was calculated
+		 */
+		virtual bool IntegralGradient( DataPoint* InputPoint, PhaseSpaceBoundary* InputPhaseSpace, const vector<string>& Names, double* output );
+
+		/*!
+		 * @brief Find the PhysicsParameters which a composite of two PDFs can differentiate analytically
+		 *
+		 * A parameter is supported if each of the two PDFs either differentiates it analytically or doesn't depend on it
+		 *
+		 * @param extraNames  Parameters belonging to the composite itself which it can always differentiate
+		 */
+		static vector<string> CombineAnalyticGradientParameters( IPDF* first, IPDF* second, const vector<string> extraNames );
+
 	protected:
 
+		/*!
+		 * @brief Set all derivatives to 0
+		 *
+		 * @return false if this PDF depends on any of the requested PhysicsParameters
+		 */
+		bool NoGradientDependence( const vector<string>& Names, double* output );
+
 		/*!
 		 * @brief   Interface Function:  This function is called ONCE per call from Minuit
 		 *
@@ -402,6 +535,23 @@ class BasePDF : public BasePDF_Framework, public BasePDF_MCCaching, public IPDF
 
 		bool CheckFixed( PhaseSpaceBoundary* NewBoundary );
 
+		/*!
+		 * @brief Declare which PhysicsParameters the cached Normalisation of this PDF depends on
+		 *
+		 * By default the Normalisation caches are thrown away whenever ANY parameter in allParameters changes.
+		 * A PDF whose Normalisation only depends on some of its parameters can use this so that i.e. changing a
+		 * mistag parameter does not force the time-dependent Normalisation to be re-calculated.
+		 *
+		 * An empty list means the Normalisation doesn't depend on any of the PhysicsParameters.
+		 *
+		 * Internal caches within the PDF can be handled in the same way by checking allParameters.HasChanged( ... ) in SetPhysicsParameters
+		 *
+		 * @param Names   Names of the PhysicsParameters the Normalisation depends on
+		 *
+		 * @return Void
+		 */
+		void SetCacheDependencies( const vector<string> Names );
+
 		/*!
 		 * @brief Protected Function for each PDF which provides a method for the PDF to analytically integrate over the whole phase space
 		 *
@@ -444,9 +594,6 @@ class BasePDF : public BasePDF_Framework, public BasePDF_MCCaching, public IPDF
 
 		unsigned int GetThisIndex( PhaseSpaceBoundary* NewBoundary, DataPoint* thisPoint );
 
-		unsigned int stored_index;
-		DataPoint* stored_point;
-		PhaseSpaceBoundary* stored_boundary;
 
 		bool numericalNormalisation;                  /*!     Does this PDF require Numerical Integration, or has Numerical Integration been requested?       */
 
@@ -469,6 +616,49 @@ class BasePDF : public BasePDF_Framework, public BasePDF_MCCaching, public IPDF
 
 		bool _basePDFComponentStatus;
 
+		vector<ObservableRef> cacheDependencies;	/*!	PhysicsParameters which the Normalisation caches depend on				*/
+		bool cacheDependenciesSet;			/*!	Has SetCacheDependencies been called, if not the caches depend on all parameters	*/
+		bool physicsParametersSet;			/*!	Has SetPhysicsParameters been called on this instance yet?				*/
+
+		/*!
+		 * Normalisation Caches for one parameter point
+		 */
+		struct NormalisationCacheEntry
+		{
+			size_t key;				/*!	Hash of parameterValues					*/
+			vector<double> parameterValues;		/*!	Values of the key parameters for these Caches		*/
+			vector<double> normalisations;		/*!	Contents of DiscreteCaches at this parameter point	*/
+		};
+
+		/*!
+		 * @brief Get the values of the parameters the Normalisation depends on and their hash
+		 */
+		size_t NormalisationCacheKey( vector<double>& values );
+
+		/*!
+		 * @brief Set the Normalisation Caches to -1, leaving the parameter-keyed cache alone
+		 */
+		void ResetDiscreteCaches();
+
+		/*!
+		 * @brief Store the current Normalisation Caches keyed on the current parameters
+		 */
+		void StoreNormalisationCache();
+
+		/*!
+		 * @brief Replace the Normalisation Caches with those stored for the current parameters
+		 *
+		 * @return true if the current parameters were found in the cache
+		 */
+		bool RestoreNormalisationCache();
+
+		unsigned int normalisationCacheSize;					/*!	Maximum number of parameter points kept, 0 is off	*/
+		list<NormalisationCacheEntry> normalisationCache;			/*!	Stored parameter points, most recently used first	*/
+		map<size_t, list<NormalisationCacheEntry>::iterator> normalisationCacheIndex;	/*!	Position of each key in normalisationCache	*/
+		vector<ObservableRef> normalisationCacheParameters;			/*!	Parameters making up the key				*/
+		unsigned int normalisationCacheHits;
+		unsigned int normalisationCacheMisses;
+
 };
 
 #endif
@@ -0,0 +1,228 @@
+/*!
+ * @class ColumnarDataSet
+ *
+ * @brief A data set which stores each Observable as one contiguous array of doubles
+ *
+ * The names and units of the Observables are held once by the PhaseSpaceBoundary of the DataSet,
+ * only the values of each Observable and the per-event weight are stored per event.
+ *
+ * PDFs which know about this class can read whole columns of data directly with GetColumn
+ *
+ * Code which needs each event of a batch as a DataPoint only for a moment can copy it into one re-used DataPoint with
+ * MakeRowView and FillRowView, this doesn't build or keep anything per event.
+ *
+ * PDFs which only understand DataPoints are still supported through GetDataPoint, this builds a DataPoint view of the
+ * requested event on first use and keeps it until the data in the DataSet is changed so that pointers remain valid
+ * for the whole of a fit. ReleaseDataPoints can be used to throw these views away when they are no longer needed.
+ */
+
+#pragma once
+#ifndef COLUMNAR_DATA_SET_H
+#define COLUMNAR_DATA_SET_H
+
+///	RapidFit Headers
+#include "IDataSet.h"
+#include "DataPoint.h"
+#include "ObservableRef.h"
+#include "PhaseSpaceBoundary.h"
+///	System Headers
+#include <vector>
+#include <string>
+#include <pthread.h>
+
+using namespace::std;
+
+class ColumnarDataSet : public IDataSet
+{
+	public:
+		/*!
+		 * @brief Construct an empty DataSet, one column is created for every Observable in the PhaseSpaceBoundary
+		 */
+		ColumnarDataSet( PhaseSpaceBoundary* );
+
+		/*!
+		 * @brief Construct a DataSet containing a copy of the values of the DataPoints given, no checks are made against the PhaseSpaceBoundary
+		 */
+		ColumnarDataSet( PhaseSpaceBoundary*, vector<DataPoint> );
+
+		/*!
+		 * @brief Construct a DataSet containing a copy of the values of every DataPoint in the input DataSet
+		 */
+		ColumnarDataSet( IDataSet* );
+
+		~ColumnarDataSet();
+
+		//Interface functions
+		virtual DataPoint * GetDataPoint( int );
+		virtual bool AddDataPoint( DataPoint* );
+		virtual int GetDataNumber( DataPoint* templateDataPoint =NULL ) const;
+		virtual PhaseSpaceBoundary * GetBoundary() const;
+		virtual void SetBoundary( const PhaseSpaceBoundary* );
+
+		virtual void SortBy( string );
+
+		virtual IDataSet* GetDiscreteDataSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const;
+
+		virtual vector<DataPoint> GetDiscreteSubSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const;
+		virtual vector<DataPoint> GetDiscreteSubSet( const vector<string> discreteParam, const vector<double> discreteVal ) const;
+		virtual vector<DataPoint> GetDiscreteSubSet( DataPoint* input ) const;
+
+		double Yield();
+		double YieldError();
+
+		string GetWeightName() const;
+		bool GetWeightsWereUsed() const;
+		void UseEventWeights( const string Name );
+
+		double GetSumWeights();
+		double GetSumWeightsSq();
+		void ApplyAlpha( const double, const double );
+		double GetAlpha();
+
+		void ApplyExternalAlpha( const string alphaName );
+
+		void NormaliseWeights();
+
+		virtual void Print();
+
+		void PrintYield();
+
+		/*!
+		 * @brief Add a DataPoint without checking it lies within the PhaseSpaceBoundary, the input is NOT deleted
+		 */
+		void SafeAddDataPoint( DataPoint* NewDataPoint );
+
+		/*!
+		 * @brief Remove all events and DataPoint views from the DataSet
+		 */
+		void Clear();
+
+		/*!
+		 * @brief Exchange the stored columns with the input, every event is given a weight of 1
+		 *
+		 * This allows a buffer of events to be handed to the DataSet without copying, and the previous buffer to be re-used.
+		 * No checks are made against the PhaseSpaceBoundary
+		 *
+		 * @param Columns   One column per Observable in the order of the PhaseSpaceBoundary, all of the same length
+		 */
+		void SwapColumns( vector<vector<double> >& Columns );
+
+		/*!
+		 * @brief Number of columns (Observables) stored in this DataSet
+		 */
+		unsigned int GetNumberColumns() const;
+
+		/*!
+		 * @brief Position of the column for the requested Observable
+		 *
+		 * @return index of the column, or -1 if the Observable is not stored in this DataSet
+		 */
+		int GetColumnIndex( const ObservableRef& Name ) const;
+
+		/*!
+		 * @brief Direct access to the values of one Observable for every event in the DataSet
+		 *
+		 * The returned pointer is valid until events are next added to or removed from the DataSet
+		 *
+		 * @return Pointer to GetDataNumber() values, or NULL if the Observable is not stored in this DataSet
+		 */
+		const double* GetColumn( const ObservableRef& Name ) const;
+
+		/*!
+		 * @brief Direct access to the values of the column at position index
+		 */
+		const double* GetColumn( const unsigned int index ) const;
+
+		/*!
+		 * @brief Values of one Observable for the events [begin,end) of any DataSet
+		 *
+		 * The column of a ColumnarDataSet is returned directly, for any other DataSet the values are copied into buffer
+		 *
+		 * @return Pointer to end-begin values, valid as long as the DataSet and buffer are unchanged
+		 */
+		static const double* ReadColumn( IDataSet* Data, const ObservableRef& Name, const unsigned int begin, const unsigned int end, vector<double>& buffer );
+
+		/*!
+		 * @brief Direct access to the per-event weights of every event in the DataSet (1. if weights are not used)
+		 */
+		const double* GetEventWeights() const;
+
+		/*!
+		 * @brief Direct access to the per-event offsets of the log-likelihood, NaN until they are set by the fit
+		 *
+		 * Each event is only ever offset by the one thread evaluating it, so these can be written without a lock
+		 */
+		double* GetInitialNLLs();
+
+		/*!
+		 * @brief Throw away all of the DataPoint views which have been built by GetDataPoint
+		 *
+		 * @warning Any pointers returned by GetDataPoint before this call are no longer valid
+		 */
+		void ReleaseDataPoints();
+
+		/*!
+		 * @brief Has GetDataPoint built a DataPoint view of every event?
+		 *
+		 * Once it has, GetDataPoint doesn't allocate or take a lock until events are next added to or removed from the DataSet
+		 */
+		bool DataPointsBuilt() const;
+
+		/*!
+		 * @brief Build a DataPoint with the Observables of this DataSet which can be filled with any event by FillRowView
+		 */
+		DataPoint MakeRowView() const;
+
+		/*!
+		 * @brief Copy the event at index into a DataPoint built by MakeRowView
+		 *
+		 * Nothing is allocated, so a single DataPoint can be re-used for every event of a batch.
+		 * Anything stored in the DataPoint for the previous event (derived data, discrete index) is thrown away.
+		 */
+		void FillRowView( const unsigned int index, DataPoint& view ) const;
+
+	private:
+		//	Uncopyable!
+		ColumnarDataSet ( const ColumnarDataSet& );
+		ColumnarDataSet& operator = ( const ColumnarDataSet& );
+
+		/*!
+		 * @brief Build the (empty) columns to match the current PhaseSpaceBoundary
+		 */
+		void MakeColumns();
+
+		/*!
+		 * @brief Build a new DataPoint containing a copy of the event at index
+		 */
+		DataPoint MakeDataPoint( const unsigned int index ) const;
+
+		/*!
+		 * @brief Indices of all events which match the discrete values given
+		 */
+		vector<unsigned int> GetDiscreteIndices( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const;
+
+		/*!
+		 * @brief Reset the per-event weights to the value of a column multiplied by a per-event or global factor
+		 */
+		void SetEventWeights( const int weightColumn, const int alphaColumn, const double factor );
+
+		PhaseSpaceBoundary * dataBoundary;	/*!	Boundary which the data lives in, this owns the names and units of all columns	*/
+		vector<string> columnNames;		/*!	Names of the Observables in each column						*/
+		vector<string> columnUnits;		/*!	Units of the Observables in each column						*/
+		vector<vector<double> > columns;	/*!	Value of each Observable for every event					*/
+		vector<double> eventWeights;		/*!	Per-event weight of every event							*/
+		vector<double> initialNLLs;		/*!	Per-event offset of the log-likelihood, see GetInitialNLLs			*/
+
+		mutable vector<DataPoint*> pointViews;	/*!	DataPoint views of the events built on demand by GetDataPoint			*/
+		unsigned int numberViews;		/*!	Number of views which have been built						*/
+		bool viewsComplete;			/*!	Has a view been built for every event?						*/
+		pthread_mutex_t viewLock;		/*!	Protects the creation of the DataPoint views					*/
+
+		bool useWeights;
+		string WeightName;
+		double alpha;
+		string alphaName;
+};
+
+#endif
+
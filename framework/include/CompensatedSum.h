@@ -0,0 +1,61 @@
+/*!
+ * @class CompensatedSum
+ *
+ * @brief Accumulate a sum of doubles using Neumaier's variant of Kahan summation
+ *
+ * The rounding error of each addition is carried in a separate compensation term, so the result is accurate to
+ * a few units in the last place independent of the number of terms or the order they are added in.
+ * This means a large DataSet can be summed in a single pass without first sorting the terms.
+ *
+ * Partial sums (eg from different threads) can be combined with Add( const CompensatedSum& ), to get reproducible
+ * results these should always be combined in the same order.
+ */
+
+#pragma once
+#ifndef RAPIDFIT_COMPENSATED_SUM_H
+#define RAPIDFIT_COMPENSATED_SUM_H
+
+///	System Headers
+#include <cmath>
+
+class CompensatedSum
+{
+	public:
+		/*!
+		 * @brief Constructor, the sum starts at zero
+		 */
+		CompensatedSum();
+
+		/*!
+		 * @brief Add a single term to the sum
+		 */
+		inline void Add( const double input )
+		{
+			const double temp = sum + input;
+			if( fabs( sum ) >= fabs( input ) ) compensation += ( sum - temp ) + input;
+			else compensation += ( input - temp ) + sum;
+			sum = temp;
+		}
+
+		/*!
+		 * @brief Add a partial sum accumulated elsewhere, keeping its compensation term
+		 */
+		void Add( const CompensatedSum& input );
+
+		/*!
+		 * @brief Return the sum of all of the terms added so far
+		 */
+		double Sum() const;
+
+		/*!
+		 * @brief Reset the sum to zero
+		 */
+		void Clear();
+
+	private:
+		double sum;		/*!	Running sum of the terms		*/
+		double compensation;	/*!	Accumulated rounding error of sum	*/
+};
+
+#endif
+
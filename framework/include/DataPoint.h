@@ -215,8 +215,17 @@ class DataPoint
 
 		size_t GetDiscreteIndexID() const;
 
+		/*!
+		 * @brief Store the Discrete Index of this datapoint within the PhaseSpaceBoundary with the given ID
+		 *
+		 * The most recently stored index is also kept as the Discrete Index/ID of this datapoint so it can be found without a map lookup
+		 */
 		void SetDiscreteIndexIDMap( size_t thisID, int index );
 		bool FindDiscreteIndexID( size_t thisID );
+
+		/*!
+		 * @brief Return the Discrete Index stored for the PhaseSpaceBoundary with the given ID (-1 if not set)
+		 */
 		int GetDiscreteIndexMap( size_t thisID );
 		void ClearDiscreteIndexMap();
 
@@ -269,10 +278,33 @@ class DataPoint
 		 */
 		void ClearPerEventData();
 
+		/*!
+		 * @brief Return the values of a DerivedColumn which have been stored in this DataPoint
+		 *
+		 * @param slot   Slot assigned to the DerivedColumn, see DerivedColumn::GetSlot
+		 *
+		 * @return pointer to the stored values, NULL if nothing has been stored since the Observables were last changed
+		 */
+		const double* GetDerivedData( const unsigned int slot ) const;
+
+		/*!
+		 * @brief Store the values of a DerivedColumn in this DataPoint
+		 *
+		 * These are thrown away whenever any Observable in this DataPoint is changed
+		 */
+		void SetDerivedData( const unsigned int slot, const vector<double>& input );
+
+		/*!
+		 * @brief Throw away all stored DerivedColumn values
+		 */
+		void ClearDerivedData();
+
 	private:
 
 		vector<double> PerEventData;
 
+		vector<vector<double> > DerivedData;	/*!	Values of each DerivedColumn indexed by slot, only valid for the current Observables	*/
+
 		double initialNLL;
 
 		/*!
@@ -0,0 +1,120 @@
+/*!
+ * @class DataSetCache
+ *
+ * @brief A binary copy of the columns read from a ROOT file, which can be memory-mapped on later runs instead of re-reading the ntuple
+ *
+ * The cache file contains a header followed by one column of doubles per Observable, stored in the order of the PhaseSpaceBoundary.
+ * The header records the input file (including its size and modification time), the ntuple path, the cut string, the first entry read
+ * and a hash of the PhaseSpaceBoundary. A cache is only used if all of these match the current request, otherwise it is re-written.
+ *
+ * The columns hold every event which passed the cut, events are still checked against the PhaseSpaceBoundary when the DataSet is built.
+ *
+ * @warning The doubles are stored in the byte order of the machine which wrote the cache, a cache written on a machine with a different byte order is simply treated as stale
+ */
+
+#pragma once
+#ifndef RAPIDFIT_DATA_SET_CACHE_H
+#define RAPIDFIT_DATA_SET_CACHE_H
+
+///	RapidFit Headers
+#include "PhaseSpaceBoundary.h"
+///	System Headers
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+using namespace::std;
+
+class DataSetCache
+{
+	public:
+		/*!
+		 * @brief Constructor, this only works out the name of the cache file and doesn't touch the disk
+		 *
+		 * @param CacheDirectory  Directory holding the cache files, this is created if it doesn't exist
+		 * @param FileName        Name of the ROOT file being read
+		 * @param NTuplePath      Path of the ntuple within the file
+		 * @param CutString       Cut applied when reading the ntuple
+		 * @param StartEntry      First entry read from the ntuple
+		 * @param Boundary        PhaseSpaceBoundary of the DataSet, the columns are stored in the order of its Observables
+		 */
+		DataSetCache( const string CacheDirectory, const string FileName, const string NTuplePath, const string CutString, const int StartEntry, const PhaseSpaceBoundary* Boundary );
+
+		/*!
+		 * @brief Destructor, this unmaps the cache if it was opened
+		 */
+		~DataSetCache();
+
+		/*!
+		 * @brief Memory-map the cache file
+		 *
+		 * @return true if the cache exists and matches the requested input, false if it needs to be (re-)written
+		 */
+		bool Open();
+
+		/*!
+		 * @brief Write the columns read from the ROOT file to the cache
+		 *
+		 * @param Columns   One column per Observable in the PhaseSpaceBoundary, all of the same length
+		 *
+		 * @return true if the cache was written
+		 */
+		bool Write( const vector<vector<double> >& Columns ) const;
+
+		/*!
+		 * @brief Number of events stored in the opened cache
+		 */
+		uint64_t GetNumberEvents() const;
+
+		/*!
+		 * @brief Values of one Observable for every event in the opened cache, valid until this object is destroyed
+		 */
+		const double* GetColumn( const unsigned int obsIndex ) const;
+
+		/*!
+		 * @brief Full path of the cache file
+		 */
+		string GetCacheFileName() const;
+
+		/*!
+		 * @brief 64bit FNV-1a hash of a string
+		 */
+		static uint64_t Hash( const string input );
+
+	private:
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		DataSetCache( const DataSetCache& );
+
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		DataSetCache& operator= ( const DataSetCache& );
+
+		/*!
+		 * @brief Release the memory-mapped cache
+		 */
+		void Close();
+
+		/*!
+		 * @brief Size and modification time of the input file, both 0 if it can't be found on the local disk
+		 */
+		void GetSourceStatus( uint64_t& size, int64_t& modified ) const;
+
+		string cacheFileName;		/*!	Full path of the cache file					*/
+		string cacheDirectory;		/*!	Directory holding the cache files				*/
+		string sourceFile;		/*!	ROOT file the cache was made from				*/
+		string description;		/*!	Ntuple path, cut string and first entry, stored in the header	*/
+		uint64_t boundaryHash;		/*!	Hash of the XML of the PhaseSpaceBoundary			*/
+		unsigned int numberColumns;	/*!	Number of Observables in the PhaseSpaceBoundary			*/
+
+		void* mappedData;		/*!	Start of the memory-mapped cache file				*/
+		size_t mappedSize;		/*!	Size of the memory-mapped cache file				*/
+		uint64_t numberEvents;		/*!	Number of events in the opened cache				*/
+		vector<const double*> columns;	/*!	Start of each column in the opened cache			*/
+};
+
+#endif
+
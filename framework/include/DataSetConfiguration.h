@@ -98,6 +98,11 @@ class DataSetConfiguration
 		 */
 		string GetSource() const;
 
+		/*!
+		 * @brief Get the number of events requested for each DataSet
+		 */
+		long GetNumberEvents() const;
+
 		/*!
 		 * @brief External Interface to get a DataSet, either File or Toy Based
 		 *
@@ -186,7 +191,14 @@ class DataSetConfiguration
 
 		IDataSet * LoadDataFile( vector<string>, vector<string>, PhaseSpaceBoundary*, long );	/*! @brief Undocumented	*/
 		IDataSet * LoadAsciiFileIntoMemory( string, long, PhaseSpaceBoundary* );		/*! @brief Undocumented	*/
-		IDataSet * LoadRootFileIntoMemory( string, string, long, PhaseSpaceBoundary* );		/*! @brief Undocumented	*/
+		IDataSet * LoadRootFileIntoMemory( string, string, long, PhaseSpaceBoundary*, bool columnarStorage=false, string cacheDirectory="" );	/*! @brief Read a ROOT file into a MemoryDataSet, or a ColumnarDataSet if requested, using a DataSetCache in cacheDirectory if given	*/
+
+		/*!
+		 * @brief Read the value of every Observable in the PhaseSpaceBoundary for every event passing the cut from a ROOT file
+		 *
+		 * @return The number of events which passed the cut, real_data_array has one column of this length per Observable
+		 */
+		int ReadRootFileColumns( string, string, PhaseSpaceBoundary*, vector<vector<double> >& real_data_array );
 
 		/*!
 		 * @brief Private method for polling a ROOT file for the ntuple path
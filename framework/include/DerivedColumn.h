@@ -0,0 +1,106 @@
+/*!
+ * @class DerivedColumn
+ *
+ * @brief A set of per-event quantities which depend only on the Observables of each event
+ *
+ * These are calculated once for each DataPoint and stored within it, so that a PDF can read them back as plain doubles
+ * on every call from the minimiser rather than recalculating them.
+ *
+ * Each DerivedColumn is identified by a name which MUST uniquely describe what is calculated (including any configuration
+ * such as Observable names or acceptance files). Every DerivedColumn with the same name shares the same slot in each DataPoint,
+ * this means that copies of a PDF used in different threads share the values which have already been calculated.
+ *
+ * The stored values are thrown away by the DataPoint whenever one of its Observables is changed, so this is safe to use
+ * with DataPoints which are re-used during numerical integration, projections or generation.
+ *
+ * A PDF should construct its DerivedColumns at setup time and calculate them for the whole DataSet in PrecomputeDerivedColumns.
+ * Values are only ever stored by Precompute, which is called before the DataSet is shared between threads. GetValues never
+ * writes to the DataPoint, for an event without stored values it calculates them into a buffer owned by this instance.
+ */
+
+#pragma once
+#ifndef RAPIDFIT_DERIVED_COLUMN_H
+#define RAPIDFIT_DERIVED_COLUMN_H
+
+///	RapidFit Headers
+#include "DataPoint.h"
+#include "IDataSet.h"
+///	System Headers
+#include <string>
+#include <vector>
+
+using namespace::std;
+
+class DerivedColumn
+{
+	public:
+		/*!
+		 * @brief Constructor
+		 *
+		 * @param Name    Unique name describing what is calculated for each event
+		 * @param Width   Number of values calculated for each event
+		 */
+		DerivedColumn( const string Name, const unsigned int Width );
+
+		virtual ~DerivedColumn();
+
+		/*!
+		 * @brief Name describing what is calculated for each event
+		 */
+		string GetName() const;
+
+		/*!
+		 * @brief Number of values calculated for each event
+		 */
+		unsigned int GetWidth() const;
+
+		/*!
+		 * @brief Slot used by all DerivedColumns with this name to store their values in a DataPoint
+		 */
+		unsigned int GetSlot() const;
+
+		/*!
+		 * @brief Return the values stored in this DataPoint, or calculate them if they haven't been precomputed
+		 *
+		 * @return Pointer to GetWidth() values, valid until the Observables in the DataPoint are changed or the next call to GetValues
+		 */
+		const double* GetValues( DataPoint* input ) const;
+
+		/*!
+		 * @brief Calculate and store the values for every DataPoint in the DataSet which doesn't already have them
+		 */
+		void Precompute( IDataSet* input ) const;
+
+	protected:
+		/*!
+		 * @brief Calculate the values for this DataPoint
+		 *
+		 * @param input   DataPoint to calculate the values for
+		 * @param output  Array of GetWidth() doubles to be filled
+		 */
+		virtual void Calculate( DataPoint* input, double* output ) const = 0;
+
+	private:
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		DerivedColumn( const DerivedColumn& );
+
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		DerivedColumn& operator= ( const DerivedColumn& );
+
+		/*!
+		 * @brief Find the slot reserved for this name, reserving a new one if this name hasn't been seen before
+		 */
+		static unsigned int ReserveSlot( const string Name );
+
+		string name;			/*!	Unique name of this column		*/
+		unsigned int width;		/*!	Number of values per event		*/
+		unsigned int slot;		/*!	Slot of this column in each DataPoint	*/
+		mutable vector<double> scratch;	/*!	Values for an event which hasn't been precomputed	*/
+};
+
+#endif
+
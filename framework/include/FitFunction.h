@@ -24,6 +24,7 @@
 #include "RapidFitIntegratorConfig.h"
 #include "ObservableRef.h"
 #include "DebugClass.h"
+#include "ThreadPool.h"
 
 #include <vector>
 #include <string>
@@ -92,6 +93,25 @@ class FitFunction : public IFitFunction
 		 */
 		virtual double Evaluate();
 
+		/*!
+		 * @brief Can the derivatives of the FitFunction be calculated by EvaluateGradient
+		 *
+		 * This requires the FitFunction to provide EvaluateDataSetGradient and every PDF to have analytic derivatives for at least one floated PhysicsParameter
+		 *
+		 * @return true if EvaluateGradient will provide any analytic derivatives
+		 */
+		bool CanEvaluateGradient();
+
+		/*!
+		 * @brief Evaluate the derivative of the FitFunction wrt each PhysicsParameter
+		 *
+		 * Derivatives are calculated analytically for PhysicsParameters which every PDF depending on them can differentiate,
+		 * all other Floated PhysicsParameters are differentiated numerically using Evaluate
+		 *
+		 * @return Returns one derivative for each PhysicsParameter in the same order as GetParameterSet()->GetAllNames()
+		 */
+		vector<double> EvaluateGradient();
+
 		/*!
 		 * @brief Set the Name of the Weights to use and the fact that Weights were used in the fit
 		 *
@@ -135,6 +155,24 @@ class FitFunction : public IFitFunction
 		 */
 		int GetThreads() const;
 
+		/*!
+		 * @brief Set the number of events in each chunk of work handed out to the threads during Evaluate
+		 *
+		 * Many small chunks are claimed by whichever thread is free, so events with very different costs are spread evenly between the threads
+		 *
+		 * @param Input  Number of events per chunk, 0 splits each DataSet into one equal slice per thread
+		 *
+		 * @return Void
+		 */
+		void SetChunkSize( const unsigned int Input );
+
+		/*!
+		 * @brief Get the persistent worker threads owned by this FitFunction
+		 *
+		 * @return Returns the ThreadPool created in SetPhysicsBottle, NULL if this FitFunction isn't threaded
+		 */
+		ThreadPool* GetWorkerPool() const;
+
 		/*!
 		 * @brief Set whether any RapidFitIntegrator Objects created internally should check the PDF/Numerical Integral
 		 *
@@ -180,6 +218,45 @@ class FitFunction : public IFitFunction
 		 */
 		virtual double EvaluateDataSet( IPDF*, IDataSet*, int );
 
+		/*!
+		 * @brief Evaluate every PDF/DataSet pair in the PhysicsBottle in one go, rather than calling EvaluateDataSet for each in turn
+		 *
+		 * @param output  Filled with the same value EvaluateDataSet would give for each pair, DataSets with no events are ignored
+		 *
+		 * @return false if this isn't possible, Evaluate then calls EvaluateDataSet for each pair
+		 */
+		virtual bool EvaluateAllDataSets( vector<double>& output );
+
+		/*!
+		 * @brief Does this FitFunction provide EvaluateDataSetGradient?
+		 */
+		virtual bool ProvidesDataSetGradient() const;
+
+		/*!
+		 * @brief Derivative of EvaluateDataSet wrt each of the named PhysicsParameters
+		 *
+		 * @param Names   PhysicsParameters which the PDF can differentiate analytically
+		 * @param output  Filled with the derivative wrt each of Names
+		 *
+		 * @return false if any derivative couldn't be calculated
+		 */
+		virtual bool EvaluateDataSetGradient( IPDF*, IDataSet*, int, const vector<string>& Names, vector<double>& output );
+
+		/*!
+		 * @brief Numerical derivative of Evaluate wrt a single PhysicsParameter, the ParameterSet is restored afterwards
+		 */
+		double NumericalDerivative( const string& paramName );
+
+		/*!
+		 * @brief Numerical derivative of the constraints wrt a single PhysicsParameter, the PDFs are not updated
+		 */
+		double ConstraintDerivative( const string& paramName );
+
+		/*!
+		 * @brief Points either side of the current value used for the numerical derivatives, these are kept within the limits of the PhysicsParameter
+		 */
+		void NumericalStepPoints( PhysicsParameter* thisParameter, double& lower, double& upper ) const;
+
 		PhysicsBottle * allData;			/*!	Undocumented	*/
 		double testDouble;			/*!	Undocumented	*/
 		bool useWeights;			/*!	Undocumented	*/
@@ -200,10 +277,12 @@ class FitFunction : public IFitFunction
 		int Threads;				/*!	Undocumented	*/
 		vector<IPDF*> stored_pdfs;		/*!	Undocumented	*/
 		vector<PhaseSpaceBoundary*> StoredBoundary;			/*!	Undocumented	*/
-		vector< vector<vector<DataPoint*> > > StoredDataSubSet;		/*!	Undocumented	*/
+		vector< vector<pair<unsigned int,unsigned int> > > StoredDataRanges;	/*!	[begin,end) of the events given to each thread, for each DataSet	*/
 		vector<RapidFitIntegrator*> StoredIntegrals;			/*	Undocumented	*/
 		bool finalised;				/*!	Undocumented	*/
 		struct Fitting_Thread* fit_thread_data;	/*!	Undocumented	*/
+		ThreadPool* workerPool;			/*!	Workers which persist between calls to Evaluate		*/
+		unsigned int chunkSize;			/*!	Events per chunk of work, 0 for one slice per thread	*/
 
 		bool testIntegrator;			/*!	Undocumented	*/
 
@@ -215,14 +294,14 @@ class FitFunction : public IFitFunction
 
 		unsigned int callNum;
 
-		vector<vector<IDataSet*> > stored_datasets;
-
 		bool OffSetNLL;
 
 		double initialConstraint;
 
-		void ClearPhaseSpaceCaches( IDataSet* thisDataSet );
-		void ClearPDF( IPDF* thisPDF );
+		/*!
+		 * @brief Find the discrete combination of every event in the DataSet once before the fit, these are stored in the DataPoints
+		 */
+		void IndexDiscreteCombinations( IDataSet* thisDataSet );
 };
 
 #endif
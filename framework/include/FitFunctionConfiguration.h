@@ -41,6 +41,11 @@ class FitFunctionConfiguration
 		 */
 		FitFunctionConfiguration( string, string );
 
+		/*!
+		 * Copy Constructor, used to give each worker of a parallel study its own configuration
+		 */
+		FitFunctionConfiguration( const FitFunctionConfiguration& input );
+
 		/*!
 		 *	Destructor
 		 */
@@ -92,6 +97,11 @@ class FitFunctionConfiguration
 		 */
 		void SetThreads( int );
 
+		/*!
+		 * Set the Number of events in each chunk of work given to the threads of the FitFunction, 0 for one slice per thread
+		 */
+		void SetChunkSize( unsigned int );
+
 		/*!
 		 * Set wether The FitFunction should test the Integrator
 		 */
@@ -125,8 +135,6 @@ class FitFunctionConfiguration
 
 	private:
 
-		FitFunctionConfiguration( const FitFunctionConfiguration& input );
-
 		FitFunctionConfiguration& operator= ( const FitFunctionConfiguration& input );
 
 		string functionName, weightName;/*!	Name of the Function and Weight to use		*/
@@ -135,6 +143,7 @@ class FitFunctionConfiguration
 		TString TraceFileName;		/*!	Trace Output FileName				*/
 		int traceCount;			/*!	Trace Number, to avoid overwriting the output file	*/
 		int Threads;			/*!	Number of Threads to Construct FitFunction With	*/
+		unsigned int ChunkSize;		/*!	Events per chunk of work for the threads	*/
 		string Strategy;		/*!	Name of Strategy to use				*/
 		RapidFitIntegratorConfig* integratorConfig;/*!	Object for holding all of the config data for the Integrators	*/
 		bool testIntegrator;
@@ -51,6 +51,10 @@ class FixedResolutionModel : public IResolutionModel
 		double ExpCos( double time, double gamma, double dms ) ;
 		double ExpCosInt( double tlow, double thigh, double gamma, double dms ) ;
 
+		void ExpBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, double* output );
+		void ExpCosSinBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, const double dms,
+				double* outCos, double* outSin );
+
 		bool isPerEvent() ;
 
 	protected:
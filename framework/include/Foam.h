@@ -6,6 +6,13 @@
  * 
  * Just a wrapper for the Root TFoam generator
  *
+ * The TFoam cells are built once for each discrete combination. When more than one thread is requested each thread
+ * generates blocks of events from its own copy of the cells, PDF and a RapidFitRandomStream for each block
+ *
+ * If a grid cache directory has been set the cells built for each discrete combination are also written there, keyed by
+ * the PDF, the values of its parameters and the PhaseSpaceBoundary, and are read back instead of being rebuilt whenever
+ * a later generator (in this or any other job using the same directory) asks for the same key
+ *
  * @author Benjamin M Wynne bwynne@cern.ch
  */
 
@@ -22,6 +29,7 @@
 #include "MemoryDataSet.h"
 #include "IntegratorFunction.h"
 #include "ObservableRef.h"
+#include "IConstraint.h"
 ///	System Headers
 #include <vector>
 
@@ -61,8 +69,32 @@ class Foam : public IDataGenerator
 		 */
 		virtual IDataSet * GetDataSet() const;
 
+		/*!
+		 * @brief Interface Function to set the number of threads used to generate events
+		 *
+		 * With more than one thread the events are generated in fixed size blocks, each from its own random number stream,
+		 * so the DataSet does not depend on the number of threads. With a single thread the events are generated as before.
+		 *
+		 * @param Input   Number of threads, 0 or 1 for single threaded generation
+		 */
+		virtual void SetNumberThreads( unsigned int Input );
+
+		/*!
+		 * @brief Set the directory in which the TFoam cells are stored and looked up, shared by all Foam generators in this job
+		 *
+		 * @param Input   Directory to use, this is created if it doesn't exist. An empty string disables the cache (default)
+		 */
+		static void SetGridCacheDirectory( const string Input );
+
+		/*!
+		 * @brief Get the directory in which the TFoam cells are stored and looked up
+		 */
+		static string GetGridCacheDirectory();
+
 	protected:
 
+		struct FoamWorker;
+
 		/*!
 		 * Don't Copy the class this way!
 		 */
@@ -83,6 +115,57 @@ class Foam : public IDataGenerator
 		 */
 		void RemoveGenerator();
 
+		/*!
+		 * @brief Build the TFoam cells for one discrete combination, or read them from the grid cache if they have been built before
+		 *
+		 * @param Name                 Name of the new TFoam object
+		 * @param combinationIndex     Index of the discrete combination in discreteCombinations
+		 * @param combinationFunction  Wrapper of the PDF for this combination
+		 *
+		 * @return A TFoam ready to generate events, using rootRandom and combinationFunction
+		 */
+		TFoam* BuildGenerator( const TString Name, const unsigned int combinationIndex, IntegratorFunction* combinationFunction );
+
+		/*!
+		 * @brief Everything which determines the TFoam cells for one discrete combination, as a string
+		 *
+		 * This includes the parameters, the PhaseSpaceBoundary, a hash of the configuration of the PDF and the size and modification time of any files it names
+		 */
+		string GridKey( const unsigned int combinationIndex ) const;
+
+		/*!
+		 * @brief Read the TFoam cells from a grid cache file, returns NULL if the file doesn't exist or was made for a different key
+		 */
+		static TFoam* LoadGrid( const string FileName, const string Key );
+
+		/*!
+		 * @brief Write the TFoam cells to a grid cache file along with the key they were built for
+		 */
+		static void SaveGrid( TFoam* Generator, const string FileName, const string Key );
+
+		/*!
+		 * @brief Generate a single event and store its values
+		 *
+		 * @param Generators      One TFoam for each discrete combination
+		 * @param Random          Random number generator for the discrete Observables, normally the one used by Generators
+		 * @param GeneratedEvent  Space for the continuous values of one event from TFoam
+		 * @param EventIndex      Position of this event in each column
+		 * @param Columns         One column per Observable in the order of allNames
+		 */
+		void SampleEvent( const vector<TFoam*>& Generators, TRandom* Random, Double_t* GeneratedEvent, const unsigned int EventIndex, vector<vector<double> >& Columns ) const;
+
+		/*!
+		 * @brief Fill the columns using numberThreads threads, each with its own copy of the TFoam generators
+		 */
+		void GenerateInThreads( const unsigned int DataAmount, vector<vector<double> >& Columns );
+
+		/*!
+		 * @brief Loop of each generator thread, takes the next block of events until all have been generated
+		 *
+		 * @param Input   This is the FoamWorker belonging to this thread
+		 */
+		static void* GenerateBlocks( void* Input );
+
 		/*!
 		 * A list of the number of files currently Open.
 		 * These Files are closed on destruction of this class
@@ -98,7 +181,7 @@ class Foam : public IDataGenerator
 		IntegratorFunction * generationFunction;		/*!	Instance of the Wrapper Class between ROOT and the PDFs in RapidFit, this may be redudant, requires checking	*/
 		PhaseSpaceBoundary * generationBoundary;		/*!	Pointer to the PhaseSpace to be filled from Construction		*/
 		MemoryDataSet * newDataSet;				/*!	Internal Pointer to the DataSet that was requested			*/
-		TRandom3 * rootRandom;					/*!	Pointer to the TRandom3 instance from the PDF provided			*/
+		TRandom * rootRandom;					/*!	Pointer to the random number generator from RapidFitRandom		*/
 		vector< TFoam* > foamGenerators;			/*!	A vector of all TFoam instances for this PDF and PhaseSpace		*/
 		vector< IntegratorFunction* > storedIntegrator;		/*!	Vector of Integrator Functions Used as wrappers to this PDF from ROOT	*/
 		//int dataNumber;
@@ -108,6 +191,12 @@ class Foam : public IDataGenerator
 		vector<ObservableRef*> continuousNames_ref2, discreteNames_ref2;
 		vector< vector<double> > discreteValues;		/*!	Undocumented, may be duplicate of discreteCombinations 			*/
 		vector<double> minima, ranges;				/*!	Minima and Range of Each Observable in the PhaseSpace, required to be passed to IntegratorFunction as a cross check	*/
+		vector<IConstraint*> discreteConstraints;		/*!	Constraints of the Discrete Observables, used to generate their values			*/
+		vector<unsigned int> discretePositions, continuousPositions;/*!	Position of each Discrete and Continuous Observable within allNames			*/
+		vector<string> allUnits;				/*!	Units of the Observables in allNames							*/
+		unsigned int numberThreads;				/*!	Number of threads used to generate events						*/
+
+		static string gridCacheDirectory;			/*!	Directory holding the cached TFoam cells, empty if not used				*/
 };
 
 #endif
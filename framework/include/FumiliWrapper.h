@@ -64,6 +64,7 @@ class FumiliWrapper : public IMinimiser
 		void CallHesse();
 		RapidFitMatrix* GetCovarianceMatrix();
 		void ApplyCovarianceMatrix( RapidFitMatrix* Input );
+		void SetStartingCovariance( const RapidFitMatrix* Input );
 
 	private:
 		//	Uncopyable!
@@ -0,0 +1,58 @@
+/*!
+ * @class FunctionDerivedColumn
+ *
+ * @brief A DerivedColumn built from a list of functions of a fixed set of Observables
+ *
+ * Each function is passed the values of the Observables (in the order given) and gives one value per event,
+ * this matches the static angular functions such as Bs2JpsiPhi_Angular_Terms::TangleFactorA0A0
+ */
+
+#pragma once
+#ifndef RAPIDFIT_FUNCTION_DERIVED_COLUMN_H
+#define RAPIDFIT_FUNCTION_DERIVED_COLUMN_H
+
+///	RapidFit Headers
+#include "DerivedColumn.h"
+#include "ObservableRef.h"
+///	System Headers
+#include <string>
+#include <vector>
+
+using namespace::std;
+
+class FunctionDerivedColumn : public DerivedColumn
+{
+	public:
+		typedef double (*ObservableFunction)( vector<double> );
+
+		/*!
+		 * @brief Constructor
+		 *
+		 * @param Name         Unique name describing what is calculated, see DerivedColumn
+		 * @param Observables  Names of the Observables passed to each function, in order
+		 * @param Functions    Functions to evaluate for each event, one value per function
+		 */
+		FunctionDerivedColumn( const string Name, const vector<string> Observables, const vector<ObservableFunction> Functions );
+
+		~FunctionDerivedColumn();
+
+	protected:
+		void Calculate( DataPoint* input, double* output ) const;
+
+	private:
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		FunctionDerivedColumn( const FunctionDerivedColumn& );
+
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		FunctionDerivedColumn& operator= ( const FunctionDerivedColumn& );
+
+		vector<ObservableRef> observables;		/*!	Observables passed to each function	*/
+		vector<ObservableFunction> functions;		/*!	Functions evaluated for each event	*/
+};
+
+#endif
+
@@ -57,7 +57,7 @@ class IConstraint
 		 *
 		 * @return This returns a new Observable which has a Random value compatible with this Constraint
 		 */
-		virtual Observable * CreateObservable( TRandom3* ) const = 0;
+		virtual Observable * CreateObservable( TRandom* ) const = 0;
 
 		/*!
 		 * @brief Interface Function:
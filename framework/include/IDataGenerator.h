@@ -31,6 +31,12 @@ class IDataGenerator
 		 */
 		virtual IDataSet * GetDataSet() const = 0;
 
+		/*!
+		 * Interface Function:
+		 * Set the number of threads which may be used by GenerateData
+		 */
+		virtual void SetNumberThreads( unsigned int ) = 0;
+
 		/*!
 		 * Virtual Destructor
 		 */
@@ -86,6 +86,24 @@ class IFitFunction
 		 */
 		virtual double Evaluate() = 0;
 
+		/*!
+		 * @brief Can the derivatives of the IFitFunction be calculated by EvaluateGradient
+		 *
+		 * Minuit2 only uses them when the Minimiser has <ConfigureMinimiser>AnalyticGradient</ConfigureMinimiser>
+		 *
+		 * @return true if at least some of the derivatives are known analytically
+		 */
+		virtual bool CanEvaluateGradient() = 0;
+
+		/*!
+		 * @brief Evaluate the derivative of the IFitFunction wrt each PhysicsParameter
+		 *
+		 * Derivatives which can't be calculated analytically are calculated numerically from Evaluate
+		 *
+		 * @return Returns one derivative for each PhysicsParameter in the same order as GetParameterSet()->GetAllNames(), Fixed parameters have a derivative of 0
+		 */
+		virtual vector<double> EvaluateGradient() = 0;
+
 		/*!
 		 * @brief Set the Name of the Weights to use and the fact that Weights were used in the fit
 		 *
@@ -129,6 +147,22 @@ class IFitFunction
 		 */
 		virtual int GetThreads() const = 0;
 
+		/*!
+		 * @brief Set the number of events in each chunk of work handed out to the threads during Evaluate
+		 *
+		 * @param Input  Number of events per chunk, 0 splits each DataSet into one equal slice per thread
+		 *
+		 * @return Void
+		 */
+		virtual void SetChunkSize( const unsigned int Input ) = 0;
+
+		/*!
+		 * @brief Get the persistent worker threads used by this IFitFunction
+		 *
+		 * @return Returns the ThreadPool, NULL if this IFitFunction isn't threaded
+		 */
+		virtual ThreadPool* GetWorkerPool() const = 0;
+
 		/*!
 		 * @brief Set whether any RapidFitIntegrator Objects created internally should check the PDF/Numerical Integral
 		 *
@@ -167,6 +167,18 @@ class IMinimiser
 		 */
 		virtual void ApplyCovarianceMatrix( RapidFitMatrix* Input ) = 0;
 
+		/*!
+		 * @brief Interface Function:
+		 *        Provide an estimate of the Covariance Matrix to start the next minimisation from, eg the result of a fit at a nearby point of a scan
+		 *
+		 * Minimisers which can't make use of this are free to ignore it
+		 *
+		 * @param Input   Covariance Matrix of the Free Parameters, this is copied. NULL starts from the Minimiser's own estimate
+		 *
+		 * @return Void
+		 */
+		virtual void SetStartingCovariance( const RapidFitMatrix* Input ) = 0;
+
 		virtual void SetNSigma( int nSigma ) = 0;
 
 	protected:
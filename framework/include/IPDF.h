@@ -33,6 +33,8 @@
 
 using namespace::std;
 
+class IDataSet;
+
 class IPDF : public virtual IPDF_NormalisationCaching, public virtual IPDF_MCCaching, public virtual IPDF_Framework
 {
 	public:
@@ -115,6 +117,43 @@ class IPDF : public virtual IPDF_NormalisationCaching, public virtual IPDF_MCCac
 		 */
 		virtual double EvaluateComponent( DataPoint*, ComponentRef* ) = 0;
 
+		/*!
+		 * Interface Function:
+		 * Evaluate the function for the events [begin,end) of the DataSet, output[i-begin] is the value for event i
+		 */
+		virtual void EvaluateBatch( IDataSet*, const unsigned int begin, const unsigned int end, double* output ) = 0;
+
+		/*!
+		 * Interface Function:
+		 * Return the integral over the given boundary for the events [begin,end) of the DataSet, output[i-begin] is the integral for event i
+		 */
+		virtual void NormalisationBatch( IDataSet*, const unsigned int begin, const unsigned int end, PhaseSpaceBoundary*, double* output ) = 0;
+
+		/*!
+		 * Interface Function:
+		 * Calculate any parameter independent per-event quantities (DerivedColumns) for every event in the DataSet before a fit
+		 */
+		virtual void PrecomputeDerivedColumns( IDataSet* ) = 0;
+
+		/*!
+		 * Interface Function:
+		 * Names of the PhysicsParameters for which both Evaluate and Integral can be differentiated analytically
+		 */
+		virtual vector<string> GetAnalyticGradientParameters() = 0;
+
+		/*!
+		 * Interface Function:
+		 * Derivative of Evaluate at the given point wrt each of the named PhysicsParameters, output[i] is the derivative wrt Names[i]
+		 * Parameters the PDF doesn't depend on have a derivative of 0, false is returned if any derivative couldn't be calculated
+		 */
+		virtual bool EvaluateGradient( DataPoint*, const vector<string>& Names, double* output ) = 0;
+
+		/*!
+		 * Interface Function:
+		 * Derivative of Integral at the given point wrt each of the named PhysicsParameters, as for EvaluateGradient
+		 */
+		virtual bool IntegralGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>& Names, double* output ) = 0;
+
 	protected:
 
 		/*!
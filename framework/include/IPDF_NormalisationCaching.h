@@ -99,6 +99,22 @@ class IPDF_NormalisationCaching
 		 */
 		virtual void UnsetCache() = 0;
 
+		/*!
+		 * Interface Function:
+		 * Keep up to this many sets of Normalisation Caches keyed on the PDF parameters, 0 disables this
+		 */
+		virtual void SetNormalisationCacheSize( const unsigned int ) = 0;
+
+		virtual unsigned int GetNormalisationCacheSize() const = 0;
+
+		/*!
+		 * Interface Function:
+		 * Number of parameter changes for which the Normalisation Caches were/weren't found in the parameter-keyed cache
+		 */
+		virtual unsigned int GetNormalisationCacheHits() const = 0;
+
+		virtual unsigned int GetNormalisationCacheMisses() const = 0;
+
 	protected:
 		/*!
 		 * Default Constructor
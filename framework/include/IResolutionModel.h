@@ -16,6 +16,7 @@
 
 #include "PDFConfigurator.h"
 #include "Observable.h"
+#include "IDataSet.h"
 //	System Headers
 #include <iostream>
 #include <fstream>
@@ -55,6 +56,36 @@ class IResolutionModel
 		virtual pair<double,double> ExpCosSinInt( double tlow, double thigh, double gamma, double dms )
 		{ (void) time; (void) gamma; (void) dms; (void) tlow; (void) thigh; return make_pair(0.,0.); };
 
+		/*!
+		 * @brief Exp for the events [begin,end) of the DataSet, time[i] and output[i] belong to event begin+i
+		 *
+		 * By default this takes the observables of each event in turn and calls Exp
+		 */
+		virtual void ExpBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, double* output )
+		{
+			for( unsigned int i=begin; i< end; ++i )
+			{
+				this->setObservables( data->GetDataPoint( (int)i ) );
+				output[i-begin] = this->Exp( time[i-begin], gamma );
+			}
+		};
+
+		/*!
+		 * @brief ExpCos and ExpSin for the events [begin,end) of the DataSet, time[i] and the outputs belong to event begin+i
+		 *
+		 * By default this takes the observables of each event in turn and calls ExpCos and ExpSin
+		 */
+		virtual void ExpCosSinBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, const double dms,
+				double* outCos, double* outSin )
+		{
+			for( unsigned int i=begin; i< end; ++i )
+			{
+				this->setObservables( data->GetDataPoint( (int)i ) );
+				outCos[i-begin] = this->ExpCos( time[i-begin], gamma, dms );
+				outSin[i-begin] = this->ExpSin( time[i-begin], gamma, dms );
+			}
+		};
+
 		virtual bool isPerEvent() = 0;
 
 		virtual ~IResolutionModel() {};
@@ -67,6 +67,14 @@ namespace Mathematics
 
 	double evalCerfIm( double swt, double u, double c );
 
+	//	Batch versions of the above, these take an array of n arguments and fill an array of n results
+
+	//	Faddeeva function w(z) for z = re[i] + i*im[i]
+	void FaddeevaBatch( const double* re, const double* im, const unsigned int n, double* outRe, double* outIm );
+
+	void evalCerfApproxBatch( const double swt, const double* u, const double* c, const unsigned int n, double* outRe, double* outIm );
+	void evalCerfBatch( const double swt, const double* u, const double* c, const unsigned int n, double* outRe, double* outIm );
+
 	//--------------------------- exp and exp*sin and exp*cos time functions -------------------------
 	// time functions for use in PDFs with resolution
 
@@ -110,6 +118,17 @@ namespace Mathematics
 	pair<double,double> ExpCosSin( double t, double gamma, double deltaM, double resolution );
 	pair<double,double> ExpCosSinInt( double tlow, double thigh, double gamma, double deltaM, double resolution );
 
+	//	Batch versions of the time functions for n events, each with their own resolution
+	void ExpBatch( const double* t, const unsigned int n, const double gamma, const double* resolution, double* output );
+	void ExpCoshBatch( const double* t, const unsigned int n, const double gamma, const double deltaGamma, const double* resolution, double* output );
+	void ExpSinhBatch( const double* t, const unsigned int n, const double gamma, const double deltaGamma, const double* resolution, double* output );
+	void ExpCosBatch( const double* t, const unsigned int n, const double gamma, const double deltaM, const double* resolution, double* output );
+	void ExpSinBatch( const double* t, const unsigned int n, const double gamma, const double deltaM, const double* resolution, double* output );
+	void ExpCosSinBatch( const double* t, const unsigned int n, const double gamma, const double deltaM, const double* resolution, double* outCos, double* outSin );
+
+	//	Check the batch functions against RooMath and the single event functions, returns the largest relative difference found
+	double TestFaddeevaBatch();
+
 	double expErfInt( double tlimit, double tau, double sigma);
 	double expErfInt_Wrapper( vector<double> input );
 
@@ -26,6 +26,10 @@ class MinimiserConfiguration
 	public:
 		MinimiserConfiguration( string );
 		MinimiserConfiguration( string, OutputConfiguration* );
+
+		//	Copy the settings only, the copy constructs its own minimiser
+		MinimiserConfiguration( const MinimiserConfiguration& );
+
 		~MinimiserConfiguration();
 
 		IMinimiser * GetMinimiser();
@@ -40,6 +44,11 @@ class MinimiserConfiguration
 		void SetMultiMini( bool );
 		void SetNSigma( int );
 
+		//	Covariance of the free parameters given to each new minimiser to start from, this is copied. NULL to let the minimiser make its own estimate
+		void SetStartingCovariance( const RapidFitMatrix* );
+
+		string GetMinimiserName() const;
+
 		//Output some debugging info
 		void Print() const;
 
@@ -47,7 +56,6 @@ class MinimiserConfiguration
 
 	private:
 		//	Uncopyable!
-		MinimiserConfiguration ( const MinimiserConfiguration& );
 		MinimiserConfiguration& operator = ( const MinimiserConfiguration& );
 
 		IMinimiser* theMinimiser;
@@ -60,6 +68,7 @@ class MinimiserConfiguration
 		bool MultiMini;
 		int Quality;
 		int nSigma;
+		RapidFitMatrix* startingCovariance;
 };
 
 #endif
@@ -0,0 +1,49 @@
+/**
+        @class Minuit2GradientFunction
+
+        A wrapper making IFitFunctions which can calculate their own derivatives work with the Minuit2 FCNGradientBase API
+
+        The function value is taken from a Minuit2Function so both wrappers always agree on the value and the error definition
+
+*/
+
+#pragma once
+#ifndef MINUIT2_GRADIENT_FUNCTION_H
+#define MINUIT2_GRADIENT_FUNCTION_H
+
+//	ROOT Headers
+#include "Minuit2/FCNGradientBase.h"
+//	RapidFit Headers
+#include "IFitFunction.h"
+#include "Minuit2Function.h"
+//	System Headers
+#include <vector>
+
+using namespace ROOT::Minuit2;
+
+class Minuit2GradientFunction : public FCNGradientBase
+{
+	public:
+		Minuit2GradientFunction( Minuit2Function*, IFitFunction* );
+		~Minuit2GradientFunction();
+
+		//Interface functions
+		virtual double operator()( const vector<double>& ) const;
+		virtual vector<double> Gradient( const vector<double>& ) const;
+		virtual double Up() const;
+		virtual void SetErrorDef( double );
+		virtual double ErrorDef() const;
+
+		//	Don't let Minuit2 compare the analytic derivatives against its own numerical ones before each fit
+		virtual bool CheckGradient() const;
+
+	private:
+		//	Uncopyable!
+		Minuit2GradientFunction ( const Minuit2GradientFunction& );
+		Minuit2GradientFunction& operator = ( const Minuit2GradientFunction& );
+
+		Minuit2Function * valueFunction;
+		IFitFunction * function;
+};
+
+#endif
@@ -13,6 +13,7 @@
 
 //	ROOT Headers
 #include "Minuit2/MnMigrad.h"
+#include "Minuit2/MnUserParameterState.h"
 #include "Minuit2Function.h"
 #include "RapidFitMatrix.h"
 //	RapidFit Headers
@@ -49,12 +50,16 @@ class Minuit2Wrapper : public IMinimiser
 		void CallHesse();
 		RapidFitMatrix* GetCovarianceMatrix();
 		void ApplyCovarianceMatrix( RapidFitMatrix* Input );
+		void SetStartingCovariance( const RapidFitMatrix* Input );
 
 	private:
 		//	Uncopyable!
 		Minuit2Wrapper ( const Minuit2Wrapper& );
 		Minuit2Wrapper& operator = ( const Minuit2Wrapper& );
 
+		//	Parameters to start Migrad from, along with the starting covariance if one was provided for all of the free parameters
+		MnUserParameterState GetStartingState() const;
+
 		//MnMigrad minuit;
 		Minuit2Function * function;
 		FunctionMinimum* minimum;
@@ -66,6 +71,8 @@ class Minuit2Wrapper : public IMinimiser
                 vector<string> Options;
 		int Quality;
 		int nSigma;
+		RapidFitMatrix* startingCovariance;
+		vector<string> minimisedNames;		/*!	Free parameters in the order given to Minuit2 by the last call to Minimise	*/
 
 };
 
@@ -60,6 +60,7 @@ class MinuitWrapper : public IMinimiser
 		void CallHesse();
 
 		void ApplyCovarianceMatrix( RapidFitMatrix* Input );
+		void SetStartingCovariance( const RapidFitMatrix* Input );
 
 	private:
 		//	Uncopyable!
@@ -79,6 +80,7 @@ class MinuitWrapper : public IMinimiser
 		vector<string> Options;
 		int Quality;
 		int nSigma;
+		vector<string> minimisedNames;		/*!	Free parameters in the order given to TMinuit by the last call to Minimise	*/
 		//ParameterSet* test;
 
 };
@@ -8,6 +8,7 @@
 #include "DataPoint.h"
 #include "Threading.h"
 #include "ThreadingConfig.h"
+#include "ThreadPool.h"
 
 #include <stdio.h>
 #include <pthread.h>
@@ -39,9 +40,31 @@ class MultiThreadedFunctions
 		MultiThreadedFunctions();
 		~MultiThreadedFunctions();
 
-		static vector<double>* ParallelEvaluate_pthreads( IPDF* thisFunction, IDataSet* thesePoints, unsigned int nThreads, ComponentRef* thisRef=NULL );
+		static vector<double>* ParallelEvaluate_pthreads( IPDF* thisFunction, IDataSet* thesePoints, unsigned int nThreads, ComponentRef* thisRef=NULL, ThreadPool* workerPool=NULL, unsigned int chunkSize=0 );
 
-		static vector<double>* ParallelEvaluate_pthreads( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, unsigned int nThreads, ComponentRef* thisRef=NULL );
+		static vector<double>* ParallelEvaluate_pthreads( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, unsigned int nThreads, ComponentRef* thisRef=NULL, ThreadPool* workerPool=NULL, unsigned int chunkSize=0 );
+
+		/*!
+		 * @brief Run the given task once per Fitting_Thread, on the worker pool if possible, else on freshly created pthreads
+		 *
+		 * With a chunkSize the slices are instead cut into chunks of that many events which are claimed by the free workers of the pool
+		 */
+		static void RunThreads( void* (*poolTask)( void* ), void* (*threadTask)( void* ), Fitting_Thread* fit_thread_data, unsigned int nThreads, ThreadPool* workerPool, unsigned int chunkSize=0 );
+
+		/*!
+		 * @brief Run the task over chunks of chunkSize events and collect the results of each slice in order
+		 *
+		 * @return false if the pool was unavailable or has more workers than there are slices, nothing is run in this case
+		 */
+		static bool RunChunks( void* (*poolTask)( void* ), Fitting_Thread* fit_thread_data, unsigned int nThreads, ThreadPool* workerPool, unsigned int chunkSize );
+
+		/*!
+		 * Bodies of the thread functions, these return so they can be run by the ThreadPool
+		 */
+		static void* Evaluate_task( void *input_data );
+		static void* EvaluateComponent_task( void *input_data );
+		static void* Integrate_task( void *input_data );
+		static void* Chunk_task( void *input_data );
 
                 #ifndef __CINT__
                         //      CINT behaves badly with this attribute
@@ -58,21 +81,9 @@ class MultiThreadedFunctions
 			static void* Integrate_pthread( void *input_data );
 		#endif
 
-		static Fitting_Thread* GetFittingThreadData( unsigned int nThreads );
-
-		static Fitting_Thread* stored_tread_data;
-
-		static unsigned int stored_thread_data_n;
-
-		static pthread_t* GetFittingThreads( unsigned int nThreads );
-
-		static pthread_t* Thread;
-
-		static unsigned int Threads_n;
-
-		static vector<double>* ParallelIntegrate_pthreads( IPDF* thisFunction, IDataSet* thesePoints, PhaseSpaceBoundary* thisBoundary, unsigned int nThreads );
+		static vector<double>* ParallelIntegrate_pthreads( IPDF* thisFunction, IDataSet* thesePoints, PhaseSpaceBoundary* thisBoundary, unsigned int nThreads, ThreadPool* workerPool=NULL, unsigned int chunkSize=0 );
 
-		static vector<double>* ParallelIntegrate_pthreads( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, vector<PhaseSpaceBoundary*> thisBoundary, unsigned int nThreads );
+		static vector<double>* ParallelIntegrate_pthreads( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, vector<PhaseSpaceBoundary*> thisBoundary, unsigned int nThreads, ThreadPool* workerPool=NULL, unsigned int chunkSize=0 );
 
 		static vector<IPDF*> GetFunctions( IPDF* thisFunction, unsigned int nThreads );
 
@@ -24,6 +24,8 @@ class NegativeLogLikelihood : public FitFunction
 
 	protected:
 		virtual double EvaluateDataSet( IPDF*, IDataSet*, int );
+		virtual bool ProvidesDataSetGradient() const;
+		virtual bool EvaluateDataSetGradient( IPDF*, IDataSet*, int, const vector<string>&, vector<double>& );
 };
 #endif
 
@@ -26,7 +26,30 @@ class NegativeLogLikelihoodThreaded : public FitFunction
 	protected:
 		virtual double EvaluateDataSet( IPDF*, IDataSet*, int );
 
+		/*!
+		 * @brief Evaluate the slices of every DataSet in a single batch on the ThreadPool
+		 *
+		 * The slices are shared between the workers according to how long each took in the previous call (initially the number of events),
+		 * so the workers evaluating slices of a large DataSet also pick up the slices of the small ones.
+		 * Each slice is summed exactly as in EvaluateDataSet, so the result doesn't depend on how they were shared out
+		 *
+		 * With a ChunkSize the chunks of every DataSet are handed out together instead
+		 */
+		virtual bool EvaluateAllDataSets( vector<double>& output );
+		virtual bool ProvidesDataSetGradient() const;
+		virtual bool EvaluateDataSetGradient( IPDF*, IDataSet*, int, const vector<string>&, vector<double>& );
+
 	private:
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		NegativeLogLikelihoodThreaded( const NegativeLogLikelihoodThreaded& );
+
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		NegativeLogLikelihoodThreaded& operator= ( const NegativeLogLikelihoodThreaded& );
+
 		#ifndef __CINT__
 			//	CINT behaves badly with this attribute
 			//	and,
@@ -38,6 +61,62 @@ class NegativeLogLikelihoodThreaded : public FitFunction
 			static void* ThreadWork( void* );
 		#endif
 
+			/*!
+			 * @brief The body of ThreadWork, this returns so that it can be run by the ThreadPool
+			 */
+			static void* EvaluateSubSet( void* );
+
+			/*!
+			 * @brief Sum the derivatives of the NLL over the DataPoints given to one thread
+			 */
+			static void* EvaluateSubSetGradient( void* );
+
+			/*!
+			 * @brief Run EvaluateSubSet for each slice given to one worker by EvaluateAllDataSets and time each of them
+			 */
+			static void* EvaluateSlices( void* );
+
+			/*!
+			 * @brief Fill the Fitting_Thread objects handed to each thread for this DataSet
+			 *
+			 * @param threadData  Array of Threads objects to be filled
+			 */
+			void PrepareThreadData( Fitting_Thread* threadData, IDataSet* TotalDataSet, const int number );
+
+			/*!
+			 * @brief Combine the sums over each block of events for one DataSet in block order, DBL_MAX if any thread failed
+			 *
+			 * @param nThreadData  Number of Fitting_Thread objects to combine
+			 */
+			double CombineThreadData( const Fitting_Thread* threadData, const unsigned int nThreadData ) const;
+
+			/*!
+			 * @brief Split a DataSet into contiguous chunks of chunkSize events, this is only done the first time it is evaluated
+			 *
+			 * chunkSize is rounded up to a whole number of blocks of Threading::EventsPerBlock() events
+			 */
+			void MakeChunks( IDataSet* TotalDataSet, const unsigned int number );
+
+			/*!
+			 * @brief Evaluate all of the chunks of the given DataSets on the ThreadPool, each chunk is claimed by the first free worker
+			 *
+			 * @param gradientNames  Parameters to differentiate the NLL wrt, NULL to evaluate the NLL itself
+			 *
+			 * @return false if the ThreadPool couldn't be used and nothing was evaluated
+			 */
+			bool EvaluateChunks( const vector<unsigned int>& numbers, const vector<string>* gradientNames=NULL );
+
+			/*!
+			 * @brief Evaluate one chunk, or its gradient, with the copy of the PDF belonging to the worker which claimed it
+			 */
+			static void* EvaluateChunk( void* );
+
+			Fitting_Thread* allSlices;		/*!	Threads slices of each DataSet used by EvaluateAllDataSets		*/
+			vector<double> sliceCost;		/*!	Seconds taken by each slice in the last call, or its number of events	*/
+			bool sliceCostMeasured;			/*!	Has sliceCost been measured yet?					*/
+			vector<Fitting_Thread*> chunkData;	/*!	Chunks of chunkSize events for each DataSet				*/
+			vector<unsigned int> numberChunks;	/*!	Number of chunks of each DataSet					*/
+
 };
 
 #endif
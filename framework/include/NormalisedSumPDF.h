@@ -47,6 +47,21 @@ class NormalisedSumPDF : public BasePDF
 		double Evaluate( DataPoint* );
 		double EvaluateForNumericIntegral( DataPoint* );
 
+		//Evaluate a range of events by passing the whole range to each of the two PDFs
+		void EvaluateBatch( IDataSet*, const unsigned int begin, const unsigned int end, double* output );
+
+		//Precompute the DerivedColumns of both PDFs
+		void PrecomputeDerivedColumns( IDataSet* );
+
+		//Return the fraction and every parameter which both PDFs can differentiate analytically
+		vector<string> GetAnalyticGradientParameters();
+
+		//Derivative of the sum of the two normalised PDFs
+		bool EvaluateGradient( DataPoint*, const vector<string>& Names, double* output );
+
+		//The sum is already normalised so the derivative of the Integral is 0
+		bool IntegralGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>& Names, double* output );
+
 		//Set the function parameters
 		bool SetPhysicsParameters( ParameterSet* );
 
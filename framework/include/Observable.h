@@ -48,9 +48,6 @@ class Observable
 		void SetAcceptance( const double ) const;
 		void SetBkgAcceptance( const double ) const;
 
-		void SetOffSet( const double ) const;
-		double GetOffSet() const;
-
 		string GetName() const;
 
 		void Print() const;
@@ -66,7 +63,6 @@ class Observable
 		mutable int bkg_bin_num;
 		mutable double acceptance;
 		mutable double bkg_acceptance;
-		mutable double offset;
 };
 
 #endif
@@ -32,7 +32,7 @@ class ObservableDiscreteConstraint : public IConstraint
 		//Interface functions
 		virtual bool CheckObservable( Observable* ) const;
 		virtual Observable* CreateObservable() const;
-		virtual Observable* CreateObservable( TRandom3* ) const;
+		virtual Observable* CreateObservable( TRandom* ) const;
 		virtual string GetName() const;
 		virtual string GetUnit() const;
 		virtual double GetMaximum() const;
@@ -104,6 +104,8 @@ class PDFConfigurator
 
 		bool hasConfigurationOption( string ) const;
 
+		vector<string> GetConfigurationValues() const;
+
 	private:
 
 		//      Uncopyable This Way!
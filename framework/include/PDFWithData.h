@@ -37,6 +37,15 @@ class PDFWithData
 		 */
 		PDFWithData( IPDF* InputPDF, PhaseSpaceBoundary* InputPhaseSpace, DataSetConfiguration* InputConfig );
 
+		/*!
+		 * @brief Copy Constructor
+		 *
+		 * The PDF, PhaseSpaceBoundary and DataSetConfiguration are all copied so the new instance can be used in a different thread
+		 * The cached DataSet is NOT copied, the new instance will make its own
+		 * The copy does NOT take control of any MC cache files already made for the PDF
+		 */
+		PDFWithData( const PDFWithData& );
+
 		/*!
 		 * @brief Destructor
 		 *
@@ -74,6 +83,11 @@ class PDFWithData
 		 */
 		IPDF * GetPDF() const;
 
+		/*!
+		 * @brief Get a pointer to the PhaseSpaceBoundary the DataSets are created in
+		 */
+		PhaseSpaceBoundary * GetPhaseSpaceBoundary() const;
+
 		/*!
 		 * @brief Get a new/cached dataset.
 		 *        When the source is a 'File' it is permenantly cached in memory and by definition doesn't ever change
@@ -120,11 +134,6 @@ class PDFWithData
 		void SetUseCache( bool );
 
 	private:
-		/*!
-		 * Don't Copy the class this way!
-		 */
-		PDFWithData ( const PDFWithData& );
-
 		/*!
 		 * Don't Copy the class this way!
 		 */
@@ -138,6 +147,8 @@ class PDFWithData
 
 		mutable bool useCache;				/*!	Should PDFWithData return the last cached DataSet that it has (default false)		*/
 
+		bool ownsMCCache;				/*!	Should the MC cache files of the PDF be removed when this instance is destroyed		*/
+
 };
 
 #endif
@@ -231,6 +231,37 @@ class ParameterSet
 		 */
 		void FloatedFirst( vector<string> ParameterList=vector<string>() );
 
+		/*!
+		 * @brief Mark every PhysicsParameter in this set as unchanged
+		 *
+		 * After this any change to the value, limits or type of a PhysicsParameter, either directly or through SetPhysicsParameters, will mark it as changed again
+		 *
+		 * @return Void
+		 */
+		void ResetChanged();
+
+		/*!
+		 * @brief Has the value, limits or type of any PhysicsParameter changed since the last call to ResetChanged?
+		 */
+		bool HasChanged() const;
+
+		/*!
+		 * @brief Has the value of the requested PhysicsParameter changed since the last call to ResetChanged?
+		 */
+		bool HasChanged( const ObservableRef& Name ) const;
+
+		/*!
+		 * @brief Has the value of any of the requested PhysicsParameters changed since the last call to ResetChanged?
+		 *
+		 * This allows a PDF to only re-calculate internal caches which depend on the parameters which have actually moved
+		 */
+		bool HasChanged( const vector<ObservableRef>& Names ) const;
+
+		/*!
+		 * @brief The Names of all PhysicsParameters which have changed since the last call to ResetChanged
+		 */
+		vector<string> GetChangedNames() const;
+
 	private:
 
 		void SetUniqueID( size_t );
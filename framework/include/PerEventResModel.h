@@ -54,6 +54,10 @@ class PerEventResModel : public IResolutionModel
 		pair<double,double> ExpCosSin( double time, double gamma, double dms );
 		pair<double,double> ExpCosSinInt( double tlow, double thigh, double gamma, double dms );
 
+		void ExpBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, double* output );
+		void ExpCosSinBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, const double dms,
+				double* outCos, double* outSin );
+
 		bool isPerEvent() ;
 
 		//Wrappers
@@ -83,6 +87,11 @@ class PerEventResModel : public IResolutionModel
 		unsigned int numberComponents;
 
 		bool isCacheValid;
+
+		/*!
+		 * @brief Scaled per-event resolutions of the events [begin,end) of the DataSet
+		 */
+		void EventResolutions( IDataSet* data, const unsigned int begin, const unsigned int end, vector<double>& resolution ) const;
 };
 
 #endif
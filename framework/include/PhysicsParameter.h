@@ -21,6 +21,13 @@ class PhysicsParameter
 	public:
 		static bool DiffParams( PhysicsParameter* first, PhysicsParameter* second );
 
+		/*!
+		 * @brief Do the two parameters have the same value, limits, type and blinding?
+		 *
+		 * Used to decide if a parameter has changed in a way which a PDF can see
+		 */
+		static bool SameSettings( const PhysicsParameter* first, const PhysicsParameter* second );
+
 		PhysicsParameter( string );
 		PhysicsParameter( string, double, double, double, double, string, string );
 		PhysicsParameter( string, double, double, string, string );
@@ -68,6 +75,18 @@ class PhysicsParameter
 
 		void SetBlindingInfo( string, double );
 
+		/*!
+		 * @brief Has the value, limits, type or blinding of this parameter been changed since the last call to SetChanged( false )?
+		 *
+		 * A newly constructed parameter is always considered to have changed
+		 */
+		bool HasChanged() const;
+
+		/*!
+		 * @brief Mark or un-mark this parameter as having changed
+		 */
+		void SetChanged( const bool );
+
 	private:
 		string name;
 		double value;
@@ -85,6 +104,8 @@ class PhysicsParameter
 		double blindScale;
 
 		bool _isFixed;
+
+		bool changed;		/*!	Has the value been changed since the last time this flag was reset	*/
 };
 
 #endif
@@ -70,6 +70,21 @@ class ProdPDF : public BasePDF
 		double Evaluate( DataPoint* );
 		double EvaluateForNumericIntegral( DataPoint* );
 
+		//Evaluate a range of events by passing the whole range to each of the two PDFs
+		void EvaluateBatch( IDataSet*, const unsigned int begin, const unsigned int end, double* output );
+
+		//Precompute the DerivedColumns of both PDFs
+		void PrecomputeDerivedColumns( IDataSet* );
+
+		//Return every parameter which both PDFs can differentiate analytically
+		vector<string> GetAnalyticGradientParameters();
+
+		//Derivative of the product of the two PDFs
+		bool EvaluateGradient( DataPoint*, const vector<string>& Names, double* output );
+
+		//Derivative of the product of the integrals of the two PDFs
+		bool IntegralGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>& Names, double* output );
+
 		//Return a prototype data point
 		vector<string> GetPrototypeDataPoint();
 
@@ -31,6 +31,10 @@ class RapidFitConfiguration
 
 		//Variables to store command line arguments
 		int numberRepeats;
+		int toyWorkers;
+		int scanWorkers;
+		int adaptiveContourFits;
+		vector<double> adaptiveContourLevels;
 		unsigned int Nuisencemodel;
 		int jobNum;
 		int nData;
@@ -70,6 +74,10 @@ class RapidFitConfiguration
 		bool saveOneDataSetFlag;
 		bool saveOneFoamDataSetFlag;
 		bool testIntegratorFlag;
+		bool testIntegratorThreadsFlag;
+		bool testFaddeevaFlag;
+		bool testCacheDependenciesFlag;
+		bool benchmarkAcceptRejectFlag;
 		bool testComponentPlotFlag;
 		bool observableNameFlag;
 		bool doPlottingFlag;
@@ -25,20 +25,16 @@
 ///	System Headers
 #include <string>
 #include <vector>
+#include <pthread.h>
 
 class IPDF;
 class FoamIntegrator;
 class IntegratorFunction;
+class ThreadPool;
 
 using namespace ROOT::Math;
 using namespace::std;
 
-static vector<DataPoint*> _global_doEval_points;
-static vector<double> _global_range_minima;
-static vector<double> _global_range_maxima;
-static vector<string> _global_observable_names;
-static string GSLvalidFor;
-
 class RapidFitIntegrator
 {
 	public:
@@ -96,6 +92,16 @@ class RapidFitIntegrator
 
 		void SetNumThreads( const unsigned int input );
 
+		/*!
+		 * @brief Persistent workers to use for the threaded GSL integral, NULL to create threads per call
+		 *
+		 * This is not copied with the integrator as the pool is owned by the FitFunction which created it
+		 *
+		 * @param input      Workers owned by the FitFunction
+		 * @param chunkSize  Points per task claimed by the workers, 0 for one slice per thread
+		 */
+		void SetWorkerPool( ThreadPool* input, const unsigned int chunkSize=0 );
+
 		/*!
 		 *
 		 * @brief Setup the Integrator for Projections (potentially speeds up the process slightly)
@@ -273,12 +279,24 @@ class RapidFitIntegrator
 		 */
 		vector<string> DontNumericallyIntegrateList( const DataPoint*, vector<string> = vector<string>() );
 
-		static vector<DataPoint*> getGSLIntegrationPoints( unsigned int number, vector<double> maxima, vector<double> minima, DataPoint* templateDataPoint, vector<string> doIntegrate,
-									PhaseSpaceBoundary* input );
-
-		static void clearGSLIntegrationPoints();
+		/*!
+		 * @brief Free the GSL integration points held by this integrator, they are re-generated on the next GSL integral
+		 */
+		void clearGSLIntegrationPoints();
 	private:
 
+		/*!
+		 * @brief Get the GSL integration points of this integrator as one DataSet per thread
+		 *
+		 * The quasi-random points are only generated when the integrated observables, their ranges or the number of points change,
+		 * and the DataSets are only rebuilt when the PhaseSpace or number of threads also change.
+		 * On every call the observables which aren't integrated are copied from the template DataPoint.
+		 *
+		 * These are owned by this instance and are deleted by clearGSLIntegrationPoints or the destructor
+		 */
+		vector<IDataSet*> getGSLIntegrationPoints( unsigned int number, vector<double> maxima, vector<double> minima, DataPoint* templateDataPoint, vector<string> doIntegrate,
+									const PhaseSpaceBoundary* input, unsigned int nThreads );
+
 		/*!
 		 * Don't Copy the class this way!
 		 */
@@ -314,8 +332,21 @@ class RapidFitIntegrator
 		static double PseudoRandomNumberIntegral( IPDF* functionToWrap, const DataPoint * NewDataPoint, const PhaseSpaceBoundary * NewBoundary, ComponentRef* componentIndex,
 				vector<string> doIntegrate, vector<string> doNotIntegrate, unsigned int GSLFixedPoints=10000 );
 
-		static double PseudoRandomNumberIntegralThreaded( IPDF* functionToWrap, const DataPoint * NewDataPoint, const PhaseSpaceBoundary * NewBoundary, ComponentRef* componentIndex,
-				vector<string> doIntegrate, vector<string> doNotIntegrate, unsigned int num_threads=4, unsigned int GSLFixedPoints=10000 );
+		/*!
+		 * @brief Threaded version of PseudoRandomNumberIntegral using the GSL points and PDF copies owned by this instance
+		 */
+		double PseudoRandomNumberIntegralThreaded( const DataPoint * NewDataPoint, const PhaseSpaceBoundary * NewBoundary, ComponentRef* componentIndex,
+				vector<string> doIntegrate, vector<string> doNotIntegrate );
+
+		/*!
+		 * @brief Get one copy of functionToWrap per thread, updated to the current PhysicsParameters
+		 */
+		vector<IPDF*> GetThreadFunctions( const unsigned int nThreads );
+
+		/*!
+		 * @brief Construct a MultiDim integrator with the tolerances requested of this instance
+		 */
+		AdaptiveIntegratorMultiDim* NewMultiDimIntegrator() const;
 
 		/*!
 		 * @brief This is the Interface to The MuliDimentional Integral class within ROOT
@@ -400,14 +431,55 @@ class RapidFitIntegrator
 
 		unsigned int num_threads;
 
+		ThreadPool* workerPool;
+		unsigned int workerChunkSize;
+
 		unsigned int GSLFixedPoints;
 
 
-		//static vector<double*> initGSLDataPoints( unsigned int number, vector<double> maxima, vector<double> minima );
+		/*!
+		 * Settings of the MultiDim integrator, kept so that a second integrator can be built when this instance is busy
+		 */
+		unsigned int maxIntegrationSteps;
+		double integrationAbsTolerance;
+		double integrationRelTolerance;
 
-		static vector<DataPoint*> initGSLDataPoints( unsigned int number, vector<double> maxima, vector<double> minima, DataPoint* thisDataPoint, vector<string> doIntegrate );
+		/*!
+		 * @brief Held while a thread numerically integrates with this instance
+		 *
+		 * The ROOT integrators, GSL points and functionToWrap all belong to this instance, so threads sharing it take turns.
+		 * Threads wanting to integrate at the same time should each use their own copy of the PDF, as the threaded FitFunctions do
+		 */
+		pthread_mutex_t integratorLock;
 
-		static void ModifiyStoredPoints( DataPoint* NewDataPoint, string ProjectThis );
+		/*!
+		 * @brief GSL integration points, one column of gslNumberPoints values per integrated observable
+		 */
+		vector<double> gslColumns;
+
+		/*!
+		 * The number of points, ranges and observables gslColumns were generated for
+		 */
+		unsigned int gslNumberPoints;
+		vector<double> gslMinima;
+		vector<double> gslMaxima;
+		vector<string> gslObservableNames;
+
+		/*!
+		 * @brief The GSL integration points as one DataSet per thread, and the ID of the PhaseSpace they were built in
+		 */
+		vector<IDataSet*> gslSlices;
+		size_t gslBoundaryID;
+
+		/*!
+		 * @brief Copies of functionToWrap used by the threaded GSL integral
+		 */
+		vector<IPDF*> threadFunctions;
+
+		/*!
+		 * @brief Generate number quasi-random points within the given ranges, stored one column per observable
+		 */
+		static vector<double> initGSLDataPoints( unsigned int number, vector<double> maxima, vector<double> minima );
 
 		mutable RapidFitIntegratorConfig* _storedConfig;
 };
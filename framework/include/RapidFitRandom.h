@@ -3,6 +3,10 @@
 #define RAPIDFITRANDOM_H
 
 #include "TRandom3.h"
+#include "RapidFitRandomStream.h"
+
+#include <pthread.h>
+#include <stdint.h>
 
 class RapidFitRandom
 {
@@ -36,9 +40,9 @@ class RapidFitRandom
 		/*!
 		 * @brief Get the Random function stored for Physics Sim
 		 *
-		 * @return pointer to the TRandom3 instance inside the centinel
+		 * @return pointer to the TRandom3 instance inside the centinel, or the random number generator set for this thread
 		 */
-		static TRandom3* GetRandomFunction();
+		static TRandom* GetRandomFunction();
 
 		/*!
 		 * @brief Get the Random function intended to be used for internal framework use
@@ -49,8 +53,55 @@ class RapidFitRandom
 
 		static int GetSeedNumFramework();
 
+		/*!
+		 * @brief Use a different TRandom3 instance for Physics Sim in the calling thread only
+		 *
+		 * This allows independent workers (eg a parallel ToyStudy) to each generate from their own reproducable stream
+		 *
+		 * @param Input   Random number generator owned by the caller (normally a RapidFitRandomStream), NULL returns the thread to the shared instance
+		 *
+		 * @return Void
+		 */
+		static void SetThreadRandomFunction( TRandom* Input );
+
+		/*!
+		 * @brief Use a different TRandom3 instance for internal framework use in the calling thread only
+		 *
+		 * @param Input   TRandom3 instance owned by the caller, NULL returns the thread to the shared instance
+		 *
+		 * @return Void
+		 */
+		static void SetThreadFrameworkRandomFunction( TRandom3* Input );
+
+		/*!
+		 * @brief Get the seed used as the key of every RapidFitRandomStream
+		 *
+		 * This is the seed from the XML, if this is 0 (a random seed) it is drawn once from the shared TRandom3 instance
+		 *
+		 * @return Returns the seed of all RapidFitRandomStreams made in this job
+		 */
+		static uint32_t GetStreamSeed();
+
+		/*!
+		 * @brief Make a new random number stream which is independent of every other stream with a different Stream or Thread
+		 *
+		 * The same Stream and Thread always give the same sequence for the same seed, whichever thread calls this and in whatever order
+		 *
+		 * @param Stream  Number identifying the work this stream is for, eg a toy number or scan point number
+		 *
+		 * @param Thread  Number identifying a part of that work, eg a thread within a generator
+		 *
+		 * @return pointer to a new RapidFitRandomStream, this is owned by the caller
+		 */
+		static RapidFitRandomStream* MakeRandomStream( const uint64_t Stream, const uint32_t Thread=0 );
+
 	private:
 
+		/*!
+		 * Create the keys used to hold the per-thread TRandom3 instances
+		 */
+		static void MakeThreadKeys();
+
 		/*!
 		 * vector of a single TRandom3 object for this PDF, this allows us to have a reproducable result for a defined seed
 		 * the seed_function.empty() is used to see if this is defined, should probably check for NULL pointer, but oh well
@@ -64,6 +115,16 @@ class RapidFitRandom
 		 */
 		static int seed_num;
 
+		static uint32_t stream_seed;
+
+		static bool stream_seed_set;
+
+		static pthread_once_t thread_keys_once;
+
+		static pthread_key_t thread_seed_function;
+
+		static pthread_key_t thread_seed_function_Framework;
+
 };
 
 #endif
@@ -0,0 +1,115 @@
+/*!
+ * @class RapidFitRandomStream
+ *
+ * @brief Counter-based random number stream (Philox4x32-10) which can be used anywhere a TRandom is expected
+ *
+ * Each stream is identified by a key of (Seed, Stream, Thread), eg the XML seed, the number of a toy and the number of a generator thread.
+ * The n'th number in a stream is a pure function of the key and n, so:
+ *
+ *   - Streams with different keys are independent, no matter the order or the thread in which they are used
+ *   - Any stream can be re-created, or moved to any position, without drawing the numbers before it
+ *
+ * Every call to Rndm() uses 64 bits of one Philox block, so each block gives 2 numbers
+ *
+ * See: Salmon, Moraes, Dror & Shaw, "Parallel Random Numbers: As Easy as 1, 2, 3", SC11
+ */
+
+#pragma once
+#ifndef RAPIDFIT_RANDOM_STREAM_H
+#define RAPIDFIT_RANDOM_STREAM_H
+
+///	ROOT Headers
+#include "TRandom.h"
+#include "RVersion.h"
+///	System Headers
+#include <stdint.h>
+
+class RapidFitRandomStream : public TRandom
+{
+	public:
+		/*!
+		 * @brief Constructor
+		 *
+		 * @param Seed    Seed of the whole job, normally the seed from the XML
+		 *
+		 * @param Stream  Number of this stream within the job, eg the toy number or scan point number
+		 *
+		 * @param Thread  Number of the thread using this stream, for work split within a single toy or scan point
+		 */
+		RapidFitRandomStream( const uint32_t Seed, const uint64_t Stream=0, const uint32_t Thread=0 );
+
+		/*!
+		 * @brief Destructor
+		 */
+		virtual ~RapidFitRandomStream();
+
+		/*!
+		 * @brief Uniform random number in (0,1), 0 and 1 are never returned
+		 */
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+		virtual Double_t Rndm();
+#else
+		virtual Double_t Rndm( Int_t i=0 );
+#endif
+
+		/*!
+		 * @brief Fill an array with uniform random numbers in (0,1)
+		 */
+		virtual void RndmArray( Int_t n, Double_t* array );
+
+		/*!
+		 * @brief Fill an array with uniform random numbers in (0,1)
+		 */
+		virtual void RndmArray( Int_t n, Float_t* array );
+
+		/*!
+		 * @brief Switch to a different Stream and Thread with the same Seed, the next number is the first in the new stream
+		 *
+		 * This allows a single object to be handed to eg TFoam once and then re-used for many independent blocks of work
+		 */
+		void SetKey( const uint64_t Stream, const uint32_t Thread );
+
+		/*!
+		 * @brief Move to the requested position in the stream, the next call to Rndm() returns the Position'th number (counting from 0)
+		 */
+		void SetPosition( const uint64_t Position );
+
+		/*!
+		 * @brief Position of the next number in the stream
+		 */
+		uint64_t GetPosition() const;
+
+		/*!
+		 * @brief Philox4x32-10 block function
+		 *
+		 * @param counter  4 words of counter, replaced with the 4 words of output
+		 *
+		 * @param key      2 words of key
+		 */
+		static void Philox( uint32_t* counter, const uint32_t* key );
+
+	private:
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		RapidFitRandomStream( const RapidFitRandomStream& );
+
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		RapidFitRandomStream& operator= ( const RapidFitRandomStream& );
+
+		/*!
+		 * @brief Calculate the block for the current position and store the output
+		 */
+		void FillBlock();
+
+		uint32_t key[2];		/*!	Seed and Thread							*/
+		uint64_t stream;		/*!	Stream number, the upper 2 words of each counter			*/
+		uint64_t position;		/*!	Position of the next number in the stream			*/
+		uint32_t block[4];		/*!	Output of the block holding the number at position		*/
+		uint64_t blockNumber;		/*!	Block number stored in block, or -1 if none has been calculated	*/
+};
+
+#endif
+
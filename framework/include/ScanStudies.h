@@ -74,6 +74,29 @@ class ScanStudies
 				const vector< PDFWithData* > inputPDFWithData, const vector< ConstraintFunction* > inputConstraints, OutputConfiguration* inputConfig,
 				const string param, const int output=-999, bool forceContinue=false );
 
+		/*!
+		 * @brief Set the number of workers used to fit the points of each scan
+		 *
+		 * With 0 (the default) the points are fitted one after another, each starting from the input values.
+		 * With 1 or more each point starts from the fitted parameters and covariance matrix of its best converged neighbour,
+		 * with more than 1 the points are fitted concurrently by workers holding their own copy of the fit setup
+		 *
+		 * @Param Input   Number of workers
+		 */
+		static void SetNumberWorkers( unsigned int Input );
+
+		/*!
+		 * @brief Replace the full grid of each 2D scan with an adaptive scan following the requested contours
+		 *
+		 * The scan starts from a coarse grid and repeatedly halves only the cells whose DeltaNLL straddles one of the Levels,
+		 * or which hold the lowest point found so far. Every fitted point lies on the grid defined by the ScanParams
+		 *
+		 * @Param MaxFits  Maximum number of points fitted in each 2D scan, 0 (the default) scans the full grid
+		 *
+		 * @Param Levels   DeltaNLL of each contour to follow, empty for the 68%, 90% and 95% CL contours drawn by Rapid2DLL
+		 */
+		static void SetAdaptiveContour( unsigned int MaxFits, vector<double> Levels=vector<double>() );
+
 	private:
 
 		static void DoScan( MinimiserConfiguration *, FitFunctionConfiguration *, ParameterSet*, const vector< PDFWithData* >,
@@ -82,6 +105,26 @@ class ScanStudies
 		static void DoScan2D( MinimiserConfiguration*, FitFunctionConfiguration*, ParameterSet*, const vector< PDFWithData* >,
 				const vector< ConstraintFunction* >, const pair<ScanParam*, ScanParam* >, vector<FitResultVector*>*, const int, bool forceContinue=false );
 
+		/*!
+		 * @brief Perform a 1D or 2D scan with the points shared between numberWorkers workers, each point warm-started from a neighbour
+		 *
+		 * One FitResultVector is added to the output for each value of the first parameter of a 2D scan, or for the whole of a 1D scan
+		 */
+		static void DoParallelScan( MinimiserConfiguration*, FitFunctionConfiguration*, ParameterSet*, const vector< PDFWithData* >,
+				const vector< ConstraintFunction* >, const vector<ScanParam*>, vector<FitResultVector*>*, const int, bool forceContinue=false );
+
+		/*!
+		 * @brief Perform an adaptive 2D scan, fitting at most adaptiveMaxFits points of the grid
+		 *
+		 * Only values of the first parameter with at least one fitted point are added to the output
+		 */
+		static void DoAdaptiveScan2D( MinimiserConfiguration*, FitFunctionConfiguration*, ParameterSet*, const vector< PDFWithData* >,
+				const vector< ConstraintFunction* >, const pair<ScanParam*, ScanParam* >, vector<FitResultVector*>*, const int, bool forceContinue=false );
+
+		static unsigned int numberWorkers;	/*!	Number of workers for each scan, 0 to use DoScan/DoScan2D	*/
+		static unsigned int adaptiveMaxFits;	/*!	Maximum number of fits in an adaptive 2D scan, 0 to scan the full grid	*/
+		static vector<double> adaptiveLevels;	/*!	DeltaNLL of the contours followed by an adaptive 2D scan		*/
+
 };
 
 #endif
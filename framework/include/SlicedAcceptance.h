@@ -105,6 +105,17 @@ class SlicedAcceptance
 		 */
 		double getValue( const Observable* time, const double timeOffset=0. ) const;
 
+		/*!
+		 * @brief Batch version of getValue( const double ) for many times at once
+		 *
+		 * @param time	array of n times
+		 *
+		 * @param n	number of times
+		 *
+		 * @param output	array of n acceptances to be filled
+		 */
+		void getValues( const double* time, const unsigned int n, double* output ) const;
+
 		/*!
 		 * @brief Method for the normalisation integral in slices
 		 *
@@ -123,6 +134,8 @@ class SlicedAcceptance
 
 		unsigned int findSliceNum( const Observable* time, const double offSet=0. ) const;
 
+		unsigned int findSliceNum( const double time ) const;
+
 		bool GetIsSorted() const;
 
 		double GetMax() const;
@@ -144,17 +157,32 @@ class SlicedAcceptance
 
 		bool isSorted() const;
 
-		void FindMaxMin() const;
+		/*!
+		 * @brief Set t_min and t_max from the edge table
+		 */
+		void FindMaxMin();
 
-		mutable double t_max;
-		mutable double t_min;
-		mutable bool maxminset;
+		/*!
+		 * @brief Build the table of the acceptance between every pair of neighbouring slice edges
+		 */
+		void BuildEdgeTable();
+
+		/*!
+		 * @brief Index of the edge table interval containing time, -1 if time is outside the acceptance
+		 */
+		int findEdgeNum( const double time ) const;
+
+		vector<double> edgeTable;	/*!	Sorted unique edges of all of the slices	*/
+		vector<double> heightTable;	/*!	Summed height of the slices between edgeTable[i] and edgeTable[i+1]	*/
+		bool uniformEdges;		/*!	Are the edges equally spaced, allowing the interval to be calculated directly	*/
+		double edgeWidthInverse;
+
+		double t_max;
+		double t_min;
+		bool maxminset;
 
 		mutable bool _hasChecked;
 		mutable bool _storedDecision;
-
-		mutable double returnValue;
-		mutable int finalBin;
 };
 
 #endif
@@ -0,0 +1,69 @@
+/*!
+ * @class StudyWorkers
+ *
+ * @brief Setup shared by the studies which run whole fits in parallel (ToyStudy, ScanStudies and VectoredFeldmanCousins)
+ *
+ * Each of these studies gives every worker its own copy of the Minimiser, FitFunction, PDFs and Constraints and
+ * then lets the workers claim fits from a shared queue, this class holds the parts which are identical between them
+ */
+
+#pragma once
+#ifndef RAPIDFIT_STUDY_WORKERS_H
+#define RAPIDFIT_STUDY_WORKERS_H
+
+///	ROOT Headers
+#include "TRandom3.h"
+///	System Headers
+#include <time.h>
+
+using namespace::std;
+
+class StudyWorkers
+{
+	public:
+		/*!
+		 * @brief Stop ROOT from attaching new histograms to gDirectory
+		 *
+		 * The PDFs are copied into each worker and again within each fit, which must not touch the gDirectory shared between the workers
+		 *
+		 * @return Whether histograms were being added before, to be handed back to RestoreHistograms once the workers have finished
+		 */
+		static bool DetachHistograms();
+
+		/*!
+		 * @brief Undo DetachHistograms
+		 *
+		 * @param addDirectory  The value returned by DetachHistograms
+		 */
+		static void RestoreHistograms( const bool addDirectory );
+
+		/*!
+		 * @brief Framework random function for a single worker, seeded from the global one
+		 *
+		 * This is only used for the unique IDs of the objects made by the worker, the caller owns the returned object
+		 */
+		static TRandom3* MakeFrameworkRandom();
+
+		/*!
+		 * @brief Run loop( workerInput[i] ) in a new thread for each worker and return once all of them have finished
+		 *
+		 * @param loop         Main loop of each worker
+		 * @param workerInput  Array of nWorkers pointers passed to each worker
+		 * @param nWorkers     Number of workers to start
+		 */
+		static void RunWorkers( void* (*loop)( void* ), void** workerInput, const unsigned int nWorkers );
+
+		/*!
+		 * @brief Time in seconds between two calls to clock_gettime
+		 */
+		static double ElapsedTime( const timespec& start, const timespec& stop );
+
+	private:
+		/*!
+		 * Don't Construct the class, it only holds static functions
+		 */
+		StudyWorkers();
+};
+
+#endif
+
@@ -91,6 +91,31 @@ class SumPDF : public BasePDF
 		 */
 		double Evaluate( DataPoint* );
 
+		/*!
+		 * @brief Evaluate a range of events by passing the whole range to each of the two PDFs
+		 */
+		void EvaluateBatch( IDataSet*, const unsigned int begin, const unsigned int end, double* output );
+
+		/*!
+		 * @brief Precompute the DerivedColumns of both PDFs
+		 */
+		void PrecomputeDerivedColumns( IDataSet* );
+
+		/*!
+		 * @brief The fraction and every parameter which both PDFs can differentiate analytically
+		 */
+		vector<string> GetAnalyticGradientParameters();
+
+		/*!
+		 * @brief Derivative of the weighted sum of the two PDFs
+		 */
+		bool EvaluateGradient( DataPoint*, const vector<string>& Names, double* output );
+
+		/*!
+		 * @brief Derivative of the weighted sum of the integrals of the two PDFs
+		 */
+		bool IntegralGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>& Names, double* output );
+
 		/*!
 		 * @brief Interface Function: Return a prototype data point
 		 *
@@ -0,0 +1,157 @@
+/*!
+ * @class ThreadPool
+ *
+ * @brief A set of long-lived worker threads which are parked between evaluations
+ *
+ * Creating and joining a pthread for every call from Minuit is expensive when the fit makes O(10k) calls
+ * This class creates the workers once and wakes them up for each batch of work,
+ * the calling thread then waits on a barrier until every worker has finished the batch
+ *
+ * Each worker claims the next task of the batch as soon as it finishes its last one, so a batch split into many small
+ * tasks is balanced between the workers even if the tasks take very different times
+ *
+ * The task functions have the same signature as a pthread start routine but MUST return rather than call pthread_exit
+ *
+ * If the pool is already busy, or the call comes from one of the workers of this pool, Execute returns false and the
+ * caller is expected to fall back to creating its own threads
+ */
+
+#pragma once
+#ifndef RAPIDFIT_THREAD_POOL_H
+#define RAPIDFIT_THREAD_POOL_H
+
+///	System Headers
+#include <pthread.h>
+#include <vector>
+#include <string>
+
+using namespace::std;
+
+class ThreadPool;
+
+/*!
+ * @brief Object handed to each worker so that it knows which pool it belongs to and which slot it occupies
+ */
+struct ThreadPool_Worker
+{
+	ThreadPool* pool;		/*!	Pool which owns this worker		*/
+	unsigned int index;		/*!	Index of this worker within the pool	*/
+};
+
+class ThreadPool
+{
+	public:
+		/*!
+		 * @brief Start nThreads workers which wait for work to be submitted
+		 *
+		 * @param nThreads  Number of workers in the pool (a minimum of 1 is always created)
+		 */
+		ThreadPool( const unsigned int nThreads );
+
+		/*!
+		 * @brief Wake all of the workers, ask them to stop and join them
+		 */
+		~ThreadPool();
+
+		/*!
+		 * @brief Run nTasks tasks on the pool and return once all have finished
+		 *
+		 * Task i is run as task( taskInput[i] ) by whichever worker claims it first, tasks are claimed in order
+		 *
+		 * @param task       Function to run for each task, this MUST return and not call pthread_exit
+		 * @param taskInput  Array of nTasks pointers passed to each task
+		 * @param nTasks     Number of tasks to run
+		 *
+		 * @return true if the tasks were run on the pool, false if the pool was unavailable and nothing was run
+		 */
+		bool Execute( void* (*task)( void* ), void** taskInput, const unsigned int nTasks );
+
+		/*!
+		 * @brief Number of workers in this pool
+		 */
+		unsigned int GetNumThreads() const;
+
+		/*!
+		 * @brief Is the calling thread one of the workers belonging to this pool?
+		 */
+		bool IsWorkerThread() const;
+
+		/*!
+		 * @brief Index of the calling thread within this pool, so a task can use objects belonging to the worker running it
+		 *
+		 * @return 0 to GetNumThreads()-1, or -1 if the calling thread isn't one of the workers of this pool
+		 */
+		int GetWorkerIndex() const;
+
+		/*!
+		 * @brief Time in seconds each worker has spent running tasks since the pool was created or ResetStatistics was called
+		 */
+		vector<double> GetBusyTimes() const;
+
+		/*!
+		 * @brief Number of tasks each worker has run since the pool was created or ResetStatistics was called
+		 */
+		vector<unsigned long> GetTaskCounts() const;
+
+		/*!
+		 * @brief Time in seconds between submitting each batch and the last worker finishing it, summed over all batches
+		 */
+		double GetBatchTime() const;
+
+		/*!
+		 * @brief Zero the busy times, task counts and batch time
+		 */
+		void ResetStatistics();
+
+		/*!
+		 * @brief Print the busy time and tasks of each worker and how well the batches were balanced between them
+		 */
+		void PrintStatistics( const string& label ) const;
+
+	private:
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		ThreadPool( const ThreadPool& );
+
+		/*!
+		 * Don't Copy the class this way!
+		 */
+		ThreadPool& operator= ( const ThreadPool& );
+
+		/*!
+		 * @brief Main loop of each worker, sleep until woken, run this worker's share of the tasks and report back
+		 */
+		static void* WorkerLoop( void* input );
+
+		/*!
+		 * @brief Claim and run tasks from the current batch until there are none left
+		 */
+		void RunTasks( const unsigned int index );
+
+		unsigned int nThreads;			/*!	Number of workers					*/
+		vector<pthread_t> workers;		/*!	Handles of the running workers				*/
+		vector<ThreadPool_Worker> workerInfo;	/*!	Per-worker input to WorkerLoop				*/
+
+		pthread_mutex_t poolLock;		/*!	Protects all of the state below				*/
+		pthread_cond_t wakeCondition;		/*!	Signalled when a new batch is ready or on shutdown	*/
+		pthread_cond_t doneCondition;		/*!	Signalled when the last worker finishes a batch		*/
+		pthread_mutex_t dispatchLock;		/*!	Only one caller may submit work at a time		*/
+
+		unsigned long generation;		/*!	Incremented for each batch submitted			*/
+		unsigned int pending;			/*!	Number of workers still running the current batch	*/
+		bool shutdown;				/*!	Set when the workers should exit			*/
+
+		void* (*currentTask)( void* );		/*!	Task for the current batch				*/
+		void** currentInput;			/*!	Input for the current batch				*/
+		unsigned int currentTasks;		/*!	Number of tasks in the current batch			*/
+		unsigned int nextTask;			/*!	Next task of the current batch to be claimed		*/
+
+		vector<double> busyTime;		/*!	Seconds each worker has spent running tasks		*/
+		vector<unsigned long> tasksRun;		/*!	Number of tasks run by each worker			*/
+		double batchTime;			/*!	Seconds taken by all batches				*/
+		unsigned long batches;			/*!	Number of batches run					*/
+};
+
+#endif
+
@@ -7,9 +7,12 @@
 #include "DataPoint.h"
 #include "IDataSet.h"
 #include "ComponentRef.h"
+#include "CompensatedSum.h"
 
 #include <vector>
 #include <string>
+#include <utility>
+#include <pthread.h>
 
 using namespace::std;
 
@@ -20,12 +23,14 @@ class IDataSet;
 //	This object is useful as multiple bits of information need to be provided to the running thread
 struct Fitting_Thread{
 	explicit Fitting_Thread() :
-		dataSubSet(), fittingPDF(NULL), useWeights(false), dataPoint_Result(), FitBoundary(NULL),
-		stored_integral(0.), weightsSquared(false), dataSet(NULL), thisComponent(NULL)
+		dataSet(NULL), dataBegin(0), dataEnd(0), fittingPDF(NULL), useWeights(false), dataPoint_Result(), FitBoundary(NULL),
+		stored_integral(0.), weightsSquared(false), thisComponent(NULL),
+		gradientNames(), gradient_Result(), gradientValid(true), NLL_Blocks(), NLL_Valid(true), offSetNLL(false)
 	{}
 
-	vector<DataPoint*> dataSubSet;		/*!	DataPoints to be evaluated by this thread		*/
-	IDataSet* dataSet;			/*!	DataSet containtaining the DataPoints			*/
+	IDataSet* dataSet;			/*!	DataSet containtaining the events to be evaluated by this thread	*/
+	unsigned int dataBegin;			/*!	Index of the first event to be evaluated within dataSet	*/
+	unsigned int dataEnd;			/*!	Index one past the last event to be evaluated in dataSet	*/
 	IPDF* fittingPDF;			/*!	Pointer to the PDF instance to be used by this thread	*/
 	bool useWeights;			/*!	Are we performing a weighted fit?			*/
 	vector<double> dataPoint_Result;	/*!	Result for evaluating each datapoint			*/
@@ -35,6 +40,14 @@ struct Fitting_Thread{
 
 	ComponentRef* thisComponent;
 
+	vector<string> gradientNames;		/*!	Parameters to differentiate wrt in gradient evaluations	*/
+	vector<double> gradient_Result;		/*!	Sum of the derivatives over all datapoints		*/
+	bool gradientValid;			/*!	Were all of the derivatives calculated?			*/
+
+	vector<CompensatedSum> NLL_Blocks;	/*!	Sum of the log-likelihood over each block of Threading::EventsPerBlock() events	*/
+	bool NLL_Valid;				/*!	Did every datapoint give a valid log-likelihood?	*/
+	bool offSetNLL;				/*!	Subtract the initial log-likelihood of each datapoint?	*/
+
 	private:
 		Fitting_Thread(const Fitting_Thread&);
 		Fitting_Thread& operator=(const Fitting_Thread&);
@@ -49,11 +62,20 @@ class Threading
 		//	Split the data into subset(s) with a safe default
 		static vector<vector<DataPoint*> > divideData( IDataSet*, int=1 );
 
+		//	Split the events of the data into contiguous [begin,end) ranges, each range starts on a multiple of blockSize events
+		static vector<pair<unsigned int,unsigned int> > divideRanges( IDataSet*, int=1, unsigned int blockSize=1 );
+
+		//	Events in each block of a DataSet which is always summed in the same order, independent of the number of threads
+		static unsigned int EventsPerBlock();
+
 		static vector<IDataSet*> divideDataSet( IDataSet* input, unsigned int subsets=1 );
 
 		//	Function to divide the data values used in the threaded GSL Norm function
 		static vector<vector<double*> > divideDataNormalise( vector<double*> input, int subsets=1 );
 
+		//	Lock held by any thread reading or writing ROOT files or building a Foam generator, as these all go through gDirectory
+		static pthread_mutex_t* RootIOLock();
+
 	private:
 
 		//	Cannot Construct this class, it's simply a collection of static methods
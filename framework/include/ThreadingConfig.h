@@ -1,18 +1,26 @@
-
 #pragma once
 #ifndef _THREADING_CONFIG_H_
 #define _THREADING_CONFIG_H_
 
 #include <string>
+#include <cstddef>
 
 using namespace::std;
 
+class ComponentRef;
+class ThreadPool;
+
 class ThreadingConfig
 {
 	public:
+		ThreadingConfig() : MultiThreadingInstance(), numThreads(0), wantedComponent(NULL), workerPool(NULL), chunkSize(0)
+		{}
+
 		string MultiThreadingInstance;
 		unsigned int numThreads;
 		ComponentRef* wantedComponent;
+		ThreadPool* workerPool;		/*!	Persistent workers to dispatch into, NULL creates threads per call	*/
+		unsigned int chunkSize;		/*!	Events per task claimed from workerPool, 0 for one slice per thread	*/
 };
 
 #endif
@@ -57,6 +57,10 @@ class TimeAccRes : public IResolutionModel
 		pair<double, double> ExpCosSin( double time, double gamma, double dms );
 		pair<double, double> ExpCosSinInt( double tlow, double thigh, double gamma, double dms );
 
+		void ExpBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, double* output );
+		void ExpCosSinBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, const double dms,
+				double* outCos, double* outSin );
+
 		bool isPerEvent();
 
 		bool CacheValid() const;
@@ -69,6 +73,9 @@ class TimeAccRes : public IResolutionModel
 		double GetFraction( unsigned int input ) { (void) input; return 0.; };
 
 	private:
+		//	Uncopyable!
+		TimeAccRes& operator = ( const TimeAccRes& );
+
 		double GetThisScale() { return 0.; };
 
 		IResolutionModel* resolutionModel;
@@ -78,6 +85,53 @@ class TimeAccRes : public IResolutionModel
 
 		void ConfigTimeAcc( PDFConfigurator* configurator, bool quiet );
 		void ConfigTimeRes( PDFConfigurator* configurator, bool quiet );
+		void ConfigIntegralTables( PDFConfigurator* configurator, bool quiet );
+
+		/*!
+		 * The time integrals which can be looked up in the integral tables
+		 */
+		enum IntegralType { ExpIntegral=0, ExpSinIntegral, ExpCosIntegral, ExpCosSinIntegral };
+
+		/*!
+		 * One time integral summed over all acceptance slices, keyed on its arguments
+		 */
+		struct SliceIntegral
+		{
+			IntegralType type;
+			double tlow, thigh, gamma, dms;
+			pair<double,double> value;
+			bool usable;	//	false if the sigma class failed the tolerance check against the exact integral
+		};
+
+		/*!
+		 * Sum the resolution model integrals over all of the acceptance slices
+		 */
+		pair<double,double> SlicedIntegral( IntegralType type, double tlow, double thigh, double gamma, double dms );
+
+		/*!
+		 * Look up the sliced integral in the table for the current resolution, filling the table on a miss
+		 */
+		pair<double,double> TabulatedIntegral( IntegralType type, double tlow, double thigh, double gamma, double dms );
+
+		/*!
+		 * Table to use for the current event, -1 if the exact integral has to be calculated
+		 */
+		int ResolutionClass() const;
+
+		bool useIntegralTables;			/*!	Cache the sliced integrals for each set of arguments and resolution parameters	*/
+		unsigned int resolutionClasses;		/*!	Number of sigma classes per-event resolutions are binned into, 0 means always use the exact integral	*/
+		double resolutionClassMin;
+		double resolutionClassMax;
+		double resolutionClassTolerance;	/*!	Maximum relative deviation between a class centre and its edges for the class to be used	*/
+
+		ObservableRef eventResolutionName;
+		vector<ObservableRef> resolutionParameterNames;
+		vector<double> resolutionParameterValues;
+
+		vector<vector<SliceIntegral> > integralTables;	/*!	One table per sigma class, or a single table for resolution models which aren't per-event	*/
+
+		DataPoint* currentMeasurement;
+		double currentResolution;
 };
 
 #endif
@@ -86,6 +86,19 @@ class ToyStudy	:	public IStudy
 		 */
 		void setSaveAllToys();
 
+		/*!
+		 * @brief Generate and fit the toys with this many independent workers
+		 *
+		 * Each worker has its own copy of the PDFs, FitFunction, Minimiser and a random number stream for each toy
+		 * Every fit in a worker is single threaded, this replaces the per-event threading of the FitFunction
+		 *
+		 * The results are stored in toy order and each toy is generated from a seed which only depends on the XML seed and the toy number,
+		 * so the output doesn't depend on the number of workers
+		 *
+		 * @param Input  Number of workers, 0 or 1 runs the study serially as before
+		 */
+		void SetNumberWorkers( unsigned int Input );
+
 	private:
 		//	Uncopyable!
 		ToyStudy ( const ToyStudy& );
@@ -93,8 +106,24 @@ class ToyStudy	:	public IStudy
 
 		FitResult * GenerateAndMinimise();
 
+		struct ToyQueue;
+		struct ToyWorker;
+
+		/*!
+		 * @brief Perform the study using numberWorkers worker threads
+		 */
+		void DoParallelStudy( int OutputLevel );
+
+		/*!
+		 * @brief Loop of each worker thread, takes the next toy from the shared ToyQueue until the study is complete
+		 *
+		 * @param input  This is the ToyWorker belonging to this thread
+		 */
+		static void* ToyWorkerLoop( void* input );
+
 		bool fixedNumToys;
 		bool saveAllToys;
+		unsigned int numberWorkers;
 };
 
 #endif
@@ -3,6 +3,8 @@
 #ifndef VectoredFeldmanCousins_H
 #define VectoredFeldmanCousins_H
 
+#include "TTree.h"
+
 #include "IStudy.h"
 #include "PDFWithData.h"
 #include "FitResultVector.h"
@@ -72,6 +74,22 @@ class VectoredFeldmanCousins : public IStudy
 		 */
 		void SetCommandLineParams( vector<string> );
 
+		/*!
+		 * @brief Generate and fit the toys at all of the grid points with this many independent workers
+		 *
+		 * Each (grid point, toy) pair is one task. Each worker has its own copy of the PDFs, FitFunction, Minimiser and
+		 * a random number stream for each task keyed by the grid point and toy number, so the output doesn't depend on
+		 * the number of workers. Every fit in a worker is single threaded.
+		 *
+		 * The result of each task is written to FCTasks/FCTask_P<point>_T<toy>.root as soon as it finishes, laid out
+		 * as the output of a single toy at a single grid point. If the study is interrupted and run again, the tasks whose
+		 * file already exists are read back rather than fitted again. All of the tasks are then merged into the usual study
+		 * result in grid point and toy order.
+		 *
+		 * @param Input  Number of workers, 0 or 1 runs the study serially as before
+		 */
+		void SetNumberWorkers( unsigned int Input );
+
 	private:
 
 		//	Can't be copied
@@ -93,6 +111,54 @@ class VectoredFeldmanCousins : public IStudy
 		 */
 		vector<IDataSet*> GetNewDataSets( ParameterSet* input_params );
 
+		/*!
+		 * @brief Used to get the datasets for a toy from a given set of PDFWithData, i.e. the copies belonging to a worker
+		 */
+		vector<IDataSet*> GetNewDataSets( ParameterSet* input_params, vector<PDFWithData*> thesePDFsAndData );
+
+		/*!
+		 * @brief Make the free and fixed parameter sets used at a grid point
+		 */
+		void MakeGridPointParameters( ParameterSet* inputParameters, ParameterSet*& freeParameters, ParameterSet*& fixedParameters ) const;
+
+		struct FCTask;
+		struct FCQueue;
+		struct FCWorker;
+
+		/*!
+		 * @brief Perform the study using numberWorkers worker threads
+		 */
+		void DoParallelStudy( int OutputLevel );
+
+		/*!
+		 * @brief Loop of each worker thread, takes the next (grid point, toy) task from the shared FCQueue until the study is complete
+		 *
+		 * @param input  This is the FCWorker belonging to this thread
+		 */
+		static void* FCWorkerLoop( void* input );
+
+		/*!
+		 * @brief Write the result of a finished task to its file, the caller must hold Threading::RootIOLock()
+		 */
+		void WriteTaskFile( const string& fileName, const unsigned int pointIndex, FitResultVector* fixedResult, FitResultVector* freeResult ) const;
+
+		/*!
+		 * @brief Read back the result of a task written by WriteTaskFile, the caller must hold Threading::RootIOLock()
+		 *
+		 * @return false if the file couldn't be read, in which case the task has to be performed again
+		 */
+		bool ReadTaskFile( const string& fileName, FitResultVector*& fixedResult, FitResultVector*& freeResult ) const;
+
+		/*!
+		 * @brief Rebuild a single fit from one entry of the RapidFitResult tree of a task file
+		 */
+		FitResultVector* ReadTaskResult( TTree* inputTree, const Long64_t entry ) const;
+
+		/*!
+		 * @brief Merge the results of all of the tasks into allResults in grid point and toy order
+		 */
+		void MergeTaskResults( const FCQueue& queue );
+
 		/*!
 		 * @brief Used for controlling the Output Level of the study during the fit to ensure the minimal information is output to screen
 		 */
@@ -119,6 +185,7 @@ class VectoredFeldmanCousins : public IStudy
 		vector<double> generate_n_events;
 		ParameterSet* ParameterSetWithFreeParameters;
 		ParameterSet* ParameterSetWithFixedParameters;;
+		unsigned int numberWorkers;
 };
 
 #endif
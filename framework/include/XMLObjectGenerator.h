@@ -65,6 +65,8 @@ class XMLObjectGenerator
 		static PDFWithData * GetPDFWithData( XMLTag*, XMLTag*, int StartVal, XMLTag* overloadConfigurator, XMLTag* common, ParameterSet* thisParameterSet, PhaseSpaceBoundary* thisPhaseSpaceBoundary );
 
 	private:
+		static unsigned int GetNormalisationCacheSize( XMLTag* );
+
 		XMLObjectGenerator();
 		~XMLObjectGenerator();
 };
@@ -99,6 +99,16 @@ int saveOneDataSet( RapidFitConfiguration* config );
 
 int testIntegrator( RapidFitConfiguration* config );
 
+int testIntegratorThreads( RapidFitConfiguration* config );
+
+int testFaddeeva( RapidFitConfiguration* config );
+
+int testCacheDependencies( RapidFitConfiguration* config );
+
+double TimeAcceptReject( PhaseSpaceBoundary* boundary, IPDF* pdf, int numberEvents, bool batched, unsigned int threads );
+
+int benchmarkAcceptReject( RapidFitConfiguration* config );
+
 int testComponentPlot( RapidFitConfiguration* config );
 
 int calculateFitFractions( RapidFitConfiguration* config );
@@ -12,26 +12,42 @@
 #include "AcceptReject.h"
 #include "PhaseSpaceBoundary.h"
 #include "RapidFitRandom.h"
+#include "ClassLookUp.h"
 //	System Headers
 #include <iostream>
+#include <algorithm>
 #include <math.h>
 #include <float.h>
 
 //#define DOUBLE_TOLERANCE DBL_MIN
 #define DOUBLE_TOLERANCE 1E-6
 
+//	Number of trials drawn and evaluated together
+#define ACCEPT_REJECT_BLOCK_SIZE 10000
+//	Smallest block used once the efficiency is known
+#define ACCEPT_REJECT_MIN_BLOCK_SIZE 500
+
 //Constructor with correct argument
 AcceptReject::AcceptReject( PhaseSpaceBoundary * NewBoundary, IPDF * NewPDF ) : generationFunction(NewPDF),
-	generationBoundary(NewBoundary), dataNumber(0), newDataSet(), rootRandom(), moreThanMaximum(0.01), numberAttempts(0)
+	generationBoundary(NewBoundary), dataNumber(0), newDataSet(), rootRandom(), moreThanMaximum(0.01), numberAttempts(0),
+	allNames(), acceptedColumns(), numberThreads(1), workerPool(NULL), threadFunctions()
 {
 	newDataSet = new MemoryDataSet(generationBoundary);
 	rootRandom = RapidFitRandom::GetRandomFunction();
+	allNames = generationBoundary->GetAllNames();
+	acceptedColumns.resize( allNames.size() );
 }
 
 //Destructor
 AcceptReject::~AcceptReject()
 {
 	delete newDataSet;
+	if( workerPool != NULL ) delete workerPool;
+	while( !threadFunctions.empty() )
+	{
+		if( threadFunctions.back() != NULL ) delete threadFunctions.back();
+		threadFunctions.pop_back();
+	}
 	//delete rootRandom;
 	//delete generationFunction;
 	//delete generationBoundary;
@@ -39,9 +55,213 @@ AcceptReject::~AcceptReject()
 
 //Use accept/reject method to create data
 int AcceptReject::GenerateData( int DataAmount )
+{
+	if( DataAmount <= 0 ) return dataNumber;
+
+	vector<IConstraint*> constraints;
+	vector<bool> discrete;
+	for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex )
+	{
+		constraints.push_back( generationBoundary->GetConstraint( allNames[nameIndex] ) );
+		discrete.push_back( constraints.back()->IsDiscrete() );
+	}
+
+	const size_t target = acceptedColumns[0].size() + (size_t) DataAmount;
+	int numberAccepted = 0;
+
+	ColumnarDataSet* trials = new ColumnarDataSet( generationBoundary );
+	DataPoint trialView = trials->MakeRowView();
+	vector<vector<double> > trialColumns( allNames.size() );
+	vector<double> testRandoms, functionValues;
+
+	//Keep trying until required amount of data is generated
+	while( acceptedColumns[0].size() < target )
+	{
+		//	Once the efficiency is known only draw about as many trials as are needed
+		unsigned int blockSize = ACCEPT_REJECT_BLOCK_SIZE;
+		if( numberAccepted > 0 )
+		{
+			const double needed = 1.2 * double( target - acceptedColumns[0].size() ) * double(numberAttempts) / double(numberAccepted);
+			if( needed < double(ACCEPT_REJECT_BLOCK_SIZE) ) blockSize = max( (unsigned int) needed, (unsigned int) ACCEPT_REJECT_MIN_BLOCK_SIZE );
+		}
+
+		//	Draw the trials, in the same order as one DataPoint at a time
+		for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex ) trialColumns[nameIndex].resize( blockSize );
+		testRandoms.resize( blockSize );
+		for( unsigned int trialIndex = 0; trialIndex < blockSize; ++trialIndex )
+		{
+			for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex )
+			{
+				if( discrete[nameIndex] )
+				{
+					Observable * newObservable = constraints[nameIndex]->CreateObservable(rootRandom);
+					trialColumns[nameIndex][trialIndex] = newObservable->GetValue();
+					delete newObservable;
+				}
+				else
+				{
+					const double minimum = constraints[nameIndex]->GetMinimum();
+					const double maximum = constraints[nameIndex]->GetMaximum();
+					trialColumns[nameIndex][trialIndex] = minimum + ( ( maximum - minimum ) * rootRandom->Rndm() );
+				}
+			}
+			testRandoms[trialIndex] = rootRandom->Rndm();
+		}
+
+		//	Hand the block to the DataSet, the previous block's buffers are returned to be re-used next time
+		trials->SwapColumns( trialColumns );
+
+		functionValues.resize( blockSize );
+		this->EvaluateTrials( trials, &(functionValues[0]) );
+
+		double blockMaximum = 0.;
+		for( unsigned int trialIndex = 0; trialIndex < blockSize; ++trialIndex )
+		{
+			if ( fabs(functionValues[trialIndex] - 0.0) < DOUBLE_TOLERANCE )
+			{
+				//Will get stuck in infinite loop
+				cerr << "Function value zero" << endl;
+				delete trials;
+				this->FillDataSet();
+				return dataNumber;
+			}
+			if( functionValues[trialIndex] > blockMaximum ) blockMaximum = functionValues[trialIndex];
+		}
+
+		if( blockMaximum > moreThanMaximum )
+		{
+			//	Raise the maximum and correct the events accepted with the old one, this block is then accepted with the new maximum
+			double newMaximum = moreThanMaximum;
+			while( blockMaximum > newMaximum ) newMaximum *= 2.0;
+			cout << "Function value " << blockMaximum << " is more than expected maximum " << moreThanMaximum << ": raising maximum to " << newMaximum << endl;
+			this->ThinAccepted( moreThanMaximum / newMaximum );
+			moreThanMaximum = newMaximum;
+		}
+
+		for( unsigned int trialIndex = 0; trialIndex < blockSize && acceptedColumns[0].size() < target; ++trialIndex )
+		{
+			++numberAttempts;
+
+			//Accept/reject
+			const double testValue = moreThanMaximum * testRandoms[trialIndex];
+			if( !( testValue < functionValues[trialIndex] ) ) continue;
+
+			//	Only the trials which pass are ever needed as a DataPoint
+			trials->FillRowView( trialIndex, trialView );
+			if( Preselection( &trialView, testValue ) )
+			{
+				for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex )
+				{
+					acceptedColumns[nameIndex].push_back( trials->GetColumn( nameIndex )[trialIndex] );
+				}
+				++numberAccepted;
+			}
+		}
+	}
+
+	delete trials;
+
+	this->FillDataSet();
+
+	//Return data generation statistics
+	cout << "Data generation: " << numberAccepted << " accepted from " << numberAttempts << endl;
+	numberAttempts = 0;
+	return dataNumber;
+}
+
+void AcceptReject::EvaluateTrials( ColumnarDataSet* Trials, double* Output )
+{
+	const unsigned int numberTrials = (unsigned) Trials->GetDataNumber();
+	if( numberThreads < 2 || numberTrials < numberThreads )
+	{
+		generationFunction->EvaluateBatch( Trials, 0, numberTrials, Output );
+		return;
+	}
+
+	if( workerPool == NULL ) workerPool = new ThreadPool( numberThreads );
+	if( threadFunctions.empty() )
+	{
+		for( unsigned int threadNum = 0; threadNum < numberThreads; ++threadNum )
+		{
+			threadFunctions.push_back( ClassLookUp::CopyPDF( generationFunction ) );
+		}
+	}
+
+	vector<EvaluationTask> tasks( numberThreads );
+	vector<void*> taskInput( numberThreads, NULL );
+	for( unsigned int threadNum = 0; threadNum < numberThreads; ++threadNum )
+	{
+		tasks[threadNum].function = threadFunctions[threadNum];
+		tasks[threadNum].trials = Trials;
+		tasks[threadNum].begin = ( numberTrials * threadNum ) / numberThreads;
+		tasks[threadNum].end = ( numberTrials * ( threadNum + 1 ) ) / numberThreads;
+		tasks[threadNum].output = Output + tasks[threadNum].begin;
+		taskInput[threadNum] = (void*) &(tasks[threadNum]);
+	}
+
+	//	If the pool can't be used (i.e. we're already running on it) evaluate everything here
+	if( !workerPool->Execute( AcceptReject::EvaluateTask, &(taskInput[0]), numberThreads ) )
+	{
+		for( unsigned int threadNum = 0; threadNum < numberThreads; ++threadNum )
+		{
+			AcceptReject::EvaluateTask( taskInput[threadNum] );
+		}
+	}
+}
+
+void* AcceptReject::EvaluateTask( void* Input )
+{
+	EvaluationTask* thisTask = (EvaluationTask*) Input;
+	if( thisTask->end > thisTask->begin )
+	{
+		thisTask->function->EvaluateBatch( thisTask->trials, thisTask->begin, thisTask->end, thisTask->output );
+	}
+	return NULL;
+}
+
+void AcceptReject::ThinAccepted( const double Fraction )
+{
+	const size_t numberEvents = acceptedColumns[0].size();
+	size_t kept = 0;
+	for( size_t eventIndex = 0; eventIndex < numberEvents; ++eventIndex )
+	{
+		if( rootRandom->Rndm() < Fraction )
+		{
+			for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex )
+			{
+				acceptedColumns[nameIndex][kept] = acceptedColumns[nameIndex][eventIndex];
+			}
+			++kept;
+		}
+	}
+	for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex ) acceptedColumns[nameIndex].resize( kept );
+}
+
+void AcceptReject::FillDataSet()
+{
+	vector<string> allUnits;
+	for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex )
+	{
+		allUnits.push_back( generationBoundary->GetConstraint( allNames[nameIndex] )->GetUnit() );
+	}
+
+	newDataSet->Clear();
+	for( size_t eventIndex = 0; eventIndex < acceptedColumns[0].size(); ++eventIndex )
+	{
+		DataPoint * newDataPoint = new DataPoint(allNames);
+		for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex )
+		{
+			newDataPoint->SetObservable( allNames[nameIndex], acceptedColumns[nameIndex][eventIndex], allUnits[nameIndex], true, (int)nameIndex );
+		}
+		newDataSet->AddDataPoint(newDataPoint);
+	}
+	dataNumber = newDataSet->GetDataNumber();
+}
+
+//Use accept/reject method to create data, one trial at a time
+int AcceptReject::GenerateDataUnbatched( int DataAmount )
 {
 	int numberAccepted = 0;
-	vector<string> allNames = generationBoundary->GetAllNames();
 	vector<string>::iterator nameIterator;
 
 	//Keep trying until required amount of data is generated
@@ -70,6 +290,7 @@ int AcceptReject::GenerateData( int DataAmount )
 				//Will get stuck in infinite loop
 				cerr << "Function value zero" << endl;
 				delete testDataPoint;
+				this->FillDataSet();
 				return dataNumber;
 			}
 
@@ -77,38 +298,28 @@ int AcceptReject::GenerateData( int DataAmount )
 			{
 				//Restart accept/reject
 				cout << "Function value " << functionValue << " is more than expected maximum " << moreThanMaximum << ": restarting data generation" << endl;
-				dataNumber = 0;
-				numberAccepted = 0;
-				newDataSet->Clear();
+				for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex ) acceptedColumns[nameIndex].clear();
 				moreThanMaximum *= 2.0;
 				delete testDataPoint;
-				return GenerateData(DataAmount);
+				return GenerateDataUnbatched(DataAmount);
 			}
-			else
+			else if (testValue < functionValue)
 			{
-				if (testValue < functionValue)
+				//Accept
+				for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex )
 				{
-					//Accept
-					newDataSet->AddDataPoint(testDataPoint);
-					++numberAccepted;
-					delete testDataPoint;
-				}
-				else
-				{
-					//Reject
-					delete testDataPoint;
+					acceptedColumns[nameIndex].push_back( testDataPoint->GetObservable( allNames[nameIndex] )->GetValue() );
 				}
+				++numberAccepted;
 			}
 		}
-		else
-		{
-			//Reject
-			delete testDataPoint;
-		}
+
+		delete testDataPoint;
 	}
 
+	this->FillDataSet();
+
 	//Return data generation statistics
-	dataNumber += numberAccepted;
 	cout << "Data generation: " << numberAccepted << " accepted from " << numberAttempts << endl;
 	numberAttempts = 0;
 	return dataNumber;
@@ -120,6 +331,11 @@ IDataSet * AcceptReject::GetDataSet() const
 	return newDataSet;
 }
 
+void AcceptReject::SetNumberThreads( unsigned int Input )
+{
+	numberThreads = Input;
+}
+
 //Overload in child functions to speed data generation for complex functions
 bool AcceptReject::Preselection( DataPoint * TestDataPoint, double TestValue )
 {
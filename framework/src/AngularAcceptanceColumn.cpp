@@ -0,0 +1,26 @@
+/*!
+ * @class AngularAcceptanceColumn
+ *
+ * @brief A DerivedColumn holding the per-event weight from an AngularAcceptance
+ */
+
+///	RapidFit Headers
+#include "AngularAcceptanceColumn.h"
+///	System Headers
+#include <string>
+
+using namespace::std;
+
+AngularAcceptanceColumn::AngularAcceptanceColumn( const string Name, AngularAcceptance* Acceptance, const string first, const string second, const string third ) :
+	DerivedColumn( Name, 1 ), acceptance( Acceptance ), firstName( first ), secondName( second ), thirdName( third )
+{
+}
+
+AngularAcceptanceColumn::~AngularAcceptanceColumn()
+{
+}
+
+void AngularAcceptanceColumn::Calculate( DataPoint* input, double* output ) const
+{
+	output[0] = acceptance->getValue( input->GetObservable( firstName ), input->GetObservable( secondName ), input->GetObservable( thirdName ) );
+}
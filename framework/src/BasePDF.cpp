@@ -15,10 +15,15 @@
 #include "ObservableRef.h"
 #include "PhaseSpaceBoundary.h"
 #include "RapidFitIntegrator.h"
+#include "IDataSet.h"
+#include "ColumnarDataSet.h"
+#include "DebugClass.h"
 ///	System Headers
 #include <iostream>
 #include <cmath>
 #include <sstream>
+#include <cstring>
+#include <stdint.h>
 #include <pthread.h>
 
 using namespace::std;
@@ -27,7 +32,9 @@ using namespace::std;
 BasePDF::BasePDF() : BasePDF_Framework( this ), BasePDF_MCCaching(),
 	numericalNormalisation(false), allParameters( vector<string>() ), allObservables(), doNotIntegrateList(), observableDistNames(), observableDistributions(),
 	component_list(), requiresBoundary(false), cachingEnabled( true ), haveTestedIntegral( false ), discrete_Normalisation( false ), DiscreteCaches(new vector<double>()),
-	debug_mutex(NULL), can_remove_mutex(true), fixed_checked(false), isFixed(false), fixedID(0), _basePDFComponentStatus(false), stored_boundary(NULL), stored_point(NULL), stored_index(0)
+	debug_mutex(NULL), can_remove_mutex(true), fixed_checked(false), isFixed(false), fixedID(0), _basePDFComponentStatus(false),
+	cacheDependencies(), cacheDependenciesSet(false), physicsParametersSet(false), normalisationCacheSize(0), normalisationCache(), normalisationCacheIndex(),
+	normalisationCacheParameters(), normalisationCacheHits(0), normalisationCacheMisses(0)
 {
 	component_list.push_back( "0" );
 }
@@ -39,7 +46,9 @@ BasePDF::BasePDF( const BasePDF& input ) : BasePDF_Framework( input ), BasePDF_M
 	cachingEnabled( input.cachingEnabled ), haveTestedIntegral( input.haveTestedIntegral ),
 	discrete_Normalisation( input.discrete_Normalisation ), DiscreteCaches(NULL),
 	debug_mutex(input.debug_mutex), can_remove_mutex(false), fixed_checked(input.fixed_checked), isFixed(input.isFixed), fixedID(input.fixedID),
-	_basePDFComponentStatus(input._basePDFComponentStatus), stored_boundary(input.stored_boundary), stored_index(input.stored_index), stored_point(input.stored_point)
+	_basePDFComponentStatus(input._basePDFComponentStatus),
+	cacheDependencies( input.cacheDependencies ), cacheDependenciesSet( input.cacheDependenciesSet ), physicsParametersSet(false), normalisationCacheSize( input.normalisationCacheSize ), normalisationCache(),
+	normalisationCacheIndex(), normalisationCacheParameters( input.normalisationCacheParameters ), normalisationCacheHits(0), normalisationCacheMisses(0)
 {
 	allParameters.SetPhysicsParameters( &(input.allParameters) );
 	DiscreteCaches = new vector<double>( input.DiscreteCaches->size() );
@@ -60,6 +69,11 @@ BasePDF::~BasePDF()
 	if( DiscreteCaches != NULL ) delete DiscreteCaches;
 	if( debug_mutex != NULL && can_remove_mutex == true ) delete debug_mutex;
 
+	if( ( normalisationCacheHits + normalisationCacheMisses ) > 0 && DebugClass::DebugThisClass( "NormalisationCache" ) )
+	{
+		cout << "BasePDF: " << this->GetLabel() << " Normalisation Cache hits: " << normalisationCacheHits << " misses: " << normalisationCacheMisses << endl;
+	}
+
 }
 
 void BasePDF::SetComponentStatus( const bool input )
@@ -109,7 +123,7 @@ bool BasePDF::CacheValid( DataPoint* InputPoint, PhaseSpaceBoundary* InputBounda
 
 	unsigned int cacheIndex = this->GetThisIndex( InputBoundary, InputPoint );
 
-	double norm = DiscreteCaches->at(cacheIndex);
+	double norm = (*DiscreteCaches)[cacheIndex];
 
 	if( norm > 0 ) return true;
 	else return false;
@@ -151,7 +165,7 @@ void BasePDF::SetCache( double input, DataPoint* InputPoint, PhaseSpaceBoundary*
 	 */
 	unsigned int thisIndex = this->GetThisIndex( InputBoundary, InputPoint );
 
-	DiscreteCaches->at(thisIndex) = input;
+	(*DiscreteCaches)[thisIndex] = input;
 
 }
 
@@ -173,6 +187,15 @@ void BasePDF::CheckCaches( PhaseSpaceBoundary* InputBoundary )
 }
 
 void BasePDF::UnsetCache()
+{
+	this->ResetDiscreteCaches();
+
+	//	Whatever invalidated the current caches (a new boundary or configuration) invalidates the stored ones too
+	normalisationCache.clear();
+	normalisationCacheIndex.clear();
+}
+
+void BasePDF::ResetDiscreteCaches()
 {
 	for(vector<double>::iterator this_i = DiscreteCaches->begin(); this_i != DiscreteCaches->end(); ++this_i )
 	{
@@ -185,9 +208,20 @@ void BasePDF::UpdatePhysicsParameters( ParameterSet* Input )
 {
 	if( allParameters.GetAllNames().size() != 0 )
 	{
-		//  Invalidate the cache
-		if( !(allParameters == (*Input)) ) this->UnsetCache();
+		//	Keep the caches for the parameters we're moving away from
+		bool keyedCache = normalisationCacheSize > 0 && cachingEnabled;
+		if( keyedCache ) this->StoreNormalisationCache();
+
+		//	Only the parameters which have moved since the last call are flagged as changed
+		allParameters.ResetChanged();
 		allParameters.SetPhysicsParameters( Input );
+
+		//  Invalidate the cache, unless we've already been at this point
+		bool normalisationChanged = cacheDependenciesSet ? allParameters.HasChanged( cacheDependencies ) : allParameters.HasChanged();
+		if( normalisationChanged )
+		{
+			if( !( keyedCache && this->RestoreNormalisationCache() ) ) this->ResetDiscreteCaches();
+		}
 	}
 	else
 	{
@@ -195,7 +229,141 @@ void BasePDF::UpdatePhysicsParameters( ParameterSet* Input )
 		this->UnsetCache();
 	}
 
+	//	Minuit moves one parameter at a time when calculating the gradient, don't recalculate everything in this PDF if none of its parameters moved
+	if( physicsParametersSet && !allParameters.HasChanged() ) return;
+
 	this->SetPhysicsParameters( Input );
+	physicsParametersSet = true;
+}
+
+void BasePDF::SetCacheDependencies( const vector<string> Names )
+{
+	cacheDependencies.clear();
+	for( vector<string>::const_iterator name_i = Names.begin(); name_i != Names.end(); ++name_i )
+	{
+		cacheDependencies.push_back( ObservableRef( *name_i ) );
+	}
+	cacheDependenciesSet = true;
+	this->UnsetCache();
+
+	//	The key of the parameter-keyed cache has changed
+	this->SetNormalisationCacheSize( normalisationCacheSize );
+}
+
+vector<string> BasePDF::GetCacheDependencies()
+{
+	if( !cacheDependenciesSet ) return this->GetPrototypeParameterSet();
+
+	vector<string> names;
+	for( unsigned int i=0; i< cacheDependencies.size(); ++i ) names.push_back( cacheDependencies[i].Name() );
+	return names;
+}
+
+void BasePDF::SetNormalisationCacheSize( const unsigned int input )
+{
+	normalisationCacheSize = input;
+	normalisationCache.clear();
+	normalisationCacheIndex.clear();
+	normalisationCacheParameters.clear();
+}
+
+unsigned int BasePDF::GetNormalisationCacheSize() const
+{
+	return normalisationCacheSize;
+}
+
+unsigned int BasePDF::GetNormalisationCacheHits() const
+{
+	return normalisationCacheHits;
+}
+
+unsigned int BasePDF::GetNormalisationCacheMisses() const
+{
+	return normalisationCacheMisses;
+}
+
+size_t BasePDF::NormalisationCacheKey( vector<double>& values )
+{
+	//	Only the parameters this PDF declares (or has said the Normalisation depends on) make up the key
+	if( normalisationCacheParameters.empty() )
+	{
+		vector<string> keyNames = this->GetCacheDependencies();
+
+		vector<string> haveNames = allParameters.GetAllNames();
+		for( unsigned int i=0; i< keyNames.size(); ++i )
+		{
+			if( StringProcessing::VectorContains( &haveNames, &(keyNames[i]) ) != -1 ) normalisationCacheParameters.push_back( ObservableRef( keyNames[i] ) );
+		}
+	}
+
+	//	FNV-1a over the bits of each value
+	uint64_t hash = 14695981039346656037ULL;
+	values.resize( normalisationCacheParameters.size() );
+	for( unsigned int i=0; i< normalisationCacheParameters.size(); ++i )
+	{
+		values[i] = allParameters.GetPhysicsParameter( normalisationCacheParameters[i] )->GetValue();
+		uint64_t bits = 0;
+		memcpy( &bits, &(values[i]), sizeof(double) );
+		for( unsigned int j=0; j< 8; ++j )
+		{
+			hash ^= ( bits >> ( 8*j ) ) & 0xFF;
+			hash *= 1099511628211ULL;
+		}
+	}
+	return (size_t) hash;
+}
+
+void BasePDF::StoreNormalisationCache()
+{
+	//	Nothing worth keeping
+	bool haveValid = false;
+	for( vector<double>::const_iterator cache_i = DiscreteCaches->begin(); cache_i != DiscreteCaches->end(); ++cache_i )
+	{
+		if( *cache_i > 0 ) { haveValid = true; break; }
+	}
+	if( !haveValid ) return;
+
+	NormalisationCacheEntry thisEntry;
+	thisEntry.key = this->NormalisationCacheKey( thisEntry.parameterValues );
+	thisEntry.normalisations = *DiscreteCaches;
+
+	//	Replace any older entry for this key and move it to the front
+	map<size_t, list<NormalisationCacheEntry>::iterator>::iterator found = normalisationCacheIndex.find( thisEntry.key );
+	if( found != normalisationCacheIndex.end() )
+	{
+		normalisationCache.erase( found->second );
+		normalisationCacheIndex.erase( found );
+	}
+
+	normalisationCache.push_front( thisEntry );
+	normalisationCacheIndex[ thisEntry.key ] = normalisationCache.begin();
+
+	//	Drop the least recently used
+	while( normalisationCache.size() > normalisationCacheSize )
+	{
+		normalisationCacheIndex.erase( normalisationCache.back().key );
+		normalisationCache.pop_back();
+	}
+}
+
+bool BasePDF::RestoreNormalisationCache()
+{
+	vector<double> values;
+	size_t key = this->NormalisationCacheKey( values );
+
+	map<size_t, list<NormalisationCacheEntry>::iterator>::iterator found = normalisationCacheIndex.find( key );
+
+	//	Check the values as well as the hash
+	if( found == normalisationCacheIndex.end() || found->second->parameterValues != values || found->second->normalisations.size() != DiscreteCaches->size() )
+	{
+		++normalisationCacheMisses;
+		return false;
+	}
+
+	*DiscreteCaches = found->second->normalisations;
+	normalisationCache.splice( normalisationCache.begin(), normalisationCache, found->second );
+	++normalisationCacheHits;
+	return true;
 }
 
 //Set the function parameters
@@ -207,14 +375,9 @@ bool BasePDF::SetPhysicsParameters( ParameterSet * NewParameterSet )
 
 unsigned int BasePDF::GetThisIndex( PhaseSpaceBoundary* NewBoundary, DataPoint* thisPoint )
 {
-	if( stored_boundary == NewBoundary && stored_point == thisPoint ) return stored_index;
-	else
-	{
-		stored_index = NewBoundary->GetDiscreteIndex( thisPoint );
-		stored_boundary = NewBoundary;
-		stored_point = thisPoint;
-		return stored_index;
-	}
+	//	The index of each event in the boundary used for the fit is calculated when the fit is set up and stored in the DataPoint
+	if( thisPoint->GetDiscreteIndexID() == NewBoundary->GetID() && thisPoint->GetDiscreteIndex() != -1 ) return (unsigned)thisPoint->GetDiscreteIndex();
+	else return NewBoundary->GetDiscreteIndex( thisPoint );
 }
 
 double BasePDF::GetCache( DataPoint* InputPoint, PhaseSpaceBoundary* NewBoundary )
@@ -231,7 +394,7 @@ double BasePDF::GetCache( DataPoint* InputPoint, PhaseSpaceBoundary* NewBoundary
 
 	unsigned int thisIndex = this->GetThisIndex( NewBoundary, InputPoint );
 
-	double thisVal = DiscreteCaches->at(thisIndex);
+	double thisVal = (*DiscreteCaches)[thisIndex];
 
 	if( DebugCheck )
 	{
@@ -549,6 +712,103 @@ double BasePDF::Evaluate(DataPoint * NewDataPoint)
 	return  -1.0;
 }
 
+//Calculate the function value for a range of events
+void BasePDF::EvaluateBatch( IDataSet* InputData, const unsigned int begin, const unsigned int end, double* output )
+{
+	//	Columnar data without stored views is read through one re-used DataPoint rather than building a view of every event
+	ColumnarDataSet* columnarData = dynamic_cast<ColumnarDataSet*>( InputData );
+	if( columnarData != NULL && !columnarData->DataPointsBuilt() && end > begin )
+	{
+		DataPoint rowView = columnarData->MakeRowView();
+		for( unsigned int i=begin; i< end; ++i )
+		{
+			columnarData->FillRowView( i, rowView );
+			output[i-begin] = this->Evaluate( &rowView );
+		}
+		return;
+	}
+
+	for( unsigned int i=begin; i< end; ++i )
+	{
+		output[i-begin] = this->Evaluate( InputData->GetDataPoint( (int)i ) );
+	}
+}
+
+//Calculate the integral for a range of events
+void BasePDF::NormalisationBatch( IDataSet* InputData, const unsigned int begin, const unsigned int end, PhaseSpaceBoundary* InputPhaseSpace, double* output )
+{
+	ColumnarDataSet* columnarData = dynamic_cast<ColumnarDataSet*>( InputData );
+	if( columnarData != NULL && !columnarData->DataPointsBuilt() && end > begin )
+	{
+		DataPoint rowView = columnarData->MakeRowView();
+		for( unsigned int i=begin; i< end; ++i )
+		{
+			columnarData->FillRowView( i, rowView );
+			output[i-begin] = this->Integral( &rowView, InputPhaseSpace );
+		}
+		return;
+	}
+
+	for( unsigned int i=begin; i< end; ++i )
+	{
+		output[i-begin] = this->Integral( InputData->GetDataPoint( (int)i ), InputPhaseSpace );
+	}
+}
+
+void BasePDF::PrecomputeDerivedColumns( IDataSet* InputData )
+{
+	(void) InputData;
+}
+
+vector<string> BasePDF::GetAnalyticGradientParameters()
+{
+	return vector<string>();
+}
+
+bool BasePDF::EvaluateGradient( DataPoint* InputPoint, const vector<string>& Names, double* output )
+{
+	(void) InputPoint;
+	return this->NoGradientDependence( Names, output );
+}
+
+bool BasePDF::IntegralGradient( DataPoint* InputPoint, PhaseSpaceBoundary* InputPhaseSpace, const vector<string>& Names, double* output )
+{
+	(void) InputPoint; (void) InputPhaseSpace;
+	return this->NoGradientDependence( Names, output );
+}
+
+bool BasePDF::NoGradientDependence( const vector<string>& Names, double* output )
+{
+	vector<string> dependsOn = this->GetPrototypeParameterSet();
+	bool success = true;
+	for( unsigned int i=0; i< Names.size(); ++i )
+	{
+		output[i] = 0.;
+		if( StringProcessing::VectorContains( &dependsOn, &(Names[i]) ) != -1 ) success = false;
+	}
+	return success;
+}
+
+vector<string> BasePDF::CombineAnalyticGradientParameters( IPDF* first, IPDF* second, const vector<string> extraNames )
+{
+	vector<string> firstAnalytic = first->GetAnalyticGradientParameters();
+	vector<string> secondAnalytic = second->GetAnalyticGradientParameters();
+	vector<string> firstDepends = first->GetPrototypeParameterSet();
+	vector<string> secondDepends = second->GetPrototypeParameterSet();
+
+	vector<string> candidates = StringProcessing::CombineUniques( firstAnalytic, secondAnalytic );
+	candidates = StringProcessing::CombineUniques( candidates, extraNames );
+
+	vector<string> returnable;
+	for( vector<string>::iterator name_i = candidates.begin(); name_i != candidates.end(); ++name_i )
+	{
+		bool firstOK = StringProcessing::VectorContains( &firstAnalytic, &(*name_i) ) != -1 || StringProcessing::VectorContains( &firstDepends, &(*name_i) ) == -1;
+		bool secondOK = StringProcessing::VectorContains( &secondAnalytic, &(*name_i) ) != -1 || StringProcessing::VectorContains( &secondDepends, &(*name_i) ) == -1;
+		if( firstOK && secondOK ) returnable.push_back( *name_i );
+	}
+	return returnable;
+}
+
 //Return the function value at the given point for generation
 double BasePDF::EvaluateForNumericGeneration( DataPoint* NewDataPoint )
 {
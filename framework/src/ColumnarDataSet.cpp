@@ -0,0 +1,652 @@
+/*!
+ * @class ColumnarDataSet
+ *
+ * @brief A data set which stores each Observable as one contiguous array of doubles
+ */
+
+///	RapidFit Headers
+#include "ColumnarDataSet.h"
+#include "IConstraint.h"
+#include "StringProcessing.h"
+///	System Headers
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+#include <iomanip>
+#include <cstdlib>
+#include <limits>
+
+#define DOUBLE_TOLERANCE_DATA 1E-8
+
+using namespace::std;
+
+ColumnarDataSet::ColumnarDataSet( PhaseSpaceBoundary* NewBoundary ) :
+	dataBoundary( new PhaseSpaceBoundary(*NewBoundary) ), columnNames(), columnUnits(), columns(), eventWeights(), initialNLLs(),
+	pointViews(), numberViews(0), viewsComplete(false), viewLock(), useWeights(false), WeightName(""), alpha(1.), alphaName("uninitialized")
+{
+	pthread_mutex_init( &viewLock, NULL );
+	this->MakeColumns();
+}
+
+ColumnarDataSet::ColumnarDataSet( PhaseSpaceBoundary* NewBoundary, vector<DataPoint> inputData ) :
+	dataBoundary( new PhaseSpaceBoundary(*NewBoundary) ), columnNames(), columnUnits(), columns(), eventWeights(), initialNLLs(),
+	pointViews(), numberViews(0), viewsComplete(false), viewLock(), useWeights(false), WeightName(""), alpha(1.), alphaName("uninitialized")
+{
+	pthread_mutex_init( &viewLock, NULL );
+	this->MakeColumns();
+	for( unsigned int i=0; i< columns.size(); ++i ) columns[i].reserve( inputData.size() );
+	eventWeights.reserve( inputData.size() );
+	for( unsigned int i=0; i< inputData.size(); ++i )
+	{
+		this->SafeAddDataPoint( &(inputData[i]) );
+	}
+}
+
+ColumnarDataSet::ColumnarDataSet( IDataSet* inputData ) :
+	dataBoundary( new PhaseSpaceBoundary(*(inputData->GetBoundary())) ), columnNames(), columnUnits(), columns(), eventWeights(), initialNLLs(),
+	pointViews(), numberViews(0), viewsComplete(false), viewLock(), useWeights(false), WeightName(""), alpha(1.), alphaName("uninitialized")
+{
+	pthread_mutex_init( &viewLock, NULL );
+	this->MakeColumns();
+	unsigned int numberEvents = (unsigned)inputData->GetDataNumber();
+	for( unsigned int i=0; i< columns.size(); ++i ) columns[i].reserve( numberEvents );
+	eventWeights.reserve( numberEvents );
+	for( unsigned int i=0; i< numberEvents; ++i )
+	{
+		this->SafeAddDataPoint( inputData->GetDataPoint( (int)i ) );
+	}
+	//	The event weights have already been copied from the input, just remember how they were made
+	useWeights = inputData->GetWeightsWereUsed();
+	WeightName = inputData->GetWeightName();
+}
+
+ColumnarDataSet::~ColumnarDataSet()
+{
+	this->ReleaseDataPoints();
+	pthread_mutex_destroy( &viewLock );
+	if( dataBoundary != NULL ) delete dataBoundary;
+}
+
+void ColumnarDataSet::MakeColumns()
+{
+	columnNames = dataBoundary->GetAllNames();
+	columnUnits.clear();
+	for( unsigned int i=0; i< columnNames.size(); ++i )
+	{
+		IConstraint* thisConstraint = dataBoundary->GetConstraint( columnNames[i] );
+		columnUnits.push_back( thisConstraint!=NULL ? thisConstraint->GetUnit() : string("") );
+	}
+	columns.clear();
+	columns.resize( columnNames.size() );
+	eventWeights.clear();
+	initialNLLs.clear();
+}
+
+//Add a data point to the set
+bool ColumnarDataSet::AddDataPoint( DataPoint* NewDataPoint )
+{
+	bool added = false;
+	if( dataBoundary->IsPointInBoundary(NewDataPoint) )
+	{
+		this->SafeAddDataPoint( NewDataPoint );
+		added = true;
+	}
+	delete NewDataPoint;
+	return added;
+}
+
+//Add a data point to the set
+void ColumnarDataSet::SafeAddDataPoint( DataPoint* NewDataPoint )
+{
+	const size_t pointSize = NewDataPoint->GetAllNames().size();
+	for( unsigned int i=0; i< columnNames.size(); ++i )
+	{
+		//	Points built from the same PhaseSpaceBoundary have the Observables in the same order, only search by name if this is not the case
+		Observable* thisObservable = NULL;
+		if( i < pointSize ) thisObservable = NewDataPoint->GetObservable( i );
+		if( thisObservable == NULL || thisObservable->GetName() != columnNames[i] ) thisObservable = NewDataPoint->GetObservable( columnNames[i] );
+		columns[i].push_back( thisObservable->GetValue() );
+	}
+	eventWeights.push_back( NewDataPoint->GetEventWeight() );
+	initialNLLs.push_back( numeric_limits<double>::quiet_NaN() );
+	viewsComplete = false;
+}
+
+//Retrieve the data point with the given index
+DataPoint* ColumnarDataSet::GetDataPoint( int Index )
+{
+	if( Index < 0 || Index >= (int)eventWeights.size() )
+	{
+		cerr << "Index (" << Index << ") out of range in DataSet" << endl;
+		return NULL;
+	}
+
+	//	Once every view has been built nothing changes pointViews until the events do, so there's no need to lock
+	if( !viewsComplete )
+	{
+		pthread_mutex_lock( &viewLock );
+		if( pointViews.size() < eventWeights.size() ) pointViews.resize( eventWeights.size(), NULL );
+		if( pointViews[(unsigned)Index] == NULL )
+		{
+			pointViews[(unsigned)Index] = new DataPoint( this->MakeDataPoint( (unsigned)Index ) );
+			++numberViews;
+			if( numberViews == eventWeights.size() ) viewsComplete = true;
+		}
+		pthread_mutex_unlock( &viewLock );
+	}
+	DataPoint* thisPoint = pointViews[(unsigned)Index];
+
+	thisPoint->SetPhaseSpaceBoundary( dataBoundary );
+	return thisPoint;
+}
+
+DataPoint ColumnarDataSet::MakeDataPoint( const unsigned int index ) const
+{
+	DataPoint thisPoint( columnNames );
+	for( unsigned int i=0; i< columnNames.size(); ++i )
+	{
+		thisPoint.SetObservable( columnNames[i], columns[i][index], columnUnits[i], true, (int)i );
+	}
+	thisPoint.SetEventWeight( eventWeights[index] );
+	thisPoint.SetPhaseSpaceBoundary( dataBoundary );
+	return thisPoint;
+}
+
+void ColumnarDataSet::ReleaseDataPoints()
+{
+	pthread_mutex_lock( &viewLock );
+	viewsComplete = false;
+	numberViews = 0;
+	while( !pointViews.empty() )
+	{
+		if( pointViews.back() != NULL ) delete pointViews.back();
+		pointViews.pop_back();
+	}
+	pthread_mutex_unlock( &viewLock );
+}
+
+bool ColumnarDataSet::DataPointsBuilt() const
+{
+	return viewsComplete;
+}
+
+DataPoint ColumnarDataSet::MakeRowView() const
+{
+	DataPoint thisPoint( columnNames );
+	for( unsigned int i=0; i< columnNames.size(); ++i )
+	{
+		thisPoint.SetObservable( columnNames[i], 0., columnUnits[i], true, (int)i );
+	}
+	thisPoint.SetPhaseSpaceBoundary( dataBoundary );
+	return thisPoint;
+}
+
+void ColumnarDataSet::FillRowView( const unsigned int index, DataPoint& view ) const
+{
+	view.ClearDerivedData();
+	view.ClearPerEventData();
+	view.ClearDiscreteIndexMap();
+	for( unsigned int i=0; i< columns.size(); ++i )
+	{
+		//	Only the value changes between events, forget anything cached for the previous one
+		Observable* thisObservable = view.GetObservable( i );
+		thisObservable->ExternallySetValue( columns[i][index] );
+		thisObservable->SetBinNumber( -1 );
+		thisObservable->SetAcceptance( -1. );
+		thisObservable->SetBkgBinNumber( -1 );
+		thisObservable->SetBkgAcceptance( -1. );
+	}
+	view.SetEventWeight( eventWeights[index] );
+	view.SetInitialNLL( initialNLLs[index] );
+	view.SetPhaseSpaceBoundary( dataBoundary );
+}
+
+//Get the number of data points in the set
+int ColumnarDataSet::GetDataNumber( DataPoint* templateDataPoint ) const
+{
+	if( templateDataPoint == NULL ) return (int)eventWeights.size();
+	else
+	{
+		pair< vector<ObservableRef>, vector<double > > thisPointInfo = this->GetBoundary()->GetDiscreteInfo( templateDataPoint );
+		return (int)this->GetDiscreteIndices( thisPointInfo.first, thisPointInfo.second ).size();
+	}
+}
+
+//Get the data bound
+PhaseSpaceBoundary * ColumnarDataSet::GetBoundary() const
+{
+	return dataBoundary;
+}
+
+void ColumnarDataSet::SetBoundary( const PhaseSpaceBoundary* Input )
+{
+	//	The columns are keyed on the Observables in the boundary, so keep hold of the data while they are rebuilt
+	vector<string> oldNames = columnNames;
+	vector<vector<double> > oldColumns;
+	oldColumns.swap( columns );
+	vector<double> oldWeights, oldNLLs;
+	oldWeights.swap( eventWeights );
+	oldNLLs.swap( initialNLLs );
+
+	this->ReleaseDataPoints();
+	delete dataBoundary;
+	dataBoundary = new PhaseSpaceBoundary( *Input );
+	this->MakeColumns();
+
+	eventWeights.swap( oldWeights );
+	initialNLLs.swap( oldNLLs );
+	for( unsigned int i=0; i< columnNames.size(); ++i )
+	{
+		int oldIndex = StringProcessing::VectorContains( &oldNames, &(columnNames[i]) );
+		if( oldIndex >= 0 ) columns[i].swap( oldColumns[(unsigned)oldIndex] );
+		else if( !eventWeights.empty() )
+		{
+			cerr << "ColumnarDataSet: Observable " << columnNames[i] << " not present in DataSet, cannot change PhaseSpaceBoundary" << endl;
+			exit(-87);
+		}
+	}
+}
+
+unsigned int ColumnarDataSet::GetNumberColumns() const
+{
+	return (unsigned)columns.size();
+}
+
+int ColumnarDataSet::GetColumnIndex( const ObservableRef& Name ) const
+{
+	return StringProcessing::VectorContains( &columnNames, Name.NameRef() );
+}
+
+const double* ColumnarDataSet::GetColumn( const ObservableRef& Name ) const
+{
+	int index = this->GetColumnIndex( Name );
+	if( index < 0 ) return NULL;
+	return this->GetColumn( (unsigned)index );
+}
+
+const double* ColumnarDataSet::GetColumn( const unsigned int index ) const
+{
+	if( index >= columns.size() || columns[index].empty() ) return NULL;
+	return &(columns[index][0]);
+}
+
+const double* ColumnarDataSet::ReadColumn( IDataSet* Data, const ObservableRef& Name, const unsigned int begin, const unsigned int end, vector<double>& buffer )
+{
+	ColumnarDataSet* columnarData = dynamic_cast<ColumnarDataSet*>( Data );
+	const double* column = columnarData != NULL ? columnarData->GetColumn( Name ) : NULL;
+	if( column != NULL ) return column + begin;
+
+	buffer.resize( end > begin ? end - begin : 1 );
+	for( unsigned int i=begin; i< end; ++i )
+	{
+		buffer[i-begin] = Data->GetDataPoint( (int)i )->GetObservable( Name )->GetValue();
+	}
+	return &(buffer[0]);
+}
+
+const double* ColumnarDataSet::GetEventWeights() const
+{
+	if( eventWeights.empty() ) return NULL;
+	return &(eventWeights[0]);
+}
+
+double* ColumnarDataSet::GetInitialNLLs()
+{
+	if( initialNLLs.empty() ) return NULL;
+	return &(initialNLLs[0]);
+}
+
+//Empty the data set
+void ColumnarDataSet::Clear()
+{
+	this->ReleaseDataPoints();
+	for( unsigned int i=0; i< columns.size(); ++i )
+	{
+		vector<double> empty;
+		columns[i].swap( empty );
+	}
+	vector<double> empty, emptyNLLs;
+	eventWeights.swap( empty );
+	initialNLLs.swap( emptyNLLs );
+}
+
+void ColumnarDataSet::SwapColumns( vector<vector<double> >& Columns )
+{
+	if( Columns.size() != columns.size() )
+	{
+		cerr << "ColumnarDataSet: Expected " << columns.size() << " columns, given " << Columns.size() << endl;
+		exit(-1);
+	}
+	this->ReleaseDataPoints();
+	columns.swap( Columns );
+	eventWeights.assign( columns.empty() ? 0 : columns[0].size(), 1. );
+	initialNLLs.assign( eventWeights.size(), numeric_limits<double>::quiet_NaN() );
+}
+
+void ColumnarDataSet::SortBy( string parameter )
+{
+	int sortColumn = this->GetColumnIndex( ObservableRef( parameter ) );
+	if( sortColumn < 0 )
+	{
+		cerr << "ColumnarDataSet: Cannot sort by unknown Observable " << parameter << endl;
+		return;
+	}
+
+	//	Sort an index of the events and then shuffle every column into this order
+	vector<pair<double,unsigned int> > order;
+	order.reserve( eventWeights.size() );
+	for( unsigned int i=0; i< eventWeights.size(); ++i )
+	{
+		order.push_back( make_pair( columns[(unsigned)sortColumn][i], i ) );
+	}
+	stable_sort( order.begin(), order.end() );
+
+	for( unsigned int i=0; i< columns.size(); ++i )
+	{
+		vector<double> sorted( columns[i].size() );
+		for( unsigned int j=0; j< order.size(); ++j ) sorted[j] = columns[i][order[j].second];
+		columns[i].swap( sorted );
+	}
+	vector<double> sorted( eventWeights.size() );
+	for( unsigned int j=0; j< order.size(); ++j ) sorted[j] = eventWeights[order[j].second];
+	eventWeights.swap( sorted );
+	for( unsigned int j=0; j< order.size(); ++j ) sorted[j] = initialNLLs[order[j].second];
+	initialNLLs.swap( sorted );
+
+	//	Any existing view now refers to a different event
+	this->ReleaseDataPoints();
+}
+
+vector<unsigned int> ColumnarDataSet::GetDiscreteIndices( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const
+{
+	vector<unsigned int> returnable_indices;
+
+	if( discreteParam.empty() || discreteVal.empty() )
+	{
+		for( unsigned int i=0; i< eventWeights.size(); ++i ) returnable_indices.push_back( i );
+		return returnable_indices;
+	}
+
+	if( discreteParam.size() != discreteVal.size() )
+	{
+		cerr << "\n\n\t\tBadly Defined definition of a subset, returning 0 events!\n\n" << endl;
+		return returnable_indices;
+	}
+
+	vector<const double*> discreteColumns;
+	for( unsigned int j=0; j< discreteParam.size(); ++j )
+	{
+		const double* thisColumn = this->GetColumn( discreteParam[j] );
+		if( thisColumn == NULL && !eventWeights.empty() )
+		{
+			cerr << "Observable name " << discreteParam[j].Name() << " not found in ColumnarDataSet" << endl;
+			throw(-20);
+		}
+		discreteColumns.push_back( thisColumn );
+	}
+
+	for( unsigned int i=0; i< eventWeights.size(); ++i )
+	{
+		bool decision = true;
+		for( unsigned int j=0; j< discreteColumns.size(); ++j )
+		{
+			if( !( fabs( discreteColumns[j][i] - discreteVal[j] ) < DOUBLE_TOLERANCE_DATA ) )
+			{
+				decision = false;
+				break;
+			}
+		}
+		if( decision ) returnable_indices.push_back( i );
+	}
+
+	return returnable_indices;
+}
+
+IDataSet* ColumnarDataSet::GetDiscreteDataSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const
+{
+	return (IDataSet*) new ColumnarDataSet( this->GetBoundary(), this->GetDiscreteSubSet( discreteParam, discreteVal ) );
+}
+
+vector<DataPoint> ColumnarDataSet::GetDiscreteSubSet( const vector<ObservableRef> discreteParam, const vector<double> discreteVal ) const
+{
+	vector<unsigned int> indices = this->GetDiscreteIndices( discreteParam, discreteVal );
+	vector<DataPoint> returnable_subset;
+	returnable_subset.reserve( indices.size() );
+	for( unsigned int i=0; i< indices.size(); ++i )
+	{
+		returnable_subset.push_back( this->MakeDataPoint( indices[i] ) );
+	}
+	return returnable_subset;
+}
+
+vector<DataPoint> ColumnarDataSet::GetDiscreteSubSet( const vector<string> discreteParam, const vector<double> discreteVal ) const
+{
+	vector<ObservableRef> temp_ref;
+	for( unsigned int j=0; j< discreteParam.size(); ++j )
+	{
+		temp_ref.push_back( ObservableRef( discreteParam[j] ) );
+	}
+	return this->GetDiscreteSubSet( temp_ref, discreteVal );
+}
+
+vector<DataPoint> ColumnarDataSet::GetDiscreteSubSet( DataPoint* templateDataPoint ) const
+{
+	vector<ObservableRef> discreteParam;
+	vector<double> discreteVal;
+	if( templateDataPoint != NULL )
+	{
+		pair< vector<ObservableRef>, vector<double > > thisPointInfo = this->GetBoundary()->GetDiscreteInfo( templateDataPoint );
+		discreteParam = thisPointInfo.first;
+		discreteVal = thisPointInfo.second;
+	}
+	return this->GetDiscreteSubSet( discreteParam, discreteVal );
+}
+
+double ColumnarDataSet::Yield()
+{
+	if( useWeights )	return this->GetSumWeights();
+	else			return this->GetDataNumber();
+}
+
+double ColumnarDataSet::YieldError()
+{
+	if( useWeights )	return sqrt( this->GetSumWeightsSq() );
+	else			return sqrt( this->GetDataNumber() );
+}
+
+string ColumnarDataSet::GetWeightName() const
+{
+	return WeightName;
+}
+
+bool ColumnarDataSet::GetWeightsWereUsed() const
+{
+	return useWeights;
+}
+
+void ColumnarDataSet::SetEventWeights( const int weightColumn, const int alphaColumn, const double factor )
+{
+	for( unsigned int i=0; i< eventWeights.size(); ++i )
+	{
+		double thisWeight = columns[(unsigned)weightColumn][i] * factor;
+		if( alphaColumn >= 0 ) thisWeight *= columns[(unsigned)alphaColumn][i];
+		eventWeights[i] = thisWeight;
+	}
+
+	//	Keep any existing views consistent with the new weights
+	pthread_mutex_lock( &viewLock );
+	for( unsigned int i=0; i< pointViews.size(); ++i )
+	{
+		if( pointViews[i] != NULL ) pointViews[i]->SetEventWeight( eventWeights[i] );
+	}
+	pthread_mutex_unlock( &viewLock );
+}
+
+void ColumnarDataSet::UseEventWeights( const string Name )
+{
+	int weightColumn = this->GetColumnIndex( ObservableRef( Name ) );
+	if( weightColumn < 0 )
+	{
+		cerr << "Observable name " << Name << " not found in ColumnarDataSet, cannot use it as a weight" << endl;
+		throw(-20);
+	}
+	WeightName = Name;
+	useWeights = true;
+	this->SetEventWeights( weightColumn, -1, 1. );
+}
+
+void ColumnarDataSet::NormaliseWeights()
+{
+	if( useWeights )
+	{
+		double sum_Val=0.;
+		double sum_Val2=0.;
+		for( unsigned int i=0; i< eventWeights.size(); ++i )
+		{
+			double thisVal=eventWeights[i];
+			sum_Val += thisVal;
+			sum_Val2 += thisVal*thisVal;
+		}
+
+		this->ApplyAlpha( sum_Val, sum_Val2 );
+	}
+}
+
+void ColumnarDataSet::PrintYield()
+{
+	cout << "Total Yield = " << this->Yield() << " ± " << this->YieldError() << endl;
+	this->Print();
+}
+
+void ColumnarDataSet::Print()
+{
+	int weightColumn = -1;
+	if( this->GetWeightsWereUsed() ) weightColumn = this->GetColumnIndex( ObservableRef( WeightName ) );
+
+	if( weightColumn >= 0 && this->GetDataNumber() > 0 )
+	{
+		double total=0.;
+		double err=0.;
+		for( unsigned int i=0; i< eventWeights.size(); ++i )
+		{
+			double val = columns[(unsigned)weightColumn][i];
+			total+=val;
+			err+=val*val;
+		}
+		err = sqrt(err);
+		cout << "DataSet contains a total of:     " << total << " ± " << err << "     SIGNAL events.(" << eventWeights.size() << " total). In " << this->GetBoundary()->GetNumberCombinations() << " Discrete DataSets." << endl;
+	}
+	else
+	{
+		cout << "DataSet contains a total of:     " << eventWeights.size() << "     events. In " << this->GetBoundary()->GetNumberCombinations() << " Discrete DataSets." << endl;
+	}
+
+	if( this->GetBoundary()->GetNumberCombinations() > 1 && this->GetBoundary()->GetNumberCombinations() < 20 )
+	{
+		vector<DataPoint*> combinations = this->GetBoundary()->GetDiscreteCombinations();
+		for( unsigned int i=0; i< combinations.size(); ++i )
+		{
+			string description = this->GetBoundary()->DiscreteDescription( combinations[i] );
+			for( unsigned int j=0; j< description.size(); ++j )
+			{
+				if( description[j] == '\n' ) description[j] = ' ';
+				if( description[j] == '\t' ) description[j] = ' ';
+			}
+			pair< vector<ObservableRef>, vector<double > > thisPointInfo = this->GetBoundary()->GetDiscreteInfo( combinations[i] );
+			vector<unsigned int> indices = this->GetDiscreteIndices( thisPointInfo.first, thisPointInfo.second );
+			if( indices.empty() ) continue;
+			cout << "Combination: " << description << " has: " << indices.size() << " events";
+			if( weightColumn >= 0 )
+			{
+				double this_yield=0.;
+				for( unsigned int k=0; k< indices.size(); ++k ) this_yield += columns[(unsigned)weightColumn][indices[k]];
+				cout << " and " << this_yield << " yield." << endl;
+			}
+			else cout << "." << endl;
+		}
+	}
+}
+
+double ColumnarDataSet::GetSumWeights()
+{
+	int weightColumn = this->GetColumnIndex( ObservableRef( WeightName ) );
+	if( this->GetWeightsWereUsed() && weightColumn >= 0 )
+	{
+		double total=0.;
+		for( unsigned int i=0; i< eventWeights.size(); ++i )
+		{
+			total+=columns[(unsigned)weightColumn][i];
+		}
+		return total;
+	}
+	else
+	{
+		return (double)this->GetDataNumber();
+	}
+}
+
+double ColumnarDataSet::GetSumWeightsSq()
+{
+	int weightColumn = this->GetColumnIndex( ObservableRef( WeightName ) );
+	if( this->GetWeightsWereUsed() && weightColumn >= 0 )
+	{
+		double total=0.;
+		for( unsigned int i=0; i< eventWeights.size(); ++i )
+		{
+			double val = columns[(unsigned)weightColumn][i];
+			total+=val*val;
+		}
+		return total;
+	}
+	else
+	{
+		return (double)this->GetDataNumber();
+	}
+}
+
+void ColumnarDataSet::ApplyAlpha( const double total_sum, const double total_sum_sq )
+{
+	alpha= fabs(total_sum / total_sum_sq);
+	int weightColumn = this->GetColumnIndex( ObservableRef( WeightName ) );
+	if( weightColumn >= 0 ) this->SetEventWeights( weightColumn, -1, alpha );
+	cout << "alpha = " << setprecision(10) << total_sum << "  /  " << total_sum_sq << endl;
+	cout << "Correction Factor: " << setprecision(5) << fabs(alpha) << " applied to DataSet containing " << eventWeights.size() << " events." << endl << endl;
+}
+
+double ColumnarDataSet::GetAlpha()
+{
+	int alphaColumn = this->GetColumnIndex( ObservableRef( alphaName ) );
+	if( alphaName != "uninitialized" && alphaColumn >= 0 )
+	{
+		double alphaSum=0.;
+		for( unsigned int i=0; i< eventWeights.size(); ++i )
+		{
+			alphaSum+=columns[(unsigned)alphaColumn][i];
+		}
+		alphaSum/=(double)eventWeights.size();
+		return fabs(alphaSum);
+	}
+	else
+	{
+		return alpha;
+	}
+}
+
+void ColumnarDataSet::ApplyExternalAlpha( const string AlphaName )
+{
+	alphaName = AlphaName;
+	int alphaColumn = this->GetColumnIndex( ObservableRef( alphaName ) );
+	int weightColumn = this->GetColumnIndex( ObservableRef( WeightName ) );
+	if( alphaColumn < 0 || weightColumn < 0 )
+	{
+		cerr << "Cannot apply per-event alpha " << alphaName << " to weight " << WeightName << ", Observable not found in ColumnarDataSet" << endl;
+		throw(-20);
+	}
+	double avr=0.;
+	for( unsigned int i=0; i< eventWeights.size(); ++i ) avr+=columns[(unsigned)alphaColumn][i];
+	avr/=(double)eventWeights.size();
+	this->SetEventWeights( weightColumn, alphaColumn, 1. );
+	cout << "Using Observable: " << alphaName << " to apply a per-event alpha correction to the per-event weights used. Average Weight: " << avr << endl << endl;
+}
+
@@ -0,0 +1,30 @@
+/*!
+ * @class CompensatedSum
+ *
+ * @brief Accumulate a sum of doubles using Neumaier's variant of Kahan summation
+ */
+
+///	RapidFit Headers
+#include "CompensatedSum.h"
+
+CompensatedSum::CompensatedSum() : sum(0.), compensation(0.)
+{
+}
+
+void CompensatedSum::Add( const CompensatedSum& input )
+{
+	this->Add( input.sum );
+	this->Add( input.compensation );
+}
+
+double CompensatedSum::Sum() const
+{
+	return sum + compensation;
+}
+
+void CompensatedSum::Clear()
+{
+	sum = 0.;
+	compensation = 0.;
+}
+
@@ -24,14 +24,14 @@ using namespace::std;
 
 //	Required for Sorting
 DataPoint::DataPoint() : allObservables(), allNames(), myPhaseSpaceBoundary(NULL), thisDiscreteIndex(-1),
-	WeightValue(1.), storedID(0), initialNLL( numeric_limits<double>::quiet_NaN() ), PerEventData(), nameIndex(), DiscreteIndexMap()
+	WeightValue(1.), storedID(0), initialNLL( numeric_limits<double>::quiet_NaN() ), PerEventData(), DerivedData(), nameIndex(), DiscreteIndexMap()
 {
 }
 
 //Constructor with correct arguments
 DataPoint::DataPoint( vector<string> NewNames ) : allObservables(), allNames(), myPhaseSpaceBoundary(NULL),
 	thisDiscreteIndex(-1), WeightValue(1.), storedID(0), initialNLL( numeric_limits<double>::quiet_NaN() ),
-	PerEventData(), nameIndex(), DiscreteIndexMap()
+	PerEventData(), DerivedData(), nameIndex(), DiscreteIndexMap()
 {
 	allObservables.reserve( NewNames.size() );
 	//Populate the map
@@ -64,6 +64,7 @@ DataPoint& DataPoint::operator=( const DataPoint& NewPoint )
 		this->storedID = NewPoint.storedID;
 		this->initialNLL = NewPoint.initialNLL;
 		this->PerEventData = NewPoint.PerEventData;
+		this->DerivedData = NewPoint.DerivedData;
 		this->nameIndex = NewPoint.nameIndex;
 		for( unsigned int i=0; i< NewPoint.allObservables.size(); ++i )
 		{
@@ -77,7 +78,7 @@ DataPoint& DataPoint::operator=( const DataPoint& NewPoint )
 DataPoint::DataPoint( const DataPoint& input ) :
 	allObservables(), allNames(input.allNames), myPhaseSpaceBoundary(input.myPhaseSpaceBoundary),
 	thisDiscreteIndex(input.thisDiscreteIndex), WeightValue(input.WeightValue), storedID(input.storedID),
-	initialNLL( input.initialNLL ), PerEventData(input.PerEventData), nameIndex(), DiscreteIndexMap(input.DiscreteIndexMap)
+	initialNLL( input.initialNLL ), PerEventData(input.PerEventData), DerivedData(input.DerivedData), nameIndex(), DiscreteIndexMap(input.DiscreteIndexMap)
 {
 	for( unsigned int i=0; i< input.allObservables.size(); ++i )
 	{
@@ -98,6 +99,7 @@ vector<string> DataPoint::GetAllNames() const
 
 void DataPoint::RemoveObservable( const string input )
 {
+	this->ClearDerivedData();
 	vector<string>::iterator name_i = allNames.begin();
 	vector<Observable>::iterator obs_i = allObservables.begin();
 
@@ -172,6 +174,7 @@ bool DataPoint::SetObservable( string Name, Observable * NewObservable )
 	}
 	else
 	{
+		this->ClearDerivedData();
 		allObservables[(unsigned)nameIndex].SetObservable(NewObservable);
 		return true;
 	}
@@ -192,6 +195,7 @@ bool DataPoint::SetObservable( ObservableRef& Name, Observable * NewObservable )
 		else
 		{
 			Name.SetIndex( nameIndex );
+			this->ClearDerivedData();
 			allObservables[(unsigned)nameIndex].SetObservable(NewObservable);
 			return true;
 		}
@@ -199,6 +203,7 @@ bool DataPoint::SetObservable( ObservableRef& Name, Observable * NewObservable )
 	}
 	else
 	{
+		this->ClearDerivedData();
 		allObservables[(unsigned)Name.GetIndex()].SetObservable(NewObservable);
 		return true;
 	}
@@ -208,6 +213,7 @@ void DataPoint::AddObservable( string Name, Observable* NewObservable )
 {
 	if( StringProcessing::VectorContains( &allNames, &Name ) == -1 )
 	{
+		this->ClearDerivedData();
 		allNames.push_back( Name );
 		allObservables.push_back( Observable(*NewObservable) );
 	}
@@ -222,6 +228,7 @@ void DataPoint::AddObservable( string Name, double Value, string Unit, bool trus
 	Observable *tempObservable = new Observable( Name, Value, Unit );
 	if( trusted )
 	{
+		this->ClearDerivedData();
 		allObservables[(unsigned)thisnameIndex].SetObservable( tempObservable );
 	}
 	else
@@ -239,6 +246,7 @@ bool DataPoint::SetObservable( string Name, double Value, string Unit, bool trus
 	if( trusted )
 	{
 		returnValue=true;
+		this->ClearDerivedData();
 		allObservables[(unsigned)thisnameIndex].SetObservable( temporaryObservable );
 	}
 	else
@@ -334,9 +342,29 @@ void DataPoint::ClearPerEventData()
 	PerEventData.clear();
 }
 
+const double* DataPoint::GetDerivedData( const unsigned int slot ) const
+{
+	if( slot >= DerivedData.size() || DerivedData[slot].empty() ) return NULL;
+	return &(DerivedData[slot][0]);
+}
+
+void DataPoint::SetDerivedData( const unsigned int slot, const vector<double>& input )
+{
+	if( slot >= DerivedData.size() ) DerivedData.resize( slot+1 );
+	DerivedData[slot] = input;
+}
+
+void DataPoint::ClearDerivedData()
+{
+	if( !DerivedData.empty() ) DerivedData.clear();
+}
+
 void DataPoint::SetDiscreteIndexIDMap( size_t thisID, int index )
 {
-	DiscreteIndexMap.insert( pair<size_t,int>(thisID, index) );
+	DiscreteIndexMap[thisID] = index;
+	//	Keep the latest lookup outside of the map, in a fit every lookup is made with the same PhaseSpaceBoundary
+	storedID = thisID;
+	thisDiscreteIndex = index;
 }
 
 bool DataPoint::FindDiscreteIndexID( size_t thisID )
@@ -346,9 +374,12 @@ bool DataPoint::FindDiscreteIndexID( size_t thisID )
 
 int DataPoint::GetDiscreteIndexMap( size_t thisID )
 {
-	if( this->FindDiscreteIndexID( thisID ) )
+	if( storedID == thisID && thisDiscreteIndex != -1 ) return thisDiscreteIndex;
+
+	map<size_t,int>::const_iterator found = DiscreteIndexMap.find( thisID );
+	if( found != DiscreteIndexMap.end() )
 	{
-		return DiscreteIndexMap.at( thisID );
+		return found->second;
 	}
 	else
 	{
@@ -359,5 +390,7 @@ int DataPoint::GetDiscreteIndexMap( size_t thisID )
 void DataPoint::ClearDiscreteIndexMap()
 {
 	DiscreteIndexMap.clear();
+	storedID = 0;
+	thisDiscreteIndex = -1;
 }
 
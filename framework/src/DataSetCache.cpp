@@ -0,0 +1,267 @@
+/*!
+ * @class DataSetCache
+ *
+ * @brief A binary copy of the columns read from a ROOT file, which can be memory-mapped on later runs instead of re-reading the ntuple
+ */
+
+///	RapidFit Headers
+#include "DataSetCache.h"
+///	System Headers
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdio>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace::std;
+
+//	Bump this whenever the layout of the file changes
+#define DATASET_CACHE_VERSION 1
+
+namespace
+{
+	const char cacheMagic[8] = { 'R', 'F', 'D', 'C', 'A', 'C', 'H', 'E' };
+	const uint32_t cacheByteOrder = 0x01020304;
+
+	//	Fixed size header at the start of every cache file, followed by the source file name and description then the columns
+	struct DataSetCacheHeader
+	{
+		char magic[8];
+		uint32_t byteOrder;
+		uint32_t version;
+		uint64_t sourceSize;
+		int64_t sourceModified;
+		uint64_t boundaryHash;
+		uint64_t numberColumns;
+		uint64_t numberEvents;
+		uint64_t sourceLength;
+		uint64_t descriptionLength;
+	};
+
+	//	Columns start on an 8 byte boundary
+	uint64_t PaddedLength( const uint64_t input )
+	{
+		return ( input + 7 ) & ~( (uint64_t) 7 );
+	}
+}
+
+DataSetCache::DataSetCache( const string CacheDirectory, const string FileName, const string NTuplePath, const string CutString, const int StartEntry, const PhaseSpaceBoundary* Boundary ) :
+	cacheFileName(), cacheDirectory( CacheDirectory ), sourceFile( FileName ), description(), boundaryHash( 0 ), numberColumns( 0 ),
+	mappedData( NULL ), mappedSize( 0 ), numberEvents( 0 ), columns()
+{
+	stringstream thisDescription;
+	thisDescription << "NTuplePath: " << NTuplePath << "\nCutString: " << CutString << "\nStartEntry: " << StartEntry;
+	description = thisDescription.str();
+
+	boundaryHash = DataSetCache::Hash( Boundary->XML() );
+	numberColumns = (unsigned) Boundary->GetAllNames().size();
+
+	//	Everything except the state of the source file goes into the name, so a changed input file replaces its old cache
+	stringstream thisName;
+	thisName << cacheDirectory << "/" << hex << setw(16) << setfill('0') << DataSetCache::Hash( sourceFile + "\n" + description + "\n" + Boundary->XML() ) << ".rfcache";
+	cacheFileName = thisName.str();
+}
+
+DataSetCache::~DataSetCache()
+{
+	this->Close();
+}
+
+uint64_t DataSetCache::Hash( const string input )
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for( string::const_iterator char_i = input.begin(); char_i != input.end(); ++char_i )
+	{
+		hash ^= (uint64_t)(unsigned char)(*char_i);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+string DataSetCache::GetCacheFileName() const
+{
+	return cacheFileName;
+}
+
+uint64_t DataSetCache::GetNumberEvents() const
+{
+	return numberEvents;
+}
+
+const double* DataSetCache::GetColumn( const unsigned int obsIndex ) const
+{
+	if( obsIndex >= columns.size() ) return NULL;
+	return columns[obsIndex];
+}
+
+void DataSetCache::GetSourceStatus( uint64_t& size, int64_t& modified ) const
+{
+	struct stat sourceStat;
+	if( stat( sourceFile.c_str(), &sourceStat ) == 0 )
+	{
+		size = (uint64_t) sourceStat.st_size;
+		modified = (int64_t) sourceStat.st_mtime;
+	}
+	else
+	{
+		//	Not a local file (eg xrootd), only the file name is checked
+		size = 0;
+		modified = 0;
+	}
+}
+
+void DataSetCache::Close()
+{
+	if( mappedData != NULL ) munmap( mappedData, mappedSize );
+	mappedData = NULL;
+	mappedSize = 0;
+	numberEvents = 0;
+	columns.clear();
+}
+
+bool DataSetCache::Open()
+{
+	this->Close();
+
+	int fileDescriptor = open( cacheFileName.c_str(), O_RDONLY );
+	if( fileDescriptor == -1 ) return false;
+
+	struct stat cacheStat;
+	if( fstat( fileDescriptor, &cacheStat ) != 0 || (size_t) cacheStat.st_size < sizeof(DataSetCacheHeader) )
+	{
+		close( fileDescriptor );
+		return false;
+	}
+
+	mappedSize = (size_t) cacheStat.st_size;
+	mappedData = mmap( NULL, mappedSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+	close( fileDescriptor );
+	if( mappedData == MAP_FAILED )
+	{
+		mappedData = NULL;
+		mappedSize = 0;
+		return false;
+	}
+
+	const char* start = (const char*) mappedData;
+	DataSetCacheHeader header;
+	memcpy( &header, start, sizeof(DataSetCacheHeader) );
+
+	uint64_t sourceSize=0;
+	int64_t sourceModified=0;
+	this->GetSourceStatus( sourceSize, sourceModified );
+
+	bool valid = ( memcmp( header.magic, cacheMagic, sizeof(cacheMagic) ) == 0 );
+	valid = valid && header.byteOrder == cacheByteOrder && header.version == DATASET_CACHE_VERSION;
+	valid = valid && header.sourceSize == sourceSize && header.sourceModified == sourceModified;
+	valid = valid && header.boundaryHash == boundaryHash && header.numberColumns == (uint64_t) numberColumns;
+	valid = valid && header.sourceLength == (uint64_t) sourceFile.size() && header.descriptionLength == (uint64_t) description.size();
+
+	const uint64_t columnStart = PaddedLength( sizeof(DataSetCacheHeader) + header.sourceLength + header.descriptionLength );
+	valid = valid && (uint64_t) mappedSize == columnStart + header.numberColumns * header.numberEvents * sizeof(double);
+
+	//	Protect against a collision of the hash used in the file name
+	if( valid )
+	{
+		const char* strings = start + sizeof(DataSetCacheHeader);
+		valid = ( sourceFile.compare( 0, string::npos, strings, sourceFile.size() ) == 0 );
+		valid = valid && ( description.compare( 0, string::npos, strings + sourceFile.size(), description.size() ) == 0 );
+	}
+
+	if( !valid )
+	{
+		cout << "DataSetCache: " << cacheFileName << " is out of date, it will be re-written" << endl;
+		this->Close();
+		return false;
+	}
+
+	numberEvents = header.numberEvents;
+	for( unsigned int obsIndex=0; obsIndex< numberColumns; ++obsIndex )
+	{
+		columns.push_back( (const double*)( start + columnStart + obsIndex * numberEvents * sizeof(double) ) );
+	}
+
+	cout << "DataSetCache: Read " << numberEvents << " events from " << cacheFileName << endl;
+
+	return true;
+}
+
+bool DataSetCache::Write( const vector<vector<double> >& Columns ) const
+{
+	if( Columns.size() != numberColumns )
+	{
+		cerr << "DataSetCache: Expected " << numberColumns << " columns, not writing cache" << endl;
+		return false;
+	}
+
+	const uint64_t thisNumberEvents = Columns.empty() ? 0 : (uint64_t) Columns[0].size();
+	for( unsigned int obsIndex=0; obsIndex< Columns.size(); ++obsIndex )
+	{
+		if( (uint64_t) Columns[obsIndex].size() != thisNumberEvents )
+		{
+			cerr << "DataSetCache: Columns have different lengths, not writing cache" << endl;
+			return false;
+		}
+	}
+
+	if( mkdir( cacheDirectory.c_str(), 0755 ) != 0 && errno != EEXIST )
+	{
+		cerr << "DataSetCache: Cannot create cache directory " << cacheDirectory << endl;
+		return false;
+	}
+
+	DataSetCacheHeader header;
+	memset( &header, 0, sizeof(DataSetCacheHeader) );
+	memcpy( header.magic, cacheMagic, sizeof(cacheMagic) );
+	header.byteOrder = cacheByteOrder;
+	header.version = DATASET_CACHE_VERSION;
+	this->GetSourceStatus( header.sourceSize, header.sourceModified );
+	header.boundaryHash = boundaryHash;
+	header.numberColumns = numberColumns;
+	header.numberEvents = thisNumberEvents;
+	header.sourceLength = sourceFile.size();
+	header.descriptionLength = description.size();
+
+	const uint64_t stringLength = sizeof(DataSetCacheHeader) + header.sourceLength + header.descriptionLength;
+	const string padding( (size_t)( PaddedLength( stringLength ) - stringLength ), '\0' );
+
+	//	Write to a temporary file and move it into place so that a job reading the cache never sees a partial file
+	stringstream tempName;
+	tempName << cacheFileName << ".tmp" << getpid();
+
+	ofstream output( tempName.str().c_str(), ios::out | ios::binary | ios::trunc );
+	if( !output.is_open() )
+	{
+		cerr << "DataSetCache: Cannot write to " << tempName.str() << endl;
+		return false;
+	}
+
+	output.write( (const char*) &header, sizeof(DataSetCacheHeader) );
+	output.write( sourceFile.c_str(), (streamsize) sourceFile.size() );
+	output.write( description.c_str(), (streamsize) description.size() );
+	output.write( padding.c_str(), (streamsize) padding.size() );
+	for( unsigned int obsIndex=0; obsIndex< Columns.size(); ++obsIndex )
+	{
+		if( thisNumberEvents > 0 ) output.write( (const char*) &(Columns[obsIndex][0]), (streamsize)( thisNumberEvents * sizeof(double) ) );
+	}
+	output.close();
+
+	if( output.fail() || rename( tempName.str().c_str(), cacheFileName.c_str() ) != 0 )
+	{
+		cerr << "DataSetCache: Failed to write " << cacheFileName << endl;
+		remove( tempName.str().c_str() );
+		return false;
+	}
+
+	cout << "DataSetCache: Wrote " << thisNumberEvents << " events to " << cacheFileName << endl;
+
+	return true;
+}
+
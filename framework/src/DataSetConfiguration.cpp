@@ -22,9 +22,12 @@
 ///	RapidFit Headers
 #include "StringProcessing.h"
 #include "MemoryDataSet.h"
+#include "ColumnarDataSet.h"
+#include "DataSetCache.h"
 #include "DataSetConfiguration.h"
 #include "ClassLookUp.h"
 #include "ResultFormatter.h"
+#include "Threading.h"
 ///	System Headers
 #include <iostream>
 #include <fstream>
@@ -32,9 +35,16 @@
 #include <map>
 #include <stdlib.h>
 #include <sstream>
+#include <pthread.h>
 
 using namespace::std;
 
+//	Reading ROOT files and building a Foam generator (which writes its MC cache files) both go through gDirectory, so only one thread does either at a time
+//	This is the Threading::RootIOLock() shared with the studies which write their own ROOT files from several workers
+//	AcceptReject only uses the PDF it is given and the random function of the calling thread, each worker of a ToyStudy has its own copy of both
+//	FoamFile passes the DataSet through a ROOT file which may have the same name in every worker
+static pthread_mutex_t foam_file_lock = PTHREAD_MUTEX_INITIALIZER;
+
 //Constructor with correct argument
 DataSetConfiguration::DataSetConfiguration( string DataSource, long DataNumber, string cut, vector<string> DataArguments, vector<string> DataArgumentNames, int starting_entry, PhaseSpaceBoundary* Boundary ) :
 	source(DataSource), cutString(cut), numberEvents(DataNumber), arguments(DataArguments), argumentNames(DataArgumentNames),
@@ -117,6 +127,11 @@ string DataSetConfiguration::GetSource() const
 	return source;
 }
 
+long DataSetConfiguration::GetNumberEvents() const
+{
+	return numberEvents;
+}
+
 //Create the DataSet
 IDataSet * DataSetConfiguration::MakeDataSet( PhaseSpaceBoundary * DataBoundary, IPDF * FitPDF, int real_numberEvents )
 {
@@ -133,7 +148,9 @@ IDataSet * DataSetConfiguration::MakeDataSet( PhaseSpaceBoundary * DataBoundary,
 	if( source == "File" )
 	{
 		//Load data from file
+		pthread_mutex_lock( Threading::RootIOLock() );
 		newDataSet = this->LoadDataFile( arguments, argumentNames, internalBoundary, numberEvents );
+		pthread_mutex_unlock( Threading::RootIOLock() );
 	}
 	else if( source == "FoamFile" )
 	{
@@ -150,6 +167,9 @@ IDataSet * DataSetConfiguration::MakeDataSet( PhaseSpaceBoundary * DataBoundary,
 
 IDataSet* DataSetConfiguration::LoadGeneratorDataset( string Source, PhaseSpaceBoundary* InternalBoundary, int NumberEvents, IPDF* FitPDF )
 {
+	const bool sharedGenerator = ( Source == "Foam" );
+	if( sharedGenerator ) pthread_mutex_lock( Threading::RootIOLock() );
+
 	//Assume it's an accept/reject generator, or some child of it
 	IDataGenerator * dataGenerator = NULL;
 	if (separateGeneratePDF)
@@ -165,10 +185,22 @@ IDataSet* DataSetConfiguration::LoadGeneratorDataset( string Source, PhaseSpaceB
 		cerr << "Generator NOT found!" << endl;
 		exit(-9864);
 	}
+
+	//Generators which support it can use more than one thread
+	string searchName = "GeneratorThreads";
+	int threadsIndex = StringProcessing::VectorContains( &argumentNames, &searchName );
+	if( threadsIndex >= 0 )
+	{
+		int generatorThreads = atoi( arguments[unsigned(threadsIndex)].c_str() );
+		if( generatorThreads > 1 ) dataGenerator->SetNumberThreads( (unsigned) generatorThreads );
+	}
+
 	dataGenerator->GenerateData( (int)NumberEvents );
 	IDataSet* newDataSet = dataGenerator->GetDataSet();
 	delete dataGenerator;
 
+	if( sharedGenerator ) pthread_mutex_unlock( Threading::RootIOLock() );
+
 	return newDataSet;
 }
 
@@ -189,10 +221,14 @@ IDataSet* DataSetConfiguration::FoamFile( vector<string> Arguments, vector<strin
 
 	string Source="Foam";
 
+	pthread_mutex_lock( &foam_file_lock );
+
 	IDataSet* FoamDataSet = this->LoadGeneratorDataset( Source, InternalBoundary, NumberEvents, FitPDF );
 
 	vector<IDataSet*> TotalFoamDataSet(1, FoamDataSet);
 
+	pthread_mutex_lock( Threading::RootIOLock() );
+
 	remove( fileName.c_str() );
 
 	ResultFormatter::MakeRootDataFile( fileName, TotalFoamDataSet );
@@ -210,6 +246,9 @@ IDataSet* DataSetConfiguration::FoamFile( vector<string> Arguments, vector<strin
 		ResultFormatter::MakeRootDataFile( fileName, TotalFoamDataSet );
 	}
 
+	pthread_mutex_unlock( Threading::RootIOLock() );
+	pthread_mutex_unlock( &foam_file_lock );
+
 	return FileDataSet;
 }
 
@@ -340,6 +379,30 @@ IDataSet * DataSetConfiguration::LoadDataFile( vector<string> Arguments, vector<
 		nTuplePath = this->getNtuplePath( fileName );
 	}
 
+	//Find the storage requested for the data if specified
+	searchName = "Storage";
+	int storageIndex = StringProcessing::VectorContains( &ArgumentNames, &searchName );
+	bool columnarStorage = false;
+	if ( storageIndex >= 0 )
+	{
+		string storage = Arguments[unsigned(storageIndex)];
+		if( storage == "Columnar" ) columnarStorage = true;
+		else if( storage != "Memory" )
+		{
+			cerr << "Unrecognised Storage: " << storage << " use either Memory or Columnar" << endl;
+			exit(1);
+		}
+	}
+
+	//Find the directory for the binary cache of the file if specified
+	searchName = "CacheDirectory";
+	int cacheIndex = StringProcessing::VectorContains( &ArgumentNames, &searchName );
+	string cacheDirectory = "";
+	if ( cacheIndex >= 0 )
+	{
+		cacheDirectory = Arguments[unsigned(cacheIndex)];
+	}
+
 	//Find the file type, and treat appropriately
 	vector<string> splitFileName = StringProcessing::SplitString( fileName, '.' );
 	string fileNameExtension = splitFileName[ splitFileName.size() - 1 ];
@@ -347,7 +410,7 @@ IDataSet * DataSetConfiguration::LoadDataFile( vector<string> Arguments, vector<
 	{
 		//Make a RootFileDataSet from a root file
 		//data = new RootFileDataSet( fileName, dataBoundary );
-		return LoadRootFileIntoMemory( fileName, nTuplePath, NumberEventsToRead, DataBoundary );
+		return LoadRootFileIntoMemory( fileName, nTuplePath, NumberEventsToRead, DataBoundary, columnarStorage, cacheDirectory );
 	}
 	else if ( fileNameExtension == "csv" )
 	{
@@ -367,9 +430,84 @@ IDataSet * DataSetConfiguration::LoadDataFile( vector<string> Arguments, vector<
 	}
 }
 
-IDataSet * DataSetConfiguration::LoadRootFileIntoMemory( string this_fileName, string ntuplePath, long numberEventsToRead, PhaseSpaceBoundary * DataBoundary )
+IDataSet * DataSetConfiguration::LoadRootFileIntoMemory( string this_fileName, string ntuplePath, long numberEventsToRead, PhaseSpaceBoundary * DataBoundary, bool columnarStorage, string cacheDirectory )
+{
+	IDataSet * data = NULL;
+	if( columnarStorage ) data = new ColumnarDataSet(DataBoundary);
+	else data = new MemoryDataSet(DataBoundary);
+	vector<string> observableNames = DataBoundary->GetAllNames();
+	int numberOfObservables = int(observableNames.size());
+
+	//  Container for all of the data read in from a root file
+	vector<vector<Double_t> > real_data_array;
+
+	//	Pointers to the start of each column, either in real_data_array or in a memory-mapped cache
+	vector<const double*> columns( (unsigned)numberOfObservables, NULL );
+	int numberOfEventsAfterCut = 0;
+
+	DataSetCache* cache = NULL;
+	if( !cacheDirectory.empty() )
+	{
+		cache = new DataSetCache( cacheDirectory, this_fileName, ntuplePath, cutString, Start_Entry, DataBoundary );
+	}
+
+	if( cache != NULL && cache->Open() )
+	{
+		numberOfEventsAfterCut = (int) cache->GetNumberEvents();
+		for( unsigned int obsIndex = 0; obsIndex < (unsigned)numberOfObservables; ++obsIndex ) columns[obsIndex] = cache->GetColumn( obsIndex );
+	}
+	else
+	{
+		numberOfEventsAfterCut = this->ReadRootFileColumns( this_fileName, ntuplePath, DataBoundary, real_data_array );
+		if( cache != NULL ) cache->Write( real_data_array );
+		for( unsigned int obsIndex = 0; obsIndex < (unsigned)numberOfObservables; ++obsIndex )
+		{
+			if( numberOfEventsAfterCut > 0 ) columns[obsIndex] = &(real_data_array[obsIndex][0]);
+		}
+	}
+
+	//	Look up the units once rather than for every event
+	vector<string> observableUnits;
+	for( unsigned int obsIndex = 0; obsIndex < (unsigned)numberOfObservables; ++obsIndex )
+	{
+		observableUnits.push_back( data->GetBoundary()->GetConstraint( observableNames[obsIndex] )->GetUnit() );
+	}
+
+	// Now populate the dataset
+	int numberOfDataPointsAdded = 0;
+	int numberOfDataPointsRead = 0;
+
+	//  Now we have all of the data stored in memory in columns which has a 1<->1 with observableName
+	//  Create and store data points for each event as before and throw away events outside of the PhaseSpace
+	for( ; (numberOfDataPointsRead < numberOfEventsAfterCut) && (numberOfDataPointsAdded < numberEventsToRead) ; ++numberOfDataPointsRead )
+	{
+		DataPoint* point = new DataPoint( observableNames );
+		for(int obsIndex = 0; obsIndex < numberOfObservables; ++obsIndex )
+		{
+			point->SetObservable( observableNames[unsigned(obsIndex)], columns[unsigned(obsIndex)][unsigned(numberOfDataPointsRead)], observableUnits[unsigned(obsIndex)], true, obsIndex);
+			//cout << columns[unsigned(obsIndex)][unsigned(numberOfDataPointsRead)] << endl;
+		}
+		bool dataPointAdded = data->AddDataPoint( point );
+		if (dataPointAdded) ++numberOfDataPointsAdded;
+	}
+
+	if( DEBUG_DATA )
+	{
+		data->Print();
+	}
+
+	if( cache != NULL ) delete cache;
+
+	cout << "Added " << numberOfDataPointsAdded << " events from ROOT file: " << this_fileName << " which are consistent with the PhaseSpaceBoundary" << endl;
+	time_t timeNow;
+	time(&timeNow);
+	cout << "Time: " << ctime( &timeNow );
+	while( !real_data_array.empty() ){ while( !real_data_array.back().empty() ){real_data_array.back().pop_back(); }; real_data_array.pop_back(); }
+	return data;
+}
+
+int DataSetConfiguration::ReadRootFileColumns( string this_fileName, string ntuplePath, PhaseSpaceBoundary * DataBoundary, vector<vector<double> >& real_data_array )
 {
-	MemoryDataSet * data = new MemoryDataSet(DataBoundary);
 	vector<string> observableNames = DataBoundary->GetAllNames();
 	int numberOfObservables = int(observableNames.size());
 
@@ -400,8 +538,6 @@ IDataSet * DataSetConfiguration::LoadRootFileIntoMemory( string this_fileName, s
 	cout << "You have applied this cut to the data: '" << cutString << "'" << endl;
 	cout << "Total number of events after cut: " << numberOfEventsAfterCut << endl;
 
-	//  Container for all of the data read in from a root file
-	vector<vector<Double_t> > real_data_array;
 	//real_data_array.reserve( unsigned(numberOfObservables) );
 
 
@@ -506,40 +642,10 @@ IDataSet * DataSetConfiguration::LoadRootFileIntoMemory( string this_fileName, s
 	//time(&timeNow2);
 	//cout << "Time After Draw Read: " << ctime( &timeNow2 ) << endl;
 
-
-	// Now populate the dataset
-	int numberOfDataPointsAdded = 0;
-	int numberOfDataPointsRead = 0;
-
-	//  Now we have all of the data stored in memory in real_data_array which has a 1<->1 with observableName
-	//  Create and store data points for each event as before and throw away events outside of the PhaseSpace
-	for( ; (numberOfDataPointsRead < numberOfEventsAfterCut) && (numberOfDataPointsAdded < numberEventsToRead) ; ++numberOfDataPointsRead )
-	{
-		DataPoint* point = new DataPoint( observableNames );
-		for(int obsIndex = 0; obsIndex < numberOfObservables; ++obsIndex )
-		{
-			string name = observableNames[unsigned(obsIndex)];
-			string unit = data->GetBoundary()->GetConstraint( name )->GetUnit();
-			point->SetObservable( name, real_data_array[unsigned(obsIndex)][unsigned(numberOfDataPointsRead)], unit, true, obsIndex);
-			//cout << real_data_array[unsigned(obsIndex)][unsigned(numberOfDataPointsRead)] << endl;
-		}
-		bool dataPointAdded = data->AddDataPoint( point );
-		if (dataPointAdded) ++numberOfDataPointsAdded;
-	}
-
-	if( DEBUG_DATA )
-	{
-		data->Print();
-	}
-
 	inputFile->Close();
 	delete inputFile;
-	cout << "Added " << numberOfDataPointsAdded << " events from ROOT file: " << this_fileName << " which are consistent with the PhaseSpaceBoundary" << endl;
-	time_t timeNow;
-	time(&timeNow);
-	cout << "Time: " << ctime( &timeNow );
-	while( !real_data_array.empty() ){ while( !real_data_array.back().empty() ){real_data_array.back().pop_back(); }; real_data_array.pop_back(); }
-	return data;
+
+	return numberOfEventsAfterCut;
 }
 
 IDataSet * DataSetConfiguration::LoadAsciiFileIntoMemory( string this_fileName, long numberEventsToRead, PhaseSpaceBoundary * DataBoundary )
@@ -0,0 +1,84 @@
+/*!
+ * @class DerivedColumn
+ *
+ * @brief A set of per-event quantities which depend only on the Observables of each event
+ */
+
+///	RapidFit Headers
+#include "DerivedColumn.h"
+///	System Headers
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+using namespace::std;
+
+//	Slots are shared between every DerivedColumn with the same name for the lifetime of the process
+static map<string,unsigned int> derivedColumnSlots;
+static pthread_mutex_t derivedColumnLock = PTHREAD_MUTEX_INITIALIZER;
+
+DerivedColumn::DerivedColumn( const string Name, const unsigned int Width ) :
+	name( Name ), width( Width ), slot( DerivedColumn::ReserveSlot( Name ) ), scratch( Width, 0. )
+{
+}
+
+DerivedColumn::~DerivedColumn()
+{
+}
+
+unsigned int DerivedColumn::ReserveSlot( const string Name )
+{
+	pthread_mutex_lock( &derivedColumnLock );
+	map<string,unsigned int>::iterator found = derivedColumnSlots.find( Name );
+	unsigned int thisSlot = 0;
+	if( found == derivedColumnSlots.end() )
+	{
+		thisSlot = (unsigned) derivedColumnSlots.size();
+		derivedColumnSlots[ Name ] = thisSlot;
+	}
+	else
+	{
+		thisSlot = found->second;
+	}
+	pthread_mutex_unlock( &derivedColumnLock );
+	return thisSlot;
+}
+
+string DerivedColumn::GetName() const
+{
+	return name;
+}
+
+unsigned int DerivedColumn::GetWidth() const
+{
+	return width;
+}
+
+unsigned int DerivedColumn::GetSlot() const
+{
+	return slot;
+}
+
+const double* DerivedColumn::GetValues( DataPoint* input ) const
+{
+	const double* stored = input->GetDerivedData( slot );
+	if( stored != NULL ) return stored;
+
+	//	Don't store anything here, the DataPoint may be being read by other threads at the same time
+	this->Calculate( input, &(scratch[0]) );
+	return &(scratch[0]);
+}
+
+void DerivedColumn::Precompute( IDataSet* input ) const
+{
+	if( input == NULL ) return;
+	vector<double> values( width, 0. );
+	for( int i=0; i< input->GetDataNumber(); ++i )
+	{
+		DataPoint* thisPoint = input->GetDataPoint( i );
+		if( thisPoint->GetDerivedData( slot ) != NULL ) continue;
+		this->Calculate( thisPoint, &(values[0]) );
+		thisPoint->SetDerivedData( slot, values );
+	}
+}
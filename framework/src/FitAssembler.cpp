@@ -18,6 +18,7 @@
 #include "ResultFormatter.h"
 #include "StringProcessing.h"
 #include "PhysicsBottle.h"
+#include "ThreadPool.h"
 ///	System Headers
 #include <iostream>
 #include <iomanip>
@@ -84,6 +85,14 @@ FitResult * FitAssembler::DoFit( IMinimiser * Minimiser, IFitFunction * TheFunct
 
 	cout << "\nMinimised!\n" << endl;
 
+	//	How evenly the events were shared between the threads over the whole fit
+	ThreadPool* workerPool = TheFunction->GetWorkerPool();
+	if( workerPool != NULL )
+	{
+		workerPool->PrintStatistics( "FitFunction Threads" );
+		cout << endl;
+	}
+
 	FitResult* final_result = Minimiser->GetFitResult();
 
 	if( DebugClass::DebugThisClass( "FitAssembler" ) )
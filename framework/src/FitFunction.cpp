@@ -22,8 +22,9 @@
 #include "ClassLookUp.h"
 #include "RapidFitIntegrator.h"
 #include "StringProcessing.h"
-#include "MemoryDataSet.h"
+#include "ColumnarDataSet.h"
 #include "ProdPDF.h"
+#include "CompensatedSum.h"
 //	System Headers
 #include <iostream>
 #include <iomanip>
@@ -37,7 +38,7 @@ using namespace::std;
 //Default constructor
 FitFunction::FitFunction() :
 	Name("Unknown"), allData(), testDouble(), useWeights(false), weightObservableName(), Fit_File(NULL), Fit_Tree(NULL), branch_objects(), branch_names(), fit_calls(0),
-	Threads(-1), stored_pdfs(), StoredBoundary(), StoredDataSubSet(), StoredIntegrals(), finalised(false), fit_thread_data(NULL), testIntegrator( true ), weightsSquared( false ),
+	Threads(-1), stored_pdfs(), StoredBoundary(), StoredDataRanges(), StoredIntegrals(), finalised(false), fit_thread_data(NULL), workerPool(NULL), chunkSize(0), testIntegrator( true ), weightsSquared( false ),
 	traceNum(0), step_time(-1), callNum(0), integrationConfig(new RapidFitIntegratorConfig()), initialConstraint( numeric_limits<double>::quiet_NaN() )
 {
 }
@@ -55,6 +56,18 @@ FitFunction::~FitFunction()
 		Fit_File->Close();
 	}
 	if( fit_thread_data != NULL ) delete [] fit_thread_data;
+	if( workerPool != NULL )
+	{
+		//	The PDFs in the bottle may outlive us, make sure they don't keep a handle on the workers
+		if( allData != NULL )
+		{
+			for( int resultIndex = 0; resultIndex < allData->NumberResults(); ++resultIndex )
+			{
+				allData->GetResultPDF( resultIndex )->GetPDFIntegrator()->SetWorkerPool( NULL );
+			}
+		}
+		delete workerPool;
+	}
 	//if( allData != NULL ) delete allData;
 	/*while( !StoredBoundary.empty() )
 	  {
@@ -182,6 +195,10 @@ void FitFunction::SetPhysicsBottle( const PhysicsBottle * NewBottle )
 			cout << "FitFunction: Finished Performing Integration Test" << endl;
 		}
 
+		//	Calculate the parameter independent per-event quantities once, the per-thread copies of the data below carry these with them
+		allData->GetResultPDF(resultIndex)->PrecomputeDerivedColumns( allData->GetResultDataSet(resultIndex) );
+		this->IndexDiscreteCombinations( allData->GetResultDataSet(resultIndex) );
+
 		if( Threads > 0 )
 		{
 			//      Create simple data subsets. We no longer care about the handles that IDataSet takes care of
@@ -189,13 +206,9 @@ void FitFunction::SetPhysicsBottle( const PhysicsBottle * NewBottle )
 			{
 				cout << "FitFunction: Splitting DataSet" << endl;
 			}
-			StoredDataSubSet.push_back( Threading::divideData( NewBottle->GetResultDataSet(resultIndex), Threads ) );
-			vector<IDataSet*> sets;
-			for( unsigned int i=0; i<  StoredDataSubSet.back().size(); ++i )
-			{
-				sets.push_back( new MemoryDataSet( NewBottle->GetResultDataSet(resultIndex)->GetBoundary(), StoredDataSubSet.back()[i] ) );
-			}
-			stored_datasets.push_back( sets );
+			//	Whole blocks of events per thread so that the NLL is summed the same way for any number of threads
+			//	Each thread reads its events from the DataSet by index, so nothing is copied or built per event here
+			StoredDataRanges.push_back( Threading::divideRanges( NewBottle->GetResultDataSet(resultIndex), Threads, Threading::EventsPerBlock() ) );
 			for( int i=0; i< Threads; ++i )
 			{
 				/*if( DebugClass::DebugThisClass( "FitFunction" ) )
@@ -216,6 +229,13 @@ void FitFunction::SetPhysicsBottle( const PhysicsBottle * NewBottle )
 	if( Threads > 0 )
 	{
 		fit_thread_data = new Fitting_Thread[ (unsigned) Threads ];
+
+		//	Start the workers once here rather than creating new threads on every call from the minimiser
+		if( workerPool == NULL ) workerPool = new ThreadPool( (unsigned) Threads );
+		for( int resultIndex = 0; resultIndex < allData->NumberResults(); ++resultIndex )
+		{
+			allData->GetResultPDF( resultIndex )->GetPDFIntegrator()->SetWorkerPool( workerPool, chunkSize );
+		}
 	}
 
 	if( DebugClass::DebugThisClass( "FitFunction" ) )
@@ -271,10 +291,15 @@ double FitFunction::Evaluate()
 	}
 #endif
 	double minimiseValue = 0.0;
-	double temp=0.;
 
-	vector<double> values;
+	//	The DataSets are always added in the same order so the total is reproducible
+	CompensatedSum values;
 	if( DebugClass::DebugThisClass( "FitFunction" ) ) cout << endl;
+
+	//	Let the FitFunction evaluate all of the DataSets at once if it can keep more threads busy that way
+	vector<double> dataSetValues;
+	const bool evaluatedTogether = this->EvaluateAllDataSets( dataSetValues );
+
 	//Calculate the function value for each PDF-DataSet pair
 	for( int resultIndex = 0; resultIndex < allData->NumberResults(); ++resultIndex )
 	{
@@ -287,40 +312,29 @@ double FitFunction::Evaluate()
 			}
 			continue;
 		}
-		if( allData->GetResultDataSet( resultIndex )->GetDataNumber() < 1 )
-		{
-			values.push_back( 0. );
-		}
-		else
+		double thisValue = 0.;
+		if( allData->GetResultDataSet( resultIndex )->GetDataNumber() >= 1 )
 		{
 			//cout << "Eval Set: " << allData->GetResultDataSet( resultIndex ) << "\t" << resultIndex << endl;
-			values.push_back( this->EvaluateDataSet( allData->GetResultPDF( resultIndex ), allData->GetResultDataSet( resultIndex ), resultIndex ) );
-			//cout << "Result: " << temp << endl;
-
-			ClearPhaseSpaceCaches( allData->GetResultDataSet( resultIndex ) );
+			if( evaluatedTogether ) thisValue = dataSetValues[(unsigned)resultIndex];
+			else thisValue = this->EvaluateDataSet( allData->GetResultPDF( resultIndex ), allData->GetResultDataSet( resultIndex ), resultIndex );
+			//cout << "Result: " << thisValue << endl;
 		}
 
-		if( fabs(values.back()) >= DBL_MAX )
+		if( fabs(thisValue) >= DBL_MAX )
 		{
 			return DBL_MAX;
 		}
 		else
 		{
-			minimiseValue = values.back();
+			values.Add( thisValue );
 		}
-		if( DebugClass::DebugThisClass( "FitFunction" ) ) cout << "DataSet " << resultIndex << " : " << minimiseValue << endl;
+		if( DebugClass::DebugThisClass( "FitFunction" ) ) cout << "DataSet " << resultIndex << " : " << thisValue << endl;
 	}
 
 	if( DebugClass::DebugThisClass( "FitFunction" ) ) cout << endl;
 
-	sort( values.begin(), values.end() );
-
-	for( unsigned int i=0; i< values.size(); ++i )
-	{
-		temp+=values[i];
-	}
-
-	minimiseValue=temp;
+	minimiseValue = values.Sum();
 
 	double constraintScale = 0.;
 	//Calculate the value of each constraint
@@ -406,6 +420,198 @@ double FitFunction::EvaluateDataSet( IPDF * TestPDF, IDataSet * TestDataSet, int
 	return 1.0;
 }
 
+bool FitFunction::EvaluateAllDataSets( vector<double>& output )
+{
+	(void)output;
+
+	return false;
+}
+
+bool FitFunction::ProvidesDataSetGradient() const
+{
+	return false;
+}
+
+bool FitFunction::EvaluateDataSetGradient( IPDF * TestPDF, IDataSet * TestDataSet, int number, const vector<string>& Names, vector<double>& output )
+{
+	(void)TestPDF;
+	(void)TestDataSet;
+	(void)number;
+	output = vector<double>( Names.size(), 0. );
+	return false;
+}
+
+bool FitFunction::CanEvaluateGradient()
+{
+	if( !this->ProvidesDataSetGradient() ) return false;
+
+	vector<string> floatedNames = allData->GetParameterSet()->GetAllFloatNames();
+	bool anyPDF = false;
+	for( int resultIndex = 0; resultIndex < allData->NumberResults(); ++resultIndex )
+	{
+		if( allData->GetResultDataSet( resultIndex )->GetDataNumber() == 0 ) continue;
+		vector<string> analyticNames = allData->GetResultPDF( resultIndex )->GetAnalyticGradientParameters();
+		bool anyFloated = false;
+		for( vector<string>::iterator name_i = analyticNames.begin(); name_i != analyticNames.end(); ++name_i )
+		{
+			if( StringProcessing::VectorContains( &floatedNames, &(*name_i) ) != -1 ) anyFloated = true;
+		}
+		if( !anyFloated ) return false;
+		anyPDF = true;
+	}
+	return anyPDF;
+}
+
+vector<double> FitFunction::EvaluateGradient()
+{
+	ParameterSet* fitParameters = allData->GetParameterSet();
+	vector<string> allNames = fitParameters->GetAllNames();
+	vector<double> gradient( allNames.size(), 0. );
+
+	const unsigned int nResults = (unsigned) allData->NumberResults();
+	vector<vector<string> > dependsOn( nResults ), analyticNames( nResults );
+	for( unsigned int resultIndex = 0; resultIndex < nResults; ++resultIndex )
+	{
+		if( allData->GetResultDataSet( (int)resultIndex )->GetDataNumber() == 0 ) continue;
+		dependsOn[resultIndex] = allData->GetResultPDF( (int)resultIndex )->GetPrototypeParameterSet();
+		analyticNames[resultIndex] = allData->GetResultPDF( (int)resultIndex )->GetAnalyticGradientParameters();
+	}
+
+	//	A parameter is differentiated analytically only if every PDF depending on it can do so
+	vector<bool> isAnalytic( allNames.size(), false );
+	vector<bool> isFloated( allNames.size(), false );
+	for( unsigned int paramIndex = 0; paramIndex < allNames.size(); ++paramIndex )
+	{
+		isFloated[paramIndex] = fitParameters->GetPhysicsParameter( allNames[paramIndex] )->GetType() != "Fixed";
+		if( !isFloated[paramIndex] || !this->ProvidesDataSetGradient() ) continue;
+		bool allAnalytic = true;
+		for( unsigned int resultIndex = 0; resultIndex < nResults; ++resultIndex )
+		{
+			if( StringProcessing::VectorContains( &(dependsOn[resultIndex]), &(allNames[paramIndex]) ) == -1 ) continue;
+			if( StringProcessing::VectorContains( &(analyticNames[resultIndex]), &(allNames[paramIndex]) ) == -1 ) allAnalytic = false;
+		}
+		isAnalytic[paramIndex] = allAnalytic;
+	}
+
+	//	Derivatives of the data terms
+	for( unsigned int resultIndex = 0; resultIndex < nResults; ++resultIndex )
+	{
+		IDataSet* thisDataSet = allData->GetResultDataSet( (int)resultIndex );
+		if( thisDataSet->GetDataNumber() == 0 ) continue;
+
+		vector<string> thisNames;
+		vector<unsigned int> thisIndices;
+		for( unsigned int paramIndex = 0; paramIndex < allNames.size(); ++paramIndex )
+		{
+			if( !isAnalytic[paramIndex] ) continue;
+			if( StringProcessing::VectorContains( &(dependsOn[resultIndex]), &(allNames[paramIndex]) ) == -1 ) continue;
+			thisNames.push_back( allNames[paramIndex] );
+			thisIndices.push_back( paramIndex );
+		}
+		if( thisNames.empty() ) continue;
+
+		vector<double> thisGradient;
+		bool success = this->EvaluateDataSetGradient( allData->GetResultPDF( (int)resultIndex ), thisDataSet, (int)resultIndex, thisNames, thisGradient );
+
+		for( unsigned int i=0; i< thisIndices.size(); ++i )
+		{
+			if( !success || std::isnan( thisGradient[i] ) ) isAnalytic[ thisIndices[i] ] = false;
+			else gradient[ thisIndices[i] ] += thisGradient[i];
+		}
+	}
+
+	for( unsigned int paramIndex = 0; paramIndex < allNames.size(); ++paramIndex )
+	{
+		if( !isFloated[paramIndex] )
+		{
+			gradient[paramIndex] = 0.;
+		}
+		else if( isAnalytic[paramIndex] )
+		{
+			//	The constraints are cheap to evaluate so these are always differentiated numerically
+			gradient[paramIndex] += this->ConstraintDerivative( allNames[paramIndex] );
+		}
+		else
+		{
+			gradient[paramIndex] = this->NumericalDerivative( allNames[paramIndex] );
+		}
+	}
+
+	return gradient;
+}
+
+void FitFunction::NumericalStepPoints( PhysicsParameter* thisParameter, double& lower, double& upper ) const
+{
+	const double value = thisParameter->GetBlindedValue();
+	const double step = 1E-5 * ( fabs(value) > 1. ? fabs(value) : 1. );
+	lower = value - step;
+	upper = value + step;
+
+	const string type = thisParameter->GetType();
+	if( type != "Unbounded" && type != "GaussianConstrained" )
+	{
+		if( upper > thisParameter->GetMaximum() ) upper = value;
+		if( lower < thisParameter->GetMinimum() ) lower = value;
+	}
+}
+
+double FitFunction::NumericalDerivative( const string& paramName )
+{
+	ParameterSet* fitParameters = allData->GetParameterSet();
+	PhysicsParameter* thisParameter = fitParameters->GetPhysicsParameter( paramName );
+	const double value = thisParameter->GetBlindedValue();
+
+	double lower=0., upper=0.;
+	this->NumericalStepPoints( thisParameter, lower, upper );
+	if( upper <= lower ) return 0.;
+
+	thisParameter->SetBlindedValue( upper );
+	this->SetParameterSet( fitParameters );
+	const double upperValue = this->Evaluate();
+
+	thisParameter->SetBlindedValue( lower );
+	this->SetParameterSet( fitParameters );
+	const double lowerValue = this->Evaluate();
+
+	thisParameter->SetBlindedValue( value );
+	this->SetParameterSet( fitParameters );
+
+	if( fabs(upperValue) >= DBL_MAX || fabs(lowerValue) >= DBL_MAX ) return 0.;
+
+	return ( upperValue - lowerValue ) / ( upper - lower );
+}
+
+double FitFunction::ConstraintDerivative( const string& paramName )
+{
+	vector< ConstraintFunction* > constraints = allData->GetConstraints();
+	if( constraints.empty() ) return 0.;
+
+	ParameterSet* fitParameters = allData->GetParameterSet();
+	PhysicsParameter* thisParameter = fitParameters->GetPhysicsParameter( paramName );
+	const double value = thisParameter->GetBlindedValue();
+	const bool wasChanged = thisParameter->HasChanged();
+
+	double lower=0., upper=0.;
+	this->NumericalStepPoints( thisParameter, lower, upper );
+	if( upper <= lower ) return 0.;
+
+	double upperValue = 0., lowerValue = 0.;
+	thisParameter->SetBlindedValue( upper );
+	for( unsigned int constraintIndex = 0; constraintIndex < constraints.size(); ++constraintIndex )
+	{
+		upperValue += constraints[constraintIndex]->Evaluate( fitParameters );
+	}
+	thisParameter->SetBlindedValue( lower );
+	for( unsigned int constraintIndex = 0; constraintIndex < constraints.size(); ++constraintIndex )
+	{
+		lowerValue += constraints[constraintIndex]->Evaluate( fitParameters );
+	}
+	thisParameter->SetBlindedValue( value );
+	thisParameter->SetChanged( wasChanged );
+
+	return ( upperValue - lowerValue ) / ( upper - lower );
+}
+
 //Return the Up value for error calculation
 double FitFunction::UpErrorValue( const int Sigma )
 {
@@ -437,6 +643,16 @@ int FitFunction::GetThreads() const
 	return Threads;
 }
 
+void FitFunction::SetChunkSize( const unsigned int Input )
+{
+	chunkSize = Input;
+}
+
+ThreadPool* FitFunction::GetWorkerPool() const
+{
+	return workerPool;
+}
+
 void FitFunction::SetIntegratorTest( const bool input )
 {
 	testIntegrator = input;
@@ -483,29 +699,19 @@ bool FitFunction::GetOffSetNLL() const
 	return OffSetNLL;
 }
 
-void FitFunction::ClearPhaseSpaceCaches( IDataSet* thisDataSet )
+void FitFunction::IndexDiscreteCombinations( IDataSet* thisDataSet )
 {
-	for( unsigned int i=0; i< stored_pdfs.size(); ++i )
-	{
-		ClearPDF( stored_pdfs[i] );
-	}
-	for( unsigned int i=0; i< StoredBoundary.size(); ++i  )
-	{
-		StoredBoundary[i]->ClearDiscreteCombinations();
-	}
-	thisDataSet->GetBoundary()->ClearDiscreteCombinations();
-}
+	//	Build the table of discrete combinations before any threads are started, it isn't changed again during the fit
+	PhaseSpaceBoundary* thisBoundary = thisDataSet->GetBoundary();
+	thisBoundary->GetNumberCombinations();
 
-void FitFunction::ClearPDF( IPDF* thisPDF )
-{
-	if( thisPDF->GetPhaseSpace() != NULL )
-	{
-		thisPDF->GetPhaseSpace()->ClearDiscreteCombinations();
-	}
-	vector<IPDF*> children = thisPDF->GetChildren();
-	for( unsigned int i=0; i< children.size(); ++i )
+	//	Events of a ColumnarDataSet are only turned into DataPoints on demand, each by the one thread which evaluates it
+	if( dynamic_cast<ColumnarDataSet*>( thisDataSet ) != NULL ) return;
+
+	const int dataNumber = thisDataSet->GetDataNumber();
+	for( int dataIndex=0; dataIndex< dataNumber; ++dataIndex )
 	{
-		ClearPDF( children[i] );
+		thisBoundary->GetDiscreteIndex( thisDataSet->GetDataPoint( dataIndex ) );
 	}
 }
 
@@ -21,7 +21,7 @@ using namespace::std;
 //Constructor with only name of FitFunction
 FitFunctionConfiguration::FitFunctionConfiguration( string InputName ) :
 	functionName(InputName), weightName(), hasWeight(false), wantTrace(false), TraceFileName(), traceCount(0),
-	Threads(0), Strategy(), testIntegrator(true), NormaliseWeights(false), SingleNormaliseWeights(false), alphaName("undefined"),
+	Threads(0), ChunkSize(0), Strategy(), testIntegrator(true), NormaliseWeights(false), SingleNormaliseWeights(false), alphaName("undefined"),
 	hasAlpha(false), integratorConfig( new RapidFitIntegratorConfig() ), OffSetNLL(false), _floatedParameterList()
 {
 }
@@ -29,11 +29,19 @@ FitFunctionConfiguration::FitFunctionConfiguration( string InputName ) :
 //Constructor for FitFunction with event weights
 FitFunctionConfiguration::FitFunctionConfiguration( string InputName, string InputWeight ) :
 	functionName(InputName), weightName(InputWeight), hasWeight(true), wantTrace(false), TraceFileName(), traceCount(0),
-	Threads(0), Strategy(), testIntegrator(true), NormaliseWeights(false), SingleNormaliseWeights(false), alphaName("undefined"),
+	Threads(0), ChunkSize(0), Strategy(), testIntegrator(true), NormaliseWeights(false), SingleNormaliseWeights(false), alphaName("undefined"),
 	hasAlpha(false), integratorConfig( new RapidFitIntegratorConfig() ), OffSetNLL(false), _floatedParameterList()
 {
 }
 
+FitFunctionConfiguration::FitFunctionConfiguration( const FitFunctionConfiguration& input ) :
+	functionName(input.functionName), weightName(input.weightName), hasWeight(input.hasWeight), wantTrace(input.wantTrace), TraceFileName(input.TraceFileName),
+	traceCount(input.traceCount), Threads(input.Threads), ChunkSize(input.ChunkSize), Strategy(input.Strategy), integratorConfig( new RapidFitIntegratorConfig( *input.integratorConfig ) ),
+	testIntegrator(input.testIntegrator), NormaliseWeights(input.NormaliseWeights), SingleNormaliseWeights(input.SingleNormaliseWeights),
+	hasAlpha(input.hasAlpha), alphaName(input.alphaName), OffSetNLL(input.OffSetNLL), _floatedParameterList(input._floatedParameterList)
+{
+}
+
 //Destructor
 FitFunctionConfiguration::~FitFunctionConfiguration()
 {
@@ -61,6 +69,8 @@ IFitFunction * FitFunctionConfiguration::GetFitFunction()
 
 	theFunction->SetThreads( Threads );
 
+	theFunction->SetChunkSize( ChunkSize );
+
 	theFunction->SetIntegratorTest( testIntegrator );
 
 	theFunction->SetOffSetNLL( OffSetNLL );
@@ -123,6 +133,11 @@ void FitFunctionConfiguration::SetThreads( int input )
 	Threads = input;
 }
 
+void FitFunctionConfiguration::SetChunkSize( unsigned int input )
+{
+	ChunkSize = input;
+}
+
 void FitFunctionConfiguration::SetIntegratorTest( bool input )
 {
 	testIntegrator = input;
@@ -140,6 +155,7 @@ string FitFunctionConfiguration::XML() const
 	xml << "<FitFunction>" << endl;
 	xml << "\t" << "<FunctionName>" << functionName << "</FunctionName>" << endl;
 	if(Threads>0) xml << "\t" << "<Threads>" << Threads << "</Threads>" << endl;
+	if(ChunkSize>0) xml << "\t" << "<ChunkSize>" << ChunkSize << "</ChunkSize>" << endl;
 	if( hasWeight == true ) xml << "<WeightName>" << weightName << "</WeightName>" << endl;
 	if( hasAlpha == true ) xml << "<AlphaName>" << alphaName << "</AlphaName>" << endl;
 	xml << "\t" << "<SetIntegratorTest>";
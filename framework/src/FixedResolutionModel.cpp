@@ -96,6 +96,23 @@ double FixedResolutionModel::ExpCosInt( double tlow, double thigh, double gamma,
 	return Mathematics::ExpCosInt( tlow, thigh, gamma, dms, this->GetThisScale() );
 }
 
+void FixedResolutionModel::ExpBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, double* output )
+{
+	(void) data;
+	if( end <= begin ) return;
+	vector<double> resolution( end-begin, this->GetThisScale() );
+	Mathematics::ExpBatch( time, end-begin, gamma, &(resolution[0]), output );
+}
+
+void FixedResolutionModel::ExpCosSinBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, const double dms,
+		double* outCos, double* outSin )
+{
+	(void) data;
+	if( end <= begin ) return;
+	vector<double> resolution( end-begin, this->GetThisScale() );
+	Mathematics::ExpCosSinBatch( time, end-begin, gamma, dms, &(resolution[0]), outCos, outSin );
+}
+
 double FixedResolutionModel::GetThisScale()
 {
 	double thisRes = eventResolution;
@@ -11,6 +11,8 @@
 //	ROOT Headers
 #include "TFile.h"
 #include "TFoam.h"
+#include "TH1.h"
+#include "TNamed.h"
 //	RapidFit Headers
 #include "Foam.h"
 #include "StatisticsFunctions.h"
@@ -18,6 +20,8 @@
 #include "ClassLookUp.h"
 #include "StringProcessing.h"
 #include "RapidFitRandom.h"
+#include "ParameterSet.h"
+#include "DataSetCache.h"
 //	System Headers
 #include <iostream>
 #include <cmath>
@@ -26,17 +30,34 @@
 #include <float.h>
 #include <fstream>
 #include <algorithm>
+#include <pthread.h>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
 
 //#define DOUBLE_TOLERANCE DBL_MIN
 #define DOUBLE_TOLERANCE 1E-6
 
+//	Number of events generated from each random number stream when generating in threads
+#define FOAM_BLOCK_SIZE 10000
+
+//	Bump this whenever the settings used to build the TFoam cells change, so old grid caches aren't used
+#define FOAM_GRID_VERSION 1
+
 using namespace::std;
 
+string Foam::gridCacheDirectory = "";
+
 //Constructor with correct argument
 Foam::Foam( PhaseSpaceBoundary * NewBoundary, IPDF * NewPDF ) :
 	Open_Files(), InputPDF(NewPDF), generationFunction(), generationBoundary(NewBoundary), newDataSet(), rootRandom(), foamGenerators(),
 	storedIntegrator(), discreteCombinations(), allNames(), discreteNames(), continuousNames(), discreteNames_ref(),
-	continuousNames_ref(), discreteValues(), minima(), ranges(), discreteNames_ref2(), continuousNames_ref2()
+	continuousNames_ref(), discreteValues(), minima(), ranges(), discreteNames_ref2(), continuousNames_ref2(),
+	discreteConstraints(), discretePositions(), continuousPositions(), allUnits(), numberThreads(1)
 {
 	rootRandom = RapidFitRandom::GetRandomFunction();
 
@@ -83,6 +104,21 @@ Foam::Foam( PhaseSpaceBoundary * NewBoundary, IPDF * NewPDF ) :
 		continuousNames_ref2.push_back( new ObservableRef( *cont_i ) );
 	}
 
+	//	Look up everything needed for each event once
+	for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex )
+	{
+		allUnits.push_back( generationBoundary->GetConstraint( allNames[nameIndex] )->GetUnit() );
+	}
+	for( unsigned int discreteIndex = 0; discreteIndex < discreteNames.size(); ++discreteIndex )
+	{
+		discreteConstraints.push_back( generationBoundary->GetConstraint( *discreteNames_ref[discreteIndex] ) );
+		discretePositions.push_back( (unsigned) StringProcessing::VectorContains( &allNames, &(discreteNames[discreteIndex]) ) );
+	}
+	for( unsigned int continuousIndex = 0; continuousIndex < continuousNames.size(); ++continuousIndex )
+	{
+		continuousPositions.push_back( (unsigned) StringProcessing::VectorContains( &allNames, &(continuousNames[continuousIndex]) ) );
+	}
+
 	newDataSet = new MemoryDataSet(generationBoundary);
 	cout << "Initializing Generator(s)" << endl;
 
@@ -176,31 +212,7 @@ void Foam::Init()
 			}
 			*/
 			//Initialise Foam
-			foamGenerator = new TFoam( Name );
-			foamGenerator->SetkDim( Int_t(continuousNames.size()) );
-			foamGenerator->SetPseRan( rootRandom );
-			foamGenerator->SetRho( combinationFunction );	//	Can afford to Boot Foam's ability if we're using just one cached instance :D
-			foamGenerator->SetnCells( 1000 );	//	1000	Total number of bins to construct
-			foamGenerator->SetnSampl( 200 );	//	200	Samples to take when constructing bins
-			foamGenerator->SetnBin( 8 );		//	8	Bins along each axis
-			foamGenerator->SetOptRej( 1 );		//	1/0	Don't/Use Weighted Distribution
-			foamGenerator->SetOptDrive( 2 );	//	1/2	Best Varience/Weights
-			foamGenerator->SetEvPerBin( 25 );	//	25	Weights per bin... This doesn't Saturate as object is written before generating events
-			foamGenerator->SetChat( 0 );		//	0	verbosity
-			foamGenerator->SetMaxWtRej( 1.1 );	//	1.1	Unknown what effect this has, something to do with weights
-			/*
-			if( debug != NULL )
-			{
-				if( debug->DebugThisClass("Foam") )
-				{
-					cout << "Initializing Foam" << endl;
-				}
-			}
-			*/
-			foamGenerator->Initialize();
-			//			foamGenerator->ResetPseRan( rootRandom );
-			//			foamGenerator->ResetRho( combinationFunction );	//	Can afford to Boot Foam's ability if we're using just one cached instance :D
-			//			foamGenerator->Initialize();
+			foamGenerator = this->BuildGenerator( Name, combinationIndex, combinationFunction );
 			//	As we haven't cached yet, write to file
 			foamGenerator->Write( Name, TObject::kOverwrite );
 			cout << "Storing TFOAM TObject in:\t\t" << RootName << endl;
@@ -252,22 +264,7 @@ void Foam::Init()
 				MC_Cache = new TFile( RootName, "RECREATE" );
 				MC_Cache->Write( "", TObject::kOverwrite );
 				//Initialise Foam
-				foamGenerator = new TFoam( Name );
-				foamGenerator->SetkDim( Int_t(continuousNames.size()) );
-				foamGenerator->SetPseRan( rootRandom );
-				foamGenerator->SetRho( combinationFunction );   //      Can afford to Boot Foam's ability if we're using just one cached instance :D
-				foamGenerator->SetnCells( 1000 );       //      1000    Total number of bins to construct
-				foamGenerator->SetnSampl( 200 );        //      200     Samples to take when constructing bins
-				foamGenerator->SetnBin( 8 );            //      8       Bins along each axis
-				foamGenerator->SetOptRej( 1 );          //      1/0     Don't/Use Weighted Distribution
-				foamGenerator->SetOptDrive( 2 );        //      1/2     Best Varience/Weights
-				foamGenerator->SetEvPerBin( 25 );       //      25      Weights per bin... This doesn't Saturate as object is written before generating events
-				foamGenerator->SetChat( 0 );            //      0       verbosity
-				foamGenerator->SetMaxWtRej( 1.1 );      //      1.1     Unknown what effect this has, something to do with weights
-				foamGenerator->Initialize();
-				//                      foamGenerator->ResetPseRan( rootRandom );
-				//                      foamGenerator->ResetRho( combinationFunction ); //      Can afford to Boot Foam's ability if we're using just one cached instance :D
-				//                      foamGenerator->Initialize();
+				foamGenerator = this->BuildGenerator( Name, combinationIndex, combinationFunction );
 				//      As we haven't cached yet, write to file
 				//MC_Cache->Write( "", TObject::kOverwrite );
 				foamGenerator->Write( Name, TObject::kOverwrite );
@@ -327,6 +324,165 @@ void Foam::Init()
 	InputPDF->SetMCCacheStatus( true );
 }
 
+void Foam::SetGridCacheDirectory( const string Input )
+{
+	gridCacheDirectory = Input;
+}
+
+string Foam::GetGridCacheDirectory()
+{
+	return gridCacheDirectory;
+}
+
+string Foam::GridKey( const unsigned int combinationIndex ) const
+{
+	stringstream key;
+	key << setprecision(17);
+	key << "FoamGridVersion: " << FOAM_GRID_VERSION << endl;
+	key << "PDF: " << InputPDF->GetName() << endl;
+	key << "Label: " << InputPDF->GetLabel() << endl;
+
+	ParameterSet* generationParameters = InputPDF->GetPhysicsParameters();
+	vector<string> parameterNames = generationParameters->GetAllNames();
+	for( unsigned int parameterIndex = 0; parameterIndex < parameterNames.size(); ++parameterIndex )
+	{
+		key << parameterNames[parameterIndex] << ": " << generationParameters->GetPhysicsParameter( parameterNames[parameterIndex] )->GetValue() << endl;
+	}
+
+	key << generationBoundary->XML() << endl;
+
+	//	The same PDF can be configured differently, or read a histogram which has since been replaced
+	key << "Configuration: " << hex << DataSetCache::Hash( InputPDF->XML() ) << dec << endl;
+	vector<IPDF*> allPDFs( 1, InputPDF );
+	for( unsigned int pdfIndex = 0; pdfIndex < allPDFs.size(); ++pdfIndex )
+	{
+		vector<IPDF*> children = allPDFs[pdfIndex]->GetChildren();
+		allPDFs.insert( allPDFs.end(), children.begin(), children.end() );
+
+		PDFConfigurator* thisConfig = allPDFs[pdfIndex]->GetConfigurator();
+		if( thisConfig == NULL ) continue;
+		vector<string> configValues = thisConfig->GetConfigurationValues();
+		for( unsigned int valueIndex = 0; valueIndex < configValues.size(); ++valueIndex )
+		{
+			struct stat fileInfo;
+			if( stat( configValues[valueIndex].c_str(), &fileInfo ) == 0 && S_ISREG( fileInfo.st_mode ) )
+			{
+				key << "File: " << configValues[valueIndex] << " " << fileInfo.st_size << " " << fileInfo.st_mtime << endl;
+			}
+		}
+	}
+
+	key << "Combination:";
+	for( unsigned int discreteIndex = 0; discreteIndex < discreteCombinations[combinationIndex].size(); ++discreteIndex )
+	{
+		key << " " << discreteNames[discreteIndex] << "=" << discreteCombinations[combinationIndex][discreteIndex];
+	}
+	key << endl;
+
+	return key.str();
+}
+
+TFoam* Foam::LoadGrid( const string FileName, const string Key )
+{
+	ifstream input_file;
+	input_file.open( FileName.c_str(), ifstream::in );
+	input_file.close();
+	if( input_file.fail() ) return NULL;
+
+	TDirectory* currentDirectory = gDirectory;
+	TFoam* foamGenerator = NULL;
+	TFile* gridFile = new TFile( FileName.c_str(), "READ" );
+	if( !gridFile->IsZombie() )
+	{
+		//	Protect against a collision of the hash used in the file name
+		TNamed* storedKey = (TNamed*) gridFile->Get( "Key" );
+		if( storedKey != NULL && Key == storedKey->GetTitle() )
+		{
+			foamGenerator = (TFoam*) gridFile->Get( "Foam" );
+		}
+		if( storedKey != NULL ) delete storedKey;
+	}
+	gridFile->Close();
+	delete gridFile;
+	if( currentDirectory != NULL ) currentDirectory->cd();
+
+	return foamGenerator;
+}
+
+void Foam::SaveGrid( TFoam* Generator, const string FileName, const string Key )
+{
+	if( mkdir( gridCacheDirectory.c_str(), 0755 ) != 0 && errno != EEXIST )
+	{
+		cerr << "Foam: Cannot create grid cache directory " << gridCacheDirectory << endl;
+		return;
+	}
+
+	//	Write to a temporary file and move it into place so that another job reading the cache never sees a partial file
+	stringstream tempName;
+	tempName << FileName << ".tmp" << getpid() << ".root";
+
+	TDirectory* currentDirectory = gDirectory;
+	TFile* gridFile = new TFile( tempName.str().c_str(), "RECREATE" );
+	bool written = !gridFile->IsZombie();
+	if( written )
+	{
+		TNamed storedKey( "Key", Key.c_str() );
+		written = gridFile->WriteTObject( &storedKey, "Key" ) > 0;
+		written = written && gridFile->WriteTObject( Generator, "Foam" ) > 0;
+	}
+	gridFile->Close();
+	delete gridFile;
+	if( currentDirectory != NULL ) currentDirectory->cd();
+
+	if( !written || rename( tempName.str().c_str(), FileName.c_str() ) != 0 )
+	{
+		cerr << "Foam: Failed to write grid cache " << FileName << endl;
+		remove( tempName.str().c_str() );
+		return;
+	}
+
+	cout << "Storing TFOAM cells in grid cache:\t" << FileName << endl;
+}
+
+TFoam* Foam::BuildGenerator( const TString Name, const unsigned int combinationIndex, IntegratorFunction* combinationFunction )
+{
+	string gridKey, gridFileName;
+	if( !gridCacheDirectory.empty() )
+	{
+		gridKey = this->GridKey( combinationIndex );
+		stringstream thisName;
+		thisName << gridCacheDirectory << "/FoamGrid-" << hex << setw(16) << setfill('0') << DataSetCache::Hash( gridKey ) << ".root";
+		gridFileName = thisName.str();
+
+		TFoam* cachedGenerator = Foam::LoadGrid( gridFileName, gridKey );
+		if( cachedGenerator != NULL )
+		{
+			cout << "Re-Using TFOAM cells from grid cache:\t" << gridFileName << endl;
+			cachedGenerator->ResetPseRan( rootRandom );
+			cachedGenerator->ResetRho( combinationFunction );
+			return cachedGenerator;
+		}
+	}
+
+	TFoam* foamGenerator = new TFoam( Name );
+	foamGenerator->SetkDim( Int_t(continuousNames.size()) );
+	foamGenerator->SetPseRan( rootRandom );
+	foamGenerator->SetRho( combinationFunction );	//	Can afford to Boot Foam's ability if we're using just one cached instance :D
+	foamGenerator->SetnCells( 1000 );	//	1000	Total number of bins to construct
+	foamGenerator->SetnSampl( 200 );	//	200	Samples to take when constructing bins
+	foamGenerator->SetnBin( 8 );		//	8	Bins along each axis
+	foamGenerator->SetOptRej( 1 );		//	1/0	Don't/Use Weighted Distribution
+	foamGenerator->SetOptDrive( 2 );	//	1/2	Best Varience/Weights
+	foamGenerator->SetEvPerBin( 25 );	//	25	Weights per bin... This doesn't Saturate as object is written before generating events
+	foamGenerator->SetChat( 0 );		//	0	verbosity
+	foamGenerator->SetMaxWtRej( 1.1 );	//	1.1	Unknown what effect this has, something to do with weights
+	foamGenerator->Initialize();
+
+	if( !gridFileName.empty() ) Foam::SaveGrid( foamGenerator, gridFileName, gridKey );
+
+	return foamGenerator;
+}
+
 //Destructor
 Foam::~Foam()
 {
@@ -376,57 +532,207 @@ void Foam::RemoveGenerator()
 	}
 }
 
-//Use accept/reject method to create data
-int Foam::GenerateData( int DataAmount )
+void Foam::SetNumberThreads( unsigned int Input )
 {
-	//if( newDataSet->GetDataNumber() < DataAmount ) newDataSet->ReserveDataSpace( DataAmount );
-	for( int dataIndex = 0; dataIndex < DataAmount; ++dataIndex )
+	numberThreads = Input;
+}
+
+//	Everything owned by a single generator thread
+struct Foam::FoamWorker
+{
+	Foam* parent;
+	vector<TFoam*> generators;			/*!	Copies of the TFoam generators of the parent, one per discrete combination	*/
+	vector<IntegratorFunction*> functions;		/*!	Copies of the PDF wrapper used by each of the generators			*/
+	RapidFitRandomStream* random;			/*!	Used by all of the generators, re-keyed for each block				*/
+	uint64_t generationStream;
+	unsigned int dataAmount;
+	unsigned int numberBlocks;
+	unsigned int* nextBlock;
+	pthread_mutex_t* lock;
+	vector<vector<double> >* columns;
+};
+
+//	Generate the discrete observables, select the correct Foam generator and generate the continuous observables with it
+void Foam::SampleEvent( const vector<TFoam*>& Generators, TRandom* Random, Double_t* GeneratedEvent, const unsigned int EventIndex, vector<vector<double> >& Columns ) const
+{
+	int combinationIndex = 0;
+	int incrementValue = 1;
+	for( int discreteIndex = int(discreteNames.size() - 1); discreteIndex >= 0; --discreteIndex )
 	{
-		//Generate the discrete observables, and select the correct Foam generator to use
-		int combinationIndex = 0;
-		int incrementValue = 1;
-		DataPoint * temporaryDataPoint = new DataPoint(allNames);
-		for( int discreteIndex = int(discreteNames.size() - 1); discreteIndex >= 0; --discreteIndex )
+		//Create the discrete observable
+		Observable * temporaryObservable = discreteConstraints[unsigned(discreteIndex)]->CreateObservable( Random );
+		double currentValue = temporaryObservable->GetValue();
+		delete temporaryObservable;
+		Columns[ discretePositions[unsigned(discreteIndex)] ][EventIndex] = currentValue;
+
+		//Calculate the index
+		for (unsigned int valueIndex = 0; valueIndex < discreteValues[unsigned(discreteIndex)].size(); ++valueIndex )
 		{
-			//Create the discrete observable
-			Observable * temporaryObservable = generationBoundary->GetConstraint( *discreteNames_ref[unsigned(discreteIndex)] )->CreateObservable(rootRandom);
-			double currentValue = temporaryObservable->GetValue();
-			temporaryDataPoint->SetObservable( *discreteNames_ref2[unsigned(discreteIndex)], temporaryObservable );
-			delete temporaryObservable;
-
-			//Calculate the index
-			for (unsigned int valueIndex = 0; valueIndex < discreteValues[unsigned(discreteIndex)].size(); ++valueIndex )
+			if ( fabs( discreteValues[unsigned(discreteIndex)][valueIndex] - currentValue ) < DOUBLE_TOLERANCE )
 			{
-				if ( fabs( discreteValues[unsigned(discreteIndex)][valueIndex] - currentValue ) < DOUBLE_TOLERANCE )
-				{
-					combinationIndex += ( incrementValue * int(valueIndex) );
-					incrementValue *= int(discreteValues[unsigned(discreteIndex)].size());
-					break;
-				}
+				combinationIndex += ( incrementValue * int(valueIndex) );
+				incrementValue *= int(discreteValues[unsigned(discreteIndex)].size());
+				break;
 			}
 		}
+	}
 
-		//Use the index calculated to select a Foam generator and generate an event with it
-		Double_t* generatedEvent = new Double_t[ continuousNames.size() ];
-		foamGenerators[unsigned(combinationIndex)]->MakeEvent();
-		foamGenerators[unsigned(combinationIndex)]->GetMCvect(generatedEvent);
+	//Use the index calculated to select a Foam generator and generate an event with it
+	Generators[unsigned(combinationIndex)]->MakeEvent();
+	Generators[unsigned(combinationIndex)]->GetMCvect( GeneratedEvent );
 
-		//Store the continuous observables
-		for (unsigned int continuousIndex = 0; continuousIndex < continuousNames.size(); ++continuousIndex )
+	//Store the continuous observables
+	for (unsigned int continuousIndex = 0; continuousIndex < continuousNames.size(); ++continuousIndex )
+	{
+		Columns[ continuousPositions[continuousIndex] ][EventIndex] = minima[continuousIndex] + ( ranges[continuousIndex] * GeneratedEvent[continuousIndex] );
+	}
+}
+
+void* Foam::GenerateBlocks( void* Input )
+{
+	FoamWorker* worker = (FoamWorker*) Input;
+	Double_t* generatedEvent = new Double_t[ worker->parent->continuousNames.size() + 1 ];
+
+	while( true )
+	{
+		pthread_mutex_lock( worker->lock );
+		const unsigned int blockIndex = *(worker->nextBlock);
+		++(*(worker->nextBlock));
+		pthread_mutex_unlock( worker->lock );
+		if( blockIndex >= worker->numberBlocks ) break;
+
+		worker->random->SetKey( worker->generationStream, blockIndex );
+
+		const unsigned int blockEnd = min( ( blockIndex + 1 ) * FOAM_BLOCK_SIZE, worker->dataAmount );
+		for( unsigned int dataIndex = blockIndex * FOAM_BLOCK_SIZE; dataIndex < blockEnd; ++dataIndex )
+		{
+			worker->parent->SampleEvent( worker->generators, worker->random, generatedEvent, dataIndex, *(worker->columns) );
+		}
+	}
+
+	delete[] generatedEvent;
+	return NULL;
+}
+
+void Foam::GenerateInThreads( const unsigned int DataAmount, vector<vector<double> >& Columns )
+{
+	const unsigned int numberBlocks = ( DataAmount + FOAM_BLOCK_SIZE - 1 ) / FOAM_BLOCK_SIZE;
+	const unsigned int threadsUsed = min( numberThreads, numberBlocks );
+
+	//	The streams of all the blocks are keyed from a single draw, so the DataSet is still reproducable from the seed
+	const uint64_t generationStream = (uint64_t)( rootRandom->Rndm() * 9007199254740992. );
+
+	unsigned int nextBlock = 0;
+	pthread_mutex_t lock;
+	pthread_mutex_init( &lock, NULL );
+
+	//	Copying the generators creates ROOT objects, do this here and don't let them be attached to the current directory
+	const Bool_t addDirectory = TH1::AddDirectoryStatus();
+	TH1::AddDirectory( kFALSE );
+
+	vector<FoamWorker*> workers;
+	for( unsigned int threadNum = 0; threadNum < threadsUsed; ++threadNum )
+	{
+		FoamWorker* thisWorker = new FoamWorker();
+		thisWorker->parent = this;
+		thisWorker->random = new RapidFitRandomStream( RapidFitRandom::GetStreamSeed(), generationStream, 0 );
+		thisWorker->generationStream = generationStream;
+		thisWorker->dataAmount = DataAmount;
+		thisWorker->numberBlocks = numberBlocks;
+		thisWorker->nextBlock = &nextBlock;
+		thisWorker->lock = &lock;
+		thisWorker->columns = &Columns;
+		for( unsigned int combinationIndex = 0; combinationIndex < foamGenerators.size(); ++combinationIndex )
+		{
+			IntegratorFunction* thisFunction = new IntegratorFunction( *storedIntegrator[combinationIndex] );
+			TFoam* thisGenerator = (TFoam*) foamGenerators[combinationIndex]->Clone();
+			thisGenerator->ResetPseRan( thisWorker->random );
+			thisGenerator->ResetRho( thisFunction );
+			thisWorker->functions.push_back( thisFunction );
+			thisWorker->generators.push_back( thisGenerator );
+		}
+		workers.push_back( thisWorker );
+	}
+
+	TH1::AddDirectory( addDirectory );
+
+	pthread_attr_t attrib;
+	pthread_attr_init( &attrib );
+	pthread_attr_setdetachstate( &attrib, PTHREAD_CREATE_JOINABLE );
+
+	vector<pthread_t> threads( threadsUsed );
+	for( unsigned int threadNum = 0; threadNum < threadsUsed; ++threadNum )
+	{
+		int status = pthread_create( &(threads[threadNum]), &attrib, Foam::GenerateBlocks, (void*) workers[threadNum] );
+		if( status )
+		{
+			cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
+			exit(-1);
+		}
+	}
+
+	pthread_attr_destroy( &attrib );
+
+	for( unsigned int threadNum = 0; threadNum < threadsUsed; ++threadNum )
+	{
+		pthread_join( threads[threadNum], NULL );
+	}
+
+	while( !workers.empty() )
+	{
+		FoamWorker* thisWorker = workers.back();
+		while( !thisWorker->generators.empty() )
+		{
+			delete thisWorker->generators.back();
+			thisWorker->generators.pop_back();
+		}
+		while( !thisWorker->functions.empty() )
 		{
-			string unit = generationBoundary->GetConstraint( *continuousNames_ref[continuousIndex] )->GetUnit();
-			double newValue = minima[continuousIndex] + ( ranges[continuousIndex] * generatedEvent[continuousIndex] );
-			temporaryDataPoint->SetObservable( *continuousNames_ref2[continuousIndex], newValue, unit );
-			//cout << continuousNames[continuousIndex] << "\t" << newValue << "\t" << 0.0 << "\t" << unit << endl;
+			delete thisWorker->functions.back();
+			thisWorker->functions.pop_back();
 		}
+		delete thisWorker->random;
+		delete thisWorker;
+		workers.pop_back();
+	}
 
+	pthread_mutex_destroy( &lock );
+}
+
+//Use the TFoam generators to create data
+int Foam::GenerateData( int DataAmount )
+{
+	if( DataAmount <= 0 ) return 0;
+
+	//	Generate into one column per Observable, then build the DataSet in one pass
+	vector<vector<double> > columns( allNames.size(), vector<double>( (unsigned) DataAmount, 0. ) );
+
+	if( numberThreads > 1 && (unsigned) DataAmount > FOAM_BLOCK_SIZE )
+	{
+		this->GenerateInThreads( (unsigned) DataAmount, columns );
+	}
+	else
+	{
+		//	Events come from the shared random number generator in exactly the same order as before
+		Double_t* generatedEvent = new Double_t[ continuousNames.size() + 1 ];
+		for( unsigned int dataIndex = 0; dataIndex < (unsigned) DataAmount; ++dataIndex )
+		{
+			this->SampleEvent( foamGenerators, rootRandom, generatedEvent, dataIndex, columns );
+		}
 		delete[] generatedEvent;
+	}
+
+	for( unsigned int dataIndex = 0; dataIndex < (unsigned) DataAmount; ++dataIndex )
+	{
+		DataPoint * temporaryDataPoint = new DataPoint(allNames);
+		for( unsigned int nameIndex = 0; nameIndex < allNames.size(); ++nameIndex )
+		{
+			temporaryDataPoint->SetObservable( allNames[nameIndex], columns[nameIndex][dataIndex], allUnits[nameIndex], true, (int)nameIndex );
+		}
 		//	Store the event
 		newDataSet->AddDataPoint(temporaryDataPoint);
 	}
 
-	//cout << "Destroying Generator(s)" << endl;
-	//this->RemoveGenerator();
 	return DataAmount;
 }
 
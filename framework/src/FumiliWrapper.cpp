@@ -226,6 +226,12 @@ void FumiliWrapper::ApplyCovarianceMatrix( RapidFitMatrix* Input )
 	return;
 }
 
+void FumiliWrapper::SetStartingCovariance( const RapidFitMatrix* Input )
+{
+	(void)Input;
+	return;
+}
+
 void FumiliWrapper::SetNSigma( int input )
 {
 	nSigma = input;
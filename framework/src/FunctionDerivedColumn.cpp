@@ -0,0 +1,41 @@
+/*!
+ * @class FunctionDerivedColumn
+ *
+ * @brief A DerivedColumn built from a list of functions of a fixed set of Observables
+ */
+
+///	RapidFit Headers
+#include "FunctionDerivedColumn.h"
+///	System Headers
+#include <string>
+#include <vector>
+
+using namespace::std;
+
+FunctionDerivedColumn::FunctionDerivedColumn( const string Name, const vector<string> Observables, const vector<ObservableFunction> Functions ) :
+	DerivedColumn( Name, (unsigned)Functions.size() ), observables(), functions( Functions )
+{
+	for( unsigned int i=0; i< Observables.size(); ++i )
+	{
+		observables.push_back( ObservableRef( Observables[i] ) );
+	}
+}
+
+FunctionDerivedColumn::~FunctionDerivedColumn()
+{
+}
+
+void FunctionDerivedColumn::Calculate( DataPoint* input, double* output ) const
+{
+	vector<double> values;
+	values.reserve( observables.size() );
+	for( unsigned int i=0; i< observables.size(); ++i )
+	{
+		values.push_back( input->GetObservable( observables[i] )->GetValue() );
+	}
+
+	for( unsigned int i=0; i< functions.size(); ++i )
+	{
+		output[i] = functions[i]( values );
+	}
+}
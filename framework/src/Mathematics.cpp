@@ -31,16 +31,11 @@
 #include <vector>
 #include <cmath>
 #include <iostream>
-#include <pthread.h>
 #include <iomanip>
 #include <complex>
 
-pthread_mutex_t ROOT_Lock = pthread_mutex_t();
-
 using namespace::std;
 
-bool RooMathinit=false;
-
 #ifdef __RAPIDFIT_USE_GSL
 ///	GSL Headers
 #include <gsl/gsl_complex_math.h>
@@ -155,148 +150,202 @@ namespace Mathematics
 		//   return v.exp()*(-zsq.exp()/(zc*rootpi) + 1);
 	}
 
+	//	The single event functions use the same Faddeeva function as the batch functions below, this needs no ROOT state and so no lock
 	complex<double> evalCerf( double swt, double u, double c )
 	{
-#if ROOT_VERSION_CODE < ROOT_VERSION(5,34,10)
-		RooComplex z( swt*c, u+c );
-		complex<double> returnable = 0.;
-		if( (u+c) > -4.0 )
-		{
-			if( !RooMathinit )
-			{
-				pthread_mutex_lock( &ROOT_Lock );
-#if ROOT_VERSION_CODE >= ROOT_VERSION(5,34,0)
-				if( !RooMathinit ) RooMath::initFastCERF( 800, -4.0, 4.0, 1000, -4.0, 6.0 );
-#else
-				if( !RooMathinit ) RooComplex RooReturnable = RooMath::ITPComplexErrFunc( z, 13 )*exp( -u*u );
-#endif
-				RooMathinit = true;
-				pthread_mutex_unlock( &ROOT_Lock );
-			}
-			RooComplex thisRes = RooMath::ITPComplexErrFunc( z, 13 )*exp( -u*u );
-			returnable = complex<double>( thisRes.re(), thisRes.im() );
-		}
-		else
-		{
-			returnable = evalCerfApprox( swt, u, c );
-		}
-		return returnable;
-#else
-		complex<double> z_stl( swt*c, u+c );
-		complex<double> returnable = 0.;
 		if( (u+c) > -4.0 )
 		{
-			if( !RooMathinit )
-			{
-				pthread_mutex_lock( &ROOT_Lock );
-				if( !RooMathinit ) returnable = RooMath::faddeeva( z_stl )*exp( -u*u );
-				RooMathinit = true;
-				pthread_mutex_unlock( &ROOT_Lock );
-			}
-			returnable = RooMath::faddeeva( z_stl )*exp( -u*u );
+			const double z_re = swt*c;
+			const double z_im = u+c;
+			double w_re=0., w_im=0.;
+			FaddeevaBatch( &z_re, &z_im, 1, &w_re, &w_im );
+			const double exp_u2 = exp( -u*u );
+			return complex<double>( w_re*exp_u2, w_im*exp_u2 );
 		}
 		else
 		{
-			returnable = evalCerfApprox( swt, u, c );
+			return evalCerfApprox( swt, u, c );
 		}
-		return returnable;
-#endif
 	}
 
 	double evalCerfRe( double swt, double u, double c )
 	{
-#if ROOT_VERSION_CODE < ROOT_VERSION(5,34,10)
-		RooComplex z( swt*c, u+c );
-		double returnable = 0.;
-		if( (u+c) > -4.0 )
+		return evalCerf( swt, u, c ).real();
+	}
+
+	double evalCerfIm( double swt, double u, double c)
+	{
+		return evalCerf( swt, u, c ).imag();
+	}
+
+
+	//----------------------------------------------------------------------------------------------
+	// Batch evaluation of the Faddeeva function w(z) = exp(-z^2) erfc(-iz)
+	//
+	// This uses the rational approximation of J.A.C. Weideman, SIAM J. Numer. Anal. 31 (1994) 1497 in the upper half plane
+	// and w(z) = 2 exp(-z^2) - w(-z) below it. The same arithmetic is used for every argument so that the main loop is
+	// vectorised by the compiler, and it doesn't touch any ROOT state so it can be called from any thread.
+	//
+	// With 40 terms the relative difference to an exact calculation is <2E-14 for -4 < Im(z) and |Re(z)| < 25
+
+	static const unsigned int WEIDEMAN_TERMS = 40;
+
+	struct WeidemanCoefficients
+	{
+		double L;
+		double a[WEIDEMAN_TERMS];
+
+		WeidemanCoefficients() : L( sqrt( WEIDEMAN_TERMS / sqrt(2.) ) ), a()
 		{
-			if( !RooMathinit )
+			//	Fourier coefficients of ( L^2 + t^2 ) exp( -t^2 ) with t = L tan( theta/2 ), this is a cosine series as the function is even
+			const unsigned int M = 2*WEIDEMAN_TERMS;
+			vector<double> f( M, 0. );
+			for( unsigned int k=0; k< M; ++k )
 			{
-				pthread_mutex_lock( &ROOT_Lock );
-#if ROOT_VERSION_CODE >= ROOT_VERSION(5,34,0)
-				if( !RooMathinit ) RooMath::initFastCERF( 800, -4.0, 4.0, 1000, -4.0, 6.0 );
-#else
-				if( !RooMathinit ) RooComplex RooReturnable = RooMath::ITPComplexErrFuncRe( z, 13 )*exp( -u*u );
-#endif
-				RooMathinit = true;
-				pthread_mutex_unlock( &ROOT_Lock );
+				const double t = L * tan( 0.5 * k * _pi / M );
+				f[k] = exp( -t*t ) * ( L*L + t*t );
+			}
+			for( unsigned int j=1; j<= WEIDEMAN_TERMS; ++j )
+			{
+				double sum = f[0];
+				for( unsigned int k=1; k< M; ++k ) sum += 2. * f[k] * cos( _pi * j * k / M );
+				a[j-1] = sum / ( 2. * M );
 			}
-			returnable = RooMath::ITPComplexErrFuncRe( z, 13 )*exp( -u*u );
-		}
-		else
-		{
-			returnable = evalCerfApprox( swt, u, c ).real();
 		}
-		return returnable;
-#else
-		complex<double> z_stl( swt*c, u+c );
-		double returnable = 0.;
-		if( (u+c) > -4.0 )
+	};
+
+	static const WeidemanCoefficients weideman;
+
+	void FaddeevaBatch( const double* re, const double* im, const unsigned int n, double* outRe, double* outIm )
+	{
+		const double L = weideman.L;
+		const double* a = weideman.a;
+		const double inv_rootpi = 1./rootpi;
+
+		for( unsigned int i=0; i< n; ++i )
 		{
-			if( !RooMathinit )
+			//	Fold into the upper half plane
+			const double sign = im[i] < 0. ? -1. : 1.;
+			const double x = sign * re[i];
+			const double y = sign * im[i];
+
+			//	d = L - iz,  Z = ( L + iz ) / ( L - iz )
+			const double d_re = L + y;
+			const double d_im = -x;
+			const double inv_d_mag2 = 1. / ( d_re*d_re + d_im*d_im );
+			const double Z_re = ( ( L - y ) * d_re + x * d_im ) * inv_d_mag2;
+			const double Z_im = ( x * d_re - ( L - y ) * d_im ) * inv_d_mag2;
+
+			//	p(Z) by Horner's method
+			double p_re = a[WEIDEMAN_TERMS-1];
+			double p_im = 0.;
+			for( unsigned int j=WEIDEMAN_TERMS-1; j> 0; --j )
 			{
-				pthread_mutex_lock( &ROOT_Lock );
-				if( !RooMathinit ) returnable = RooMath::faddeeva( z_stl ).real()*exp( -u*u );
-				RooMathinit = true;
-				pthread_mutex_unlock( &ROOT_Lock );
+				const double temp = p_re * Z_re - p_im * Z_im + a[j-1];
+				p_im = p_re * Z_im + p_im * Z_re;
+				p_re = temp;
 			}
-			returnable = RooMath::faddeeva( z_stl ).real()*exp( -u*u );
+
+			//	w = 2 p / d^2 + 1 / ( sqrt(pi) d )
+			const double inv_d_re = d_re * inv_d_mag2;
+			const double inv_d_im = -d_im * inv_d_mag2;
+			const double inv_d2_re = inv_d_re*inv_d_re - inv_d_im*inv_d_im;
+			const double inv_d2_im = 2. * inv_d_re * inv_d_im;
+
+			outRe[i] = 2. * ( p_re * inv_d2_re - p_im * inv_d2_im ) + inv_rootpi * inv_d_re;
+			outIm[i] = 2. * ( p_re * inv_d2_im + p_im * inv_d2_re ) + inv_rootpi * inv_d_im;
 		}
-		else
+
+		//	Unfold the arguments below the real axis
+		for( unsigned int i=0; i< n; ++i )
 		{
-			returnable = evalCerfApprox( swt, u, c ).real();
+			if( im[i] >= 0. ) continue;
+			const double x = re[i];
+			const double y = im[i];
+			const double mag = 2. * exp( y*y - x*x );
+			const double phase = -2. * x * y;
+			outRe[i] = mag * cos( phase ) - outRe[i];
+			outIm[i] = mag * sin( phase ) - outIm[i];
 		}
-		return returnable;
-#endif
 	}
 
-	double evalCerfIm( double swt, double u, double c)
+	void evalCerfApproxBatch( const double swt, const double* u, const double* c, const unsigned int n, double* outRe, double* outIm )
 	{
-#if ROOT_VERSION_CODE < ROOT_VERSION(5,34,10)
-		RooComplex z( swt*c, u+c );
-		double returnable = 0.;
-		if( (u+c) > -4.0 )
+		for( unsigned int i=0; i< n; ++i )
 		{
-			if( !RooMathinit )
-			{
-				pthread_mutex_lock( &ROOT_Lock );
-#if ROOT_VERSION_CODE >= ROOT_VERSION(5,34,0)
-				if( !RooMathinit ) RooMath::initFastCERF( 800, -4.0, 4.0, 1000, -4.0, 6.0 );
-#else
-				if( !RooMathinit ) returnable = RooMath::ITPComplexErrFuncIm( z, 13 )*exp( -u*u );
-#endif
-				RooMathinit = true;
-				pthread_mutex_unlock( &ROOT_Lock );
-			}
+			//	Exactly the same arithmetic as evalCerfApprox
+			const double swt_c = swt * c[i];
+			const double z_re = swt_c;
+			const double z_im = u[i] + c[i];
+			const double zc_re = z_im;
+			const double zc_im = -swt_c;
+			const double zsq_re = z_re*z_re - z_im*z_im;
+			const double zsq_im = 2. * z_re * z_im;
+			const double v_mag = exp( -zsq_re - u[i]*u[i] );
+			const double v_exp_re = v_mag * cos( -zsq_im );
+			const double v_exp_im = v_mag * sin( -zsq_im );
+			const double zsq_mag = exp( zsq_re );
+			const double zsq_exp_re = zsq_mag * cos( zsq_im );
+			const double zsq_exp_im = zsq_mag * sin( zsq_im );
+
+			//	1 - zsq_exp / ( zc * rootpi )
+			const double inv_zc_mag2 = 1. / ( ( zc_re*zc_re + zc_im*zc_im ) * rootpi );
+			const double term_re = 1. - ( zsq_exp_re * zc_re + zsq_exp_im * zc_im ) * inv_zc_mag2;
+			const double term_im = -( zsq_exp_im * zc_re - zsq_exp_re * zc_im ) * inv_zc_mag2;
+
+			outRe[i] = 2. * ( v_exp_re * term_re - v_exp_im * term_im );
+			outIm[i] = 2. * ( v_exp_re * term_im + v_exp_im * term_re );
 		}
-		else
+	}
+
+	void evalCerfBatch( const double swt, const double* u, const double* c, const unsigned int n, double* outRe, double* outIm )
+	{
+		//	Split the arguments between the two branches of evalCerf so that each branch runs over a contiguous array
+		vector<unsigned int> exactIndex, approxIndex;
+		exactIndex.reserve( n );
+		for( unsigned int i=0; i< n; ++i )
 		{
-			returnable = evalCerfApprox( swt, u, c ).imag();
+			if( (u[i]+c[i]) > -4.0 ) exactIndex.push_back( i );
+			else approxIndex.push_back( i );
 		}
-		return returnable;
-#else
-		complex<double> z_stl( swt*c, u+c );
-		double returnable = 0.;
-		if( (u+c) > -4.0 )
+
+		if( !exactIndex.empty() )
 		{
-			if( !RooMathinit )
+			const unsigned int nExact = (unsigned) exactIndex.size();
+			vector<double> z_re( nExact ), z_im( nExact ), w_re( nExact ), w_im( nExact );
+			for( unsigned int i=0; i< nExact; ++i )
 			{
-				pthread_mutex_lock( &ROOT_Lock );
-				if( !RooMathinit ) returnable = RooMath::faddeeva( z_stl ).imag()*exp( -u*u );
-				RooMathinit = true;
-				pthread_mutex_unlock( &ROOT_Lock );
+				z_re[i] = swt * c[ exactIndex[i] ];
+				z_im[i] = u[ exactIndex[i] ] + c[ exactIndex[i] ];
+			}
+			FaddeevaBatch( &(z_re[0]), &(z_im[0]), nExact, &(w_re[0]), &(w_im[0]) );
+			for( unsigned int i=0; i< nExact; ++i )
+			{
+				const double thisU = u[ exactIndex[i] ];
+				const double exp_u2 = exp( -thisU*thisU );
+				outRe[ exactIndex[i] ] = w_re[i] * exp_u2;
+				outIm[ exactIndex[i] ] = w_im[i] * exp_u2;
 			}
-			returnable = RooMath::faddeeva( z_stl ).imag()*exp( -u*u );
 		}
-		else
+
+		if( !approxIndex.empty() )
 		{
-			returnable = evalCerfApprox( swt, u, c ).imag();
+			const unsigned int nApprox = (unsigned) approxIndex.size();
+			vector<double> thisU( nApprox ), thisC( nApprox ), w_re( nApprox ), w_im( nApprox );
+			for( unsigned int i=0; i< nApprox; ++i )
+			{
+				thisU[i] = u[ approxIndex[i] ];
+				thisC[i] = c[ approxIndex[i] ];
+			}
+			evalCerfApproxBatch( swt, &(thisU[0]), &(thisC[0]), nApprox, &(w_re[0]), &(w_im[0]) );
+			for( unsigned int i=0; i< nApprox; ++i )
+			{
+				outRe[ approxIndex[i] ] = w_re[i];
+				outIm[ approxIndex[i] ] = w_im[i];
+			}
 		}
-		return returnable;
-#endif
 	}
 
-
 	//----------------------------------------------------------------------------------------------
 	//........................................
 	//evaluate a simple exponential with single gaussian time resolution
@@ -692,6 +741,173 @@ namespace Mathematics
 		}
 	}
 
+	//----------------------------------------------------------------------------------------------
+	// Batch versions of the time functions above for arrays of times with per-event resolutions
+	// These give the same results as calling the single event functions for each event
+
+	void ExpBatch( const double* t, const unsigned int n, const double gamma, const double* resolution, double* output )
+	{
+		for( unsigned int i=0; i< n; ++i )
+		{
+			if( resolution[i] > 0. )
+			{
+				const double t_gamma=t[i]*gamma;
+				const double resolution_2_gamma=resolution[i]*resolution[i]*gamma;
+				const double theExp = exp( -t_gamma + resolution_2_gamma*gamma *0.5 ) ;
+				const double theErfc = erfc(  -( t[i] - resolution_2_gamma ) *_over_sqrt_2 /resolution[i] )  ;
+				output[i] = theExp * theErfc  *0.5 ;
+			}
+			else
+			{
+				output[i] = t[i] < 0.0 ? 0.0 : exp( -t[i]*gamma );
+			}
+		}
+	}
+
+	void ExpCoshBatch( const double* t, const unsigned int n, const double gamma, const double deltaGamma, const double* resolution, double* output )
+	{
+		const double dg_2 = deltaGamma*0.5;
+		vector<double> expL( n );
+		ExpBatch( t, n, gamma - dg_2, resolution, output );
+		ExpBatch( t, n, gamma + dg_2, resolution, &(expL[0]) );
+		for( unsigned int i=0; i< n; ++i ) output[i] = ( output[i] + expL[i] ) *0.5;
+	}
+
+	void ExpSinhBatch( const double* t, const unsigned int n, const double gamma, const double deltaGamma, const double* resolution, double* output )
+	{
+		const double dg_2 = deltaGamma*0.5;
+		vector<double> expL( n );
+		ExpBatch( t, n, gamma - dg_2, resolution, output );
+		ExpBatch( t, n, gamma + dg_2, resolution, &(expL[0]) );
+		for( unsigned int i=0; i< n; ++i ) output[i] = ( output[i] - expL[i] ) *0.5;
+	}
+
+	void ExpCosSinBatch( const double* t, const unsigned int n, const double gamma, const double deltaM, const double* resolution, double* outCos, double* outSin )
+	{
+		if( n == 0 ) return;
+
+		const double wt = deltaM / gamma ;
+		vector<double> u( n ), c( n );
+		for( unsigned int i=0; i< n; ++i )
+		{
+			//	Events without resolution are replaced below, give them a safe value here
+			const double thisRes = resolution[i] > 0. ? resolution[i] : 1.;
+			c[i] = gamma * thisRes*_over_sqrt_2;
+			u[i] = -(t[i] / thisRes) *_over_sqrt_2;
+		}
+
+		vector<double> plus_re( n ), plus_im( n ), minus_re( n ), minus_im( n );
+		evalCerfBatch( wt, &(u[0]), &(c[0]), n, &(plus_re[0]), &(plus_im[0]) );
+		evalCerfBatch( -wt, &(u[0]), &(c[0]), n, &(minus_re[0]), &(minus_im[0]) );
+
+		for( unsigned int i=0; i< n; ++i )
+		{
+			if( resolution[i] > 0. )
+			{
+				outCos[i] = ( plus_re[i] + minus_re[i] ) *0.25;
+				outSin[i] = ( plus_im[i] - minus_im[i] ) *0.25;
+			}
+			else if( t[i] < 0.0 )
+			{
+				outCos[i] = 0.;
+				outSin[i] = 0.;
+			}
+			else
+			{
+				const double exp_t = exp( -gamma*t[i] );
+				outCos[i] = exp_t * cos( deltaM*t[i] );
+				outSin[i] = exp_t * sin( deltaM*t[i] );
+			}
+		}
+	}
+
+	void ExpCosBatch( const double* t, const unsigned int n, const double gamma, const double deltaM, const double* resolution, double* output )
+	{
+		vector<double> expSin( n );
+		ExpCosSinBatch( t, n, gamma, deltaM, resolution, output, &(expSin[0]) );
+	}
+
+	void ExpSinBatch( const double* t, const unsigned int n, const double gamma, const double deltaM, const double* resolution, double* output )
+	{
+		vector<double> expCos( n );
+		ExpCosSinBatch( t, n, gamma, deltaM, resolution, &(expCos[0]), output );
+	}
+
+	//......................................................................
+	//	Compare the batch functions to RooMath::faddeeva and the single event functions over the range used by the resolution models
+	double TestFaddeevaBatch()
+	{
+		double maxFaddeeva = 0.;
+
+		//	Im(z) > -4 is all that is ever evaluated directly, below this evalCerf uses evalCerfApprox
+		vector<double> z_re, z_im;
+		for( double x = -30.; x <= 30.; x += 0.173 )
+		{
+			for( double y = -3.99; y <= 40.; y += 0.0917 )
+			{
+				z_re.push_back( x ); z_im.push_back( y );
+			}
+			z_re.push_back( x ); z_im.push_back( 1E3 );
+			z_re.push_back( x ); z_im.push_back( 1E6 );
+		}
+		const unsigned int nPoints = (unsigned) z_re.size();
+		vector<double> w_re( nPoints ), w_im( nPoints );
+		FaddeevaBatch( &(z_re[0]), &(z_im[0]), nPoints, &(w_re[0]), &(w_im[0]) );
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(5,34,10)
+		for( unsigned int i=0; i< nPoints; ++i )
+		{
+			const complex<double> reference = RooMath::faddeeva( complex<double>( z_re[i], z_im[i] ) );
+			const double diff = abs( complex<double>( w_re[i], w_im[i] ) - reference ) / abs( reference );
+			if( diff > maxFaddeeva )
+			{
+				maxFaddeeva = diff;
+			}
+		}
+		cout << "Mathematics::FaddeevaBatch vs RooMath::faddeeva, max relative difference:\t" << maxFaddeeva << "\t(" << nPoints << " points)" << endl;
+#else
+		cout << "Mathematics::FaddeevaBatch: RooMath::faddeeva is not available in this version of ROOT, only checking the time functions" << endl;
+#endif
+
+		//	Typical Bs lifetimes, mixing frequency and per-event resolutions
+		double maxTime = 0.;
+		const double gamma = 0.66, deltaGamma = 0.1, deltaM = 17.7;
+		vector<double> t, resolution;
+		for( double thisT = -1.; thisT <= 15.; thisT += 0.01 )
+		{
+			for( double thisRes = 0.; thisRes <= 0.15; thisRes += 0.005 )
+			{
+				t.push_back( thisT ); resolution.push_back( thisRes );
+			}
+		}
+		const unsigned int nTimes = (unsigned) t.size();
+		vector<double> expVal( nTimes ), expCosh( nTimes ), expSinh( nTimes ), expCos( nTimes ), expSin( nTimes );
+		ExpBatch( &(t[0]), nTimes, gamma, &(resolution[0]), &(expVal[0]) );
+		ExpCoshBatch( &(t[0]), nTimes, gamma, deltaGamma, &(resolution[0]), &(expCosh[0]) );
+		ExpSinhBatch( &(t[0]), nTimes, gamma, deltaGamma, &(resolution[0]), &(expSinh[0]) );
+		ExpCosSinBatch( &(t[0]), nTimes, gamma, deltaM, &(resolution[0]), &(expCos[0]), &(expSin[0]) );
+
+		for( unsigned int i=0; i< nTimes; ++i )
+		{
+			//	The oscillating terms pass through 0 so compare everything to the size of the un-oscillating term
+			const double scale = Exp( t[i], gamma, resolution[i] );
+			if( scale <= 0. ) continue;
+			const double diffs[5] = {
+				fabs( expVal[i] - scale ),
+				fabs( expCosh[i] - ExpCosh( t[i], gamma, deltaGamma, resolution[i] ) ),
+				fabs( expSinh[i] - ExpSinh( t[i], gamma, deltaGamma, resolution[i] ) ),
+				fabs( expCos[i] - ExpCos( t[i], gamma, deltaM, resolution[i] ) ),
+				fabs( expSin[i] - ExpSin( t[i], gamma, deltaM, resolution[i] ) ) };
+			for( unsigned int j=0; j< 5; ++j )
+			{
+				if( diffs[j] / scale > maxTime ) maxTime = diffs[j] / scale;
+			}
+		}
+		cout << "Mathematics::Exp*Batch vs Mathematics::Exp*, max relative difference:\t" << maxTime << "\t(" << nTimes << " points)" << endl;
+
+		return maxFaddeeva > maxTime ? maxFaddeeva : maxTime;
+	}
+
 	//......................................................................
 	void getBs2JpsiPhiAngularFunctions( double & f1
 			, double & f2
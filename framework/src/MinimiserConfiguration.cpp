@@ -18,7 +18,7 @@ using namespace::std;
 
 //Constructor for a minimiser only specified by name
 MinimiserConfiguration::MinimiserConfiguration( string InputName ) :
-	theMinimiser(), OutputLevel(), minimiserName(InputName), contours(), maxSteps(), bestTolerance(), MinimiseOptions(), MultiMini(false), Quality(), nSigma(1)
+	theMinimiser(), OutputLevel(), minimiserName(InputName), contours(), maxSteps(), bestTolerance(), MinimiseOptions(), MultiMini(false), Quality(), nSigma(1), startingCovariance(NULL)
 {
 	theMinimiser = NULL;
 	OutputLevel=0;
@@ -27,16 +27,24 @@ MinimiserConfiguration::MinimiserConfiguration( string InputName ) :
 //Constructor for a minimiser with requested contour plots
 MinimiserConfiguration::MinimiserConfiguration( string InputName, OutputConfiguration * Formatting ) :
 	theMinimiser(), OutputLevel(), minimiserName(InputName), nSigma(1),
-	contours( Formatting != NULL ? Formatting->GetContourPlots() : vector< pair< string, string > >() ), maxSteps(), bestTolerance(), MinimiseOptions(), MultiMini(false), Quality()
+	contours( Formatting != NULL ? Formatting->GetContourPlots() : vector< pair< string, string > >() ), maxSteps(), bestTolerance(), MinimiseOptions(), MultiMini(false), Quality(), startingCovariance(NULL)
 {
 	theMinimiser = NULL;
 	OutputLevel=0;
 }
 
+MinimiserConfiguration::MinimiserConfiguration( const MinimiserConfiguration& input ) :
+	theMinimiser(NULL), OutputLevel(input.OutputLevel), minimiserName(input.minimiserName), contours(input.contours), maxSteps(input.maxSteps),
+	bestTolerance(input.bestTolerance), MinimiseOptions(input.MinimiseOptions), MultiMini(input.MultiMini), Quality(input.Quality), nSigma(input.nSigma),
+	startingCovariance( input.startingCovariance==NULL ? NULL : new RapidFitMatrix( *input.startingCovariance ) )
+{
+}
+
 //Destructor
 MinimiserConfiguration::~MinimiserConfiguration()
 {
 	delete theMinimiser;
+	if( startingCovariance != NULL ) delete startingCovariance;
 }
 
 void MinimiserConfiguration::SetOutputLevel( int output_Level )
@@ -78,6 +86,7 @@ IMinimiser * MinimiserConfiguration::GetMinimiser( int ParameterNumber )
 	theMinimiser->SetOptions( MinimiseOptions );
 	theMinimiser->SetQuality( Quality );
 	theMinimiser->SetNSigma( nSigma );
+	theMinimiser->SetStartingCovariance( startingCovariance );
 	return theMinimiser;
 }
 
@@ -117,6 +126,17 @@ void MinimiserConfiguration::SetNSigma( int input )
 	nSigma = input;
 }
 
+void MinimiserConfiguration::SetStartingCovariance( const RapidFitMatrix* input )
+{
+	if( startingCovariance != NULL ) delete startingCovariance;
+	startingCovariance = ( input==NULL ) ? NULL : new RapidFitMatrix( *input );
+}
+
+string MinimiserConfiguration::GetMinimiserName() const
+{
+	return minimiserName;
+}
+
 void MinimiserConfiguration::Print() const
 {
 	cout << "MinimiserConfiguration:" << endl;
@@ -0,0 +1,68 @@
+/**
+        @class Minuit2GradientFunction
+
+        A wrapper making IFitFunctions which can calculate their own derivatives work with the Minuit2 FCNGradientBase API
+
+*/
+
+//	RapidFit Headers
+#include "Minuit2GradientFunction.h"
+//	System Headers
+#include <iostream>
+
+//Constructor with correct argument
+Minuit2GradientFunction::Minuit2GradientFunction( Minuit2Function * NewValueFunction, IFitFunction * NewFitFunction ) :
+	valueFunction(NewValueFunction), function(NewFitFunction)
+{
+}
+
+//Destructor
+Minuit2GradientFunction::~Minuit2GradientFunction()
+{
+}
+
+//Return the value to minimise, given the parameters passed
+double Minuit2GradientFunction::operator()( const vector<double>& NewParameterValues ) const
+{
+	return (*valueFunction)( NewParameterValues );
+}
+
+//Return the derivative of the function wrt each parameter, given the parameters passed
+vector<double> Minuit2GradientFunction::Gradient( const vector<double>& NewParameterValues ) const
+{
+	//Make parameter set and pass to wrapped function
+	ParameterSet * temporaryParameters = function->GetParameterSet();
+	try
+	{
+		temporaryParameters->SetPhysicsParameters(NewParameterValues);
+		function->SetParameterSet(temporaryParameters);
+		return function->EvaluateGradient();
+	}
+	catch(...)
+	{
+		cerr << "Minuit2 does not provide the correct parameters" << endl;
+		throw(-9999);
+	}
+}
+
+//Set the up value for error calculation
+void Minuit2GradientFunction::SetErrorDef( double thisUp )
+{
+	valueFunction->SetErrorDef( thisUp );
+}
+
+//Return the up value for error calculation
+double Minuit2GradientFunction::Up() const
+{
+	return valueFunction->Up();
+}
+
+double Minuit2GradientFunction::ErrorDef() const
+{
+	return valueFunction->ErrorDef();
+}
+
+bool Minuit2GradientFunction::CheckGradient() const
+{
+	return false;
+}
@@ -13,9 +13,12 @@
 #include "Minuit2/MnHesse.h"
 #include "Minuit2/MnMinos.h"
 #include "Minuit2/MinosError.h"
+#include "Minuit2/MnStrategy.h"
+#include "Minuit2/MnUserCovariance.h"
 #include "TMatrixDSym.h"
 //	RapidFit Headers
 #include "Minuit2Wrapper.h"
+#include "Minuit2GradientFunction.h"
 #include "ResultParameterSet.h"
 #include "StringProcessing.h"
 //	System Headers
@@ -30,7 +33,7 @@ const double STEP_SIZE = 0.01;
 
 //Default constructor
 Minuit2Wrapper::Minuit2Wrapper() :
-	function(NULL), RapidFunction(NULL), fitResult(NULL), contours(), maxSteps(), bestTolerance(), Options(), Quality(), nSigma(1), minimum(NULL)
+	function(NULL), RapidFunction(NULL), fitResult(NULL), contours(), maxSteps(), bestTolerance(), Options(), Quality(), nSigma(1), minimum(NULL), startingCovariance(NULL), minimisedNames()
 {
 }
 
@@ -38,6 +41,7 @@ Minuit2Wrapper::Minuit2Wrapper() :
 Minuit2Wrapper::~Minuit2Wrapper()
 {
 	if( minimum != NULL ) delete minimum;
+	if( startingCovariance != NULL ) delete startingCovariance;
 }
 
 void Minuit2Wrapper::SetSteps( int newSteps )
@@ -83,13 +87,35 @@ void Minuit2Wrapper::Minimise()
 {
 	function->SetSigma(nSigma);
 
+	//	The FitFunction is usually deleted before the covariance matrix is requested
+	minimisedNames = RapidFunction->GetParameterSet()->GetAllFloatNames();
+
 	cout << "Minuit2 Starting Fit" << endl;
 
-	//Minimise the wrapped function
-	MnMigrad mig( *function, *( function->GetMnUserParameters() ), (unsigned)Quality );//MINUIT_QUALITY );
+	//	Only let Migrad use the derivatives from the FitFunction when asked to, the default remains Minuit's own numerical gradient
+	string AnalyticGradient("AnalyticGradient");
+	bool useGradient = ( StringProcessing::VectorContains( &Options, &AnalyticGradient ) != -1 ) && RapidFunction->CanEvaluateGradient();
+
+	if( useGradient )
+	{
+		cout << "Minuit2 using analytic derivatives where available" << endl;
+
+		Minuit2GradientFunction gradientFunction( function, RapidFunction );
+
+		//Minimise the wrapped function
+		MnMigrad mig( gradientFunction, this->GetStartingState(), MnStrategy( (unsigned)Quality ) );
 
-	//Retrieve the result of the fit
-	minimum = new FunctionMinimum( mig( (unsigned)maxSteps, bestTolerance ) );//(int)MAXIMUM_MINIMISATION_STEPS, FINAL_GRADIENT_TOLERANCE );
+		//Retrieve the result of the fit
+		minimum = new FunctionMinimum( mig( (unsigned)maxSteps, bestTolerance ) );
+	}
+	else
+	{
+		//Minimise the wrapped function
+		MnMigrad mig( *function, this->GetStartingState(), MnStrategy( (unsigned)Quality ) );//MINUIT_QUALITY );
+
+		//Retrieve the result of the fit
+		minimum = new FunctionMinimum( mig( (unsigned)maxSteps, bestTolerance ) );//(int)MAXIMUM_MINIMISATION_STEPS, FINAL_GRADIENT_TOLERANCE );
+	}
 
 	//Work out the fit status - possibly dodgy
 	int fitStatus=0;
@@ -322,9 +348,30 @@ void Minuit2Wrapper::CallHesse()
 	hesse( *function, *minimum, 100000);
 }
 
+//	Covariance of the free parameters at the minimum, these were given to Minuit2 in the order of GetAllFloatNames when Minimise was called
 RapidFitMatrix* Minuit2Wrapper::GetCovarianceMatrix()
 {
-	return NULL;
+	if( minimum == NULL ) return NULL;
+	if( !minimum->HasCovariance() ) return NULL;
+
+	const vector<string>& floatedNames = minimisedNames;
+	const MnUserCovariance * covMatrix = &(minimum->UserCovariance());
+	if( covMatrix->Nrow() != (unsigned)floatedNames.size() ) return NULL;
+
+	TMatrixDSym* thisMatrix = new TMatrixDSym( (int)floatedNames.size() );
+	for( unsigned int i=0; i< (unsigned)floatedNames.size(); ++i )
+	{
+		for( unsigned int j=0; j< (unsigned)floatedNames.size(); ++j )
+		{
+			(*thisMatrix)((int)i,(int)j) = (*covMatrix)(i,j);
+		}
+	}
+
+	RapidFitMatrix* thisCovMatrix = new RapidFitMatrix();
+	thisCovMatrix->thisMatrix = thisMatrix;
+	thisCovMatrix->theseParameters = floatedNames;
+
+	return thisCovMatrix;
 }
 
 void Minuit2Wrapper::ApplyCovarianceMatrix( RapidFitMatrix* Input )
@@ -338,3 +385,43 @@ void Minuit2Wrapper::SetNSigma( int input )
 	nSigma = input;
 }
 
+void Minuit2Wrapper::SetStartingCovariance( const RapidFitMatrix* Input )
+{
+	if( startingCovariance != NULL ) delete startingCovariance;
+	startingCovariance = ( Input == NULL ) ? NULL : new RapidFitMatrix( *Input );
+}
+
+MnUserParameterState Minuit2Wrapper::GetStartingState() const
+{
+	const MnUserParameters * startingParameters = function->GetMnUserParameters();
+
+	if( startingCovariance == NULL || startingCovariance->thisMatrix == NULL ) return MnUserParameterState( *startingParameters );
+
+	vector<string> floatedNames = RapidFunction->GetParameterSet()->GetAllFloatNames();
+	vector<string> matrixNames = startingCovariance->theseParameters;
+	vector<int> matrixIndex;
+	for( unsigned int i=0; i< (unsigned)floatedNames.size(); ++i )
+	{
+		int thisIndex = StringProcessing::VectorContains( &matrixNames, &(floatedNames[i]) );
+		if( thisIndex == -1 )
+		{
+			cout << "Minuit2: Starting covariance doesn't contain " << floatedNames[i] << ", ignoring it" << endl;
+			return MnUserParameterState( *startingParameters );
+		}
+		matrixIndex.push_back( thisIndex );
+	}
+
+	MnUserCovariance startingMatrix( (unsigned)floatedNames.size() );
+	for( unsigned int i=0; i< (unsigned)floatedNames.size(); ++i )
+	{
+		for( unsigned int j=0; j<= i; ++j )
+		{
+			startingMatrix(i,j) = (*(startingCovariance->thisMatrix))( matrixIndex[i], matrixIndex[j] );
+		}
+	}
+
+	cout << "Minuit2 starting from the provided covariance matrix" << endl;
+
+	return MnUserParameterState( *startingParameters, startingMatrix );
+}
+
@@ -49,7 +49,7 @@ ParameterSet* MinuitWrapper::LastSet = NULL;
 
 //Constructor with correct argument
 MinuitWrapper::MinuitWrapper( int NumberParameters, int output_level ) :
-	minuit(NULL), fitResult(NULL), contours(), print_verbosity( output_level ), maxSteps(), bestTolerance(), Options(), Quality(), nSigma(1)
+	minuit(NULL), fitResult(NULL), contours(), print_verbosity( output_level ), maxSteps(), bestTolerance(), Options(), Quality(), nSigma(1), minimisedNames()
 {
 	minuit = new TMinuit( NumberParameters );
 }
@@ -217,6 +217,9 @@ void MinuitWrapper::Minimise()
 	vector<string> allNames = function->GetParameterSet()->GetAllNames();
 	ParameterSet * newParameters = function->GetParameterSet();
 
+	//	The FitFunction is usually deleted before the covariance matrix is requested
+	minimisedNames = newParameters->GetAllFloatNames();
+
 	string IntOption("Interactive");
 	if( StringProcessing::VectorContains( &Options, &IntOption ) != -1 )
 	{
@@ -390,7 +393,7 @@ ResultParameterSet* MinuitWrapper::GetResultParameters( vector<string> allNames,
 
 RapidFitMatrix* MinuitWrapper::GetCovarianceMatrix()
 {
-	unsigned int numParams = (unsigned)function->GetParameterSet()->GetAllFloatNames().size();
+	unsigned int numParams = (unsigned)minimisedNames.size();
 	/*!
 	 * This section of code causes some minor warnings against old c++ standards, but the behaviour here, explicitly requires the matrix to be allocated this way
 	 *
@@ -418,7 +421,7 @@ RapidFitMatrix* MinuitWrapper::GetCovarianceMatrix()
 
 	thisCovMatrix->thisMatrix = covMatrix;
 
-	thisCovMatrix->theseParameters = function->GetParameterSet()->GetAllFloatNames();
+	thisCovMatrix->theseParameters = minimisedNames;
 
 	return thisCovMatrix;
 }
@@ -625,6 +628,13 @@ void MinuitWrapper::ApplyCovarianceMatrix( RapidFitMatrix* Input )
 	fitResult->ApplyCovarianceMatrix( Input );
 }
 
+//	TMinuit always builds its own first estimate of the covariance
+void MinuitWrapper::SetStartingCovariance( const RapidFitMatrix* Input )
+{
+	(void)Input;
+	return;
+}
+
 void MinuitWrapper::SetNSigma( int input )
 {
 	nSigma = input;
@@ -6,18 +6,31 @@
 #include "MultiThreadedFunctions.h"
 #include "ClassLookUp.h"
 #include "MemoryDataSet.h"
+#include "ThreadPool.h"
 
 #include <string>
 #include <float.h>
 
 using namespace::std;
 
+namespace
+{
+	//	Part of one slice handed to whichever worker of the ThreadPool claims it first
+	struct MultiThreadedChunk
+	{
+		Fitting_Thread* chunk;
+		Fitting_Thread* slices;			/*!	One per worker, holding the PDF and boundary that worker should use	*/
+		ThreadPool* workerPool;
+		void* (*task)( void* );
+	};
+}
+
 vector<double>* MultiThreadedFunctions::ParallelEvaluate( IPDF* thisFunction, IDataSet* thesePoints, ThreadingConfig* threadingInfo )
 {
 	if( threadingInfo == NULL ) return MultiThreadedFunctions::ParallelEvaluate_pthreads( thisFunction, thesePoints, 4, NULL );
 	if( threadingInfo->MultiThreadingInstance == "pthreads" )
 	{
-		return MultiThreadedFunctions::ParallelEvaluate_pthreads( thisFunction, thesePoints, threadingInfo->numThreads, threadingInfo->wantedComponent );
+		return MultiThreadedFunctions::ParallelEvaluate_pthreads( thisFunction, thesePoints, threadingInfo->numThreads, threadingInfo->wantedComponent, threadingInfo->workerPool, threadingInfo->chunkSize );
 	}
 	else
 	{
@@ -30,7 +43,7 @@ vector<double>* MultiThreadedFunctions::ParallelEvaluate( vector<IPDF*> thisFunc
 	if( threadingInfo == NULL ) return MultiThreadedFunctions::ParallelEvaluate_pthreads( thisFunction, thesePoints, 4, NULL );
 	if( threadingInfo->MultiThreadingInstance == "pthreads" )
 	{
-		return MultiThreadedFunctions::ParallelEvaluate_pthreads( thisFunction, thesePoints, threadingInfo->numThreads, threadingInfo->wantedComponent );
+		return MultiThreadedFunctions::ParallelEvaluate_pthreads( thisFunction, thesePoints, threadingInfo->numThreads, threadingInfo->wantedComponent, threadingInfo->workerPool, threadingInfo->chunkSize );
 	}
 	else
 	{
@@ -43,7 +56,7 @@ vector<double>* MultiThreadedFunctions::ParallelIntegrate( IPDF* thisFunction, I
 	if( threadingInfo == NULL ) return MultiThreadedFunctions::ParallelIntegrate_pthreads( thisFunction, thesePoints, thisBoundary, 4 );
 	if( threadingInfo->MultiThreadingInstance == "pthreads" )
 	{
-		return MultiThreadedFunctions::ParallelIntegrate_pthreads( thisFunction, thesePoints, thisBoundary, threadingInfo->numThreads );
+		return MultiThreadedFunctions::ParallelIntegrate_pthreads( thisFunction, thesePoints, thisBoundary, threadingInfo->numThreads, threadingInfo->workerPool, threadingInfo->chunkSize );
 	}
 	else
 	{
@@ -56,7 +69,7 @@ vector<double>* MultiThreadedFunctions::ParallelIntegrate( vector<IPDF*> thisFun
 	if( threadingInfo == NULL ) return MultiThreadedFunctions::ParallelIntegrate_pthreads( thisFunction, thesePoints, thisBoundary, 4 );
 	if( threadingInfo->MultiThreadingInstance == "pthreads" )
 	{
-		return MultiThreadedFunctions::ParallelIntegrate_pthreads( thisFunction, thesePoints, thisBoundary, threadingInfo->numThreads );
+		return MultiThreadedFunctions::ParallelIntegrate_pthreads( thisFunction, thesePoints, thisBoundary, threadingInfo->numThreads, threadingInfo->workerPool, threadingInfo->chunkSize );
 	}
 	else
 	{
@@ -94,7 +107,7 @@ vector<IPDF*> MultiThreadedFunctions::GetFunctions( IPDF* thisFunction, unsigned
 	return StoredFunctions;
 }
 
-vector<double>* MultiThreadedFunctions::ParallelEvaluate_pthreads( IPDF* thisFunction, IDataSet* thesePoints, unsigned int nThreads, ComponentRef* thisComponent )
+vector<double>* MultiThreadedFunctions::ParallelEvaluate_pthreads( IPDF* thisFunction, IDataSet* thesePoints, unsigned int nThreads, ComponentRef* thisComponent, ThreadPool* workerPool, unsigned int chunkSize )
 {
 	vector<IDataSet*> payLoad;
 	vector<vector<DataPoint*> > datasets_data = Threading::divideData( thesePoints, nThreads );
@@ -108,7 +121,7 @@ vector<double>* MultiThreadedFunctions::ParallelEvaluate_pthreads( IPDF* thisFun
 
 	vector<IPDF*> functions = MultiThreadedFunctions::GetFunctions( thisFunction, nThreads );
 
-	vector<double>* returnable = MultiThreadedFunctions::ParallelEvaluate_pthreads( functions, payLoad, nThreads, thisComponent );
+	vector<double>* returnable = MultiThreadedFunctions::ParallelEvaluate_pthreads( functions, payLoad, nThreads, thisComponent, workerPool, chunkSize );
 
 
 	while( !payLoad.empty() )
@@ -124,7 +137,7 @@ vector<double>* MultiThreadedFunctions::ParallelEvaluate_pthreads( IPDF* thisFun
 	return returnable;
 }
 
-vector<double>* MultiThreadedFunctions::ParallelEvaluate_pthreads( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, unsigned int nThreads, ComponentRef* thisComponent )
+vector<double>* MultiThreadedFunctions::ParallelEvaluate_pthreads( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, unsigned int nThreads, ComponentRef* thisComponent, ThreadPool* workerPool, unsigned int chunkSize )
 {
 	if( ( thisFunction.size() != thesePoints.size() ) || ( ( thesePoints.size() != nThreads ) || ( thisFunction.size() != nThreads ) ) )
 	{
@@ -135,48 +148,83 @@ vector<double>* MultiThreadedFunctions::ParallelEvaluate_pthreads( vector<IPDF*>
 		exit(87356);
 	}
 
-	//      1 thread per core
-	pthread_t* Thread = MultiThreadedFunctions::GetFittingThreads( nThreads );//new pthread_t[ nThreads ];
-	pthread_attr_t attrib;
-
-	//      Threads HAVE to be joinable
-	//      We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
-	//      Not all pthread implementations are required to obey this as default when constructing the thread _SO_BE_EXPLICIT_
-	pthread_attr_init(&attrib);
-	pthread_attr_setdetachstate(&attrib, PTHREAD_CREATE_JOINABLE);
-
-	Fitting_Thread* fit_thread_data = MultiThreadedFunctions::GetFittingThreadData( nThreads );//new Fitting_Thread[ (unsigned) nThreads ];
+	//	Allocated per call so that several integrators can evaluate at once
+	Fitting_Thread* fit_thread_data = new Fitting_Thread[ (unsigned) nThreads ];
 
 	for( unsigned int i=0; i < nThreads; ++i )
 	{
 		fit_thread_data[i].fittingPDF = thisFunction[i];
 		fit_thread_data[i].dataSet = thesePoints[i];
-		//thesePoints[i]->GetDataPoint(0)->Print();
-		fit_thread_data[i].dataPoint_Result.clear();
-		if( thisComponent != NULL )
+		fit_thread_data[i].dataBegin = 0;
+		fit_thread_data[i].dataEnd = (unsigned) thesePoints[i]->GetDataNumber();
+		if( thisComponent != NULL ) fit_thread_data[i].thisComponent = new ComponentRef( *thisComponent );
+	}
+
+	if( thisComponent == NULL )
+	{
+		MultiThreadedFunctions::RunThreads( MultiThreadedFunctions::Evaluate_task, MultiThreadedFunctions::Evaluate_pthread, fit_thread_data, nThreads, workerPool, chunkSize );
+	}
+	else
+	{
+		MultiThreadedFunctions::RunThreads( MultiThreadedFunctions::EvaluateComponent_task, MultiThreadedFunctions::EvaluateComponent_pthread, fit_thread_data, nThreads, workerPool, chunkSize );
+	}
+
+	unsigned int size=0;
+	for( unsigned int i=0; i< thesePoints.size(); ++i ) size+=thesePoints[i]->GetDataNumber();
+
+	vector<double>* final_output = new vector<double>( size, 0. );
+
+	unsigned int k=0;
+	for( unsigned int i=0; i < nThreads; ++i )
+	{
+		for( unsigned j=0; j< fit_thread_data[i].dataPoint_Result.size(); ++j )
 		{
-			if( fit_thread_data[i].thisComponent != NULL )
-			{
-				//if( fit_thread_data[i].thisComponent->getComponentNumber() == thisComponent->getComponentNumber() )
-				//{
-					delete fit_thread_data[i].thisComponent;
-					fit_thread_data[i].thisComponent = new ComponentRef( *thisComponent );
-				//}
-			}
-			else fit_thread_data[i].thisComponent = new ComponentRef( *thisComponent );
+			(*final_output)[k] = fit_thread_data[i].dataPoint_Result[j];
+			++k;
+		}
+	}
+
+	for( unsigned int i=0; i < nThreads; ++i )
+	{
+		if( fit_thread_data[i].thisComponent != NULL ) delete fit_thread_data[i].thisComponent;
+	}
+
+	delete[] fit_thread_data;
+
+	return final_output;
+}
+
+void MultiThreadedFunctions::RunThreads( void* (*poolTask)( void* ), void* (*threadTask)( void* ), Fitting_Thread* fit_thread_data, unsigned int nThreads, ThreadPool* workerPool, unsigned int chunkSize )
+{
+	if( chunkSize > 0 && workerPool != NULL && MultiThreadedFunctions::RunChunks( poolTask, fit_thread_data, nThreads, workerPool, chunkSize ) ) return;
+
+	//	Prefer the persistent workers, this returns false if they're busy or we're already running on one of them
+	if( workerPool != NULL )
+	{
+		vector<void*> taskInput( nThreads, NULL );
+		for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
+		{
+			taskInput[threadnum] = (void*) &(fit_thread_data[threadnum]);
 		}
-		else fit_thread_data[i].thisComponent = NULL;
+		if( workerPool->Execute( poolTask, &(taskInput[0]), nThreads ) ) return;
 	}
 
+	//      1 thread per core
+	vector<pthread_t> Thread( nThreads );
+	pthread_attr_t attrib;
+
+	//      Threads HAVE to be joinable
+	//      We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
+	//      Not all pthread implementations are required to obey this as default when constructing the thread _SO_BE_EXPLICIT_
+	pthread_attr_init(&attrib);
+	pthread_attr_setdetachstate(&attrib, PTHREAD_CREATE_JOINABLE);
+
 	//cout << "Creating Threads" << endl;
 
 	//      Create the Threads and set them to be joinable
 	for( unsigned int threadnum=0; threadnum< nThreads ; ++threadnum )
 	{
-		int status=0;
-		if( thisComponent == NULL ) status = pthread_create( &Thread[threadnum], &attrib, MultiThreadedFunctions::Evaluate_pthread, (void *) &(fit_thread_data[threadnum]) );
-		else status = pthread_create( &Thread[threadnum], &attrib, MultiThreadedFunctions::EvaluateComponent_pthread, (void *) &(fit_thread_data[threadnum]) );
-
+		int status = pthread_create( &Thread[threadnum], &attrib, threadTask, (void *) &(fit_thread_data[threadnum]) );
 		//cout << "status: " << status << endl;
 		if( status )
 		{
@@ -199,41 +247,111 @@ vector<double>* MultiThreadedFunctions::ParallelEvaluate_pthreads( vector<IPDF*>
 
 	//      Do some cleaning Up
 	pthread_attr_destroy(&attrib);
+}
 
-	unsigned int size=0;
-	for( unsigned int i=0; i< thesePoints.size(); ++i ) size+=thesePoints[i]->GetDataNumber();
+bool MultiThreadedFunctions::RunChunks( void* (*poolTask)( void* ), Fitting_Thread* fit_thread_data, unsigned int nThreads, ThreadPool* workerPool, unsigned int chunkSize )
+{
+	//	Each chunk borrows the PDF and boundary of the slice matching the worker which claims it
+	if( workerPool->GetNumThreads() > nThreads ) return false;
 
-	vector<double>* final_output = new vector<double>( size, 0. );
+	vector<unsigned int> firstChunk( nThreads+1, 0 );
+	for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
+	{
+		const unsigned int sliceSize = fit_thread_data[threadnum].dataEnd - fit_thread_data[threadnum].dataBegin;
+		firstChunk[threadnum+1] = firstChunk[threadnum] + ( sliceSize + chunkSize - 1 ) / chunkSize;
+	}
+	const unsigned int nChunks = firstChunk[nThreads];
 
-	unsigned int k=0;
-	for( unsigned int i=0; i < nThreads; ++i )
+	Fitting_Thread* chunkData = new Fitting_Thread[ nChunks ];
+	vector<MultiThreadedChunk> chunks( nChunks );
+	vector<void*> taskInput( nChunks, NULL );
+	for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
 	{
-		for( unsigned j=0; j< fit_thread_data[i].dataPoint_Result.size(); ++j )
+		const Fitting_Thread* thisSlice = &(fit_thread_data[threadnum]);
+		for( unsigned int chunkNum=firstChunk[threadnum]; chunkNum< firstChunk[threadnum+1]; ++chunkNum )
 		{
-			(*final_output)[k] = fit_thread_data[i].dataPoint_Result[j];
-			++k;
+			Fitting_Thread* thisChunk = &(chunkData[chunkNum]);
+			thisChunk->dataSet = thisSlice->dataSet;
+			thisChunk->dataBegin = thisSlice->dataBegin + ( chunkNum - firstChunk[threadnum] ) * chunkSize;
+			thisChunk->dataEnd = thisChunk->dataBegin + chunkSize;
+			if( thisChunk->dataEnd > thisSlice->dataEnd ) thisChunk->dataEnd = thisSlice->dataEnd;
+			//	ComponentRef caches its lookup so each chunk needs its own
+			if( thisSlice->thisComponent != NULL ) thisChunk->thisComponent = new ComponentRef( *(thisSlice->thisComponent) );
+
+			chunks[chunkNum].chunk = thisChunk;
+			chunks[chunkNum].slices = fit_thread_data;
+			chunks[chunkNum].workerPool = workerPool;
+			chunks[chunkNum].task = poolTask;
+			taskInput[chunkNum] = (void*) &(chunks[chunkNum]);
 		}
 	}
 
-	//for( unsigned int i=0; i < nThreads; ++i )
-	//{
-	//	if( fit_thread_data[i].thisComponent != NULL ) delete fit_thread_data[i].thisComponent;
-	//}
+	const bool ranOnPool = ( nChunks == 0 ) || workerPool->Execute( MultiThreadedFunctions::Chunk_task, &(taskInput[0]), nChunks );
 
-	//delete[] fit_thread_data;
-	//delete[] Thread;
+	//	Results go back to the slices in event order, so the output doesn't depend on which worker ran each chunk
+	for( unsigned int threadnum=0; ranOnPool && threadnum< nThreads; ++threadnum )
+	{
+		vector<double>& sliceResult = fit_thread_data[threadnum].dataPoint_Result;
+		sliceResult.clear();
+		for( unsigned int chunkNum=firstChunk[threadnum]; chunkNum< firstChunk[threadnum+1]; ++chunkNum )
+		{
+			sliceResult.insert( sliceResult.end(), chunkData[chunkNum].dataPoint_Result.begin(), chunkData[chunkNum].dataPoint_Result.end() );
+		}
+	}
 
-	return final_output;
+	for( unsigned int chunkNum=0; chunkNum< nChunks; ++chunkNum )
+	{
+		if( chunkData[chunkNum].thisComponent != NULL ) delete chunkData[chunkNum].thisComponent;
+	}
+	delete[] chunkData;
+
+	return ranOnPool;
+}
+
+void* MultiThreadedFunctions::Chunk_task( void *input_data )
+{
+	MultiThreadedChunk* thisChunk = (MultiThreadedChunk*) input_data;
+
+	int worker = thisChunk->workerPool->GetWorkerIndex();
+	if( worker < 0 ) worker = 0;
+
+	thisChunk->chunk->fittingPDF = thisChunk->slices[worker].fittingPDF;
+	thisChunk->chunk->FitBoundary = thisChunk->slices[worker].FitBoundary;
+
+	return thisChunk->task( (void*) thisChunk->chunk );
 }
 
 void* MultiThreadedFunctions::Evaluate_pthread( void *input_data )
+{
+	MultiThreadedFunctions::Evaluate_task( input_data );
+
+	//      Finished evaluating this thread
+	pthread_exit( NULL );
+}
+
+void* MultiThreadedFunctions::Evaluate_task( void *input_data )
 {
 	struct Fitting_Thread *thread_input = (struct Fitting_Thread*) input_data;
 
 	double value=0;
 	IDataSet* myDataSet = thread_input->dataSet;
-	unsigned int number = (unsigned) myDataSet->GetDataNumber();
-	for( unsigned int i=0; i < number; ++i )
+	const unsigned int first = thread_input->dataBegin;
+	const unsigned int last = thread_input->dataEnd;
+
+	//	Evaluate the whole range in one call to the PDF, if this fails go event by event
+	vector<double> values( last-first, 0. );
+	try
+	{
+		if( last > first ) thread_input->fittingPDF->EvaluateBatch( myDataSet, first, last, &(values[0]) );
+		thread_input->dataPoint_Result.swap( values );
+		return NULL;
+	}
+	catch( ... )
+	{
+	}
+
+	thread_input->dataPoint_Result.clear();
+	for( unsigned int i=first; i < last; ++i )
 	{
 		//pthread_mutex_t* debug_lock = thread_input->fittingPDF->DebugMutex();
 		//cout << i << endl;
@@ -250,18 +368,24 @@ void* MultiThreadedFunctions::Evaluate_pthread( void *input_data )
 		thread_input->dataPoint_Result.push_back( value );
 	}
 
+	return NULL;
+}
+
+void* MultiThreadedFunctions::EvaluateComponent_pthread( void *input_data )
+{
+	MultiThreadedFunctions::EvaluateComponent_task( input_data );
+
 	//      Finished evaluating this thread
 	pthread_exit( NULL );
 }
 
-void* MultiThreadedFunctions::EvaluateComponent_pthread( void *input_data )
+void* MultiThreadedFunctions::EvaluateComponent_task( void *input_data )
 {
 	struct Fitting_Thread *thread_input = (struct Fitting_Thread*) input_data;
 
 	double value=0;
 	IDataSet* myDataSet = thread_input->dataSet;
-	unsigned int number = (unsigned) myDataSet->GetDataNumber();
-	for( unsigned int i=0; i < number; ++i )
+	for( unsigned int i=thread_input->dataBegin; i < thread_input->dataEnd; ++i )
 	{
 		//pthread_mutex_t* debug_lock = thread_input->fittingPDF->DebugMutex();
 		try
@@ -276,11 +400,10 @@ void* MultiThreadedFunctions::EvaluateComponent_pthread( void *input_data )
 		thread_input->dataPoint_Result.push_back( value );
 	}
 
-	//      Finished evaluating this thread
-	pthread_exit( NULL );
+	return NULL;
 }
 
-vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( IPDF* thisFunction, IDataSet* thesePoints, PhaseSpaceBoundary* thisBoundary, unsigned int nThreads )
+vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( IPDF* thisFunction, IDataSet* thesePoints, PhaseSpaceBoundary* thisBoundary, unsigned int nThreads, ThreadPool* workerPool, unsigned int chunkSize )
 {
 	vector<IDataSet*> payLoad;
 	vector<vector<DataPoint*> > datasets_data = Threading::divideData( thesePoints, nThreads );
@@ -300,7 +423,7 @@ vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( IPDF* thisFu
 		boundaries.push_back( new PhaseSpaceBoundary( *thisBoundary ) );
 	}
 
-	vector<double>* returnable = MultiThreadedFunctions::ParallelIntegrate_pthreads( functions, payLoad, boundaries, nThreads );
+	vector<double>* returnable = MultiThreadedFunctions::ParallelIntegrate_pthreads( functions, payLoad, boundaries, nThreads, workerPool, chunkSize );
 
 	//for( unsigned int i=0; i< payLoad.size(); ++i ) if( payLoad[i] != NULL ) delete payLoad[i];
 	//for( unsigned int i=0; i< functions.size(); ++i ) if( functions[i] != NULL ) delete functions[i];
@@ -310,11 +433,35 @@ vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( IPDF* thisFu
 }
 
 void* MultiThreadedFunctions::Integrate_pthread( void *input_data )
+{
+	MultiThreadedFunctions::Integrate_task( input_data );
+
+	//      Finished evaluating this thread
+	pthread_exit( NULL );
+}
+
+void* MultiThreadedFunctions::Integrate_task( void *input_data )
 {
 	struct Fitting_Thread *thread_input = (struct Fitting_Thread*) input_data;
 
 	double value=0;
-	for( unsigned int i=0; i< (unsigned) thread_input->dataSet->GetDataNumber(); ++i )
+
+	//	Integrate the whole range in one call to the PDF, if this fails go event by event
+	const unsigned int first = thread_input->dataBegin;
+	const unsigned int last = thread_input->dataEnd;
+	vector<double> values( last-first, 0. );
+	try
+	{
+		if( last > first ) thread_input->fittingPDF->NormalisationBatch( thread_input->dataSet, first, last, thread_input->FitBoundary, &(values[0]) );
+		thread_input->dataPoint_Result.swap( values );
+		return NULL;
+	}
+	catch( ... )
+	{
+	}
+
+	thread_input->dataPoint_Result.clear();
+	for( unsigned int i=first; i< last; ++i )
 	{
 		//pthread_mutex_t* debug_lock = thread_input->fittingPDF->DebugMutex();
 		try
@@ -329,11 +476,10 @@ void* MultiThreadedFunctions::Integrate_pthread( void *input_data )
 		thread_input->dataPoint_Result.push_back( value );
 	}
 
-	//      Finished evaluating this thread
-	pthread_exit( NULL );
+	return NULL;
 }
 
-vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, vector<PhaseSpaceBoundary*> theseBoundarys, unsigned int nThreads )
+vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( vector<IPDF*> thisFunction, vector<IDataSet*> thesePoints, vector<PhaseSpaceBoundary*> theseBoundarys, unsigned int nThreads, ThreadPool* workerPool, unsigned int chunkSize )
 {
 
 	if(        ( ( ( thisFunction.size() != thesePoints.size() ) || ( thesePoints.size() != theseBoundarys.size() ) ) || ( thisFunction.size() != theseBoundarys.size() ) )
@@ -353,54 +499,19 @@ vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( vector<IPDF*
 		(void) tempVal;
 	}
 
-	//      1 thread per core
-	pthread_t* Thread = MultiThreadedFunctions::GetFittingThreads( nThreads );//new pthread_t[ nThreads ];
-	pthread_attr_t attrib;
-
-	//      Threads HAVE to be joinable
-	//      We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
-	//      Not all pthread implementations are required to obey this as default when constructing the thread _SO_BE_EXPLICIT_
-	pthread_attr_init(&attrib);
-	pthread_attr_setdetachstate(&attrib, PTHREAD_CREATE_JOINABLE);
-
-	Fitting_Thread* fit_thread_data = MultiThreadedFunctions::GetFittingThreadData( nThreads );//new Fitting_Thread[ nThreads ];
+	Fitting_Thread* fit_thread_data = new Fitting_Thread[ nThreads ];
 
 	for( unsigned int i=0; i< nThreads; ++i )
 	{
 		fit_thread_data[i].fittingPDF = thisFunction[i];
 		fit_thread_data[i].dataSet = thesePoints[i];
+		fit_thread_data[i].dataBegin = 0;
+		fit_thread_data[i].dataEnd = (unsigned) thesePoints[i]->GetDataNumber();
 		fit_thread_data[i].FitBoundary = theseBoundarys[i];
-		fit_thread_data[i].dataPoint_Result.clear();
 	}
 
 
-	//cout << "Creating Threads" << endl;
-
-	//      Create the Threads and set them to be joinable
-	for( unsigned int threadnum=0; threadnum< nThreads ; ++threadnum )
-	{
-		int status = pthread_create( &Thread[threadnum], &attrib, MultiThreadedFunctions::Integrate_pthread, (void *) &(fit_thread_data[threadnum]) );
-		if( status )
-		{
-			cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
-			exit(-1);
-		}
-	}
-
-	//cout << "Joining Threads!!" << endl;
-
-	//      Join the Threads
-	for( unsigned int threadnum=0; threadnum< nThreads ; ++threadnum )
-	{
-		int status = pthread_join( Thread[threadnum], NULL);
-		if( status )
-		{
-			cerr << "Error Joining a Thread:\t" << threadnum << "\t:\t" << status << "\t...Exiting\n" << endl;
-		}
-	}
-
-	//      Do some cleaning Up
-	pthread_attr_destroy(&attrib);
+	MultiThreadedFunctions::RunThreads( MultiThreadedFunctions::Integrate_task, MultiThreadedFunctions::Integrate_pthread, fit_thread_data, nThreads, workerPool, chunkSize );
 
 	unsigned int size=0;
 	for( unsigned int i=0; i< thesePoints.size(); ++i ) size+=thesePoints[i]->GetDataNumber();
@@ -417,68 +528,7 @@ vector<double>* MultiThreadedFunctions::ParallelIntegrate_pthreads( vector<IPDF*
 		}
 	}
 
-	//delete[] fit_thread_data;
-	//delete[] Thread;
+	delete[] fit_thread_data;
 	return final_output;
 }
 
-Fitting_Thread* MultiThreadedFunctions::GetFittingThreadData( unsigned int nThreads )
-{
-	if( stored_tread_data == NULL )
-	{
-		stored_thread_data_n = 0;
-
-		stored_tread_data = new Fitting_Thread[ nThreads ];
-		stored_thread_data_n = nThreads;
-		return stored_tread_data;
-	}
-	else
-	{
-		if( stored_thread_data_n == nThreads )
-		{
-			return stored_tread_data;
-		}
-		else
-		{
-			delete[] stored_tread_data;
-			stored_tread_data = new Fitting_Thread[ nThreads ];
-			stored_thread_data_n = nThreads;
-			return stored_tread_data;
-		}
-	}
-}
-
-Fitting_Thread* MultiThreadedFunctions::stored_tread_data = NULL;
-
-unsigned int MultiThreadedFunctions::stored_thread_data_n = 0;
-
-pthread_t* MultiThreadedFunctions::GetFittingThreads( unsigned int nThreads )
-{
-	if( Thread == NULL )
-	{
-		Threads_n = 0;
-
-		Thread = new pthread_t[ nThreads ];
-		Threads_n = nThreads;
-		return Thread;
-	}
-	else
-	{
-		if( Threads_n == nThreads )
-		{
-			return Thread;
-		}
-		else
-		{
-			delete[] Thread;
-			Thread = new pthread_t[ nThreads ];
-			Threads_n = nThreads;
-			return Thread;
-		}
-	}
-}
-
-pthread_t* MultiThreadedFunctions::Thread = NULL;
-
-unsigned int MultiThreadedFunctions::Threads_n = 0;
-
@@ -9,11 +9,16 @@
 
 //	RapidFit Headers
 #include "NegativeLogLikelihood.h"
+#include "CompensatedSum.h"
 //	System Headers
 #include <stdlib.h>
 #include <cmath>
 #include <math.h>
 #include <iostream>
+#include <vector>
+
+//	Number of events handed to the PDF in each call to EvaluateBatch
+#define NLL_BATCH_SIZE 1024
 
 //Default constructor
 NegativeLogLikelihood::NegativeLogLikelihood() : FitFunction()
@@ -34,17 +39,29 @@ double NegativeLogLikelihood::EvaluateDataSet( IPDF * TestPDF, IDataSet * TestDa
 	//ResultIntegrator->UpdateIntegralCache( TestDataSet->GetBoundary() );
 
 	//Loop over all data points
-	double total = 0.0;
+	CompensatedSum total;
 	double integral = 0.0;
 	double weight = 1.0;
 	double value = 0.0;
 	DataPoint* temporaryDataPoint=NULL;
 	//bool flag = false;
 
-	for (int dataIndex = 0; dataIndex < TestDataSet->GetDataNumber(); ++dataIndex)
+	const unsigned int dataNumber = (unsigned) TestDataSet->GetDataNumber();
+	vector<double> values( NLL_BATCH_SIZE, 0. ), integrals( NLL_BATCH_SIZE, 0. );
+	unsigned int batchBegin=0, batchEnd=0;
+
+	for (unsigned int dataIndex = 0; dataIndex < dataNumber; ++dataIndex)
 	{
-		temporaryDataPoint = TestDataSet->GetDataPoint(dataIndex);
-		value = TestPDF->Evaluate(temporaryDataPoint);
+		//	Evaluate the PDF for the next block of events in one go
+		if( dataIndex == batchEnd )
+		{
+			batchBegin = dataIndex;
+			batchEnd = ( dataNumber - batchBegin > NLL_BATCH_SIZE ) ? batchBegin + NLL_BATCH_SIZE : dataNumber;
+			TestPDF->EvaluateBatch( TestDataSet, batchBegin, batchEnd, &(values[0]) );
+			TestPDF->NormalisationBatch( TestDataSet, batchBegin, batchEnd, TestDataSet->GetBoundary(), &(integrals[0]) );
+		}
+
+		value = values[dataIndex-batchBegin];
 
 		if( DebugClass::DebugThisClass( "NegativeLogLikelihood" ) ) cout << "V: " << value << endl;
 		//Idiot check
@@ -58,7 +75,7 @@ double NegativeLogLikelihood::EvaluateDataSet( IPDF * TestPDF, IDataSet * TestDa
 		//flag = ( (value < 0) || isnan(value) );
 		
 		//Find out the integral
-		integral = TestPDF->Integral( temporaryDataPoint, TestDataSet->GetBoundary() );
+		integral = integrals[dataIndex-batchBegin];
 		
 		if( DebugClass::DebugThisClass( "NegativeLogLikelihood" ) ) cout << "I: " << integral << endl;
 
@@ -66,6 +83,7 @@ double NegativeLogLikelihood::EvaluateDataSet( IPDF * TestPDF, IDataSet * TestDa
 		weight = 1.0;
 		if( useWeights )
 		{
+			temporaryDataPoint = TestDataSet->GetDataPoint( (int)dataIndex );
 			weight = temporaryDataPoint->GetEventWeight();
 		}
 
@@ -74,15 +92,59 @@ double NegativeLogLikelihood::EvaluateDataSet( IPDF * TestPDF, IDataSet * TestDa
 		if( useWeights ) pointValue *= weight;
 		if( useWeights && weightsSquared ) pointValue *= weight;
 
-		total+=pointValue;
+		total.Add( pointValue );
 
-		//cout << total << " " << value << " " << integral << endl;
+		//cout << total.Sum() << " " << value << " " << integral << endl;
 	}
 
 	if( false ) cerr << "PDF evaluates to " << value << endl;
 
 	//Return negative log likelihood
-	return -total;
+	return -total.Sum();
+}
+
+bool NegativeLogLikelihood::ProvidesDataSetGradient() const
+{
+	return true;
+}
+
+//Return the derivative of the negative log likelihood wrt each of the named parameters
+bool NegativeLogLikelihood::EvaluateDataSetGradient( IPDF * TestPDF, IDataSet * TestDataSet, int number, const vector<string>& Names, vector<double>& output )
+{
+	(void)number;
+	output = vector<double>( Names.size(), 0. );
+	if( Names.empty() ) return true;
+
+	vector<double> valueGradient( Names.size(), 0. ), integralGradient( Names.size(), 0. );
+	PhaseSpaceBoundary* thisBoundary = TestDataSet->GetBoundary();
+
+	const int dataNumber = TestDataSet->GetDataNumber();
+	for( int dataIndex = 0; dataIndex < dataNumber; ++dataIndex )
+	{
+		DataPoint* thisPoint = TestDataSet->GetDataPoint( dataIndex );
+
+		double value = TestPDF->Evaluate( thisPoint );
+		double integral = TestPDF->Integral( thisPoint, thisBoundary );
+		if( std::isnan(value) || std::isnan(integral) || value <= 0. || integral <= 0. ) return false;
+
+		if( !TestPDF->EvaluateGradient( thisPoint, Names, &(valueGradient[0]) ) ) return false;
+		if( !TestPDF->IntegralGradient( thisPoint, thisBoundary, Names, &(integralGradient[0]) ) ) return false;
+
+		double weight = 1.0;
+		if( useWeights )
+		{
+			weight = thisPoint->GetEventWeight();
+			if( weightsSquared ) weight *= weight;
+		}
+
+		//	d/dx -log( f/N ) = -( f'/f - N'/N )
+		for( unsigned int i=0; i< Names.size(); ++i )
+		{
+			output[i] -= weight * ( valueGradient[i] / value - integralGradient[i] / integral );
+		}
+	}
+
+	return true;
 }
 
 //Return the up value for error calculations
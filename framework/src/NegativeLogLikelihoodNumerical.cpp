@@ -82,7 +82,9 @@ double NegativeLogLikelihoodNumerical::EvaluateDataSet( IPDF * FittingPDF, IData
 	//	Initialize the Fitting_Thread objects which contain the objects to be passed to each thread
 	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
 	{
-		fit_thread_data[threadnum].dataSubSet = StoredDataSubSet[(unsigned)number][threadnum];
+		fit_thread_data[threadnum].dataSet = TotalDataSet;
+		fit_thread_data[threadnum].dataBegin = StoredDataRanges[(unsigned)number][threadnum].first;
+		fit_thread_data[threadnum].dataEnd = StoredDataRanges[(unsigned)number][threadnum].second;
 		fit_thread_data[threadnum].fittingPDF = stored_pdfs[((unsigned)number)*(unsigned)Threads + threadnum];
 		fit_thread_data[threadnum].useWeights = useWeights;					//	Defined in the fitfunction baseclass
 		fit_thread_data[threadnum].FitBoundary = StoredBoundary[(unsigned)Threads*((unsigned)number)+threadnum];
@@ -155,11 +157,12 @@ void* NegativeLogLikelihoodNumerical::ThreadWork( void *input_data )
 	//TNtuple * ntuple = new TNtuple("test_good","test", "value");
 	//TNtuple * ntuple = new TNtuple("integral","test", "integral");
 	//bool isnorm = thread_input->fittingPDF->GetName()=="NormalisedSum";
-	for( vector<DataPoint*>::iterator data_i=thread_input->dataSubSet.begin(); data_i != thread_input->dataSubSet.end(); ++data_i, ++num )
+	for( unsigned int index=thread_input->dataBegin; index< thread_input->dataEnd; ++index, ++num )
 	{
+		DataPoint* thisPoint = thread_input->dataSet->GetDataPoint( (int)index );
 		try
 		{
-			value = thread_input->fittingPDF->Evaluate( *data_i );
+			value = thread_input->fittingPDF->Evaluate( thisPoint );
 		}
 		catch( ... )
 		{
@@ -179,28 +182,28 @@ void* NegativeLogLikelihoodNumerical::ThreadWork( void *input_data )
 		{
 			thread_input->dataPoint_Result.push_back( DBL_MAX );
 			cout << endl << "PDF is nan" << endl;
-			(*data_i)->Print();
+			thisPoint->Print();
 			break;
 		}
 		if( std::isnan(integral) == true )
 		{
 			thread_input->dataPoint_Result.push_back( DBL_MAX );
 			cout << endl << "Integral is nan" << endl;
-			(*data_i)->Print();
+			thisPoint->Print();
 			break;
 		}
 		if( value <= 0 )
 		{
 			thread_input->dataPoint_Result.push_back( DBL_MAX );
 			cout << endl << "Value is <=0 " << value << endl;
-			(*data_i)->Print();
+			thisPoint->Print();
 			break;
 		}
 		if( integral <= 0 )
 		{
 			thread_input->dataPoint_Result.push_back( DBL_MAX );
 			cout << endl << "Integral is <= 0 " << integral << endl;
-			(*data_i)->Print();
+			thisPoint->Print();
 			break;
 		}
 
@@ -208,7 +211,7 @@ void* NegativeLogLikelihoodNumerical::ThreadWork( void *input_data )
 		{
 			thread_input->dataPoint_Result.push_back( DBL_MAX );
 			cerr << endl << "Caught invalid value from PDF" << endl;
-			(*data_i)->Print();
+			thisPoint->Print();
 			break;
 		}
 
@@ -221,7 +224,7 @@ void* NegativeLogLikelihoodNumerical::ThreadWork( void *input_data )
 		//	If we have a weighted dataset then weight the result (if not don't perform a *1.)
 		if( thread_input->useWeights == true )
 		{
-			weight = (*data_i)->GetEventWeight();
+			weight = thisPoint->GetEventWeight();
 			//pthread_mutex_lock( &_n_eval_lock );
 			result *= weight;
 			if( thread_input->weightsSquared ) result *= weight;
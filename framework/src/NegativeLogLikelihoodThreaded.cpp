@@ -23,7 +23,9 @@
 //	RapidFit Headers
 #include "NegativeLogLikelihoodThreaded.h"
 #include "ClassLookUp.h"
+#include "ThreadPool.h"
 #include "IPDF.h"
+#include "ColumnarDataSet.h"
 //	System Headers
 #include <stdlib.h>
 #include <cmath>
@@ -31,19 +33,45 @@
 #include <iostream>
 #include <pthread.h>
 #include <float.h>
+#include <time.h>
 #include <algorithm>
+#include <functional>
+#include <utility>
 
 using namespace::std;
 
 pthread_mutex_t eval_lock;
 
-bool NLLSort( double val1, double val2 )
+namespace
 {
-	return fabs(val1) < fabs(val2);
+	//	Slices of the DataSets handed to one worker of the ThreadPool by EvaluateAllDataSets
+	struct SliceBundle
+	{
+		vector<Fitting_Thread*> slices;
+		vector<unsigned int> sliceIndex;	/*!	Position of each slice in allSlices		*/
+		vector<double> seconds;			/*!	Time taken to evaluate each slice		*/
+	};
+
+	//	Chunk of a DataSet which can be evaluated by any of the workers of the ThreadPool
+	struct ChunkTask
+	{
+		NegativeLogLikelihoodThreaded* owner;
+		Fitting_Thread* chunk;
+		unsigned int number;			/*!	Index of the DataSet within the PhysicsBottle	*/
+		bool gradient;				/*!	Evaluate the derivatives rather than the NLL	*/
+	};
+
+	//	Event index of the DataSet as a DataPoint, through the re-used rowView if one has been made for this ColumnarDataSet
+	DataPoint* ReadEvent( IDataSet* data, ColumnarDataSet* columnarData, DataPoint* rowView, const unsigned int index )
+	{
+		if( rowView == NULL ) return data->GetDataPoint( (int)index );
+		columnarData->FillRowView( index, *rowView );
+		return rowView;
+	}
 }
 
 //Default constructor
-NegativeLogLikelihoodThreaded::NegativeLogLikelihoodThreaded() : FitFunction()
+NegativeLogLikelihoodThreaded::NegativeLogLikelihoodThreaded() : FitFunction(), allSlices(NULL), sliceCost(), sliceCostMeasured(false), chunkData(), numberChunks()
 {
 	Name="NegativeLogLikelihoodThreaded";
 }
@@ -51,6 +79,12 @@ NegativeLogLikelihoodThreaded::NegativeLogLikelihoodThreaded() : FitFunction()
 //Destructor
 NegativeLogLikelihoodThreaded::~NegativeLogLikelihoodThreaded()
 {
+	if( allSlices != NULL ) delete [] allSlices;
+	while( !chunkData.empty() )
+	{
+		if( chunkData.back() != NULL ) delete [] chunkData.back();
+		chunkData.pop_back();
+	}
 }
 
 //Return the negative log likelihood for a PDF/DataSet result
@@ -66,16 +100,6 @@ double NegativeLogLikelihoodThreaded::EvaluateDataSet( IPDF * FittingPDF, IDataS
 		exit(-125);
 	}
 
-	//	1 thread per core
-	pthread_t* Thread = new pthread_t[ (unsigned)Threads ];
-	pthread_attr_t attrib;
-
-	//	Threads HAVE to be joinable
-	//	We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
-	//	Not all pthread implementations are required to obey this as default when constructing the thread _SO_BE_EXPLICIT_
-	pthread_attr_init(&attrib);
-	pthread_attr_setdetachstate(&attrib, PTHREAD_CREATE_JOINABLE);
-
 	//cout << "Setup Threads: " << Threads << endl;
 	ObservableRef weightObservableRef( weightObservableName );
 
@@ -95,127 +119,549 @@ double NegativeLogLikelihoodThreaded::EvaluateDataSet( IPDF * FittingPDF, IDataS
 	   }
 	   */
 
+	//	Hand out many small chunks instead of one slice per thread
+	if( chunkSize > 0 && workerPool != NULL )
+	{
+		this->MakeChunks( TotalDataSet, (unsigned)number );
+		if( this->EvaluateChunks( vector<unsigned int>( 1, (unsigned)number ) ) )
+		{
+			return this->CombineThreadData( chunkData[(unsigned)number], numberChunks[(unsigned)number] );
+		}
+	}
+
 	//	Initialize the Fitting_Thread objects which contain the objects to be passed to each thread
-	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
+	this->PrepareThreadData( fit_thread_data, TotalDataSet, number );
+
+	//	Wake the persistent workers owned by the FitFunction, this only fails if they are busy elsewhere
+	bool ranOnPool = false;
+	if( workerPool != NULL )
+	{
+		vector<void*> taskInput( (unsigned)Threads, NULL );
+		for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
+		{
+			taskInput[threadnum] = (void*) &fit_thread_data[threadnum];
+		}
+		ranOnPool = workerPool->Execute( this->EvaluateSubSet, &(taskInput[0]), (unsigned)Threads );
+	}
+
+	if( !ranOnPool )
 	{
-		fit_thread_data[threadnum].dataSubSet = StoredDataSubSet[(unsigned)number][threadnum];
-		fit_thread_data[threadnum].fittingPDF = stored_pdfs[((unsigned)number)*(unsigned)Threads + threadnum];
-		fit_thread_data[threadnum].fittingPDF->SetDebugMutex( &eval_lock, false );
-		fit_thread_data[threadnum].useWeights = useWeights;					//	Defined in the fitfunction baseclass
-		fit_thread_data[threadnum].FitBoundary = StoredBoundary[(unsigned)Threads*((unsigned)number)+threadnum];
-		fit_thread_data[threadnum].dataPoint_Result = vector<double>();
-		fit_thread_data[threadnum].weightsSquared = weightsSquared;
+		//	1 thread per core
+		pthread_t* Thread = new pthread_t[ (unsigned)Threads ];
+		pthread_attr_t attrib;
+
+		//	Threads HAVE to be joinable
+		//	We CANNOT _AND_SHOULD_NOT_ ***EVER*** return information to Minuit without the results from ALL threads successfully returned
+		//	Not all pthread implementations are required to obey this as default when constructing the thread _SO_BE_EXPLICIT_
+		pthread_attr_init(&attrib);
+		pthread_attr_setdetachstate(&attrib, PTHREAD_CREATE_JOINABLE);
+
+		//cout << "Creating Threads" << endl;
+
+		//	Create the Threads and set them to be joinable
+		for( unsigned int threadnum=0; threadnum< (unsigned)Threads ; ++threadnum )
+		{
+			int status = pthread_create(&Thread[threadnum], &attrib, this->ThreadWork, (void *) &fit_thread_data[threadnum] );
+			if( status )
+			{
+				cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
+				exit(-1);
+			}
+		}
+
+		//cout << "Joining Threads!!" << endl;
+
+		//	Join the Threads
+		for( unsigned int threadnum=0; threadnum< (unsigned)Threads ; ++threadnum )
+		{
+			int status = pthread_join( Thread[threadnum], NULL);
+			if( status )
+			{
+				cerr << "Error Joining a Thread:\t" << threadnum << "\t:\t" << status << "\t...Exiting\n" << endl;
+			}
+		}
+
+		//      Do some cleaning Up
+		pthread_attr_destroy(&attrib);
+
+		delete [] Thread;
 	}
 
-	//cout << "Creating Threads" << endl;
+	//cout << "Leaving Threads" << endl;
+
+	return this->CombineThreadData( fit_thread_data, (unsigned)Threads );
+}
 
-	//	Create the Threads and set them to be joinable
-	for( unsigned int threadnum=0; threadnum< (unsigned)Threads ; ++threadnum )
+double NegativeLogLikelihoodThreaded::CombineThreadData( const Fitting_Thread* threadData, const unsigned int nThreadData ) const
+{
+	//	Each block of events is only ever summed by one thread and the slices are in order, so adding the block sums
+	//	in this order gives the same result however many threads or chunks the DataSet was split between
+	CompensatedSum total;
+	for( unsigned int threadnum=0; threadnum< nThreadData; ++threadnum )
 	{
-		int status = pthread_create(&Thread[threadnum], &attrib, this->ThreadWork, (void *) &fit_thread_data[threadnum] );
-		if( status )
+		if( !threadData[threadnum].NLL_Valid )
+		{
+			return DBL_MAX;
+		}
+		const vector<CompensatedSum>& blocks = threadData[threadnum].NLL_Blocks;
+		for( vector<CompensatedSum>::const_iterator block_i = blocks.begin(); block_i != blocks.end(); ++block_i )
 		{
-			cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
-			exit(-1);
+			total.Add( *block_i );
 		}
 	}
 
-	//cout << "Joining Threads!!" << endl;
+	if( std::isnan( total.Sum() ) || fabs( total.Sum() ) >= DBL_MAX )
+	{
+		return DBL_MAX;
+	}
+
+	//cout << total.Sum() << endl;
+	//exit(0);
+
+	return -total.Sum();
+}
+
+bool NegativeLogLikelihoodThreaded::EvaluateAllDataSets( vector<double>& output )
+{
+	const unsigned int nResults = (unsigned) allData->NumberResults();
+
+	//	With a single DataSet or a single thread there is nothing to gain over EvaluateDataSet
+	if( workerPool == NULL || Threads <= 1 || nResults < 2 ) return false;
 
-	//	Join the Threads
-	for( unsigned int threadnum=0; threadnum< (unsigned)Threads ; ++threadnum )
+	const unsigned int nThreads = (unsigned) Threads;
+
+	if( chunkSize > 0 )
 	{
-		int status = pthread_join( Thread[threadnum], NULL);
-		if( status )
+		vector<unsigned int> numbers;
+		for( unsigned int resultIndex=0; resultIndex< nResults; ++resultIndex )
+		{
+			IDataSet* thisDataSet = allData->GetResultDataSet( (int)resultIndex );
+			if( thisDataSet->GetDataNumber() == 0 ) continue;
+			this->MakeChunks( thisDataSet, resultIndex );
+			numbers.push_back( resultIndex );
+		}
+
+		if( !this->EvaluateChunks( numbers ) ) return false;
+
+		output = vector<double>( nResults, 0. );
+		for( unsigned int resultNum=0; resultNum< numbers.size(); ++resultNum )
 		{
-			cerr << "Error Joining a Thread:\t" << threadnum << "\t:\t" << status << "\t...Exiting\n" << endl;
+			output[numbers[resultNum]] = this->CombineThreadData( chunkData[numbers[resultNum]], numberChunks[numbers[resultNum]] );
 		}
+		return true;
 	}
 
-	//      Do some cleaning Up
-	pthread_attr_destroy(&attrib);
+	if( allSlices == NULL )
+	{
+		allSlices = new Fitting_Thread[ nResults*nThreads ];
+		sliceCost = vector<double>( nResults*nThreads, 0. );
+	}
 
-	//cout << "Leaving Threads" << endl;
+	//	Every slice of every DataSet has its own copy of the PDF so they can all be evaluated at the same time
+	vector<pair<double,unsigned int> > order;
+	for( unsigned int resultIndex=0; resultIndex< nResults; ++resultIndex )
+	{
+		IDataSet* thisDataSet = allData->GetResultDataSet( (int)resultIndex );
+		if( thisDataSet->GetDataNumber() == 0 ) continue;
+
+		this->PrepareThreadData( &(allSlices[resultIndex*nThreads]), thisDataSet, (int)resultIndex );
+		for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
+		{
+			const unsigned int sliceNum = resultIndex*nThreads + threadnum;
+			if( !sliceCostMeasured ) sliceCost[sliceNum] = (double)( allSlices[sliceNum].dataEnd - allSlices[sliceNum].dataBegin );
+			order.push_back( make_pair( sliceCost[sliceNum], sliceNum ) );
+		}
+	}
+
+	//	Longest slices first, each to the worker with the least work so far
+	sort( order.begin(), order.end(), greater<pair<double,unsigned int> >() );
+	vector<SliceBundle> bundles( nThreads );
+	vector<double> load( nThreads, 0. );
+	for( vector<pair<double,unsigned int> >::iterator slice_i = order.begin(); slice_i != order.end(); ++slice_i )
+	{
+		const unsigned int worker = (unsigned)( min_element( load.begin(), load.end() ) - load.begin() );
+		bundles[worker].slices.push_back( &(allSlices[slice_i->second]) );
+		bundles[worker].sliceIndex.push_back( slice_i->second );
+		bundles[worker].seconds.push_back( 0. );
+		load[worker] += slice_i->first;
+	}
+
+	vector<void*> taskInput( nThreads, NULL );
+	for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
+	{
+		taskInput[threadnum] = (void*) &(bundles[threadnum]);
+	}
 
-	double total=0;
+	//	The pool is busy elsewhere, fall back to evaluating each DataSet in turn
+	if( !workerPool->Execute( this->EvaluateSlices, &(taskInput[0]), nThreads ) ) return false;
 
-	vector<double> NLLValues;
+	for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
+	{
+		for( unsigned int sliceNum=0; sliceNum< bundles[threadnum].sliceIndex.size(); ++sliceNum )
+		{
+			sliceCost[ bundles[threadnum].sliceIndex[sliceNum] ] = bundles[threadnum].seconds[sliceNum];
+		}
+	}
+	sliceCostMeasured = true;
+
+	output = vector<double>( nResults, 0. );
+	for( unsigned int resultIndex=0; resultIndex< nResults; ++resultIndex )
+	{
+		if( allData->GetResultDataSet( (int)resultIndex )->GetDataNumber() == 0 ) continue;
+		output[resultIndex] = this->CombineThreadData( &(allSlices[resultIndex*nThreads]), nThreads );
+	}
+
+	return true;
+}
+
+void* NegativeLogLikelihoodThreaded::EvaluateSlices( void* input_data )
+{
+	SliceBundle* thisBundle = (SliceBundle*) input_data;
+
+	for( unsigned int sliceNum=0; sliceNum< thisBundle->slices.size(); ++sliceNum )
+	{
+		timespec start, end;
+		clock_gettime( CLOCK_MONOTONIC, &start );
+		NegativeLogLikelihoodThreaded::EvaluateSubSet( (void*) thisBundle->slices[sliceNum] );
+		clock_gettime( CLOCK_MONOTONIC, &end );
+		thisBundle->seconds[sliceNum] = (double)( end.tv_sec - start.tv_sec ) + 1E-9 * (double)( end.tv_nsec - start.tv_nsec );
+	}
+
+	return NULL;
+}
+
+void NegativeLogLikelihoodThreaded::MakeChunks( IDataSet* TotalDataSet, const unsigned int number )
+{
+	if( chunkData.size() <= number )
+	{
+		chunkData.resize( number+1, NULL );
+		numberChunks.resize( number+1, 0 );
+	}
+	if( chunkData[number] != NULL ) return;
+
+	//	Chunks are whole blocks of events, see CombineThreadData
+	const unsigned int blockSize = Threading::EventsPerBlock();
+	const unsigned int thisChunkSize = ( ( chunkSize + blockSize - 1 ) / blockSize ) * blockSize;
+
+	const unsigned int nPoints = (unsigned) TotalDataSet->GetDataNumber();
+	numberChunks[number] = ( nPoints + thisChunkSize - 1 ) / thisChunkSize;
+	if( numberChunks[number] == 0 ) numberChunks[number] = 1;
+	chunkData[number] = new Fitting_Thread[ numberChunks[number] ];
+
+	for( unsigned int chunkNum=0; chunkNum< numberChunks[number]; ++chunkNum )
+	{
+		Fitting_Thread* thisChunk = &(chunkData[number][chunkNum]);
+		thisChunk->dataBegin = chunkNum * thisChunkSize;
+		thisChunk->dataEnd = thisChunk->dataBegin + thisChunkSize;
+		if( thisChunk->dataEnd > nPoints ) thisChunk->dataEnd = nPoints;
+		if( thisChunk->dataBegin > nPoints ) thisChunk->dataBegin = nPoints;
+		thisChunk->dataSet = TotalDataSet;
+	}
 
 	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
 	{
-		for( unsigned int point_num=0; point_num< fit_thread_data[threadnum].dataPoint_Result.size(); ++point_num )
+		stored_pdfs[number*(unsigned)Threads + threadnum]->SetDebugMutex( &eval_lock, false );
+	}
+
+	if( DebugClass::DebugThisClass( "FitFunction" ) )
+	{
+		cout << "NegativeLogLikelihoodThreaded: DataSet " << number+1 << " split into " << numberChunks[number] << " chunks of up to " << thisChunkSize << " events" << endl;
+	}
+}
+
+bool NegativeLogLikelihoodThreaded::EvaluateChunks( const vector<unsigned int>& numbers, const vector<string>* gradientNames )
+{
+	vector<ChunkTask> tasks;
+	for( unsigned int resultNum=0; resultNum< numbers.size(); ++resultNum )
+	{
+		const unsigned int number = numbers[resultNum];
+		for( unsigned int chunkNum=0; chunkNum< numberChunks[number]; ++chunkNum )
 		{
-			if( fabs(fit_thread_data[threadnum].dataPoint_Result[ point_num ]) >= DBL_MAX )
+			Fitting_Thread* thisChunk = &(chunkData[number][chunkNum]);
+			thisChunk->dataSet = allData->GetResultDataSet( (int)number );
+			thisChunk->useWeights = useWeights;
+			thisChunk->weightsSquared = weightsSquared;
+			thisChunk->offSetNLL = this->GetOffSetNLL();
+			thisChunk->NLL_Blocks.clear();
+			thisChunk->NLL_Valid = true;
+			if( gradientNames != NULL )
 			{
-				return DBL_MAX;
+				thisChunk->gradientNames = *gradientNames;
+				thisChunk->gradient_Result = vector<double>( gradientNames->size(), 0. );
+				thisChunk->gradientValid = true;
 			}
 
-			DataPoint* thisPoint = fit_thread_data[threadnum].dataSubSet[ point_num ];
+			ChunkTask thisTask;
+			thisTask.owner = this;
+			thisTask.chunk = thisChunk;
+			thisTask.number = number;
+			thisTask.gradient = ( gradientNames != NULL );
+			tasks.push_back( thisTask );
+		}
+	}
 
-			if( this->GetOffSetNLL() && !std::isnan(thisPoint->GetInitialNLL()) )
-			{
-				NLLValues.push_back(fit_thread_data[threadnum].dataPoint_Result[ point_num ] - thisPoint->GetInitialNLL() );
-			}
-			else
+	if( tasks.empty() ) return true;
+
+	vector<void*> taskInput( tasks.size(), NULL );
+	for( unsigned int taskNum=0; taskNum< tasks.size(); ++taskNum )
+	{
+		taskInput[taskNum] = (void*) &(tasks[taskNum]);
+	}
+
+	return workerPool->Execute( this->EvaluateChunk, &(taskInput[0]), (unsigned) tasks.size() );
+}
+
+void* NegativeLogLikelihoodThreaded::EvaluateChunk( void* input_data )
+{
+	ChunkTask* thisTask = (ChunkTask*) input_data;
+	NegativeLogLikelihoodThreaded* owner = thisTask->owner;
+
+	//	Each worker has its own copy of the PDF for each DataSet
+	int worker = owner->workerPool->GetWorkerIndex();
+	if( worker < 0 ) worker = 0;
+	const unsigned int slot = thisTask->number*(unsigned)owner->Threads + (unsigned)worker;
+
+	thisTask->chunk->fittingPDF = owner->stored_pdfs[slot];
+	thisTask->chunk->FitBoundary = owner->StoredBoundary[slot];
+
+	if( thisTask->gradient ) return NegativeLogLikelihoodThreaded::EvaluateSubSetGradient( (void*) thisTask->chunk );
+	return NegativeLogLikelihoodThreaded::EvaluateSubSet( (void*) thisTask->chunk );
+}
+
+void NegativeLogLikelihoodThreaded::PrepareThreadData( Fitting_Thread* threadData, IDataSet* TotalDataSet, const int number )
+{
+	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
+	{
+		//	The slices are contiguous ranges of the DataSet, see Threading::divideRanges
+		threadData[threadnum].dataSet = TotalDataSet;
+		threadData[threadnum].dataBegin = StoredDataRanges[(unsigned)number][threadnum].first;
+		threadData[threadnum].dataEnd = StoredDataRanges[(unsigned)number][threadnum].second;
+		threadData[threadnum].fittingPDF = stored_pdfs[((unsigned)number)*(unsigned)Threads + threadnum];
+		threadData[threadnum].fittingPDF->SetDebugMutex( &eval_lock, false );
+		threadData[threadnum].useWeights = useWeights;					//	Defined in the fitfunction baseclass
+		threadData[threadnum].FitBoundary = StoredBoundary[(unsigned)Threads*((unsigned)number)+threadnum];
+		threadData[threadnum].NLL_Blocks.clear();
+		threadData[threadnum].NLL_Valid = true;
+		threadData[threadnum].offSetNLL = this->GetOffSetNLL();
+		threadData[threadnum].weightsSquared = weightsSquared;
+	}
+}
+
+bool NegativeLogLikelihoodThreaded::ProvidesDataSetGradient() const
+{
+	return true;
+}
+
+//Return the derivative of the negative log likelihood wrt each of the named parameters
+bool NegativeLogLikelihoodThreaded::EvaluateDataSetGradient( IPDF * FittingPDF, IDataSet * TotalDataSet, int number, const vector<string>& Names, vector<double>& output )
+{
+	(void) FittingPDF;
+
+	output = vector<double>( Names.size(), 0. );
+	if( Names.empty() || TotalDataSet->GetDataNumber() == 0 ) return true;
+
+	//	Same chunks as the NLL, summed in chunk order so the result doesn't depend on which worker ran each chunk
+	if( chunkSize > 0 && workerPool != NULL )
+	{
+		this->MakeChunks( TotalDataSet, (unsigned)number );
+		if( this->EvaluateChunks( vector<unsigned int>( 1, (unsigned)number ), &Names ) )
+		{
+			bool success = true;
+			for( unsigned int chunkNum=0; chunkNum< numberChunks[(unsigned)number]; ++chunkNum )
 			{
-				if( this->GetOffSetNLL() )
+				Fitting_Thread* thisChunk = &(chunkData[(unsigned)number][chunkNum]);
+				if( !thisChunk->gradientValid ) success = false;
+				for( unsigned int i=0; i< Names.size(); ++i )
 				{
-					NLLValues.push_back( 0. );
-					thisPoint->SetInitialNLL( fit_thread_data[threadnum].dataPoint_Result[ point_num ] );
-				}
-				else
-				{
-					NLLValues.push_back( fit_thread_data[threadnum].dataPoint_Result[ point_num ] );
+					output[i] -= thisChunk->gradient_Result[i];
 				}
+				vector<double> empty;
+				thisChunk->gradient_Result.swap( empty );
 			}
+			return success;
+		}
+	}
 
+	this->PrepareThreadData( fit_thread_data, TotalDataSet, number );
+	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
+	{
+		fit_thread_data[threadnum].gradientNames = Names;
+		fit_thread_data[threadnum].gradient_Result = vector<double>( Names.size(), 0. );
+		fit_thread_data[threadnum].gradientValid = true;
+	}
+
+	bool ranOnPool = false;
+	if( workerPool != NULL )
+	{
+		vector<void*> taskInput( (unsigned)Threads, NULL );
+		for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
+		{
+			taskInput[threadnum] = (void*) &fit_thread_data[threadnum];
 		}
-		vector<double> empty;
-		fit_thread_data[threadnum].dataPoint_Result.swap( empty );
+		ranOnPool = workerPool->Execute( this->EvaluateSubSetGradient, &(taskInput[0]), (unsigned)Threads );
 	}
 
-	sort( NLLValues.begin(), NLLValues.end(), NLLSort );
+	//	The pool is busy elsewhere, gradient calls are rare enough to just do the work here
+	if( !ranOnPool )
+	{
+		for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
+		{
+			NegativeLogLikelihoodThreaded::EvaluateSubSetGradient( (void*) &fit_thread_data[threadnum] );
+		}
+	}
 
-	for( vector<double>::iterator this_i = NLLValues.begin(); this_i != NLLValues.end(); ++this_i )
+	bool success = true;
+	for( unsigned int threadnum=0; threadnum< (unsigned)Threads; ++threadnum )
 	{
-		total+=*this_i;
+		if( !fit_thread_data[threadnum].gradientValid ) success = false;
+		for( unsigned int i=0; i< Names.size(); ++i )
+		{
+			output[i] -= fit_thread_data[threadnum].gradient_Result[i];
+		}
+		vector<double> empty;
+		fit_thread_data[threadnum].gradient_Result.swap( empty );
 	}
 
-	delete [] Thread;
+	return success;
+}
 
-	//cout << total << endl;
-	//exit(0);
+void* NegativeLogLikelihoodThreaded::EvaluateSubSetGradient( void *input_data )
+{
+	struct Fitting_Thread *thread_input = (struct Fitting_Thread*) input_data;
+
+	const vector<string>& Names = thread_input->gradientNames;
+	vector<double> valueGradient( Names.size(), 0. ), integralGradient( Names.size(), 0. );
+
+	ColumnarDataSet* columnarData = dynamic_cast<ColumnarDataSet*>( thread_input->dataSet );
+	DataPoint rowView;
+	const bool useRowView = columnarData != NULL && !columnarData->DataPointsBuilt();
+	if( useRowView ) rowView = columnarData->MakeRowView();
+
+	for( unsigned int index=thread_input->dataBegin; index< thread_input->dataEnd; ++index )
+	{
+		DataPoint* thisPoint = ReadEvent( thread_input->dataSet, columnarData, useRowView ? &rowView : NULL, index );
+		double value=0., integral=0.;
+		try
+		{
+			value = thread_input->fittingPDF->Evaluate( thisPoint );
+			integral = thread_input->fittingPDF->Integral( thisPoint, thread_input->FitBoundary );
+
+			if( std::isnan(value) || std::isnan(integral) || value <= 0. || integral <= 0. || value >= DBL_MAX || integral >= DBL_MAX )
+			{
+				thread_input->gradientValid = false;
+				break;
+			}
 
-	return -total;
+			if( !thread_input->fittingPDF->EvaluateGradient( thisPoint, Names, &(valueGradient[0]) ) ||
+				!thread_input->fittingPDF->IntegralGradient( thisPoint, thread_input->FitBoundary, Names, &(integralGradient[0]) ) )
+			{
+				thread_input->gradientValid = false;
+				break;
+			}
+		}
+		catch( ... )
+		{
+			thread_input->gradientValid = false;
+			break;
+		}
+
+		//	Same weighting as in EvaluateSubSet
+		double weight = 1.;
+		if( thread_input->useWeights == true )
+		{
+			weight = thisPoint->GetEventWeight();
+			if( thread_input->weightsSquared ) weight *= fabs( weight );
+		}
+
+		//	d/dx log( f/N ) = f'/f - N'/N
+		for( unsigned int i=0; i< Names.size(); ++i )
+		{
+			thread_input->gradient_Result[i] += weight * ( valueGradient[i] / value - integralGradient[i] / integral );
+		}
+	}
+
+	return NULL;
 }
 
 void* NegativeLogLikelihoodThreaded::ThreadWork( void *input_data )
+{
+	NegativeLogLikelihoodThreaded::EvaluateSubSet( input_data );
+
+	//	Finished evaluating this thread
+	pthread_exit( NULL );
+}
+
+void* NegativeLogLikelihoodThreaded::EvaluateSubSet( void *input_data )
 {
 	struct Fitting_Thread *thread_input = (struct Fitting_Thread*) input_data;
 
 	double value=0, weight=0, integral=0, result=0;
-	int num=0;
-	//bool isnorm = thread_input->fittingPDF->GetName()=="NormalisedSum";
-	for( vector<DataPoint*>::iterator data_i=thread_input->dataSubSet.begin(); data_i != thread_input->dataSubSet.end(); ++data_i, ++num )
+	unsigned int num=0;
+
+	//	Sum each block of events separately, see CombineThreadData
+	const unsigned int blockSize = Threading::EventsPerBlock();
+	unsigned int thisBlock = thread_input->dataBegin / blockSize;
+	CompensatedSum blockSum;
+
+	//	Evaluate the whole chunk in one call to the PDF where possible
+	const unsigned int nPoints = thread_input->dataEnd > thread_input->dataBegin ? thread_input->dataEnd - thread_input->dataBegin : 0;
+	vector<double> values( nPoints, 0. ), integrals( nPoints, 0. );
+	bool batched = false;
+	if( nPoints > 0 && thread_input->dataSet != NULL )
 	{
-
-		pthread_mutex_t* debug_lock = thread_input->fittingPDF->DebugMutex();
 		try
 		{
-			value = thread_input->fittingPDF->Evaluate( *data_i );
+			thread_input->fittingPDF->EvaluateBatch( thread_input->dataSet, thread_input->dataBegin, thread_input->dataEnd, &(values[0]) );
+			thread_input->fittingPDF->NormalisationBatch( thread_input->dataSet, thread_input->dataBegin, thread_input->dataEnd, thread_input->FitBoundary, &(integrals[0]) );
+			batched = true;
 		}
 		catch( ... )
 		{
-			value = DBL_MAX;
+			//	Re-evaluate event by event below so that the offending event is reported
+			batched = false;
 		}
+	}
 
-		try
+	//	The weights and offsets of columnar data are read directly, so a batched PDF never needs the events as DataPoints
+	ColumnarDataSet* columnarData = dynamic_cast<ColumnarDataSet*>( thread_input->dataSet );
+	const double* eventWeights = columnarData != NULL ? columnarData->GetEventWeights() : NULL;
+	double* initialNLLs = columnarData != NULL ? columnarData->GetInitialNLLs() : NULL;
+	DataPoint rowView;
+	const bool useRowView = columnarData != NULL && !columnarData->DataPointsBuilt();
+	if( useRowView ) rowView = columnarData->MakeRowView();
+
+	//bool isnorm = thread_input->fittingPDF->GetName()=="NormalisedSum";
+	for( ; num< nPoints; ++num )
+	{
+		const unsigned int index = thread_input->dataBegin + num;
+		DataPoint* thisPoint = NULL;
+		if( !batched || columnarData == NULL ) thisPoint = ReadEvent( thread_input->dataSet, columnarData, useRowView ? &rowView : NULL, index );
+
+		pthread_mutex_t* debug_lock = thread_input->fittingPDF->DebugMutex();
+		if( batched )
 		{
-			integral = thread_input->fittingPDF->Integral( *data_i, thread_input->FitBoundary );
+			value = values[num];
+			integral = integrals[num];
 		}
-		catch( ... )
+		else
 		{
-			integral = DBL_MAX;
+			try
+			{
+				value = thread_input->fittingPDF->Evaluate( thisPoint );
+			}
+			catch( ... )
+			{
+				value = DBL_MAX;
+			}
+
+			try
+			{
+				integral = thread_input->fittingPDF->Integral( thisPoint, thread_input->FitBoundary );
+			}
+			catch( ... )
+			{
+				integral = DBL_MAX;
+			}
 		}
 
 		/*
@@ -227,39 +673,43 @@ void* NegativeLogLikelihoodThreaded::ThreadWork( void *input_data )
 
 		//cout << value << "\t" << integral << endl;
 
+		//	Only a bad event needs to be built to be reported
+		const bool invalid = std::isnan(value) || std::isnan(integral) || value <= 0 || integral <= 0 || value >= DBL_MAX || integral >= DBL_MAX;
+		if( invalid && thisPoint == NULL ) thisPoint = ReadEvent( thread_input->dataSet, columnarData, useRowView ? &rowView : NULL, index );
+
 		if( std::isnan(value) == true )
 		{
 			pthread_mutex_lock( debug_lock );
-			thread_input->dataPoint_Result.push_back( DBL_MAX );
+			thread_input->NLL_Valid = false;
 			cout << endl << "PDF is nan" << endl;
-			(*data_i)->Print();
+			thisPoint->Print();
 			pthread_mutex_unlock( debug_lock );
 			break;
 		}
 		if( std::isnan(integral) == true )
 		{
 			pthread_mutex_lock( debug_lock );
-			thread_input->dataPoint_Result.push_back( DBL_MAX );
+			thread_input->NLL_Valid = false;
 			cout << endl << "Integral is nan" << endl;
-			(*data_i)->Print();
+			thisPoint->Print();
 			pthread_mutex_unlock( debug_lock );
 			break;
 		}
 		if( value <= 0 )
 		{
 			pthread_mutex_lock( debug_lock );
-			thread_input->dataPoint_Result.push_back( DBL_MAX );
+			thread_input->NLL_Valid = false;
 			cout << endl << "Value is <=0 " << value << endl;
-			(*data_i)->Print();
+			thisPoint->Print();
 			pthread_mutex_unlock( debug_lock );
 			break;
 		}
 		if( integral <= 0 )
 		{
 			pthread_mutex_lock( debug_lock );
-			thread_input->dataPoint_Result.push_back( DBL_MAX );
+			thread_input->NLL_Valid = false;
 			cout << endl << "Integral is <= 0 " << integral << endl;
-			(*data_i)->Print();
+			thisPoint->Print();
 			pthread_mutex_unlock( debug_lock );
 			break;
 		}
@@ -267,10 +717,10 @@ void* NegativeLogLikelihoodThreaded::ThreadWork( void *input_data )
 		if( value >= DBL_MAX || integral >= DBL_MAX )
 		{
 			pthread_mutex_lock( debug_lock );
-			thread_input->dataPoint_Result.push_back( DBL_MAX );
+			thread_input->NLL_Valid = false;
 			cerr << endl << "Caught invalid value from PDF: " << endl;
 			cerr << "Val: " << value << "\tNorm: " << integral << endl;
-			(*data_i)->Print();
+			thisPoint->Print();
 			pthread_mutex_unlock( debug_lock );
 			break;
 		}
@@ -286,7 +736,7 @@ void* NegativeLogLikelihoodThreaded::ThreadWork( void *input_data )
 		//	If we have a weighted dataset then weight the result (if not don't perform a *1.)
 		if( thread_input->useWeights == true )
 		{
-			weight = (*data_i)->GetEventWeight();
+			weight = eventWeights != NULL ? eventWeights[index] : thisPoint->GetEventWeight();
 			//pthread_mutex_lock( &eval_lock );
 			result *= weight;
 			if( thread_input->weightsSquared )
@@ -297,12 +747,33 @@ void* NegativeLogLikelihoodThreaded::ThreadWork( void *input_data )
 			//pthread_mutex_unlock( &eval_lock );
 		}
 
-		//	Push back the result from evaluating this datapoint
-		thread_input->dataPoint_Result.push_back( result );
+		//	Add the result from evaluating this datapoint, each event is only ever seen by one thread so the offset can be stored here
+		if( thread_input->offSetNLL )
+		{
+			const double initialNLL = initialNLLs != NULL ? initialNLLs[index] : thisPoint->GetInitialNLL();
+			if( std::isnan( initialNLL ) )
+			{
+				if( initialNLLs != NULL ) initialNLLs[index] = result;
+				else thisPoint->SetInitialNLL( result );
+				result = 0.;
+			}
+			else
+			{
+				result -= initialNLL;
+			}
+		}
+
+		if( index / blockSize != thisBlock )
+		{
+			thread_input->NLL_Blocks.push_back( blockSum );
+			blockSum.Clear();
+			thisBlock = index / blockSize;
+		}
+		blockSum.Add( result );
 	}
+	if( num > 0 ) thread_input->NLL_Blocks.push_back( blockSum );
 
-	//	Finished evaluating this thread
-	pthread_exit( NULL );
+	return NULL;
 }
 
 //Return the up value for error calculations
@@ -63,6 +63,8 @@ double NegativeLogLikelihoodThreadedNew::EvaluateDataSet( IPDF * FittingPDF, IDa
 	thisConfig->MultiThreadingInstance = "pthreads";
 	thisConfig->numThreads=(unsigned)Threads;
 	thisConfig->wantedComponent = NULL;
+	thisConfig->workerPool = workerPool;
+	thisConfig->chunkSize = chunkSize;
 
 	//cout << "Breaking into Threads" << endl;
 	//cout << endl << FittingPDF << "\t" << TotalDataSet << "\t" << thisConfig << endl;
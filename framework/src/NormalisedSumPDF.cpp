@@ -353,6 +353,90 @@ double NormalisedSumPDF::Evaluate( DataPoint* NewDataPoint )
 	return sum;
 }
 
+void NormalisedSumPDF::PrecomputeDerivedColumns( IDataSet* InputData )
+{
+	firstPDF->PrecomputeDerivedColumns( InputData );
+	secondPDF->PrecomputeDerivedColumns( InputData );
+}
+
+vector<string> NormalisedSumPDF::GetAnalyticGradientParameters()
+{
+	return BasePDF::CombineAnalyticGradientParameters( firstPDF, secondPDF, vector<string>( 1, string(fractionName) ) );
+}
+
+bool NormalisedSumPDF::EvaluateGradient( DataPoint* NewDataPoint, const vector<string>& Names, double* output )
+{
+	if( Names.empty() ) return true;
+	vector<double> firstGradient( Names.size(), 0. ), secondGradient( Names.size(), 0. );
+	vector<double> firstIntegralGradient( Names.size(), 0. ), secondIntegralGradient( Names.size(), 0. );
+	if( !firstPDF->EvaluateGradient( NewDataPoint, Names, &(firstGradient[0]) ) ) return false;
+	if( !secondPDF->EvaluateGradient( NewDataPoint, Names, &(secondGradient[0]) ) ) return false;
+	if( !firstPDF->IntegralGradient( NewDataPoint, integrationBoundary, Names, &(firstIntegralGradient[0]) ) ) return false;
+	if( !secondPDF->IntegralGradient( NewDataPoint, integrationBoundary, Names, &(secondIntegralGradient[0]) ) ) return false;
+
+	double firstIntegral = this->GetFirstIntegral( NewDataPoint );
+	double secondIntegral = this->GetSecondIntegral( NewDataPoint );
+	double firstValue = firstPDF->Evaluate( NewDataPoint );
+	double secondValue = secondPDF->Evaluate( NewDataPoint );
+
+	for( unsigned int i=0; i< Names.size(); ++i )
+	{
+		//	d/dx ( A/I ) = A'/I - A*I'/I^2
+		double firstTerm = firstGradient[i] / firstIntegral - firstValue * firstIntegralGradient[i] * firstIntegralCorrection / ( firstIntegral * firstIntegral );
+		double secondTerm = secondGradient[i] / secondIntegral - secondValue * secondIntegralGradient[i] * secondIntegralCorrection / ( secondIntegral * secondIntegral );
+		output[i] = firstTerm * firstFraction + secondTerm * ( 1 - firstFraction );
+		if( Names[i] == string(fractionName) ) output[i] += firstValue / firstIntegral - secondValue / secondIntegral;
+	}
+	return true;
+}
+
+bool NormalisedSumPDF::IntegralGradient( DataPoint* NewDataPoint, PhaseSpaceBoundary* NewBoundary, const vector<string>& Names, double* output )
+{
+	(void) NewDataPoint; (void) NewBoundary;
+	for( unsigned int i=0; i< Names.size(); ++i ) output[i] = 0.;
+	return true;
+}
+
+//Return the function value for a range of events
+void NormalisedSumPDF::EvaluateBatch( IDataSet* InputData, const unsigned int begin, const unsigned int end, double* output )
+{
+	if( end <= begin ) return;
+	const unsigned int nEvents = end - begin;
+	if( firstFraction > 1.0 || firstFraction < 0.0 )
+	{
+		cerr << "Requested impossible fraction: " << firstFraction << endl;
+		for( unsigned int i=0; i< nEvents; ++i ) output[i] = DBL_MAX;
+		return;
+	}
+
+	for( unsigned int i=0; i< nEvents; ++i ) output[i] = 0.;
+
+	vector<double> values( nEvents, 0. );
+	vector<double> integrals( nEvents, 0. );
+
+	//	Same as Evaluate, a PDF with no contribution is never evaluated
+	if( firstFraction > 0. )
+	{
+		const double thisFraction = firstFraction >= 1. ? 1. : firstFraction;
+		firstPDF->EvaluateBatch( InputData, begin, end, &(values[0]) );
+		firstPDF->NormalisationBatch( InputData, begin, end, integrationBoundary, &(integrals[0]) );
+		for( unsigned int i=0; i< nEvents; ++i )
+		{
+			output[i] += ( values[i] * thisFraction ) / ( integrals[i] * firstIntegralCorrection );
+		}
+	}
+	if( firstFraction < 1. )
+	{
+		const double thisFraction = firstFraction <= 0. ? 1. : ( 1 - firstFraction );
+		secondPDF->EvaluateBatch( InputData, begin, end, &(values[0]) );
+		secondPDF->NormalisationBatch( InputData, begin, end, integrationBoundary, &(integrals[0]) );
+		for( unsigned int i=0; i< nEvents; ++i )
+		{
+			output[i] += ( values[i] * thisFraction ) / ( integrals[i] * secondIntegralCorrection );
+		}
+	}
+}
+
 double NormalisedSumPDF::GetFirstIntegral( DataPoint* NewDataPoint )
 {
 	return firstPDF->Integral( NewDataPoint, integrationBoundary ) * firstIntegralCorrection;
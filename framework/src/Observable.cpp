@@ -19,7 +19,7 @@ using namespace::std;
 
 //Constructor with correct argument
 Observable::Observable( const string Name, const double NewValue, const string NewUnit )
-	: name(Name), value(NewValue), unit(NewUnit), bin_num(-1), acceptance(-1.), bkg_bin_num(-1), bkg_acceptance(-1.), offset(-999.)
+	: name(Name), value(NewValue), unit(NewUnit), bin_num(-1), acceptance(-1.), bkg_bin_num(-1), bkg_acceptance(-1.)
 {
 	if (unit == "")
 	{
@@ -27,13 +27,13 @@ Observable::Observable( const string Name, const double NewValue, const string N
 	}
 }
 
-Observable::Observable( const string Name ) : name(Name), value(0.), unit("Uninitialised"), bin_num(-1), acceptance(-1.), bkg_bin_num(-1), bkg_acceptance(-1.), offset(-999.)
+Observable::Observable( const string Name ) : name(Name), value(0.), unit("Uninitialised"), bin_num(-1), acceptance(-1.), bkg_bin_num(-1), bkg_acceptance(-1.)
 {
 }
 
 Observable::Observable( const Observable& input ) :
 	name(input.name), value(input.value), unit(input.unit), bin_num(input.bin_num),
-	acceptance(input.acceptance), bkg_bin_num(input.bkg_bin_num), bkg_acceptance(input.bkg_acceptance), offset(input.offset)
+	acceptance(input.acceptance), bkg_bin_num(input.bkg_bin_num), bkg_acceptance(input.bkg_acceptance)
 {
 }
 
@@ -118,7 +118,6 @@ void Observable::SetObservable( const Observable* input )
 	acceptance = input->GetAcceptance();
 	bkg_bin_num = input->GetBkgBinNumber();
 	bkg_acceptance = input->GetBkgAcceptance();
-	offset = input->GetOffSet();
 }
 
 void Observable::ExternallySetValue( const double input )
@@ -126,13 +125,3 @@ void Observable::ExternallySetValue( const double input )
 	value = input;
 }
 
-void Observable::SetOffSet( const double input ) const
-{
-	offset = input;
-}
-
-double Observable::GetOffSet() const
-{
-	return offset;
-}
-
@@ -153,7 +153,7 @@ Observable * ObservableContinuousConstraint::CreateObservable() const
 }
 
 //Create an observable within this constraint, using the specified random number generator
-Observable * ObservableContinuousConstraint::CreateObservable( TRandom3 * RandomNumberGenerator ) const
+Observable * ObservableContinuousConstraint::CreateObservable( TRandom * RandomNumberGenerator ) const
 {
 	double value = minimum + ( ( maximum - minimum ) * RandomNumberGenerator->Rndm() );
 	return new Observable( name, value/*, 0.0*/, unit );
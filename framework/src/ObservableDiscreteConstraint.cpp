@@ -127,7 +127,7 @@ Observable * ObservableDiscreteConstraint::CreateObservable() const
 }
 
 //Create an observable within this constraint, using the specified random number generator
-Observable * ObservableDiscreteConstraint::CreateObservable( TRandom3 * RandomNumberGenerator ) const
+Observable * ObservableDiscreteConstraint::CreateObservable( TRandom * RandomNumberGenerator ) const
 {
 	int randomIndex = (int)floor( int(allValues.size()) * RandomNumberGenerator->Rndm() );
 	return new Observable( name, allValues[unsigned(randomIndex)]/*, 0.0*/, unit );
@@ -186,6 +186,11 @@ string PDFConfigurator::getConfigurationValue( string configParam ) const
 	return string("") ;
 }
 
+vector<string> PDFConfigurator::GetConfigurationValues() const
+{
+	return configValues;
+}
+
 // Method to check for a configuration parameter value
 bool PDFConfigurator::hasConfigurationValue( string configParam, string paramValue )
 {
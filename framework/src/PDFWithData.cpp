@@ -21,15 +21,21 @@ using namespace::std;
 //Constructor with correct arguments
 PDFWithData::PDFWithData( IPDF * InputPDF, PhaseSpaceBoundary * InputBoundary, DataSetConfiguration* DataConfig ) :
 	fitPDF(ClassLookUp::CopyPDF(InputPDF)), inputBoundary(new PhaseSpaceBoundary(*InputBoundary)),  parametersAreSet(false),
-	dataSetMaker(), cached_data(NULL), useCache(false)
+	dataSetMaker(), cached_data(NULL), useCache(false), ownsMCCache(true)
 {
 	dataSetMaker = new DataSetConfiguration( *DataConfig );
 }
 
+PDFWithData::PDFWithData( const PDFWithData& input ) :
+	fitPDF(ClassLookUp::CopyPDF(input.fitPDF)), inputBoundary(new PhaseSpaceBoundary(*input.inputBoundary)), parametersAreSet(input.parametersAreSet),
+	dataSetMaker(new DataSetConfiguration(*input.dataSetMaker)), cached_data(NULL), useCache(input.useCache), ownsMCCache(false)
+{
+}
+
 //Destructor
 PDFWithData::~PDFWithData()
 {
-	fitPDF->Can_Remove_Cache( true );
+	if( ownsMCCache ) fitPDF->Can_Remove_Cache( true );
 	if( fitPDF != NULL ) delete fitPDF;
 	if( inputBoundary != NULL ) delete inputBoundary;
 	if( dataSetMaker != NULL ) delete dataSetMaker;
@@ -42,6 +48,11 @@ IPDF * PDFWithData::GetPDF() const
 	return fitPDF;
 }
 
+PhaseSpaceBoundary * PDFWithData::GetPhaseSpaceBoundary() const
+{
+	return inputBoundary;
+}
+
 void PDFWithData::AddCachedData( IDataSet* input_cache )
 {
 	cached_data = input_cache;
@@ -297,6 +297,7 @@ bool ParameterSet::SetPhysicsParameter( string Name, PhysicsParameter * NewPhysi
 		if( allParameters[unsigned(nameIndex)] != NULL ) delete allParameters[unsigned(nameIndex)];
 		//	Copy the new parameter into the old one so no need to delete anything
 		allParameters[unsigned(nameIndex)] = new PhysicsParameter(*NewPhysicsParameter);
+		allParameters[unsigned(nameIndex)]->SetChanged( true );
 		return true;
 	}
 }
@@ -325,9 +326,20 @@ bool ParameterSet::SetPhysicsParameters( const ParameterSet * NewParameterSet )
 		}
 		else
 		{
-			if( allParameters[(unsigned)lookup] != NULL ) delete allParameters[(unsigned)lookup];
-			//cout << thisName << endl;
-			allParameters[(unsigned)lookup] = new PhysicsParameter( *NewParameterSet->GetPhysicsParameter(thisName) );
+			PhysicsParameter* newParameter = NewParameterSet->GetPhysicsParameter( thisName );
+			PhysicsParameter* thisParameter = allParameters[(unsigned)lookup];
+			if( thisParameter == NULL )
+			{
+				allParameters[(unsigned)lookup] = new PhysicsParameter( *newParameter );
+				allParameters[(unsigned)lookup]->SetChanged( true );
+			}
+			else
+			{
+				//	Copy in place and remember if the parameter has moved, been fixed/released or had its limits changed since the flags were last reset
+				bool changed = thisParameter->HasChanged() || !PhysicsParameter::SameSettings( thisParameter, newParameter );
+				*thisParameter = *newParameter;
+				thisParameter->SetChanged( changed );
+			}
 		}
 	}
 	return true;
@@ -579,3 +591,44 @@ void ParameterSet::FloatedFirst( vector<string> RequiredFloatedSort )
 	}
 }
 
+void ParameterSet::ResetChanged()
+{
+	for( vector<PhysicsParameter*>::iterator param_i = allParameters.begin(); param_i != allParameters.end(); ++param_i )
+	{
+		if( *param_i != NULL ) (*param_i)->SetChanged( false );
+	}
+}
+
+bool ParameterSet::HasChanged() const
+{
+	for( vector<PhysicsParameter*>::const_iterator param_i = allParameters.begin(); param_i != allParameters.end(); ++param_i )
+	{
+		if( *param_i == NULL || (*param_i)->HasChanged() ) return true;
+	}
+	return false;
+}
+
+bool ParameterSet::HasChanged( const ObservableRef& Name ) const
+{
+	return this->GetPhysicsParameter( Name )->HasChanged();
+}
+
+bool ParameterSet::HasChanged( const vector<ObservableRef>& Names ) const
+{
+	for( vector<ObservableRef>::const_iterator name_i = Names.begin(); name_i != Names.end(); ++name_i )
+	{
+		if( this->GetPhysicsParameter( *name_i )->HasChanged() ) return true;
+	}
+	return false;
+}
+
+vector<string> ParameterSet::GetChangedNames() const
+{
+	vector<string> changedNames;
+	for( unsigned int i=0; i< allParameters.size(); ++i )
+	{
+		if( allParameters[i] == NULL || allParameters[i]->HasChanged() ) changedNames.push_back( allNames[i] );
+	}
+	return changedNames;
+}
+
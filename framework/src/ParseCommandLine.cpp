@@ -4,6 +4,7 @@
 #include "InputParsing.h"
 #include "StringProcessing.h"
 #include "ComponentPlotter.h"
+#include "Foam.h"
 
 #include <vector>
 #include <string>
@@ -27,6 +28,25 @@ void ParseCommandLine::RapidFitHelp()
 	cout << " -repeats n   " << endl ;
 	cout << "	Specifies the number of repeats for a Systematic study." <<endl ;
 
+	cout << endl ;
+	cout << " --toyWorkers n   " << endl ;
+	cout << "	Performs a toy study with n independent workers, each fitting a whole toy in a single thread." <<endl ;
+	cout << "	This replaces the per-event threading of each fit and is faster for many small toys." <<endl ;
+	cout << "	This also distributes the toys at every grid point of a FC scan (--doFCscan) between n workers." <<endl ;
+
+	cout << endl ;
+	cout << " --scanWorkers n   " << endl ;
+	cout << "	Fits the points of each LL scan (--doLLscan, --doLLcontour) with n workers, each point starting from the result of its best converged neighbour." <<endl ;
+	cout << "	With n=1 the points are fitted one at a time but are still started from a neighbour." <<endl ;
+
+	cout << endl ;
+	cout << " --adaptiveContour n   " << endl ;
+	cout << "	Replaces the full grid of each LL contour (--doLLcontour) with at most n fits, starting from a coarse grid and" <<endl ;
+	cout << "	only refining the cells which a contour passes through. The output can still be drawn with Rapid2DLL." <<endl ;
+	cout << endl ;
+	cout << " --adaptiveContourLevels a,b,c   " << endl ;
+	cout << "	DeltaNLL of the contours followed by --adaptiveContour, by default 1.15,2.36,3.0" <<endl ;
+
 	cout << endl ;
 
 	cout << " --doLLscan  " << endl;
@@ -72,6 +92,18 @@ void ParseCommandLine::RapidFitHelp()
 	cout << " --testIntegrator   " << endl ;
 	cout << "	Useful feature which only tests the numerical<=>analytic integrator for each PDF then exits " <<endl ;
 
+	cout << endl ;
+	cout << " --testIntegratorThreads   " << endl ;
+	cout << "	Runs the numerical integrator for each PDF from many threads at once, with an integrator per thread and with one shared integrator, and checks the results match a single thread then exits " <<endl ;
+
+	cout << endl ;
+	cout << " --testFaddeeva   " << endl ;
+	cout << "	Tests the batch Faddeeva function and time functions in Mathematics against RooMath and the single event functions then exits " <<endl ;
+
+	cout << endl ;
+	cout << " --testCacheDependencies   " << endl ;
+	cout << "	Moves each parameter of each PDF in turn and checks the cached Normalisation is only dropped for the parameters the PDF says it depends on then exits " <<endl ;
+
 	cout << endl;
 	cout << " --SetSeed 12345" << endl;
 	cout << "	Set the Random seed to 12345 if you wish to make the output reproducable. Useful on Batch Systems" << endl;
@@ -145,6 +177,23 @@ void ParseCommandLine::RapidFitHelp()
 	cout << "--testIntegrator" << endl;
 	cout << "       This allows you to test the Numerical vs Analytical Integrals from an XML" << endl;
 
+	cout << endl;
+	cout << "--testIntegratorThreads" << endl;
+	cout << "       This checks that numerical normalisations calculated concurrently in many threads agree with a single thread" << endl;
+
+	cout << endl;
+	cout << "--testFaddeeva" << endl;
+	cout << "       This checks the accuracy of the batch Faddeeva function used for resolution models, no XML is needed" << endl;
+
+	cout << endl;
+	cout << "--testCacheDependencies" << endl;
+	cout << "       This checks that changing a parameter a PDF's Normalisation doesn't depend on keeps the cached Normalisation, from an XML" << endl;
+
+	cout << endl;
+	cout << "--benchmarkAcceptReject" << endl;
+	cout << "       This compares the events per second of the batched and one-trial-at-a-time AcceptReject generators for each PDF in an XML" << endl;
+	cout << "       eg: -f tutorials/SimpleGauss3D.xml --benchmarkAcceptReject" << endl;
+
 	cout << endl;
 	cout << "--helpProjections" << endl;
 	cout << "       This will print a lot of options available for the Projections or ComponentProjections of a fit to data" << endl;
@@ -153,6 +202,11 @@ void ParseCommandLine::RapidFitHelp()
 	cout << "--SendOutput <folder name>" << endl;
 	cout << "	Write the output to a folder with the given name." << endl;
 
+	cout << endl;
+	cout << "--FoamGridCache <directory>" << endl;
+	cout << "	Store the cells built by the Foam generator in this directory and re-use them whenever the same PDF, parameters and PhaseSpace are generated again." << endl;
+	cout << "	Point many toy or grid jobs at the same directory to build the cells only once." << endl;
+
 	cout << endl;
 	cout << "--files n file1.xml file2.xml ... filen.xml" << endl;
 	cout << "       Used to fit to multiple XML files at once" << endl;
@@ -372,6 +426,62 @@ int ParseCommandLine::ParseThisCommandLine( RapidFitConfiguration& config, vecto
 				return BAD_COMMAND_LINE_ARG;
 			}
 		}
+		else if( currentArgument == "--toyWorkers" )
+		{
+			if( argumentIndex + 1 < argv.size() )
+			{
+				++argumentIndex;
+				config.toyWorkers = atoi( argv[argumentIndex].c_str() );
+			}
+			else
+			{
+				cerr << "Number of toy workers not specified" << endl;
+				return BAD_COMMAND_LINE_ARG;
+			}
+		}
+		else if( currentArgument == "--scanWorkers" )
+		{
+			if( argumentIndex + 1 < argv.size() )
+			{
+				++argumentIndex;
+				config.scanWorkers = atoi( argv[argumentIndex].c_str() );
+			}
+			else
+			{
+				cerr << "Number of scan workers not specified" << endl;
+				return BAD_COMMAND_LINE_ARG;
+			}
+		}
+		else if( currentArgument == "--adaptiveContour" )
+		{
+			if( argumentIndex + 1 < argv.size() )
+			{
+				++argumentIndex;
+				config.adaptiveContourFits = atoi( argv[argumentIndex].c_str() );
+			}
+			else
+			{
+				cerr << "Maximum number of fits for an adaptive contour not specified" << endl;
+				return BAD_COMMAND_LINE_ARG;
+			}
+		}
+		else if( currentArgument == "--adaptiveContourLevels" )
+		{
+			if( argumentIndex + 1 < argv.size() )
+			{
+				++argumentIndex;
+				vector<string> levels = StringProcessing::SplitString( argv[argumentIndex], ',' );
+				for( unsigned int i=0; i< levels.size(); ++i )
+				{
+					config.adaptiveContourLevels.push_back( atof( levels[i].c_str() ) );
+				}
+			}
+			else
+			{
+				cerr << "Adaptive contour levels not specified" << endl;
+				return BAD_COMMAND_LINE_ARG;
+			}
+		}
 		else if( currentArgument == "--OverrideXML" )
 		{
 			if( argumentIndex + 2 < argv.size() )
@@ -647,9 +757,26 @@ int ParseCommandLine::ParseThisCommandLine( RapidFitConfiguration& config, vecto
 				return BAD_COMMAND_LINE_ARG;
 			}	
 		}
+		else if( currentArgument == "--FoamGridCache" )
+		{
+			if( argumentIndex + 1 < argv.size() )
+			{
+				++argumentIndex;
+				Foam::SetGridCacheDirectory( argv[argumentIndex] );
+			}
+			else
+			{
+				cerr << "Required to give a directory for the Foam grid cache" << endl;
+				return BAD_COMMAND_LINE_ARG;
+			}
+		}
 
 		//	The Parameters beyond here are for setting boolean flags
 		else if( currentArgument == "--testIntegrator" )			{	config.testIntegratorFlag = true;			}
+		else if( currentArgument == "--testIntegratorThreads" )			{	config.testIntegratorThreadsFlag = true;		}
+		else if( currentArgument == "--testFaddeeva" )				{	config.testFaddeevaFlag = true;				}
+		else if( currentArgument == "--testCacheDependencies" )			{	config.testCacheDependenciesFlag = true;		}
+		else if( currentArgument == "--benchmarkAcceptReject" )			{	config.benchmarkAcceptRejectFlag = true;		}
 		else if( currentArgument == "--testRapidIntegrator" )			{	config.testRapidIntegratorFlag = true;			}
 		else if( currentArgument == "--calculateFitFractions" )			{	config.calculateFitFractionsFlag = true;		}
 		else if( currentArgument == "--calculateAcceptanceWeights" )		{	config.calculateAcceptanceWeights = true;		}
@@ -11,6 +11,7 @@
 #include "PerEventResModel.h"
 #include "StringProcessing.h"
 #include "Mathematics.h"
+#include "ColumnarDataSet.h"
 
 #include <stdio.h>
 #include <vector>
@@ -126,3 +127,27 @@ pair<double,double> PerEventResModel::ExpCosSinInt( double tlow, double thigh, d
 	return Mathematics::ExpCosSinInt( tlow, thigh, gamma, dms, eventResolution*resScale);
 }
 
+void PerEventResModel::EventResolutions( IDataSet* data, const unsigned int begin, const unsigned int end, vector<double>& resolution ) const
+{
+	vector<double> buffer;
+	const double* eventResolutions = ColumnarDataSet::ReadColumn( data, eventResolutionName, begin, end, buffer );
+	resolution.resize( end - begin );
+	for( unsigned int i=0; i< end-begin; ++i ) resolution[i] = eventResolutions[i]*resScale;
+}
+
+void PerEventResModel::ExpBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, double* output )
+{
+	if( end <= begin ) return;
+	vector<double> resolution;
+	this->EventResolutions( data, begin, end, resolution );
+	Mathematics::ExpBatch( time, end-begin, gamma, &(resolution[0]), output );
+}
+
+void PerEventResModel::ExpCosSinBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, const double dms,
+		double* outCos, double* outSin )
+{
+	if( end <= begin ) return;
+	vector<double> resolution;
+	this->EventResolutions( data, begin, end, resolution );
+	Mathematics::ExpCosSinBatch( time, end-begin, gamma, dms, &(resolution[0]), outCos, outSin );
+}
@@ -498,10 +498,9 @@ string PhaseSpaceBoundary::XML() const
 unsigned int PhaseSpaceBoundary::GetDiscreteIndex( DataPoint* Input, const bool silence ) const
 {
 	(void) silence;
-	//	Exit on simple case
+	//	Exit on simple case, the index of each DataPoint is only ever looked up once
 	int thisIndex = Input->GetDiscreteIndexMap( uniqueID );
-	bool IDFound = Input->FindDiscreteIndexID( uniqueID );
-	if( thisIndex != -1 && IDFound ) return (unsigned)thisIndex;
+	if( thisIndex != -1 ) return (unsigned)thisIndex;
 
 	if( this->GetDiscreteNames().empty() || (this->GetDiscreteNames().size() == 1) )
 	{
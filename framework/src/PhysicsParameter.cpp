@@ -14,27 +14,44 @@
 //	System Headers
 #include <iostream>
 #include <sstream>
+#include <string.h>
 
 using namespace::std;
 
 const double default_val = -9999.;
 
+namespace
+{
+	//	A parameter has changed if any bit of it has changed, compare the bits rather than the values
+	inline bool SameValue( const double first, const double second )
+	{
+		return memcmp( &first, &second, sizeof(double) ) == 0;
+	}
+}
+
 bool PhysicsParameter::DiffParams( PhysicsParameter* first, PhysicsParameter* second )
 {
 	return first->GetValue() == second->GetValue();
 }
 
+bool PhysicsParameter::SameSettings( const PhysicsParameter* first, const PhysicsParameter* second )
+{
+	return SameValue( first->value, second->value ) && SameValue( first->minimum, second->minimum ) && SameValue( first->maximum, second->maximum )
+		&& ( first->_isFixed == second->_isFixed ) && ( first->type == second->type )
+		&& ( first->toBeBlinded == second->toBeBlinded ) && SameValue( first->blindOffset, second->blindOffset );
+}
+
 //Default constructor
 PhysicsParameter::PhysicsParameter( string Name ) :
 	name(Name), value(default_val), originalValue(default_val), minimum(default_val), maximum(default_val), stepSize(default_val),
-	type("Uninitialised"), unit("Uninitialised"), toBeBlinded(false), blindOffset(default_val), blindString("uninitialized"), blindScale(-999.), _isFixed(false)
+	type("Uninitialised"), unit("Uninitialised"), toBeBlinded(false), blindOffset(default_val), blindString("uninitialized"), blindScale(-999.), _isFixed(false), changed(true)
 {
 }
 
 //Constructor with correct argument
 PhysicsParameter::PhysicsParameter( string Name, double NewValue, double NewMinimum, double NewMaximum, double StepSize, string NewType, string NewUnit )
 	: name(Name), value(NewValue), originalValue(NewValue), minimum(NewMinimum), maximum(NewMaximum), stepSize(StepSize),
-	type(NewType), unit(NewUnit), toBeBlinded(false), blindOffset(0.0), blindString("uninitialized"), blindScale(-999.), _isFixed( NewType == "Fixed" )
+	type(NewType), unit(NewUnit), toBeBlinded(false), blindOffset(0.0), blindString("uninitialized"), blindScale(-999.), _isFixed( NewType == "Fixed" ), changed(true)
 {
 	if ( maximum < minimum )
 	{
@@ -73,7 +90,7 @@ PhysicsParameter::PhysicsParameter( string Name, double NewValue, double NewMini
 //Constructor for unbounded parameter
 PhysicsParameter::PhysicsParameter( string Name, double NewValue, double StepSize, string NewType, string NewUnit ) :
 	value(NewValue), originalValue(NewValue), minimum(0.0), maximum(0.0), stepSize(StepSize), type(NewType), unit(NewUnit), toBeBlinded(false), blindOffset(0.0), blindString("uninitialized"), blindScale(-999.), name(Name),
-	_isFixed( NewType == "Fixed" )
+	_isFixed( NewType == "Fixed" ), changed(true)
 {
 	//You could define a fixed parameter with no maximum or minimum, but it must be unbounded if not fixed.
 	if ( type != "Fixed" )
@@ -127,6 +144,7 @@ double PhysicsParameter::GetBlindedValue() const
 //Set the blinded value
 void PhysicsParameter::SetBlindedValue(double NewValue)
 {
+	if( !SameValue( value, NewValue ) ) changed = true;
 	value = NewValue;
 }
 
@@ -145,11 +163,13 @@ double PhysicsParameter::GetTrueValue() const
 //Set the true value
 void PhysicsParameter::SetTrueValue(double NewValue)
 {
+	double oldValue = value;
 	if( toBeBlinded ) 
 	{
 		value = NewValue - blindOffset;   
 	}
 	else value = NewValue;	
+	if( !SameValue( value, oldValue ) ) changed = true;
 }
 
 //.....................
@@ -174,6 +194,7 @@ void PhysicsParameter::SetMinimum(double NewMinimum)
 	{
 		if ( NewMinimum < maximum )
 		{
+			if( !SameValue( minimum, NewMinimum ) ) changed = true;
 			minimum = NewMinimum;
 		}
 		else
@@ -204,6 +225,7 @@ void PhysicsParameter::SetMaximum(double NewMaximum)
 	{
 		if ( NewMaximum > minimum )
 		{
+			if( !SameValue( maximum, NewMaximum ) ) changed = true;
 			maximum = NewMaximum;
 		}
 		else
@@ -222,6 +244,7 @@ void PhysicsParameter::SetLimits(double NewMaximum, double NewMinimum)
 	}
 	else
 	{
+		changed = true;
 		if ( NewMaximum >= NewMinimum )
 		{
 			maximum = NewMaximum;
@@ -256,6 +279,7 @@ string PhysicsParameter::GetType() const
 
 void PhysicsParameter::SetType(string NewType)
 {
+	if( type != NewType ) changed = true;
 	if( NewType == "Fixed" )
 	{
 		originalValue = this->GetBlindedValue();
@@ -294,6 +318,7 @@ string PhysicsParameter::GetUnit() const
 //Set blinding offset
 void PhysicsParameter::SetBlindOffset( double offset )
 {
+	if( !toBeBlinded || !SameValue( blindOffset, offset ) ) changed = true;
 	blindOffset = offset;
 	toBeBlinded = true;
 	return;
@@ -302,6 +327,7 @@ void PhysicsParameter::SetBlindOffset( double offset )
 //Set blinding on or off
 void PhysicsParameter::SetBlinding( bool state )
 {
+	if( toBeBlinded != state ) changed = true;
 	toBeBlinded = state;
 	return;
 }
@@ -362,3 +388,13 @@ void PhysicsParameter::SetBlindingInfo( string input_str, double input_val )
 	blindScale = input_val;
 }
 
+bool PhysicsParameter::HasChanged() const
+{
+	return changed;
+}
+
+void PhysicsParameter::SetChanged( const bool input )
+{
+	changed = input;
+}
+
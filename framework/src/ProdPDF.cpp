@@ -240,6 +240,65 @@ double ProdPDF::Evaluate( DataPoint * NewDataPoint )
 	return prod;
 }
 
+void ProdPDF::PrecomputeDerivedColumns( IDataSet* InputData )
+{
+	firstPDF->PrecomputeDerivedColumns( InputData );
+	secondPDF->PrecomputeDerivedColumns( InputData );
+}
+
+vector<string> ProdPDF::GetAnalyticGradientParameters()
+{
+	if( this->GetNumericalNormalisation() ) return vector<string>();
+	return BasePDF::CombineAnalyticGradientParameters( firstPDF, secondPDF, vector<string>() );
+}
+
+bool ProdPDF::EvaluateGradient( DataPoint* NewDataPoint, const vector<string>& Names, double* output )
+{
+	if( Names.empty() ) return true;
+	vector<double> firstGradient( Names.size(), 0. ), secondGradient( Names.size(), 0. );
+	if( !firstPDF->EvaluateGradient( NewDataPoint, Names, &(firstGradient[0]) ) ) return false;
+	if( !secondPDF->EvaluateGradient( NewDataPoint, Names, &(secondGradient[0]) ) ) return false;
+
+	double termOne = firstPDF->Evaluate( NewDataPoint );
+	double termTwo = secondPDF->Evaluate( NewDataPoint );
+	for( unsigned int i=0; i< Names.size(); ++i )
+	{
+		output[i] = firstGradient[i] * termTwo + termOne * secondGradient[i];
+	}
+	return true;
+}
+
+bool ProdPDF::IntegralGradient( DataPoint* NewDataPoint, PhaseSpaceBoundary* NewBoundary, const vector<string>& Names, double* output )
+{
+	if( Names.empty() ) return true;
+	if( this->GetNumericalNormalisation() ) return this->NoGradientDependence( Names, output );
+	vector<double> firstGradient( Names.size(), 0. ), secondGradient( Names.size(), 0. );
+	if( !firstPDF->IntegralGradient( NewDataPoint, NewBoundary, Names, &(firstGradient[0]) ) ) return false;
+	if( !secondPDF->IntegralGradient( NewDataPoint, NewBoundary, Names, &(secondGradient[0]) ) ) return false;
+
+	double termOne = firstPDF->Integral( NewDataPoint, NewBoundary );
+	double termTwo = secondPDF->Integral( NewDataPoint, NewBoundary );
+	for( unsigned int i=0; i< Names.size(); ++i )
+	{
+		output[i] = firstGradient[i] * termTwo + termOne * secondGradient[i];
+	}
+	return true;
+}
+
+//Return the function value for a range of events
+void ProdPDF::EvaluateBatch( IDataSet* InputData, const unsigned int begin, const unsigned int end, double* output )
+{
+	if( end <= begin ) return;
+	const unsigned int nEvents = end - begin;
+	vector<double> secondValues( nEvents, 0. );
+	firstPDF->EvaluateBatch( InputData, begin, end, output );
+	secondPDF->EvaluateBatch( InputData, begin, end, &(secondValues[0]) );
+	for( unsigned int i=0; i< nEvents; ++i )
+	{
+		output[i] = output[i] * secondValues[i];
+	}
+}
+
 //Return the function value at the given point for numerical integration
 double ProdPDF::EvaluateForNumericIntegral( DataPoint * NewDataPoint )
 {
@@ -8,6 +8,10 @@ using namespace::std;
 
 RapidFitConfiguration::RapidFitConfiguration() :
 numberRepeats(),
+	toyWorkers(),
+	scanWorkers(),
+	adaptiveContourFits(),
+	adaptiveContourLevels(),
 	Nuisencemodel(),
 	jobNum(),
 	nData(),
@@ -45,6 +49,10 @@ numberRepeats(),
 	saveOneDataSetFlag(),
 	saveOneFoamDataSetFlag(),
 	testIntegratorFlag(),
+	testIntegratorThreadsFlag(),
+	testFaddeevaFlag(),
+	testCacheDependenciesFlag(),
+	benchmarkAcceptRejectFlag(),
 	testComponentPlotFlag(),
 	observableNameFlag(),
 	doPlottingFlag(),
@@ -95,6 +103,9 @@ numberRepeats(),
 {
 		//Variables to store command line arguments
 		numberRepeats = 0;
+		toyWorkers = 0;
+		scanWorkers = 0;
+		adaptiveContourFits = 0;
 		Nuisencemodel=2;
 		jobNum = 0;
 		nData = 0;
@@ -135,6 +146,10 @@ numberRepeats(),
 		saveOneDataSetFlag = false;
 		saveOneFoamDataSetFlag = false;
 		testIntegratorFlag = false;
+		testIntegratorThreadsFlag = false;
+		testFaddeevaFlag = false;
+		testCacheDependenciesFlag = false;
+		benchmarkAcceptRejectFlag = false;
 		testComponentPlotFlag = false;
 		observableNameFlag = false;
 		doPlottingFlag = false;
@@ -222,7 +237,6 @@ RapidFitConfiguration::~RapidFitConfiguration()
 			SoloContourResults.pop_back();
 		}
 		ResultFormatter::CleanUp();
-		RapidFitIntegrator::clearGSLIntegrationPoints();
 }
 
 
@@ -21,15 +21,16 @@
 #include "Threading.h"
 #include "MultiThreadedFunctions.h"
 #include "MemoryDataSet.h"
+#include "CompensatedSum.h"
 //	System Headers
 #include <iostream>
 #include <iomanip>
 #include <cmath>
 #include <stdlib.h>
+#include <string.h>
 #include <float.h>
 #include <pthread.h>
 #include <exception>
-#include <pthread.h>
 #include <algorithm>
 
 #ifdef __RAPIDFIT_USE_GSL
@@ -39,16 +40,6 @@
 #include "Math/GSLMCIntegrator.h"
 #endif
 
-pthread_mutex_t GSL_DATAPOINT_MANAGEMENT_THREADLOCK;
-pthread_mutex_t GSL_DATAPOINT_GET_THREADLOCK;
-
-pthread_mutex_t check_settings_lock;
-
-pthread_mutex_t gsl_mutex;
-
-pthread_mutex_t one_dim_lock;
-pthread_mutex_t multi_dim_lock;
-
 //#define DOUBLE_TOLERANCE DBL_MIN
 #define DOUBLE_TOLERANCE 1E-6
 
@@ -60,16 +51,16 @@ using namespace::std;
 //Constructor with correct argument
 RapidFitIntegrator::RapidFitIntegrator( IPDF * InputFunction, bool ForceNumerical, bool UsePseudoRandomIntegration ) :
 	ratioOfIntegrals(-1.), fastIntegrator(NULL), functionToWrap(InputFunction), multiDimensionIntegrator(NULL), oneDimensionIntegrator(NULL),
-	functionCanIntegrate(false), haveTestedIntegral(false), num_threads(4),
+	functionCanIntegrate(false), haveTestedIntegral(false), num_threads(4), workerPool(NULL), workerChunkSize(0),
 	RapidFitIntegratorNumerical( ForceNumerical ), obs_check(false), checked_list(),
-	pseudoRandomIntegration( UsePseudoRandomIntegration ), GSLFixedPoints( __DEFAULT_RAPIDFIT_FIXEDINTEGRATIONPOINTS ), _storedConfig(NULL)
+	pseudoRandomIntegration( UsePseudoRandomIntegration ), GSLFixedPoints( __DEFAULT_RAPIDFIT_FIXEDINTEGRATIONPOINTS ),
+	maxIntegrationSteps( __DEFAULT_RAPIDFIT_MAXINTEGRALSTEPS ), integrationAbsTolerance( __DEFAULT_RAPIDFIT_INTABSTOL ), integrationRelTolerance( __DEFAULT_RAPIDFIT_INTRELTOL ),
+	integratorLock(), gslColumns(), gslNumberPoints(0), gslMinima(), gslMaxima(), gslObservableNames(), gslSlices(), gslBoundaryID(0), threadFunctions(), _storedConfig(NULL)
 {
-	multiDimensionIntegrator = new AdaptiveIntegratorMultiDim();
-#if ROOT_VERSION_CODE > ROOT_VERSION(5,28,0)
-	multiDimensionIntegrator->SetAbsTolerance( __DEFAULT_RAPIDFIT_INTABSTOL );      //      Absolute error for things such as plots
-	multiDimensionIntegrator->SetRelTolerance( __DEFAULT_RAPIDFIT_INTRELTOL );
-	multiDimensionIntegrator->SetMaxPts( __DEFAULT_RAPIDFIT_MAXINTEGRALSTEPS );		//	These are the defaults, and it's unlikely you will be able to realistically push the integral without using "double double"'s
-#endif
+	pthread_mutex_init( &integratorLock, NULL );
+
+	//	These are the defaults, and it's unlikely you will be able to realistically push the integral without using "double double"'s
+	multiDimensionIntegrator = this->NewMultiDimIntegrator();
 
 	ROOT::Math::IntegrationOneDim::Type type = ROOT::Math::IntegrationOneDim::kGAUSS;
 	oneDimensionIntegrator = new IntegratorOneDim(type);
@@ -79,36 +70,23 @@ RapidFitIntegrator::RapidFitIntegrator( const RapidFitIntegrator& input ) : rati
 	fastIntegrator( NULL ), functionToWrap( input.functionToWrap ), multiDimensionIntegrator( NULL ), oneDimensionIntegrator( NULL ),
 	pseudoRandomIntegration(input.pseudoRandomIntegration), functionCanIntegrate( input.functionCanIntegrate ), haveTestedIntegral( true ),
 	RapidFitIntegratorNumerical( input.RapidFitIntegratorNumerical ), obs_check( input.obs_check ), checked_list( input.checked_list ),
-	num_threads(input.num_threads), GSLFixedPoints( input.GSLFixedPoints ),
+	num_threads(input.num_threads), workerPool(NULL), workerChunkSize(0), GSLFixedPoints( input.GSLFixedPoints ),
+	maxIntegrationSteps( __DEFAULT_RAPIDFIT_MAXINTEGRALSTEPS ), integrationAbsTolerance( __DEFAULT_RAPIDFIT_INTABSTOL ), integrationRelTolerance( __DEFAULT_RAPIDFIT_INTRELTOL ),
+	integratorLock(), gslColumns(), gslNumberPoints(0), gslMinima(), gslMaxima(), gslObservableNames(), gslSlices(), gslBoundaryID(0), threadFunctions(),
 	_storedConfig( input._storedConfig==NULL?NULL:new RapidFitIntegratorConfig( *input._storedConfig ) )
 {
+	pthread_mutex_init( &integratorLock, NULL );
+
 	//	We don't own the PDF so no need to duplicate it as we have to be told which one to use
 	//if( input.functionToWrap != NULL ) functionToWrap = ClassLookUp::CopyPDF( input.functionToWrap );
 
 	//	Only Construct the Integrators if they are required
 	if( input.fastIntegrator != NULL ) fastIntegrator = new FoamIntegrator( *(input.fastIntegrator) );
-	if( input.multiDimensionIntegrator != NULL )
-	{
-		multiDimensionIntegrator = new AdaptiveIntegratorMultiDim();// *(input.multiDimensionIntegrator) );//new AdaptiveIntegratorMultiDim();
-		//      These functions only exist with ROOT > 5.27 I think, at least they exist in 5.28/29
-#if ROOT_VERSION_CODE > ROOT_VERSION(5,28,0)
-		multiDimensionIntegrator->SetAbsTolerance( __DEFAULT_RAPIDFIT_INTABSTOL );      //      Absolute error for things such as plots
-		multiDimensionIntegrator->SetRelTolerance( __DEFAULT_RAPIDFIT_INTRELTOL );
-		multiDimensionIntegrator->SetMaxPts( __DEFAULT_RAPIDFIT_MAXINTEGRALSTEPS );
-#endif
-	}
-	if( input.oneDimensionIntegrator != NULL )
-	{
-		//ROOT::Math::IntegrationOneDim::Type type = ROOT::Math::IntegrationOneDim::kGAUSS;
-		//(void) type;	//	For the global state of ROOT
-		//oneDimensionIntegrator = new IntegratorOneDim( type );//*(input.oneDimensionIntegrator) );
-		oneDimensionIntegrator = new IntegratorOneDim( *(input.oneDimensionIntegrator) );
-	}
-	else
-	{
-		ROOT::Math::IntegrationOneDim::Type type = ROOT::Math::IntegrationOneDim::kGAUSS;
-		oneDimensionIntegrator = new IntegratorOneDim(type);
-	}
+	//	The GSL points and PDF copies are not shared, each instance builds its own when required
+	if( input.multiDimensionIntegrator != NULL ) multiDimensionIntegrator = this->NewMultiDimIntegrator();
+	//	Don't copy the input 1D integrator, it may be in use by another thread
+	ROOT::Math::IntegrationOneDim::Type type = ROOT::Math::IntegrationOneDim::kGAUSS;
+	oneDimensionIntegrator = new IntegratorOneDim(type);
 }
 
 void RapidFitIntegrator::SetUpIntegrator( const RapidFitIntegratorConfig* config )
@@ -130,8 +108,21 @@ RapidFitIntegratorConfig* RapidFitIntegrator::GetIntegratorConfig() const
 	return _storedConfig;
 }
 
+AdaptiveIntegratorMultiDim* RapidFitIntegrator::NewMultiDimIntegrator() const
+{
+	AdaptiveIntegratorMultiDim* thisIntegrator = new AdaptiveIntegratorMultiDim();
+	//      These functions only exist with ROOT > 5.27 I think, at least they exist in 5.28/29
+#if ROOT_VERSION_CODE > ROOT_VERSION(5,28,0)
+	thisIntegrator->SetAbsTolerance( integrationAbsTolerance );
+	thisIntegrator->SetRelTolerance( integrationRelTolerance );
+	thisIntegrator->SetMaxPts( maxIntegrationSteps );
+#endif
+	return thisIntegrator;
+}
+
 void RapidFitIntegrator::SetMaxIntegrationSteps( const unsigned int input )
 {
+	maxIntegrationSteps = input;
 #if ROOT_VERSION_CODE > ROOT_VERSION(5,28,0)
 	multiDimensionIntegrator->SetMaxPts( input );
 #endif
@@ -139,6 +130,7 @@ void RapidFitIntegrator::SetMaxIntegrationSteps( const unsigned int input )
 
 void RapidFitIntegrator::SetIntegrationAbsTolerance( const double input )
 {
+	integrationAbsTolerance = input;
 #if ROOT_VERSION_CODE > ROOT_VERSION(5,28,0)
 	multiDimensionIntegrator->SetAbsTolerance( input );
 #endif
@@ -146,6 +138,7 @@ void RapidFitIntegrator::SetIntegrationAbsTolerance( const double input )
 
 void RapidFitIntegrator::SetIntegrationRelTolerance( const double input )
 {
+	integrationRelTolerance = input;
 #if ROOT_VERSION_CODE > ROOT_VERSION(5,28,0)
 	multiDimensionIntegrator->SetRelTolerance( input );
 #endif
@@ -156,6 +149,12 @@ void RapidFitIntegrator::SetNumThreads( const unsigned int input )
 	num_threads = input;
 }
 
+void RapidFitIntegrator::SetWorkerPool( ThreadPool* input, const unsigned int chunkSize )
+{
+	workerPool = input;
+	workerChunkSize = chunkSize;
+}
+
 bool RapidFitIntegrator::GetUseGSLIntegrator() const
 {
 	return pseudoRandomIntegration;
@@ -183,12 +182,9 @@ void RapidFitIntegrator::SetFixedIntegralPoints( const unsigned int input )
 //	Don't want the projections to be insanely accurate
 void RapidFitIntegrator::ProjectionSettings()
 {
-	//	These functions only exist with ROOT > 5.27 I think, at least they exist in 5.28/29
-#if ROOT_VERSION_CODE > ROOT_VERSION(5,28,0)
-	multiDimensionIntegrator->SetAbsTolerance( 1E-4 );	//	Absolute error for things such as plots
-	multiDimensionIntegrator->SetRelTolerance( 1E-4 );
-	multiDimensionIntegrator->SetMaxPts( 10000 );
-#endif
+	this->SetIntegrationAbsTolerance( 1E-4 );	//	Absolute error for things such as plots
+	this->SetIntegrationRelTolerance( 1E-4 );
+	this->SetMaxIntegrationSteps( 10000 );
 }
 
 RapidFitIntegrator::~RapidFitIntegrator()
@@ -196,8 +192,14 @@ RapidFitIntegrator::~RapidFitIntegrator()
 	if( multiDimensionIntegrator != NULL ) delete multiDimensionIntegrator;
 	if( oneDimensionIntegrator != NULL ) delete oneDimensionIntegrator;
 	if( fastIntegrator != NULL ) delete fastIntegrator;
-	//this->clearGSLIntegrationPoints();
+	this->clearGSLIntegrationPoints();
+	while( !threadFunctions.empty() )
+	{
+		if( threadFunctions.back() != NULL ) delete threadFunctions.back();
+		threadFunctions.pop_back();
+	}
 	if( this->_storedConfig != NULL ) delete this->_storedConfig;
+	pthread_mutex_destroy( &integratorLock );
 }
 
 //Return the integral over all observables
@@ -372,6 +374,11 @@ IPDF * RapidFitIntegrator::GetPDF() const
 void RapidFitIntegrator::SetPDF( IPDF* input )
 {
 	functionToWrap = input;
+	while( !threadFunctions.empty() )
+	{
+		if( threadFunctions.back() != NULL ) delete threadFunctions.back();
+		threadFunctions.pop_back();
+	}
 }
 
 /*
@@ -475,30 +482,20 @@ double RapidFitIntegrator::OneDimentionIntegral( IPDF* functionToWrap, Integrato
 
 	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) ) cout << "RapidFitIntegrator:: Evaluating Points" << endl;
 
-	vector<double> evals;
-	for( unsigned int i=0; i< n_eval; ++i )
+	CompensatedSum evals;
+	const unsigned int n_points = n_eval;
+	for( unsigned int i=0; i< n_points; ++i )
 	{
 		try{
-			evals.push_back( functionToWrap->Evaluate( thesePoints[i] ) );
+			evals.Add( functionToWrap->Evaluate( thesePoints[i] ) );
 		}
 		catch(...)
 		{
-			evals.push_back( 0. );
 			--n_eval;
 		}
 	}
 
-	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) ) cout << "RapidFitIntegrator:: Sorting Results" << endl;
-
-	sort( evals.begin(), evals.end() );
-
-	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) ) cout << "RapidFitIntegrator:: Adding Results" << endl;
-
-	double output=0.;
-	for( unsigned int i=0; i< evals.size(); ++i )
-	{
-		output+= evals[i];
-	}
+	double output=evals.Sum();
 
 	//cout << output << endl;
 	//cout << maximum-minimum << endl;
@@ -601,20 +598,14 @@ double RapidFitIntegrator::PseudoRandomNumberIntegral( IPDF* functionToWrap, con
 #endif
 }
 
-vector<DataPoint*> RapidFitIntegrator::initGSLDataPoints( unsigned int number, vector<double> maxima, vector<double> minima, DataPoint* templateDataPoint, vector<string> doIntegrate )
+vector<double> RapidFitIntegrator::initGSLDataPoints( unsigned int number, vector<double> maxima, vector<double> minima )
 {
-	vector<DataPoint*> doEval_points;
-	pthread_mutex_lock( &GSL_DATAPOINT_MANAGEMENT_THREADLOCK );
+	vector<double> columns;
 
 #ifdef __RAPIDFIT_USE_GSL
 
 	unsigned int nDim = (unsigned) minima.size();
 
-	unsigned int npoint = number;
-	vector<double> * integrationPoints = new vector<double>[ nDim ];
-
-	//pthread_mutex_lock( &gsl_mutex );
-	//cout << "Allocating GSL Integration Tool. nDim " << nDim << endl;
 	gsl_qrng * q = NULL;
 	try
 	{
@@ -635,133 +626,160 @@ vector<DataPoint*> RapidFitIntegrator::initGSLDataPoints( unsigned int number, v
 		exit(-741);
 	}
 
-	double* v = new double[ nDim ];
-	for( unsigned int i = 0; i < npoint; i++)
+	//	One column per observable, scaled to the range being integrated
+	columns.resize( nDim * number );
+	vector<double> v( nDim, 0. );
+	for( unsigned int i = 0; i < number; i++)
 	{
-		gsl_qrng_get( q, v );
+		gsl_qrng_get( q, &(v[0]) );
 		for( unsigned int j = 0; j < nDim; j++)
 		{
-			integrationPoints[j].push_back( v[j] );
+			columns[ j*number + i ] = v[j]*(maxima[j]-minima[j])+minima[j];
 		}
 	}
-	delete v;
 	gsl_qrng_free(q);
-	//cout << "Freed GSL Integration Tool" << endl;
-	//pthread_mutex_unlock( &gsl_mutex );
-
-	/*vector<double> minima_v, maxima_v;
-	  for( unsigned int i=0; i< nDim; ++i )
-	  {
-	  minima_v.push_back( minima[i] );
-	  maxima_v.push_back( maxima[i] );
-	  }*/
-	//cout << "Constructing Functions" << endl;
-	//IntegratorFunction* quickFunction = new IntegratorFunction( functionToWrap, NewDataPoint, doIntegrate, dontIntegrate, NewBoundary, componentIndex, minima_v, maxima_v );
+#endif
 
-	for (unsigned int i = 0; i < integrationPoints[0].size(); ++i)
-	{
-		double* point = new double[ nDim ];
-		for ( unsigned int j = 0; j < nDim; j++)
-		{
-			//cout << doIntegrate[j] << " " << maxima[j] << " " << minima[j] << " " << integrationPoints[j][i] << endl;
-			point[j] = integrationPoints[j][i]*(maxima[j]-minima[j])+minima[j];
-		}
+	(void) maxima; (void) minima; (void) number;
+	return columns;
+}
 
-		DataPoint* thisPoint = new DataPoint( *templateDataPoint );
+vector<IDataSet*> RapidFitIntegrator::getGSLIntegrationPoints( unsigned int number, vector<double> maxima, vector<double> minima, DataPoint* templateDataPoint, vector<string> doIntegrate,
+		const PhaseSpaceBoundary* thisBound, unsigned int nThreads )
+{
+	//	The quasi-random numbers only depend on the observables, their ranges and the number of points
+	bool newPoints = ( number != gslNumberPoints ) || ( gslMinima != minima ) || ( gslMaxima != maxima ) || ( gslObservableNames != doIntegrate );
+	if( newPoints )
+	{
+		this->clearGSLIntegrationPoints();
+		gslColumns = RapidFitIntegrator::initGSLDataPoints( number, maxima, minima );
+		gslNumberPoints = number;
+		gslMinima = minima;
+		gslMaxima = maxima;
+		gslObservableNames = doIntegrate;
+	}
 
-		thisPoint->ClearPerEventData();
-		vector<string> allObs=thisPoint->GetAllNames();
-		for( unsigned int j=0; j<allObs.size(); ++j )
+	//	Build the DataPoints once per point set, PhaseSpace and number of threads, with one DataSet for each thread
+	if( newPoints || gslSlices.size() != nThreads || gslBoundaryID != thisBound->GetID() )
+	{
+		while( !gslSlices.empty() )
 		{
-			Observable* thisObs = thisPoint->GetObservable( j );
-			thisObs->SetBinNumber(-1);
-			thisObs->SetBkgBinNumber(-1);
+			if( gslSlices.back() != NULL ) delete gslSlices.back();
+			gslSlices.pop_back();
 		}
 
-		for( unsigned int k=0; k< doIntegrate.size(); ++k )
+		PhaseSpaceBoundary* sliceBound = new PhaseSpaceBoundary( *thisBound );
+		DataPoint thisPoint( *templateDataPoint );
+		thisPoint.ClearPerEventData();
+
+		//	Same split as Threading::divideData, the remainder goes on the last thread
+		unsigned int sliceSize = number / nThreads;
+		for( unsigned int t=0; t< nThreads; ++t )
 		{
-			thisPoint->SetObservable( doIntegrate[k], point[k], "noUnitsHere" );
+			MemoryDataSet* thisSlice = new MemoryDataSet( sliceBound );
+			unsigned int end = ( t+1 == nThreads ) ? number : (t+1)*sliceSize;
+			for( unsigned int i=t*sliceSize; i< end; ++i )
+			{
+				for( unsigned int k=0; k< doIntegrate.size(); ++k )
+				{
+					thisPoint.SetObservable( doIntegrate[k], gslColumns[ k*number + i ], "noUnitsHere" );
+				}
+				thisSlice->SafeAddDataPoint( &thisPoint );
+			}
+			gslSlices.push_back( (IDataSet*) thisSlice );
 		}
+		delete sliceBound;
 
-		doEval_points.push_back( thisPoint );
-		//result += quickFunction->DoEval( point );
-		delete[] point;
+		gslBoundaryID = thisBound->GetID();
 	}
 
-	delete[] integrationPoints;
-#endif
-
-	(void) maxima; (void) minima; (void) number;
-	pthread_mutex_unlock( &GSL_DATAPOINT_MANAGEMENT_THREADLOCK );
-	return doEval_points;
-}
-
-vector<DataPoint*> RapidFitIntegrator::getGSLIntegrationPoints( unsigned int number, vector<double> maxima, vector<double> minima, DataPoint* templateDataPoint, vector<string> doIntegrate, PhaseSpaceBoundary* thisBound )
-{
-	pthread_mutex_lock( &GSL_DATAPOINT_GET_THREADLOCK );
+	//	Only the observables which aren't being integrated change between calls, copy them from the template DataPoint
+	vector<string> allObs = templateDataPoint->GetAllNames();
+	vector<ObservableRef> copyObs;
+	vector<Observable*> templateObs;
+	for( unsigned int j=0; j< allObs.size(); ++j )
+	{
+		if( StringProcessing::VectorContains( &doIntegrate, &(allObs[j]) ) != -1 ) continue;
+		copyObs.push_back( ObservableRef( allObs[j] ) );
+		templateObs.push_back( templateDataPoint->GetObservable( allObs[j] ) );
+	}
 
-	bool pointsGood = true;
-	if( !_global_doEval_points.empty() )
+	for( unsigned int t=0; t< gslSlices.size(); ++t )
 	{
-		if( _global_doEval_points[0] != NULL )
+		int sliceNumber = gslSlices[t]->GetDataNumber();
+		for( int i=0; i< sliceNumber; ++i )
 		{
-			vector<string> allConsts = thisBound->GetDiscreteNames();
-			for( unsigned int i=0; i< allConsts.size(); ++i )
+			DataPoint* thisPoint = gslSlices[t]->GetDataPoint( i );
+			bool changed = false;
+			for( unsigned int j=0; j< copyObs.size(); ++j )
 			{
-				double haveVal = _global_doEval_points[0]->GetObservable( allConsts[i] )->GetValue();
-				double wantVal = templateDataPoint->GetObservable( allConsts[i] )->GetValue();
-
-				if( haveVal != wantVal )
+				const double oldValue = thisPoint->GetObservable( copyObs[j] )->GetValue();
+				const double newValue = templateObs[j]->GetValue();
+				if( memcmp( &oldValue, &newValue, sizeof(double) ) != 0 )
 				{
-					pointsGood = false;
-					break;
+					thisPoint->SetObservable( copyObs[j], templateObs[j] );
+					Observable* thisObs = thisPoint->GetObservable( copyObs[j] );
+					thisObs->SetBinNumber( -1 );
+					thisObs->SetBkgBinNumber( -1 );
+					changed = true;
 				}
 			}
+			//	The discrete combination may have changed with them
+			if( changed )
+			{
+				thisPoint->ClearDiscreteIndexMap();
+				thisPoint->SetDiscreteIndex( templateDataPoint->GetDiscreteIndex() );
+				thisPoint->SetDiscreteIndexID( templateDataPoint->GetDiscreteIndexID() );
+			}
+			thisPoint->ClearPerEventData();
 		}
 	}
 
-	if( ( number != _global_doEval_points.size() ) || (( ( _global_range_minima != minima ) || ( _global_range_maxima != maxima ) ) || !pointsGood ) )
+	return gslSlices;
+}
+
+void RapidFitIntegrator::clearGSLIntegrationPoints()
+{
+	while( !gslSlices.empty() )
 	{
-		clearGSLIntegrationPoints();
-		_global_doEval_points = initGSLDataPoints( number, maxima, minima, templateDataPoint, doIntegrate );
-		_global_range_minima = minima;
-		_global_range_maxima = maxima;
-		_global_observable_names = doIntegrate;
+		if( gslSlices.back() != NULL ) delete gslSlices.back();
+		gslSlices.pop_back();
 	}
+	gslColumns.clear();
+	gslNumberPoints = 0;
+	gslMinima.clear();
+	gslMaxima.clear();
+	gslObservableNames.clear();
+	gslBoundaryID = 0;
+}
 
-	vector<string> allObs = _global_doEval_points[0]->GetAllNames();
-	for( unsigned int i=0; i< _global_doEval_points.size(); ++i )
+vector<IPDF*> RapidFitIntegrator::GetThreadFunctions( const unsigned int nThreads )
+{
+	if( threadFunctions.size() == nThreads )
 	{
-		DataPoint* thisPoint = _global_doEval_points[i];
-		for( unsigned int j=0; j< allObs.size(); ++j )
+		for( unsigned int i=0; i< nThreads; ++i )
 		{
-			Observable* thisObs = thisPoint->GetObservable( j );
-			thisObs->SetBinNumber( -1 );
-			thisObs->SetBkgBinNumber( -1 );
+			threadFunctions[i]->UpdatePhysicsParameters( functionToWrap->GetPhysicsParameters() );
 		}
-		thisPoint->ClearPerEventData();
+		return threadFunctions;
 	}
 
-	pthread_mutex_unlock( &GSL_DATAPOINT_GET_THREADLOCK );
-	return _global_doEval_points;
-}
+	while( !threadFunctions.empty() )
+	{
+		if( threadFunctions.back() != NULL ) delete threadFunctions.back();
+		threadFunctions.pop_back();
+	}
 
-void RapidFitIntegrator::clearGSLIntegrationPoints()
-{
-	pthread_mutex_lock( &GSL_DATAPOINT_MANAGEMENT_THREADLOCK );
-	while( !_global_doEval_points.empty() )
+	for( unsigned int i=0; i< nThreads; ++i )
 	{
-		if( _global_doEval_points.back() != NULL ) delete _global_doEval_points.back();
-		_global_doEval_points.pop_back();
+		threadFunctions.push_back( ClassLookUp::CopyPDF( functionToWrap ) );
 	}
-	_global_range_minima.clear();
-	_global_range_maxima.clear();
-	_global_observable_names.clear();
-	pthread_mutex_unlock( &GSL_DATAPOINT_MANAGEMENT_THREADLOCK );
+
+	return threadFunctions;
 }
 
-double RapidFitIntegrator::PseudoRandomNumberIntegralThreaded( IPDF* functionToWrap, const DataPoint * NewDataPoint, const PhaseSpaceBoundary * NewBoundary,
-		ComponentRef* componentIndex, vector<string> doIntegrate, vector<string> dontIntegrate, unsigned int num_threads, unsigned int GSLFixedPoints )
+double RapidFitIntegrator::PseudoRandomNumberIntegralThreaded( const DataPoint * NewDataPoint, const PhaseSpaceBoundary * NewBoundary,
+		ComponentRef* componentIndex, vector<string> doIntegrate, vector<string> dontIntegrate )
 {
 #ifdef __RAPIDFIT_USE_GSL
 
@@ -825,55 +843,36 @@ double RapidFitIntegrator::PseudoRandomNumberIntegralThreaded( IPDF* functionToW
 		maxima_v.push_back( maxima[i] );
 	}
 
-	//	the whole new/delete here is because I'm too lazy to lookup how to cast away the const from a pointer...
+	const unsigned int nThreads = num_threads > 0 ? num_threads : 1;
 
-	DataPoint* templateDataPoint = new DataPoint( *NewDataPoint );
+	DataPoint templateDataPoint( *NewDataPoint );
 
-	PhaseSpaceBoundary* thisBound = new PhaseSpaceBoundary( *NewBoundary );
-
-	vector<DataPoint*> doEval_points = RapidFitIntegrator::getGSLIntegrationPoints( GSLFixedPoints, maxima_v, minima_v, templateDataPoint, doIntegrate, thisBound );
-
-	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
-	{
-		cout << "RapidFitIntegrator:: " << doEval_points.size() << " GSL Points" << endl;
-	}
-
-	delete templateDataPoint;
-
-	IDataSet* thisDataSet = new MemoryDataSet( thisBound, doEval_points );
-
-	delete thisBound;
+	//	These persist between calls, only the observables which aren't integrated are updated
+	vector<IDataSet*> payLoad = this->getGSLIntegrationPoints( GSLFixedPoints, maxima_v, minima_v, &templateDataPoint, doIntegrate, NewBoundary, nThreads );
 
 	ThreadingConfig* thisConfig = new ThreadingConfig();
-	thisConfig->numThreads = num_threads;
+	thisConfig->numThreads = nThreads;
 	thisConfig->MultiThreadingInstance = "pthreads";
+	thisConfig->workerPool = workerPool;
+	thisConfig->chunkSize = workerChunkSize;
 
 	if( componentIndex != NULL ) thisConfig->wantedComponent = new ComponentRef( *componentIndex );
 	else thisConfig->wantedComponent = NULL;
 
-	//	thisDataSet->GetDataPoint( 0 )->Print();
-
-	//	cout << functionToWrap->GetName() << "\t0:\t" << functionToWrap->Evaluate( thisDataSet->GetDataPoint( 0 ) ) << endl;
-
-	//	cout << functionToWrap->GetName() << "\t100:\t" << functionToWrap->Evaluate( thisDataSet->GetDataPoint( 100 ) ) << endl;
-
-	//	if( componentIndex != NULL ) cout << functionToWrap->GetName() << "\t" << thisConfig->wantedComponent->getComponentName() << ":\t" << functionToWrap->EvaluateComponent( thisDataSet->GetDataPoint( 0 ), thisConfig->wantedComponent ) << endl;
-
 	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
 	{
-		cout << "RapidFitIntegrator:: " << thisDataSet->GetDataNumber() << "  " << functionToWrap->GetLabel() << "  th: " << num_threads << endl;
-		thisDataSet->GetDataPoint( 0 )->Print();
+		cout << "RapidFitIntegrator:: " << GSLFixedPoints << " GSL Points  " << functionToWrap->GetLabel() << "  th: " << nThreads << endl;
+		payLoad[0]->GetDataPoint( 0 )->Print();
 	}
 
-	vector<double>* thisSet = MultiThreadedFunctions::ParallelEvaluate( functionToWrap, thisDataSet, thisConfig );
+	//	Each thread evaluates its own copy of the PDF, these belong to this integrator so nothing is shared with other instances
+	vector<double>* thisSet = MultiThreadedFunctions::ParallelEvaluate( this->GetThreadFunctions( nThreads ), payLoad, thisConfig );
 
 	if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
 	{
 		cout << "RapidFitIntegrator:: Finished Eval" << endl;
 	}
 
-	delete thisDataSet;
-
 	//	DebugClass::Dump2TTree( DebugClass::GetUniqueROOTFileName(), *thisSet );
 
 	if( thisConfig->wantedComponent != NULL ) delete thisConfig->wantedComponent;
@@ -881,15 +880,14 @@ double RapidFitIntegrator::PseudoRandomNumberIntegralThreaded( IPDF* functionToW
 
 	double number_points = (double)GSLFixedPoints;
 
-	double result=0.;
+	CompensatedSum sumPoints;
 	double thisNum=0.;
-	sort( thisSet->begin(), thisSet->end() );
 	for( unsigned int i=0; i< thisSet->size(); ++i )
 	{
 		thisNum=thisSet->at( i );
 		if( ( !std::isnan(thisNum) && fabs(thisNum)<DBL_MAX ) && ( !std::isinf(thisNum) ) )
 		{
-			result+=thisNum;
+			sumPoints.Add( thisNum );
 		}
 		else// if( std::isnan(thisNum) || std::isinf(thisNum) )
 		{
@@ -897,6 +895,8 @@ double RapidFitIntegrator::PseudoRandomNumberIntegralThreaded( IPDF* functionToW
 		}
 	}
 
+	double result=sumPoints.Sum();
+
 	//cout << result << endl;
 
 	double factor=1.;
@@ -933,7 +933,7 @@ double RapidFitIntegrator::PseudoRandomNumberIntegralThreaded( IPDF* functionToW
 
 	return result;
 #else
-	(void) functionToWrap; (void) NewDataPoint; (void) NewBoundary; (void) componentIndex; (void) doIntegrate; (void) dontIntegrate; (void) num_threads;
+	(void) NewDataPoint; (void) NewBoundary; (void) componentIndex; (void) doIntegrate; (void) dontIntegrate;
 	return -99999.;
 #endif
 }
@@ -1109,83 +1109,85 @@ double RapidFitIntegrator::DoNumericalIntegral( const DataPoint * NewDataPoint,
 	}
 	else
 	{
-		for( vector<DataPoint*>::iterator dataPoint_i = DiscreteIntegrals.begin(); dataPoint_i != DiscreteIntegrals.end(); ++dataPoint_i )
+		//	The integrators, GSL points and functionToWrap can only be used by one thread at a time
+		pthread_mutex_lock( &integratorLock );
+
+		try
 		{
-			double numericalIntegral = 0.;
-			//Chose the one dimensional or multi-dimensional method
-			if( doIntegrate.size() == 1 )
-			{
-				if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
-				{
-					cout << "RapidFitIntegrator: One Dimensional Integral" << endl;
-				}
-				pthread_mutex_lock( &one_dim_lock );
-				numericalIntegral += this->OneDimentionIntegral( functionToWrap, oneDimensionIntegrator, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate );
-				//cout << "ret: " << numericalIntegral << endl;
-				pthread_mutex_unlock( &one_dim_lock );
-			}
-			else
+			for( vector<DataPoint*>::iterator dataPoint_i = DiscreteIntegrals.begin(); dataPoint_i != DiscreteIntegrals.end(); ++dataPoint_i )
 			{
-				if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
-				{
-					cout << "RapidFitIntegrator: Multi Dimensional Integral" << endl;
-				}
-				if( !pseudoRandomIntegration )
+				double numericalIntegral = 0.;
+				//Chose the one dimensional or multi-dimensional method
+				if( doIntegrate.size() == 1 )
 				{
-					pthread_mutex_lock( &multi_dim_lock );
-					numericalIntegral += this->MultiDimentionIntegral( functionToWrap, multiDimensionIntegrator, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate );
-					pthread_mutex_unlock( &multi_dim_lock );
+					if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
+					{
+						cout << "RapidFitIntegrator: One Dimensional Integral" << endl;
+					}
+					numericalIntegral += this->OneDimentionIntegral( functionToWrap, oneDimensionIntegrator, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate );
+					//cout << "ret: " << numericalIntegral << endl;
 				}
 				else
 				{
 					if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
 					{
-						cout << "RapidFitIntegrator: Using GSL PseudoRandomNumber :D" << endl;
+						cout << "RapidFitIntegrator: Multi Dimensional Integral" << endl;
 					}
-					//numericalIntegral += this->PseudoRandomNumberIntegral( functionToWrap, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate, GSLFixedPoints );
-					numericalIntegral += this->PseudoRandomNumberIntegralThreaded( functionToWrap, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate, num_threads, GSLFixedPoints );
-					if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
+					if( !pseudoRandomIntegration )
 					{
-						cout << "RapidFitIntegrator: Finished: " << numericalIntegral << endl;
+						numericalIntegral += this->MultiDimentionIntegral( functionToWrap, multiDimensionIntegrator, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate );
 					}
-
-					if( numericalIntegral <= -99999. )
+					else
 					{
-						pthread_mutex_lock( &check_settings_lock );
-						cout << "Calculated a -ve Integral: " << numericalIntegral << ". Did you Compile with the GSL options Enabled with gsl available?" << endl;
-						//cout << endl;	exit(-2356);
-						cout << "Reverting to non-GSL integration" << endl;
-
-						if( doIntegrate.size() == 1 )
+						if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
 						{
-							pthread_mutex_lock( &one_dim_lock );
-							numericalIntegral = this->OneDimentionIntegral( functionToWrap, oneDimensionIntegrator, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate );
-							pthread_mutex_unlock( &one_dim_lock );
+							cout << "RapidFitIntegrator: Using GSL PseudoRandomNumber :D" << endl;
 						}
-						else
+						//numericalIntegral += this->PseudoRandomNumberIntegral( functionToWrap, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate, GSLFixedPoints );
+						numericalIntegral += this->PseudoRandomNumberIntegralThreaded( *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate );
+						if( DebugClass::DebugThisClass( "RapidFitIntegrator" ) )
 						{
-							pthread_mutex_lock( &multi_dim_lock );
-							numericalIntegral = this->MultiDimentionIntegral( functionToWrap, multiDimensionIntegrator, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate );
-							pthread_mutex_unlock( &multi_dim_lock );
+							cout << "RapidFitIntegrator: Finished: " << numericalIntegral << endl;
+						}
+
+						if( numericalIntegral <= -99999. )
+						{
+							cout << "Calculated a -ve Integral: " << numericalIntegral << ". Did you Compile with the GSL options Enabled with gsl available?" << endl;
+							//cout << endl;	exit(-2356);
+							cout << "Reverting to non-GSL integration" << endl;
+
+							if( doIntegrate.size() == 1 )
+							{
+								numericalIntegral = this->OneDimentionIntegral( functionToWrap, oneDimensionIntegrator, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate );
+							}
+							else
+							{
+								numericalIntegral = this->MultiDimentionIntegral( functionToWrap, multiDimensionIntegrator, *dataPoint_i, NewBoundary, componentIndex, doIntegrate, dontIntegrate );
+							}
+							this->SetUseGSLIntegrator( false );
 						}
-						this->SetUseGSLIntegrator( false );
-						pthread_mutex_unlock( &check_settings_lock );
 					}
 				}
-			}
 
-			if( !haveTestedIntegral && !functionToWrap->GetNumericalNormalisation() )
-			{
-				double testIntegral = functionToWrap->Integral( *dataPoint_i, NewBoundary );
-				cout << "Integration Test: numerical : analytical  " << setw(7) << numericalIntegral << " : " << testIntegral;
-				string description = NewBoundary->DiscreteDescription( *dataPoint_i );
-				description = description.substr(0, description.size()-2);
-				cout << "  "  << description << "  " << functionToWrap->GetLabel() << endl;
-			}
+				if( !haveTestedIntegral && !functionToWrap->GetNumericalNormalisation() )
+				{
+					double testIntegral = functionToWrap->Integral( *dataPoint_i, NewBoundary );
+					cout << "Integration Test: numerical : analytical  " << setw(7) << numericalIntegral << " : " << testIntegral;
+					string description = NewBoundary->DiscreteDescription( *dataPoint_i );
+					description = description.substr(0, description.size()-2);
+					cout << "  "  << description << "  " << functionToWrap->GetLabel() << endl;
+				}
 
-			output_val += numericalIntegral;
+				output_val += numericalIntegral;
+			}
 		}
-		//cout << "output: " << output_val << endl;
+		catch(...)
+		{
+			pthread_mutex_unlock( &integratorLock );
+			throw;
+		}
+
+		pthread_mutex_unlock( &integratorLock );
 	}
 
 	while( !DiscreteIntegrals.empty() )
@@ -1198,17 +1200,6 @@ double RapidFitIntegrator::DoNumericalIntegral( const DataPoint * NewDataPoint,
 	return output_val;
 }
 
-void RapidFitIntegrator::ModifiyStoredPoints( DataPoint* NewDataPoint, string ProjectThis )
-{
-	ObservableRef thisObs_Ext( ProjectThis );
-	ObservableRef thisObs_Int( ProjectThis );
-	for( unsigned int i=0; i< _global_doEval_points.size(); ++i )
-	{
-		Observable* InputObs = NewDataPoint->GetObservable( thisObs_Ext );
-		_global_doEval_points[i]->SetObservable( thisObs_Int, InputObs );
-	}
-}
-
 //Return the integral over all observables except one
 double RapidFitIntegrator::ProjectObservable( DataPoint* NewDataPoint, PhaseSpaceBoundary * NewBoundary, string ProjectThis, ComponentRef* Component )
 {
@@ -1216,19 +1207,6 @@ double RapidFitIntegrator::ProjectObservable( DataPoint* NewDataPoint, PhaseSpac
 	vector<string> dontIntegrate = functionToWrap->GetDoNotIntegrateList();
 	double value = -1.;
 
-	if( this->GetUseGSLIntegrator() )
-	{
-		if( GSLvalidFor == ProjectThis )
-		{
-			this->ModifiyStoredPoints( NewDataPoint, ProjectThis );
-		}
-		else
-		{
-			this->clearGSLIntegrationPoints();
-			GSLvalidFor="";
-		}
-	}
-
 	vector<string> allIntegrable = functionToWrap->GetPrototypeDataPoint();
 
 	vector<string> testedIntegrable;
@@ -1326,7 +1304,6 @@ double RapidFitIntegrator::ProjectObservable( DataPoint* NewDataPoint, PhaseSpac
 		value = this->NumericallyIntegrateDataPoint( NewDataPoint, NewBoundary, dontIntegrate, Component );
 	}
 
-	GSLvalidFor = ProjectThis;
 	return value;
 }
 
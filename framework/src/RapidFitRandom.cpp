@@ -15,6 +15,7 @@
 void RapidFitRandom::SetRandomFunction( int num )
 {
 	RapidFitRandom::seed_num = num;
+	RapidFitRandom::stream_seed_set = false;
 	if( RapidFitRandom::seed_function != NULL ) delete RapidFitRandom::seed_function;
 	RapidFitRandom::seed_function = new TRandom3( RapidFitRandom::seed_num );
 }
@@ -29,6 +30,7 @@ void RapidFitRandom::SetRandomFunction( int num )
 void RapidFitRandom::SetRandomFunction( TRandom3* Input )
 {
 	RapidFitRandom::seed_num = (int)ceil(Input->Rndm() * 1E5);
+	RapidFitRandom::stream_seed_set = false;
 	if( RapidFitRandom::seed_function != NULL ) delete RapidFitRandom::seed_function;
 	RapidFitRandom::seed_function = new TRandom3( RapidFitRandom::seed_num );
 }
@@ -48,8 +50,12 @@ int RapidFitRandom::GetSeedNum()
  *
  * @return pointer to the TRandom3 instance inside the PDF
  */
-TRandom3* RapidFitRandom::GetRandomFunction()
+TRandom* RapidFitRandom::GetRandomFunction()
 {
+	pthread_once( &RapidFitRandom::thread_keys_once, RapidFitRandom::MakeThreadKeys );
+	TRandom* thread_function = (TRandom*) pthread_getspecific( RapidFitRandom::thread_seed_function );
+	if( thread_function != NULL ) return thread_function;
+
 	if( RapidFitRandom::seed_function == NULL )
 	{
 		if( RapidFitRandom::seed_num < 0 )
@@ -67,6 +73,10 @@ TRandom3* RapidFitRandom::GetRandomFunction()
 
 TRandom3* RapidFitRandom::GetFrameworkRandomFunction()
 {
+	pthread_once( &RapidFitRandom::thread_keys_once, RapidFitRandom::MakeThreadKeys );
+	TRandom3* thread_function = (TRandom3*) pthread_getspecific( RapidFitRandom::thread_seed_function_Framework );
+	if( thread_function != NULL ) return thread_function;
+
 	if( RapidFitRandom::seed_function_Framework == NULL )
 	{
 		//	We Explicityly use this to avoid collisions when small objects for caching are duplicated
@@ -82,6 +92,48 @@ int RapidFitRandom::GetSeedNumFramework()
 	return RapidFitRandom::GetFrameworkRandomFunction()->Rndm();
 }
 
+void RapidFitRandom::MakeThreadKeys()
+{
+	pthread_key_create( &RapidFitRandom::thread_seed_function, NULL );
+	pthread_key_create( &RapidFitRandom::thread_seed_function_Framework, NULL );
+}
+
+void RapidFitRandom::SetThreadRandomFunction( TRandom* Input )
+{
+	pthread_once( &RapidFitRandom::thread_keys_once, RapidFitRandom::MakeThreadKeys );
+	pthread_setspecific( RapidFitRandom::thread_seed_function, Input );
+}
+
+void RapidFitRandom::SetThreadFrameworkRandomFunction( TRandom3* Input )
+{
+	pthread_once( &RapidFitRandom::thread_keys_once, RapidFitRandom::MakeThreadKeys );
+	pthread_setspecific( RapidFitRandom::thread_seed_function_Framework, Input );
+}
+
+uint32_t RapidFitRandom::GetStreamSeed()
+{
+	if( !RapidFitRandom::stream_seed_set )
+	{
+		if( RapidFitRandom::seed_num == 0 )
+		{
+			//	Take this from the shared instance, not one set for this thread
+			if( RapidFitRandom::seed_function == NULL ) RapidFitRandom::seed_function = new TRandom3( 0 );
+			RapidFitRandom::stream_seed = (uint32_t) RapidFitRandom::seed_function->Integer( kMaxUInt );
+		}
+		else
+		{
+			RapidFitRandom::stream_seed = (uint32_t) RapidFitRandom::seed_num;
+		}
+		RapidFitRandom::stream_seed_set = true;
+	}
+	return RapidFitRandom::stream_seed;
+}
+
+RapidFitRandomStream* RapidFitRandom::MakeRandomStream( const uint64_t Stream, const uint32_t Thread )
+{
+	return new RapidFitRandomStream( RapidFitRandom::GetStreamSeed(), Stream, Thread );
+}
+
 /*!
  * vector of a single TRandom3 object for this PDF, this allows us to have a reproducable result for a defined seed
  * the seed_function.empty() is used to see if this is defined, should probably check for NULL pointer, but oh well
@@ -95,3 +147,13 @@ TRandom3 * RapidFitRandom::seed_function_Framework = NULL;
  */
 int RapidFitRandom::seed_num = -1;
 
+uint32_t RapidFitRandom::stream_seed = 0;
+
+bool RapidFitRandom::stream_seed_set = false;
+
+pthread_once_t RapidFitRandom::thread_keys_once = PTHREAD_ONCE_INIT;
+
+pthread_key_t RapidFitRandom::thread_seed_function;
+
+pthread_key_t RapidFitRandom::thread_seed_function_Framework;
+
@@ -0,0 +1,113 @@
+/*!
+ * @class RapidFitRandomStream
+ *
+ * @brief Counter-based random number stream (Philox4x32-10) which can be used anywhere a TRandom is expected
+ */
+
+///	RapidFit Headers
+#include "RapidFitRandomStream.h"
+
+namespace
+{
+	const uint32_t PhiloxM0 = 0xD2511F53U;
+	const uint32_t PhiloxM1 = 0xCD9E8D57U;
+	const uint32_t PhiloxW0 = 0x9E3779B9U;
+	const uint32_t PhiloxW1 = 0xBB67AE85U;
+
+	//	Two 32bit words to a double in (0,1) with 53bits of precision
+	inline double ToUniform( const uint32_t high, const uint32_t low )
+	{
+		const uint64_t bits = ( (uint64_t)( high >> 5 ) << 26 ) | (uint64_t)( low >> 6 );
+		return ( (double) bits + 0.5 ) * ( 1. / 9007199254740992. );
+	}
+}
+
+RapidFitRandomStream::RapidFitRandomStream( const uint32_t Seed, const uint64_t Stream, const uint32_t Thread ) :
+	TRandom( Seed ), stream( Stream ), position( 0 ), blockNumber( ~((uint64_t)0) )
+{
+	key[0] = Seed;
+	key[1] = Thread;
+	block[0] = block[1] = block[2] = block[3] = 0;
+}
+
+RapidFitRandomStream::~RapidFitRandomStream()
+{
+}
+
+void RapidFitRandomStream::Philox( uint32_t* counter, const uint32_t* input_key )
+{
+	uint32_t key0 = input_key[0];
+	uint32_t key1 = input_key[1];
+	for( unsigned int round=0; round< 10; ++round )
+	{
+		const uint64_t product0 = (uint64_t) PhiloxM0 * (uint64_t) counter[0];
+		const uint64_t product1 = (uint64_t) PhiloxM1 * (uint64_t) counter[2];
+		const uint32_t output0 = (uint32_t)( product1 >> 32 ) ^ counter[1] ^ key0;
+		const uint32_t output1 = (uint32_t) product1;
+		const uint32_t output2 = (uint32_t)( product0 >> 32 ) ^ counter[3] ^ key1;
+		const uint32_t output3 = (uint32_t) product0;
+		counter[0] = output0;
+		counter[1] = output1;
+		counter[2] = output2;
+		counter[3] = output3;
+		key0 += PhiloxW0;
+		key1 += PhiloxW1;
+	}
+}
+
+void RapidFitRandomStream::FillBlock()
+{
+	blockNumber = position >> 1;
+	block[0] = (uint32_t) blockNumber;
+	block[1] = (uint32_t)( blockNumber >> 32 );
+	block[2] = (uint32_t) stream;
+	block[3] = (uint32_t)( stream >> 32 );
+	RapidFitRandomStream::Philox( block, key );
+}
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+Double_t RapidFitRandomStream::Rndm()
+#else
+Double_t RapidFitRandomStream::Rndm( Int_t )
+#endif
+{
+	if( ( position >> 1 ) != blockNumber ) this->FillBlock();
+	const unsigned int half = 2 * (unsigned int)( position & 1 );
+	++position;
+	return ToUniform( block[half], block[half+1] );
+}
+
+void RapidFitRandomStream::RndmArray( Int_t n, Double_t* array )
+{
+	for( Int_t i=0; i< n; ++i ) array[i] = this->Rndm();
+}
+
+void RapidFitRandomStream::RndmArray( Int_t n, Float_t* array )
+{
+	for( Int_t i=0; i< n; ++i )
+	{
+		//	Rounding to a float can give exactly 1
+		Float_t value = 1.f;
+		while( value >= 1.f ) value = (Float_t) this->Rndm();
+		array[i] = value;
+	}
+}
+
+void RapidFitRandomStream::SetKey( const uint64_t Stream, const uint32_t Thread )
+{
+	stream = Stream;
+	key[1] = Thread;
+	position = 0;
+	blockNumber = ~((uint64_t)0);
+}
+
+void RapidFitRandomStream::SetPosition( const uint64_t Position )
+{
+	position = Position;
+}
+
+uint64_t RapidFitRandomStream::GetPosition() const
+{
+	return position;
+}
+
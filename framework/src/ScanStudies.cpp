@@ -1,4 +1,6 @@
 
+//	ROOT Headers
+#include "TRandom3.h"
 //	RapidFit Headers
 #include "ScanStudies.h"
 #include "FitAssembler.h"
@@ -10,15 +12,698 @@
 #include "PhysicsBottle.h"
 #include "OutputConfiguration.h"
 #include "PDFWithData.h"
+#include "RapidFitRandom.h"
+#include "StudyWorkers.h"
 //	System Headers
 #include <vector>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <pthread.h>
+#include <time.h>
 
 using namespace::std;
 
+unsigned int ScanStudies::numberWorkers = 0;
+unsigned int ScanStudies::adaptiveMaxFits = 0;
+vector<double> ScanStudies::adaptiveLevels = vector<double>();
+
+void ScanStudies::SetNumberWorkers( unsigned int Input )
+{
+	numberWorkers = Input;
+}
+
+void ScanStudies::SetAdaptiveContour( unsigned int MaxFits, vector<double> Levels )
+{
+	adaptiveMaxFits = MaxFits;
+	adaptiveLevels = Levels;
+	if( adaptiveLevels.empty() )
+	{
+		//	DeltaNLL of the 68%, 90% and 95% CL contours drawn by Rapid2DLL
+		adaptiveLevels.push_back( 1.15 );
+		adaptiveLevels.push_back( 2.36 );
+		adaptiveLevels.push_back( 3. );
+	}
+}
+
+namespace
+{
+	enum ScanPointState { ScanPointSkipped, ScanPointWaiting, ScanPointRunning, ScanPointFinished };
+
+	//	One point of a scan performed by DoParallelScan or DoAdaptiveScan2D
+	struct ScanPoint
+	{
+		vector<double> scanValues;	/*!	Value of each scanned parameter, the last one is moved if the fit has to be wiggled	*/
+		ScanPointState state;
+		FitResult* result;
+		bool converged;
+		RapidFitMatrix* covariance;	/*!	Covariance of the free parameters, NULL if the fit didn't converge or the Minimiser can't provide it	*/
+		double realTime;
+		double cpuTime;
+	};
+
+	//	State shared between all of the workers of a scan
+	struct ScanQueue
+	{
+		pthread_mutex_t lock;			/*!	Protects everything below					*/
+		pthread_cond_t changed;			/*!	Signalled whenever a point is finished				*/
+		vector<ScanPoint> points;		/*!	All points, the index is outer*innerPoints+inner		*/
+		unsigned int outerPoints;		/*!	Points of the first parameter of a 2D scan, 1 for a 1D scan	*/
+		unsigned int innerPoints;		/*!	Points of the last parameter					*/
+		vector<unsigned int> seeds;		/*!	Points started from the input values before any others		*/
+		unsigned int neighbourRadius;		/*!	Furthest a neighbour can be along each axis, in grid steps	*/
+		unsigned int running;			/*!	Points currently being fitted					*/
+		ParameterSet* startingParameters;	/*!	Input values with every scanned parameter Fixed			*/
+		vector<string> scanNames;
+		vector<string> originalTypes;		/*!	Types of the scanned parameters before the scan			*/
+		vector<double> originalValues;		/*!	Values of the scanned parameters before the scan		*/
+		double outerStart;			/*!	Position of the input values on the grid, in grid steps		*/
+		double innerStart;
+		double wiggleStep;			/*!	Step used to move the last parameter when a fit fails		*/
+		int OutputLevel;
+		bool forceContinue;
+		unsigned int warmStarts;
+		unsigned int coldStarts;
+		unsigned int retriedPoints;
+		unsigned int failedPoints;
+	};
+
+	//	Everything owned by a single worker
+	struct ScanWorker
+	{
+		ScanQueue* queue;
+		unsigned int workerNumber;
+		MinimiserConfiguration* theMinimiser;
+		FitFunctionConfiguration* theFunction;
+		vector<PDFWithData*> pdfsAndData;
+		vector<ConstraintFunction*> allConstraints;
+		bool ownsSetup;				/*!	Whether pdfsAndData and allConstraints are copies to be deleted	*/
+		TRandom3* frameworkRandom;		/*!	Used for the unique IDs of the objects made in this worker	*/
+	};
+
+	//	Converged neighbour (including diagonals, up to neighbourRadius steps away) with the lowest minimum, -1 if there isn't one yet
+	int BestNeighbour( const ScanQueue* queue, const unsigned int pointIndex )
+	{
+		const int outer = (int)( pointIndex / queue->innerPoints );
+		const int inner = (int)( pointIndex % queue->innerPoints );
+		const int radius = (int)queue->neighbourRadius;
+		int best = -1;
+		for( int outerStep=-radius; outerStep<= radius; ++outerStep )
+		{
+			for( int innerStep=-radius; innerStep<= radius; ++innerStep )
+			{
+				const int thisOuter = outer + outerStep;
+				const int thisInner = inner + innerStep;
+				if( outerStep == 0 && innerStep == 0 ) continue;
+				if( thisOuter < 0 || thisOuter >= (int)queue->outerPoints || thisInner < 0 || thisInner >= (int)queue->innerPoints ) continue;
+
+				const unsigned int thisIndex = (unsigned)( thisOuter * (int)queue->innerPoints + thisInner );
+				const ScanPoint* thisPoint = &(queue->points[thisIndex]);
+				if( thisPoint->state != ScanPointFinished || !thisPoint->converged ) continue;
+				if( best == -1 || thisPoint->result->GetMinimumValue() < queue->points[(unsigned)best].result->GetMinimumValue() ) best = (int)thisIndex;
+			}
+		}
+		return best;
+	}
+
+	//	Spread the waiting points started from the input values over the grid, beginning with the point closest to the input values
+	vector<unsigned int> ChooseSeeds( const ScanQueue* queue, const unsigned int numberSeeds )
+	{
+		vector<unsigned int> seeds;
+		vector<unsigned int> waiting;
+		vector<double> distance( queue->points.size(), -1. );
+		for( unsigned int pointIndex=0; pointIndex< queue->points.size(); ++pointIndex )
+		{
+			const double outerDistance = (double)( pointIndex / queue->innerPoints ) - queue->outerStart;
+			const double innerDistance = (double)( pointIndex % queue->innerPoints ) - queue->innerStart;
+			distance[pointIndex] = outerDistance*outerDistance + innerDistance*innerDistance;
+			if( queue->points[pointIndex].state == ScanPointWaiting ) waiting.push_back( pointIndex );
+		}
+
+		while( seeds.size() < numberSeeds && seeds.size() < waiting.size() )
+		{
+			//	The first seed is the closest point to the input values, each following seed is the furthest point from any chosen so far
+			unsigned int chosen = waiting.front();
+			for( unsigned int waitingNum=1; waitingNum< waiting.size(); ++waitingNum )
+			{
+				const unsigned int pointIndex = waiting[waitingNum];
+				const bool better = seeds.empty() ? ( distance[pointIndex] < distance[chosen] ) : ( distance[pointIndex] > distance[chosen] );
+				if( better ) chosen = pointIndex;
+			}
+			seeds.push_back( chosen );
+
+			for( unsigned int pointIndex=0; pointIndex< queue->points.size(); ++pointIndex )
+			{
+				const double outerDistance = (double)( pointIndex / queue->innerPoints ) - (double)( chosen / queue->innerPoints );
+				const double innerDistance = (double)( pointIndex % queue->innerPoints ) - (double)( chosen % queue->innerPoints );
+				const double seedDistance = outerDistance*outerDistance + innerDistance*innerDistance;
+				if( seeds.size() == 1 || seedDistance < distance[pointIndex] ) distance[pointIndex] = seedDistance;
+			}
+		}
+		return seeds;
+	}
+
+	//	Choose the next point to fit and the neighbour to start it from (-1 for the input values), this must be called holding the lock
+	//	Waits for a running fit to finish rather than starting a point from the input values, returns -1 once every point has been started
+	int NextScanPoint( ScanQueue* queue, int& neighbour )
+	{
+		while( true )
+		{
+			neighbour = -1;
+			for( unsigned int seedNum=0; seedNum< queue->seeds.size(); ++seedNum )
+			{
+				if( queue->points[queue->seeds[seedNum]].state == ScanPointWaiting ) return (int)queue->seeds[seedNum];
+			}
+
+			int best = -1;
+			int firstWaiting = -1;
+			for( unsigned int pointIndex=0; pointIndex< queue->points.size(); ++pointIndex )
+			{
+				if( queue->points[pointIndex].state != ScanPointWaiting ) continue;
+				if( firstWaiting == -1 ) firstWaiting = (int)pointIndex;
+				const int thisNeighbour = BestNeighbour( queue, pointIndex );
+				if( thisNeighbour == -1 ) continue;
+				if( neighbour == -1 || queue->points[(unsigned)thisNeighbour].result->GetMinimumValue() < queue->points[(unsigned)neighbour].result->GetMinimumValue() )
+				{
+					best = (int)pointIndex;
+					neighbour = thisNeighbour;
+				}
+			}
+
+			if( best != -1 ) return best;
+			if( firstWaiting == -1 ) return -1;
+
+			//	Nothing left running which could provide a neighbour
+			if( queue->running == 0 ) return firstWaiting;
+
+			pthread_cond_wait( &(queue->changed), &(queue->lock) );
+		}
+	}
+
+	//	Input values with the free parameters moved to the result of the neighbour (if any) and the scanned parameters moved to this point
+	ParameterSet* MakePointParameters( const ScanQueue* queue, const vector<double>& scanValues, const FitResult* neighbourResult )
+	{
+		ParameterSet* pointParameters = new ParameterSet( *(queue->startingParameters) );
+
+		if( neighbourResult != NULL )
+		{
+			ParameterSet* neighbourParameters = neighbourResult->GetResultParameterSet()->GetDummyParameterSet();
+			vector<string> floatedNames = pointParameters->GetAllFloatNames();
+			for( unsigned int i=0; i< floatedNames.size(); ++i )
+			{
+				pointParameters->GetPhysicsParameter( floatedNames[i] )->SetBlindedValue( neighbourParameters->GetPhysicsParameter( floatedNames[i] )->GetValue() );
+			}
+			delete neighbourParameters;
+		}
+
+		for( unsigned int i=0; i< queue->scanNames.size(); ++i )
+		{
+			pointParameters->GetPhysicsParameter( queue->scanNames[i] )->SetBlindedValue( scanValues[i] );
+		}
+
+		return pointParameters;
+	}
+
+	FitResult* FitScanPoint( ScanWorker* worker, ParameterSet* pointParameters )
+	{
+		FitResult* scanStepResult=NULL;
+		try{
+			//	Use the SafeFit as this always returns something when a PDF has been written to throw not exit
+			scanStepResult = FitAssembler::DoSafeFit( worker->theMinimiser, worker->theFunction, pointParameters, worker->pdfsAndData, worker->allConstraints,
+					worker->queue->forceContinue, worker->queue->OutputLevel );
+		}
+		catch( int e )
+		{
+			cerr << "Caught Scan Error: " << e << endl;
+			exit(-987);
+		}
+		catch( ... )
+		{
+			cerr << "Caught Unknown Scan Error" << endl;
+			exit(-986);
+		}
+		return scanStepResult;
+	}
+
+	void* ScanWorkerLoop( void* input )
+	{
+		ScanWorker* worker = (ScanWorker*) input;
+		ScanQueue* queue = worker->queue;
+
+		RapidFitRandom::SetThreadFrameworkRandomFunction( worker->frameworkRandom );
+
+		while( true )
+		{
+			pthread_mutex_lock( &(queue->lock) );
+			int neighbour = -1;
+			const int pointIndex = NextScanPoint( queue, neighbour );
+			if( pointIndex == -1 )
+			{
+				pthread_mutex_unlock( &(queue->lock) );
+				break;
+			}
+
+			//	Finished points are never changed again so they can be read without the lock
+			ScanPoint* thisPoint = &(queue->points[(unsigned)pointIndex]);
+			thisPoint->state = ScanPointRunning;
+			++(queue->running);
+			const FitResult* neighbourResult = ( neighbour == -1 ) ? NULL : queue->points[(unsigned)neighbour].result;
+			const RapidFitMatrix* neighbourCovariance = ( neighbour == -1 ) ? NULL : queue->points[(unsigned)neighbour].covariance;
+			vector<double> scanValues = thisPoint->scanValues;
+			if( neighbour == -1 ) ++(queue->coldStarts);
+			else ++(queue->warmStarts);
+
+			cout << "\n\nSCAN POINT\t\t" << pointIndex+1 << "\t\tOF\t\t" << queue->points.size() << "\t\ton worker:\t" << worker->workerNumber << endl;
+			for( unsigned int i=0; i< queue->scanNames.size(); ++i )
+			{
+				cout << "Fitting at:\t" << queue->scanNames[i] << "=" << setw(6) << scanValues[i] << endl;
+			}
+			if( neighbour == -1 ) cout << "Starting from the input values" << endl;
+			else cout << "Starting from the result at scan point " << neighbour+1 << endl;
+
+			pthread_mutex_unlock( &(queue->lock) );
+
+			timespec realStart, realStop, cpuStart, cpuStop;
+			clock_gettime( CLOCK_MONOTONIC, &realStart );
+			clock_gettime( CLOCK_THREAD_CPUTIME_ID, &cpuStart );
+
+			worker->theMinimiser->SetStartingCovariance( neighbourCovariance );
+			ParameterSet* pointParameters = MakePointParameters( queue, scanValues, neighbourResult );
+			FitResult* scanStepResult = FitScanPoint( worker, pointParameters );
+			delete pointParameters;
+
+			//	As in DoScan, a failed fit is first retried at the same point, from the input values if it was started from a neighbour
+			//	Then perform 10 steps either side of the point with a 20th of the step size of the last parameter
+			bool retried = false;
+			int wiggle_step_num = 0;
+			while( scanStepResult->GetFitStatus() != 3 )
+			{
+				if( !retried )
+				{
+					if( neighbourResult == NULL ) cout << "\n\t\t\tRETRYING FIT" << endl;
+					else cout << "\n\t\t\tRETRYING FIT FROM THE INPUT VALUES" << endl;
+				}
+				else
+				{
+					if( wiggle_step_num >= 20 ) break;
+
+					const int left_right = ( wiggle_step_num % 2 == 0 ) ? 1 : -1;
+					scanValues.back() = thisPoint->scanValues.back() + (double)left_right * queue->wiggleStep * (double)( wiggle_step_num/2 + 1 );
+
+					cout << "\tStepping to: " << scanValues.back() << " Retrying!" << endl;
+
+					++wiggle_step_num;
+				}
+
+				retried = true;
+				delete scanStepResult;
+				worker->theMinimiser->SetStartingCovariance( NULL );
+				pointParameters = MakePointParameters( queue, scanValues, NULL );
+				scanStepResult = FitScanPoint( worker, pointParameters );
+				delete pointParameters;
+			}
+
+			clock_gettime( CLOCK_MONOTONIC, &realStop );
+			clock_gettime( CLOCK_THREAD_CPUTIME_ID, &cpuStop );
+
+			const bool converged = ( scanStepResult->GetFitStatus() == 3 );
+			RapidFitMatrix* pointCovariance = NULL;
+			//	The minimiser outlives the FitFunction deleted in DoFit, Minuit2Wrapper keeps the names it was given for this
+			IMinimiser* lastMinimiser = worker->theMinimiser->GetMinimiser();
+			if( converged && lastMinimiser != NULL ) pointCovariance = lastMinimiser->GetCovarianceMatrix();
+
+			cout << "Fit Finished!\n" <<endl;
+
+			pthread_mutex_lock( &(queue->lock) );
+
+			thisPoint->scanValues = scanValues;
+			thisPoint->result = scanStepResult;
+			thisPoint->converged = converged;
+			thisPoint->covariance = pointCovariance;
+			thisPoint->realTime = StudyWorkers::ElapsedTime( realStart, realStop );
+			thisPoint->cpuTime = StudyWorkers::ElapsedTime( cpuStart, cpuStop );
+			thisPoint->state = ScanPointFinished;
+			--(queue->running);
+			if( retried ) ++(queue->retriedPoints);
+			if( !converged ) ++(queue->failedPoints);
+
+			pthread_cond_broadcast( &(queue->changed) );
+			pthread_mutex_unlock( &(queue->lock) );
+		}
+
+		RapidFitRandom::SetThreadFrameworkRandomFunction( NULL );
+
+		return NULL;
+	}
+
+	//	Fix the scanned parameters and lay out the full grid of points, every point is Skipped until it is requested
+	void SetupScanQueue( ScanQueue* queue, ParameterSet* BottleParameters, const vector<ScanParam*>& Scan_Params, const int OutputLevel, const bool forceContinue )
+	{
+		vector<double> lowerLimits, stepSizes, startIndex;
+		vector<unsigned int> numberPoints;
+
+		// Get a pointer to the physics parameters to be scanned and fix them
+		// CAREFUL:  these must be reset as they were at the end.
+		for( unsigned int paramNum=0; paramNum< Scan_Params.size(); ++paramNum )
+		{
+			double uplim = Scan_Params[paramNum]->GetMax();
+			double lolim = Scan_Params[paramNum]->GetMin();
+			double npoints = Scan_Params[paramNum]->GetPoints();
+			string scanName = Scan_Params[paramNum]->GetName();
+
+			PhysicsParameter* scanParameter = NULL;
+			try{
+				scanParameter = BottleParameters->GetPhysicsParameter(scanName);
+			}
+			catch(...)
+			{
+				cerr << "Couldn't find Parameter: " << scanName << ". Can NOT perform scan!" << endl << endl;
+				exit(3763);
+			}
+			queue->originalValues.push_back( scanParameter->GetBlindedValue() );
+			queue->originalTypes.push_back( scanParameter->GetType() );
+
+			if( queue->originalTypes.back() == "Fixed" && fabs(uplim-lolim) < 1E-5 )
+			{
+				cerr << "Cannot Run a scan Using Parameter: " << scanName << endl << endl;
+				exit(3764);
+			}
+			scanParameter->SetType( "Fixed" );
+
+			double deltaScan=0.;
+			if( int(npoints) != 1 ) deltaScan = (uplim-lolim) / (npoints-1.);
+
+			queue->scanNames.push_back( scanName );
+			numberPoints.push_back( int(npoints) > 0 ? unsigned(npoints) : 0 );
+			lowerLimits.push_back( lolim );
+			stepSizes.push_back( deltaScan );
+
+			//	Position of the input value on the grid, in units of the grid spacing
+			double thisStart = ( fabs(deltaScan) > 0. ) ? ( queue->originalValues.back() - lolim ) / deltaScan : 0.;
+			if( thisStart < 0. ) thisStart = 0.;
+			if( numberPoints.back() > 0 && thisStart > (double)( numberPoints.back() - 1 ) ) thisStart = (double)( numberPoints.back() - 1 );
+			startIndex.push_back( thisStart );
+		}
+		BottleParameters->FloatedFirst();
+
+		queue->outerPoints = ( Scan_Params.size() == 2 ) ? numberPoints.front() : 1;
+		queue->innerPoints = numberPoints.back();
+		queue->outerStart = ( Scan_Params.size() == 2 ) ? startIndex.front() : 0.;
+		queue->innerStart = startIndex.back();
+		queue->neighbourRadius = 1;
+		queue->running = 0;
+		queue->startingParameters = new ParameterSet( *BottleParameters );
+		queue->wiggleStep = stepSizes.back() / 20.;
+		queue->OutputLevel = OutputLevel;
+		queue->forceContinue = forceContinue;
+		queue->warmStarts = 0;
+		queue->coldStarts = 0;
+		queue->retriedPoints = 0;
+		queue->failedPoints = 0;
+
+		for( unsigned int outer=0; outer< queue->outerPoints; ++outer )
+		{
+			for( unsigned int inner=0; inner< queue->innerPoints; ++inner )
+			{
+				ScanPoint thisPoint;
+				if( Scan_Params.size() == 2 ) thisPoint.scanValues.push_back( lowerLimits.front() + stepSizes.front() * outer );
+				thisPoint.scanValues.push_back( lowerLimits.back() + stepSizes.back() * inner );
+				thisPoint.state = ScanPointSkipped;
+				thisPoint.result = NULL;
+				thisPoint.converged = false;
+				thisPoint.covariance = NULL;
+				thisPoint.realTime = 0.;
+				thisPoint.cpuTime = 0.;
+				queue->points.push_back( thisPoint );
+			}
+		}
+
+		pthread_mutex_init( &(queue->lock), NULL );
+		pthread_cond_init( &(queue->changed), NULL );
+	}
+
+	//	Release everything held by the queue and reset the scanned parameters as they were
+	void ClearScanQueue( ScanQueue* queue, ParameterSet* BottleParameters )
+	{
+		for( unsigned int pointIndex=0; pointIndex< queue->points.size(); ++pointIndex )
+		{
+			if( queue->points[pointIndex].covariance != NULL ) delete queue->points[pointIndex].covariance;
+		}
+		delete queue->startingParameters;
+
+		pthread_cond_destroy( &(queue->changed) );
+		pthread_mutex_destroy( &(queue->lock) );
+
+		for( unsigned int paramNum=0; paramNum< queue->scanNames.size(); ++paramNum )
+		{
+			PhysicsParameter* scanParameter = BottleParameters->GetPhysicsParameter( queue->scanNames[paramNum] );
+			scanParameter->SetType( queue->originalTypes[paramNum] );
+			scanParameter->SetBlindedValue( queue->originalValues[paramNum] );
+		}
+	}
+
+	//	TMinuit can only be used by one fit at a time, there is also no point in more workers than points
+	unsigned int ScanWorkerCount( const MinimiserConfiguration* MinimiserConfig, const unsigned int requested, const unsigned int numberPoints )
+	{
+		unsigned int workerCount = ( requested > 0 ) ? requested : 1;
+		if( workerCount > 1 && MinimiserConfig->GetMinimiserName() == "Minuit" )
+		{
+			cerr << "ScanStudies: TMinuit can only be used by one fit at a time, using a single worker" << endl;
+			workerCount = 1;
+		}
+		if( workerCount > numberPoints && numberPoints > 0 ) workerCount = numberPoints;
+		return workerCount;
+	}
+
+	//	Copy the fit setup into each worker, a single worker keeps the threading of the FitFunction and can use the input PDFs and data
+	vector<ScanWorker*> MakeScanWorkers( ScanQueue* queue, const unsigned int workerCount, MinimiserConfiguration* MinimiserConfig, FitFunctionConfiguration* FunctionConfig,
+			const vector< PDFWithData* >& BottleData, const vector< ConstraintFunction* >& BottleConstraints )
+	{
+		vector<ScanWorker*> workers;
+		for( unsigned int workerNum=0; workerNum< workerCount; ++workerNum )
+		{
+			ScanWorker* thisWorker = new ScanWorker();
+			thisWorker->queue = queue;
+			thisWorker->workerNumber = workerNum;
+			thisWorker->theMinimiser = new MinimiserConfiguration( *MinimiserConfig );
+			thisWorker->theFunction = new FitFunctionConfiguration( *FunctionConfig );
+
+			thisWorker->ownsSetup = ( workerCount > 1 );
+			if( thisWorker->ownsSetup )
+			{
+				thisWorker->theFunction->SetThreads( 1 );
+				for( unsigned int i=0; i< BottleData.size(); ++i )
+				{
+					thisWorker->pdfsAndData.push_back( new PDFWithData( *BottleData[i] ) );
+				}
+				for( unsigned int i=0; i< BottleConstraints.size(); ++i )
+				{
+					thisWorker->allConstraints.push_back( new ConstraintFunction( *BottleConstraints[i] ) );
+				}
+			}
+			else
+			{
+				thisWorker->pdfsAndData = BottleData;
+				thisWorker->allConstraints = BottleConstraints;
+			}
+			thisWorker->frameworkRandom = StudyWorkers::MakeFrameworkRandom();
+			workers.push_back( thisWorker );
+		}
+		return workers;
+	}
+
+	void DeleteScanWorkers( vector<ScanWorker*>& workers )
+	{
+		while( !workers.empty() )
+		{
+			ScanWorker* thisWorker = workers.back();
+			if( thisWorker->ownsSetup )
+			{
+				while( !thisWorker->pdfsAndData.empty() )
+				{
+					delete thisWorker->pdfsAndData.back();
+					thisWorker->pdfsAndData.pop_back();
+				}
+				while( !thisWorker->allConstraints.empty() )
+				{
+					delete thisWorker->allConstraints.back();
+					thisWorker->allConstraints.pop_back();
+				}
+			}
+			delete thisWorker->theMinimiser;
+			delete thisWorker->theFunction;
+			delete thisWorker->frameworkRandom;
+			delete thisWorker;
+			workers.pop_back();
+		}
+	}
+
+	//	Fit every waiting point in the queue, the workers keep their copies of the fit setup between calls
+	void RunScanWorkers( vector<ScanWorker*>& workers )
+	{
+		StudyWorkers::RunWorkers( ScanWorkerLoop, (void**) &(workers[0]), (unsigned) workers.size() );
+	}
+
+	//	Store the finished points in the same order and form as DoScan/DoScan2D, one FitResultVector per value of the first parameter of a 2D scan
+	//	Values of the first parameter without any finished points are only stored if keepEmpty is set
+	void StoreScanPoints( ScanQueue* queue, ParameterSet* BottleParameters, const vector<string>& result_names, vector<FitResultVector*>* output_interface, const bool keepEmpty )
+	{
+		for( unsigned int outer=0; outer< queue->outerPoints; ++outer )
+		{
+			FitResultVector* Returnable_Result = new FitResultVector( result_names );
+
+			for( unsigned int inner=0; inner< queue->innerPoints; ++inner )
+			{
+				ScanPoint* thisPoint = &(queue->points[outer*queue->innerPoints+inner]);
+				if( thisPoint->state != ScanPointFinished ) continue;
+				FitResult* scanStepResult = thisPoint->result;
+
+				//  THIS IS ALWAYS TRUE BY DEFINITION OF THE SCAN
+				for( unsigned int paramNum=0; paramNum< queue->scanNames.size(); ++paramNum )
+				{
+					string name = queue->scanNames[paramNum];
+					string type = BottleParameters->GetPhysicsParameter( name )->GetType();
+					string unit = BottleParameters->GetPhysicsParameter( name )->GetUnit();
+					double scanVal = thisPoint->scanValues[paramNum];
+					scanStepResult->GetResultParameterSet()->SetResultParameter( name, scanVal, scanVal, 0., scanVal, scanVal, type, unit );
+				}
+
+				vector<string> Fixed_List = BottleParameters->GetAllFixedNames();
+				vector<string> Fit_List = scanStepResult->GetResultParameterSet()->GetAllNames();
+				for( unsigned short int i=0; i < Fixed_List.size() ; ++i )
+				{
+					bool found=false;
+					for( unsigned short int j=0; j < Fit_List.size(); ++j )
+					{
+						if( Fit_List[j] == Fixed_List[i] )
+						{
+							found = true;
+						}
+					}
+					if( !found )
+					{
+						string fixed_type = BottleParameters->GetPhysicsParameter( Fixed_List[i] )->GetType();
+						string fixed_unit = BottleParameters->GetPhysicsParameter( Fixed_List[i] )->GetUnit();
+						double fixed_value = BottleParameters->GetPhysicsParameter( Fixed_List[i] )->GetValue();
+						scanStepResult->GetResultParameterSet()->ForceNewResultParameter( Fixed_List[i],
+								fixed_value, fixed_value, 0., fixed_value, fixed_value, fixed_type, fixed_unit );
+					}
+				}
+
+				for( unsigned int paramNum=0; paramNum< queue->scanNames.size(); ++paramNum )
+				{
+					scanStepResult->GetResultParameterSet()->GetResultParameter( queue->scanNames[paramNum] )->SetScanStatus( true );
+				}
+
+				ResultFormatter::ReviewOutput( scanStepResult );
+
+				Returnable_Result->AddFitResult( scanStepResult, false );
+				Returnable_Result->AddRealTime( thisPoint->realTime );
+				Returnable_Result->AddCPUTime( thisPoint->cpuTime );
+				Returnable_Result->AddGLTime( thisPoint->realTime );
+			}
+
+			if( keepEmpty || Returnable_Result->NumberResults() > 0 ) output_interface->push_back( Returnable_Result );
+			else delete Returnable_Result;
+		}
+	}
+
+	//	Rectangle of the scan grid between 4 fitted corners, used by the adaptive 2D scan
+	struct ScanCell
+	{
+		unsigned int outerLow, outerHigh;
+		unsigned int innerLow, innerHigh;
+		double priority;		/*!	Distance in NLL between the centre of the cell and the closest level, smaller is refined first	*/
+	};
+
+	//	Largest power of 2 step which still leaves at least 5 points along an axis
+	unsigned int CoarseStride( const unsigned int numberPoints )
+	{
+		unsigned int stride = 1;
+		while( numberPoints > 1 && ( numberPoints - 1 ) / ( 2 * stride ) >= 4 ) stride *= 2;
+		return stride;
+	}
+
+	//	0, stride, 2*stride, ... and always the last point
+	vector<unsigned int> CoarseNodes( const unsigned int numberPoints, const unsigned int stride )
+	{
+		vector<unsigned int> nodes;
+		for( unsigned int node=0; node< numberPoints; node+=stride ) nodes.push_back( node );
+		if( numberPoints > 0 && nodes.back() != numberPoints-1 ) nodes.push_back( numberPoints-1 );
+		return nodes;
+	}
+
+	//	Whether a contour level passes between the converged corners of the cell, or the cell holds the lowest point found so far
+	bool CellNeedsRefining( const ScanQueue* queue, ScanCell& cell, const vector<double>& levels, const double minimumNLL, const unsigned int bestPoint )
+	{
+		const unsigned int corners[4] = { cell.outerLow*queue->innerPoints+cell.innerLow, cell.outerLow*queue->innerPoints+cell.innerHigh,
+			cell.outerHigh*queue->innerPoints+cell.innerLow, cell.outerHigh*queue->innerPoints+cell.innerHigh };
+
+		bool holdsBest = false;
+		unsigned int numberConverged = 0;
+		double lowest = 0., highest = 0.;
+		for( unsigned int cornerNum=0; cornerNum< 4; ++cornerNum )
+		{
+			if( corners[cornerNum] == bestPoint ) holdsBest = true;
+			const ScanPoint* thisPoint = &(queue->points[corners[cornerNum]]);
+			if( thisPoint->state != ScanPointFinished || !thisPoint->converged ) continue;
+			const double deltaNLL = thisPoint->result->GetMinimumValue() - minimumNLL;
+			if( numberConverged == 0 || deltaNLL < lowest ) lowest = deltaNLL;
+			if( numberConverged == 0 || deltaNLL > highest ) highest = deltaNLL;
+			++numberConverged;
+		}
+
+		//	A contour can close around the minimum without passing between the corners of any cell
+		bool refine = holdsBest;
+		cell.priority = holdsBest ? 0. : -1.;
+		if( numberConverged < 2 ) return refine;
+
+		for( unsigned int levelNum=0; levelNum< levels.size(); ++levelNum )
+		{
+			if( lowest < levels[levelNum] && levels[levelNum] <= highest )
+			{
+				const double distance = fabs( 0.5*( lowest + highest ) - levels[levelNum] );
+				if( !refine || distance < cell.priority ) cell.priority = distance;
+				refine = true;
+			}
+		}
+		return refine;
+	}
+
+	//	Split a cell in half along each axis which is more than one grid step wide, empty if the cell can't be split
+	vector<ScanCell> SplitCell( const ScanCell& cell )
+	{
+		vector<unsigned int> outerEdges, innerEdges;
+		outerEdges.push_back( cell.outerLow );
+		if( cell.outerHigh - cell.outerLow > 1 ) outerEdges.push_back( ( cell.outerLow + cell.outerHigh ) / 2 );
+		outerEdges.push_back( cell.outerHigh );
+		innerEdges.push_back( cell.innerLow );
+		if( cell.innerHigh - cell.innerLow > 1 ) innerEdges.push_back( ( cell.innerLow + cell.innerHigh ) / 2 );
+		innerEdges.push_back( cell.innerHigh );
+
+		vector<ScanCell> subCells;
+		if( outerEdges.size() == 2 && innerEdges.size() == 2 ) return subCells;
+
+		for( unsigned int outerNum=0; outerNum+1< outerEdges.size(); ++outerNum )
+		{
+			for( unsigned int innerNum=0; innerNum+1< innerEdges.size(); ++innerNum )
+			{
+				ScanCell thisCell;
+				thisCell.outerLow = outerEdges[outerNum];
+				thisCell.outerHigh = outerEdges[outerNum+1];
+				thisCell.innerLow = innerEdges[innerNum];
+				thisCell.innerHigh = innerEdges[innerNum+1];
+				thisCell.priority = cell.priority;
+				subCells.push_back( thisCell );
+			}
+		}
+		return subCells;
+	}
+}
+
 
 //  Interface for internal calls
 void ScanStudies::DoScan( MinimiserConfiguration * MinimiserConfig, FitFunctionConfiguration * FunctionConfig, ParameterSet* BottleParameters,
@@ -276,6 +961,201 @@ void ScanStudies::DoScan2D( MinimiserConfiguration * MinimiserConfig, FitFunctio
 	scanParameter->SetBlindedValue( originalValue ) ;
 }
 
+//  Interface for internal calls
+void ScanStudies::DoParallelScan( MinimiserConfiguration * MinimiserConfig, FitFunctionConfiguration * FunctionConfig, ParameterSet* BottleParameters,
+	vector< PDFWithData* > BottleData, vector< ConstraintFunction* > BottleConstraints, vector<ScanParam*> Scan_Params,
+	vector<FitResultVector*>* output_interface, int OutputLevel, bool forceContinue )
+{
+	FunctionConfig->SetIntegratorTest( false );
+
+	vector<string> result_names = BottleParameters->GetAllNames();
+
+	ScanQueue queue;
+	SetupScanQueue( &queue, BottleParameters, Scan_Params, OutputLevel, forceContinue );
+	for( unsigned int pointIndex=0; pointIndex< queue.points.size(); ++pointIndex ) queue.points[pointIndex].state = ScanPointWaiting;
+
+	const unsigned int workerCount = ScanWorkerCount( MinimiserConfig, numberWorkers, (unsigned) queue.points.size() );
+	queue.seeds = ChooseSeeds( &queue, workerCount );
+
+	cout << "ScanStudies: Fitting " << queue.points.size() << " scan points with " << workerCount << " worker(s), each point starting from its best converged neighbour" << endl;
+
+	const bool addDirectory = StudyWorkers::DetachHistograms();
+
+	vector<ScanWorker*> workers = MakeScanWorkers( &queue, workerCount, MinimiserConfig, FunctionConfig, BottleData, BottleConstraints );
+	RunScanWorkers( workers );
+	DeleteScanWorkers( workers );
+
+	StudyWorkers::RestoreHistograms( addDirectory );
+
+	cout << "ScanStudies: " << queue.warmStarts << " points started from a neighbour, " << queue.coldStarts << " from the input values, ";
+	cout << queue.retriedPoints << " retried and " << queue.failedPoints << " failed" << endl;
+
+	StoreScanPoints( &queue, BottleParameters, result_names, output_interface, true );
+
+	ClearScanQueue( &queue, BottleParameters );
+}
+
+//  Interface for internal calls
+void ScanStudies::DoAdaptiveScan2D( MinimiserConfiguration * MinimiserConfig, FitFunctionConfiguration * FunctionConfig, ParameterSet* BottleParameters,
+	vector< PDFWithData* > BottleData, vector< ConstraintFunction* > BottleConstraints, pair<ScanParam*, ScanParam*> Param_Set,
+	vector<FitResultVector*>* output_interface, int OutputLevel, bool forceContinue )
+{
+	FunctionConfig->SetIntegratorTest( false );
+
+	vector<string> result_names = BottleParameters->GetAllNames();
+
+	vector<ScanParam*> Scan_Params;
+	Scan_Params.push_back( Param_Set.first );
+	Scan_Params.push_back( Param_Set.second );
+
+	ScanQueue queue;
+	SetupScanQueue( &queue, BottleParameters, Scan_Params, OutputLevel, forceContinue );
+
+	//	Start from a coarse grid with a power of 2 spacing so that each refinement lands on the full grid
+	const unsigned int outerStride = CoarseStride( queue.outerPoints );
+	const unsigned int innerStride = CoarseStride( queue.innerPoints );
+	vector<unsigned int> outerNodes = CoarseNodes( queue.outerPoints, outerStride );
+	vector<unsigned int> innerNodes = CoarseNodes( queue.innerPoints, innerStride );
+
+	vector<ScanCell> cells;
+	for( unsigned int outerNum=0; outerNum< outerNodes.size(); ++outerNum )
+	{
+		for( unsigned int innerNum=0; innerNum< innerNodes.size(); ++innerNum )
+		{
+			queue.points[outerNodes[outerNum]*queue.innerPoints+innerNodes[innerNum]].state = ScanPointWaiting;
+
+			if( outerNum+1 < outerNodes.size() && innerNum+1 < innerNodes.size() )
+			{
+				ScanCell thisCell;
+				thisCell.outerLow = outerNodes[outerNum];
+				thisCell.outerHigh = outerNodes[outerNum+1];
+				thisCell.innerLow = innerNodes[innerNum];
+				thisCell.innerHigh = innerNodes[innerNum+1];
+				thisCell.priority = 0.;
+				cells.push_back( thisCell );
+			}
+		}
+	}
+
+	unsigned int fitsRequested = (unsigned)( outerNodes.size() * innerNodes.size() );
+	if( fitsRequested > adaptiveMaxFits )
+	{
+		cerr << "ScanStudies: The coarse grid of " << fitsRequested << " points is larger than the maximum of " << adaptiveMaxFits << " fits, only the coarse grid will be fitted" << endl;
+	}
+
+	const unsigned int workerCount = ScanWorkerCount( MinimiserConfig, numberWorkers, fitsRequested );
+	queue.seeds = ChooseSeeds( &queue, workerCount );
+	queue.neighbourRadius = ( outerStride > innerStride ) ? outerStride : innerStride;
+
+	cout << "ScanStudies: Adaptive 2D scan of " << queue.points.size() << " grid points, starting from a coarse grid of " << fitsRequested << " points with at most " << adaptiveMaxFits << " fits in total" << endl;
+	cout << "ScanStudies: Refining cells containing the DeltaNLL levels:";
+	for( unsigned int levelNum=0; levelNum< adaptiveLevels.size(); ++levelNum ) cout << "\t" << adaptiveLevels[levelNum];
+	cout << endl;
+
+	const bool addDirectory = StudyWorkers::DetachHistograms();
+
+	vector<ScanWorker*> workers = MakeScanWorkers( &queue, workerCount, MinimiserConfig, FunctionConfig, BottleData, BottleConstraints );
+	RunScanWorkers( workers );
+
+	unsigned int refinement=0;
+	while( fitsRequested < adaptiveMaxFits )
+	{
+		//	Levels are relative to the lowest converged point found so far
+		int bestPoint = -1;
+		for( unsigned int pointIndex=0; pointIndex< queue.points.size(); ++pointIndex )
+		{
+			const ScanPoint* thisPoint = &(queue.points[pointIndex]);
+			if( thisPoint->state != ScanPointFinished || !thisPoint->converged ) continue;
+			if( bestPoint == -1 || thisPoint->result->GetMinimumValue() < queue.points[(unsigned)bestPoint].result->GetMinimumValue() ) bestPoint = (int)pointIndex;
+		}
+		if( bestPoint == -1 )
+		{
+			cerr << "ScanStudies: No scan points have converged, can't refine the scan" << endl;
+			break;
+		}
+		const double minimumNLL = queue.points[(unsigned)bestPoint].result->GetMinimumValue();
+
+		//	Every leaf is checked again as the minimum, and so the position of each level, can move between refinements
+		vector< pair<double, unsigned int> > refineCells;
+		for( unsigned int cellNum=0; cellNum< cells.size(); ++cellNum )
+		{
+			if( CellNeedsRefining( &queue, cells[cellNum], adaptiveLevels, minimumNLL, (unsigned)bestPoint ) ) refineCells.push_back( make_pair( cells[cellNum].priority, cellNum ) );
+		}
+		sort( refineCells.begin(), refineCells.end() );
+
+		//	Split the cells closest to a level first, until the budget of fits runs out
+		vector<bool> cellSplit( cells.size(), false );
+		vector<ScanCell> nextCells;
+		vector<unsigned int> newPoints;
+		unsigned int radius = 1;
+		for( unsigned int refineNum=0; refineNum< refineCells.size(); ++refineNum )
+		{
+			const unsigned int cellNum = refineCells[refineNum].second;
+			vector<ScanCell> subCells = SplitCell( cells[cellNum] );
+			if( subCells.empty() ) continue;
+
+			vector<unsigned int> cellPoints;
+			for( unsigned int subNum=0; subNum< subCells.size(); ++subNum )
+			{
+				const unsigned int corners[4] = { subCells[subNum].outerLow*queue.innerPoints+subCells[subNum].innerLow, subCells[subNum].outerLow*queue.innerPoints+subCells[subNum].innerHigh,
+					subCells[subNum].outerHigh*queue.innerPoints+subCells[subNum].innerLow, subCells[subNum].outerHigh*queue.innerPoints+subCells[subNum].innerHigh };
+				for( unsigned int cornerNum=0; cornerNum< 4; ++cornerNum )
+				{
+					if( queue.points[corners[cornerNum]].state != ScanPointSkipped ) continue;
+					if( find( newPoints.begin(), newPoints.end(), corners[cornerNum] ) != newPoints.end() ) continue;
+					if( find( cellPoints.begin(), cellPoints.end(), corners[cornerNum] ) != cellPoints.end() ) continue;
+					cellPoints.push_back( corners[cornerNum] );
+				}
+			}
+
+			if( fitsRequested + newPoints.size() + cellPoints.size() > adaptiveMaxFits ) break;
+
+			newPoints.insert( newPoints.end(), cellPoints.begin(), cellPoints.end() );
+			nextCells.insert( nextCells.end(), subCells.begin(), subCells.end() );
+			cellSplit[cellNum] = true;
+
+			const unsigned int outerHalf = ( cells[cellNum].outerHigh - cells[cellNum].outerLow + 1 ) / 2;
+			const unsigned int innerHalf = ( cells[cellNum].innerHigh - cells[cellNum].innerLow + 1 ) / 2;
+			if( outerHalf > radius ) radius = outerHalf;
+			if( innerHalf > radius ) radius = innerHalf;
+		}
+
+		if( nextCells.empty() ) break;
+
+		//	Cells which weren't split stay as leaves so they can be refined in a later pass
+		for( unsigned int cellNum=0; cellNum< cells.size(); ++cellNum )
+		{
+			if( !cellSplit[cellNum] ) nextCells.push_back( cells[cellNum] );
+		}
+		cells = nextCells;
+
+		//	The corners of the new cells may all have been fitted already, in which case they can be checked straight away
+		if( newPoints.empty() ) continue;
+
+		++refinement;
+		cout << "ScanStudies: Refinement " << refinement << " of the adaptive scan, fitting " << newPoints.size() << " new points, the scan now has " << cells.size() << " cells" << endl;
+
+		for( unsigned int pointNum=0; pointNum< newPoints.size(); ++pointNum ) queue.points[newPoints[pointNum]].state = ScanPointWaiting;
+		fitsRequested += (unsigned) newPoints.size();
+		queue.seeds.clear();
+		queue.neighbourRadius = radius;
+
+		RunScanWorkers( workers );
+	}
+
+	DeleteScanWorkers( workers );
+
+	StudyWorkers::RestoreHistograms( addDirectory );
+
+	cout << "ScanStudies: Adaptive scan fitted " << fitsRequested << " of the " << queue.points.size() << " grid points after " << refinement << " refinements" << endl;
+	cout << "ScanStudies: " << queue.warmStarts << " points started from a neighbour, " << queue.coldStarts << " from the input values, ";
+	cout << queue.retriedPoints << " retried and " << queue.failedPoints << " failed" << endl;
+
+	StoreScanPoints( &queue, BottleParameters, result_names, output_interface, false );
+
+	ClearScanQueue( &queue, BottleParameters );
+}
+
 // Interface for external calls
 vector<FitResultVector*> ScanStudies::ContourScan( MinimiserConfiguration * MinimiserConfig, FitFunctionConfiguration * FunctionConfig,
 	ParameterSet* BottleParameters, vector< PDFWithData* > BottleData, vector< ConstraintFunction* > BottleConstraints,
@@ -285,7 +1165,21 @@ vector<FitResultVector*> ScanStudies::ContourScan( MinimiserConfiguration * Mini
 
 	pair< ScanParam*, ScanParam* > Param_Set = OutputConfig->Get2DScanParams( scanName, scanName2 );
 
-	DoScan2D( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, Param_Set, Returnable_Result, OutputLevel, forceContinue );
+	if( adaptiveMaxFits > 0 )
+	{
+		DoAdaptiveScan2D( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, Param_Set, Returnable_Result, OutputLevel, forceContinue );
+	}
+	else if( numberWorkers > 0 )
+	{
+		vector<ScanParam*> Scan_Params;
+		Scan_Params.push_back( Param_Set.first );
+		Scan_Params.push_back( Param_Set.second );
+		DoParallelScan( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, Scan_Params, Returnable_Result, OutputLevel, forceContinue );
+	}
+	else
+	{
+		DoScan2D( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, Param_Set, Returnable_Result, OutputLevel, forceContinue );
+	}
 
 	return *Returnable_Result;
 }
@@ -295,13 +1189,23 @@ FitResultVector* ScanStudies::SingleScan( MinimiserConfiguration * MinimiserConf
 	vector< PDFWithData* > BottleData, vector< ConstraintFunction* > BottleConstraints, OutputConfiguration* OutputConfig, string scanName,
 	int OutputLevel, bool forceContinue )
 {
-	FitResultVector* Returnable_Result = new FitResultVector( BottleParameters->GetAllNames() );
+	FitResultVector* Returnable_Result = NULL;
 
 	ScanParam* local_param = OutputConfig->GetScanParam( scanName );
 
 	cout << "Performing Single Scan" << endl;
 
-	DoScan( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, local_param, Returnable_Result, OutputLevel, forceContinue );
+	if( numberWorkers > 0 )
+	{
+		vector<FitResultVector*> Scan_Result;
+		DoParallelScan( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, vector<ScanParam*>( 1, local_param ), &Scan_Result, OutputLevel, forceContinue );
+		Returnable_Result = Scan_Result.front();
+	}
+	else
+	{
+		Returnable_Result = new FitResultVector( BottleParameters->GetAllNames() );
+		DoScan( MinimiserConfig, FunctionConfig, BottleParameters, BottleData, BottleConstraints, local_param, Returnable_Result, OutputLevel, forceContinue );
+	}
 
 	cout << "Returning Result" << endl;
 
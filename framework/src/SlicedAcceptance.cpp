@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 using namespace::std;
 
@@ -29,7 +30,7 @@ AcceptanceSlice::AcceptanceSlice( const AcceptanceSlice& input ) :
 //............................................
 // Constructor for flat acceptance
 SlicedAcceptance::SlicedAcceptance( double tl, double th, bool quiet ) :
-	slices(), nullSlice( new AcceptanceSlice(0.,0.,0.) ), tlow(tl), thigh(th), beta(0), _sortedSlices(false), maxminset(false), t_min(0.), t_max(0.)
+	slices(), nullSlice( new AcceptanceSlice(0.,0.,0.) ), tlow(tl), thigh(th), beta(0), _sortedSlices(false), maxminset(false), t_min(0.), t_max(0.), _hasChecked(false), _storedDecision(false)
 {
 
 	//Reality checks
@@ -45,6 +46,8 @@ SlicedAcceptance::SlicedAcceptance( double tl, double th, bool quiet ) :
 	//....done.....
 
 	_sortedSlices = true;
+
+	this->BuildEdgeTable();
 }
 
 SlicedAcceptance::SlicedAcceptance( const SlicedAcceptance& input ) :
@@ -55,6 +58,8 @@ SlicedAcceptance::SlicedAcceptance( const SlicedAcceptance& input ) :
 		if( (input.slices[i]) != NULL ) slices.push_back( new AcceptanceSlice( *(input.slices[i]) ) );
 		else slices.push_back( NULL );
 	}
+
+	this->BuildEdgeTable();
 }
 
 SlicedAcceptance::~SlicedAcceptance()
@@ -115,6 +120,8 @@ SlicedAcceptance::SlicedAcceptance( double tl, double th, double b, bool quiet )
 	{
 		if( !quiet ) cout << "Sliced Acceptance is NOT using sorted horizontal slices" << endl;
 	}
+
+	this->BuildEdgeTable();
 }
 
 
@@ -154,6 +161,8 @@ SlicedAcceptance::SlicedAcceptance( string s, bool quiet ) :
 	{
 		if( !quiet ) cout << "Sliced Acceptance is NOT using sorted horizontal slices" << endl;
 	}
+
+	this->BuildEdgeTable();
 }
 
 //............................................
@@ -227,6 +236,8 @@ SlicedAcceptance::SlicedAcceptance( string type, string fileName, bool quiet ) :
 	{
 		if( !quiet ) cout << "Sliced Acceptance is NOT using sorted horizontal slices" << endl;
 	}
+
+	this->BuildEdgeTable();
 }
 
 //............................................
@@ -320,114 +331,137 @@ SlicedAcceptance::SlicedAcceptance( string type, string fileName,string histName
 	{
 		if( !quiet ) cout << "Sliced Acceptance is NOT using sorted horizontal slices" << endl;
 	}
+
+	this->BuildEdgeTable();
 }
 
 //............................................
 // Return numerator for evaluate
 double SlicedAcceptance::getValue( const double t ) const
 {
-	returnValue = 0;
-	for( unsigned int is = 0; is < slices.size() ; ++is )
-	{
-		if( (t>=slices[is]->tlow()) && (t<slices[is]->thigh()) ) returnValue += slices[is]->height();
-		if( _sortedSlices ) if( t<slices[is]->thigh() ) break;
-	}
-	if( fabs( t - slices.front()->tlow() ) < 1E-6 ) returnValue += slices.front()->height();
-	if( fabs( t - slices.back()->thigh() ) < 1E-6 ) returnValue += slices.back()->height();
-	return returnValue;
+	const int thisEdge = this->findEdgeNum( t );
+	if( thisEdge < 0 ) return 0.;
+	return heightTable[(unsigned)thisEdge];
 }
 
 double SlicedAcceptance::getValue( const Observable* time, const double timeOffset ) const
 {
-	//return this->getValue( time->GetValue() - timeOffset );
+	double t = time->GetValue() - timeOffset;
 
-	if( time->GetBinNumber() != -1 )
+	if( t < this->GetMin() )
 	{
-		//#pragma GCC diagnostic ignored "-Wfloat-equal"
-		if( time->GetOffSet() == timeOffset ) return time->GetAcceptance();
-		//#pragma GCC diagnostic pop
+		if( time->GetValue() > this->GetMin() )
+		{
+			cout << "TIME OFFSET PUSHING VALUE BELOW ACCEPTANCE HISTOGRAM!!!" << endl;
+		}
 		else
 		{
-			time->SetBinNumber( -1 );
-			time->SetOffSet( -999. );
+			cout << "TIME BELOW ACCEPTANCE HISTO!!!" << endl;
 		}
-	}
-
-	double t = time->GetValue() - timeOffset;
-	returnValue = 0;
-	finalBin = -1;
 
-	if( time->GetBinNumber() < 0 )
+		cout << " time: " << time->GetValue() << " offset: " << timeOffset << " min: " << this->GetMin() << endl;
+		this->Print();
+		throw(-987643);
+	}
+	if( t > this->GetMax() )
 	{
-		if( t < this->GetMin() )
+		if( time->GetValue() > this->GetMax() )
 		{
-			if( time->GetValue() > this->GetMin() )
-			{
-				cout << "TIME OFFSET PUSHING VALUE BELOW ACCEPTANCE HISTOGRAM!!!" << endl;
-			}
-			else
-			{
-				cout << "TIME BELOW ACCEPTANCE HISTO!!!" << endl;
-			}
-
-			cout << " time: " << time->GetValue() << " offset: " << timeOffset << " min: " << this->GetMin() << endl;
-			this->Print();
-			throw(-987643);
+			cout << "TIME OFFSET PUSHING VALUE ABOVE ACCEPTANCE HISTOGRAM!!!" << endl;
 		}
-		if( t > this->GetMax() )
+		else
 		{
-			if( time->GetValue() > this->GetMax() )
-			{
-				cout << "TIME OFFSET PUSHING VALUE ABOVE ACCEPTANCE HISTOGRAM!!!" << endl;
-			}
-			else
-			{
-				cout << "TIME ABOVE ACCEPTANCE HISTO!!!" << endl;
-			}
-			cout << " time: " << time->GetValue() << " offset: " << timeOffset << " max: " << this->GetMax() << endl;
-
-			this->Print();
-			throw(-987643);
+			cout << "TIME ABOVE ACCEPTANCE HISTO!!!" << endl;
 		}
+		cout << " time: " << time->GetValue() << " offset: " << timeOffset << " max: " << this->GetMax() << endl;
+
+		this->Print();
+		throw(-987643);
 	}
 
-	if( time->GetBinNumber() >= 0 )
+	return this->getValue( t );
+}
+
+void SlicedAcceptance::getValues( const double* time, const unsigned int n, double* output ) const
+{
+	for( unsigned int i=0; i< n; ++i )
+	{
+		const int thisEdge = this->findEdgeNum( time[i] );
+		output[i] = thisEdge < 0 ? 0. : heightTable[(unsigned)thisEdge];
+	}
+}
+
+int SlicedAcceptance::findEdgeNum( const double t ) const
+{
+	if( heightTable.empty() ) return -1;
+	if( t < edgeTable.front() || t > edgeTable.back() ) return -1;
+
+	const int lastEdge = (int)heightTable.size() - 1;
+	int thisEdge = 0;
+
+	if( uniformEdges )
 	{
-		finalBin = time->GetBinNumber();
+		thisEdge = (int)( ( t - edgeTable.front() ) * edgeWidthInverse );
+		if( thisEdge > lastEdge ) thisEdge = lastEdge;
+		//	Correct for rounding in the division at the edges themselves
+		if( t < edgeTable[(unsigned)thisEdge] && thisEdge > 0 ) --thisEdge;
+		else if( t >= edgeTable[(unsigned)thisEdge+1] && thisEdge < lastEdge ) ++thisEdge;
 	}
 	else
 	{
-		finalBin = this->findSliceNum( time, timeOffset );
+		thisEdge = (int)( upper_bound( edgeTable.begin(), edgeTable.end(), t ) - edgeTable.begin() ) - 1;
+		//	The upper edge of the acceptance belongs to the last interval
+		if( thisEdge > lastEdge ) thisEdge = lastEdge;
 	}
 
-	//cout << finalBin << endl;
+	return thisEdge;
+}
 
-	if( _sortedSlices )
+void SlicedAcceptance::BuildEdgeTable()
+{
+	edgeTable.clear();
+	heightTable.clear();
+	uniformEdges = false;
+	edgeWidthInverse = 0.;
+
+	for( unsigned int i=0; i< slices.size(); ++i )
 	{
-		returnValue += slices[(unsigned)finalBin]->height();
+		if( slices[i] == NULL ) continue;
+		edgeTable.push_back( slices[i]->tlow() );
+		edgeTable.push_back( slices[i]->thigh() );
 	}
-	else
+
+	sort( edgeTable.begin(), edgeTable.end() );
+	edgeTable.erase( unique( edgeTable.begin(), edgeTable.end() ), edgeTable.end() );
+
+	//	Set the range once here so that GetMin and GetMax don't modify a shared acceptance
+	this->FindMaxMin();
+
+	if( edgeTable.size() < 2 ) return;
+
+	//	Sum the heights of all of the slices which cover each interval between neighbouring edges
+	for( unsigned int i=0; i< edgeTable.size()-1; ++i )
 	{
-		for( unsigned int is=0; is < slices.size(); ++is )
+		double thisHeight = 0.;
+		for( unsigned int is=0; is< slices.size(); ++is )
 		{
-			if( (t >= slices[is]->tlow() ) && ( t < slices[is]->thigh() ) )
-			{
-				returnValue += slices[is]->height();
-			}
+			if( slices[is] == NULL ) continue;
+			if( slices[is]->tlow() <= edgeTable[i] && slices[is]->thigh() >= edgeTable[i+1] ) thisHeight += slices[is]->height();
 		}
+		heightTable.push_back( thisHeight );
+	}
 
-		if( t == slices.back()->thigh() )
+	const double edgeWidth = ( edgeTable.back() - edgeTable.front() ) / (double) heightTable.size();
+	uniformEdges = edgeWidth > 0.;
+	for( unsigned int i=0; i< heightTable.size(); ++i )
+	{
+		if( fabs( ( edgeTable[i+1] - edgeTable[i] ) - edgeWidth ) > 1E-9 * edgeWidth )
 		{
-			returnValue += slices.back()->height();
+			uniformEdges = false;
+			break;
 		}
 	}
-
-	if( fabs( time->GetValue() - slices[0]->tlow() ) < 1E-5 ) returnValue = slices[0]->height();
-
-	time->SetBinNumber( finalBin );
-	time->SetAcceptance( returnValue );
-	time->SetOffSet( timeOffset );
-	return returnValue;
+	if( uniformEdges ) edgeWidthInverse = 1. / edgeWidth;
 }
 
 //............................................
@@ -456,23 +490,23 @@ double SlicedAcceptance::stream(ifstream& thisStream)
 
 unsigned int SlicedAcceptance::findSliceNum( const Observable* time, const double timeOffset ) const
 {
-	double t = time->GetValue() - timeOffset;
-	if( time->GetBinNumber() >= 0 ) return (unsigned) time->GetBinNumber();
+	return this->findSliceNum( time->GetValue() - timeOffset );
+}
+
+unsigned int SlicedAcceptance::findSliceNum( const double t ) const
+{
 	unsigned int thisNum=0;
-	for( unsigned int is; is < slices.size(); ++is )
+	for( unsigned int is=0; is < slices.size(); ++is )
 	{
 		if( (t >= slices[is]->tlow() ) && ( t < slices[is]->thigh() ) )
 		{
+			thisNum = is;
 			break;
 		}
-		else
-		{
-			continue;
-		}
-		++thisNum;
 	}
-	if( t == slices.back()->thigh() ) --thisNum;
-	time->SetBinNumber( (int)thisNum );
+	//	The upper edge of the last slice is still inside the acceptance
+	const double lastEdge = slices.back()->thigh();
+	if( t >= lastEdge && t <= lastEdge ) thisNum = (unsigned) slices.size()-1;
 	return thisNum;
 }
 
@@ -516,36 +550,20 @@ bool SlicedAcceptance::GetIsSorted() const
 
 double SlicedAcceptance::GetMax() const
 {
-	if( !maxminset ) this->FindMaxMin();
 	return t_max;
 }
 
 double SlicedAcceptance::GetMin() const
 {
-	if( !maxminset ) this->FindMaxMin();
 	return t_min;
 }
 
-void SlicedAcceptance::FindMaxMin() const
+void SlicedAcceptance::FindMaxMin()
 {
-	double temp_max = slices[0]->tlow();
-	double temp_min = slices[0]->thigh();
-	if( _sortedSlices )
-	{
-		temp_min = (*slices.begin())->tlow();
-		temp_max = (*slices.back()).thigh();
-	}
-	else
-	{
-		for( unsigned int i=0; i< slices.size(); ++i )
-		{
-			if( slices[i]->tlow() < temp_min ) temp_min = slices[i]->tlow();
-			if( slices[i]->thigh() > temp_max ) temp_max = slices[i]->thigh();
-		}
-	}
-	t_min = temp_min;
-	t_max = temp_max;
-	maxminset = true;
+	//	The edge table holds every slice edge in order
+	maxminset = !edgeTable.empty();
+	t_min = maxminset ? edgeTable.front() : 0.;
+	t_max = maxminset ? edgeTable.back() : 0.;
 }
 
 void SlicedAcceptance::Print() const
@@ -0,0 +1,69 @@
+/*!
+ * @class StudyWorkers
+ *
+ * @brief Setup shared by the studies which run whole fits in parallel
+ */
+
+///	ROOT Headers
+#include "TH1.h"
+#include "TRandom3.h"
+///	RapidFit Headers
+#include "StudyWorkers.h"
+#include "RapidFitRandom.h"
+///	System Headers
+#include <pthread.h>
+#include <time.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace::std;
+
+bool StudyWorkers::DetachHistograms()
+{
+	const bool addDirectory = TH1::AddDirectoryStatus();
+	TH1::AddDirectory( kFALSE );
+	return addDirectory;
+}
+
+void StudyWorkers::RestoreHistograms( const bool addDirectory )
+{
+	TH1::AddDirectory( addDirectory );
+}
+
+TRandom3* StudyWorkers::MakeFrameworkRandom()
+{
+	//	A seed of 0 would make TRandom3 seed itself from the time
+	return new TRandom3( RapidFitRandom::GetFrameworkRandomFunction()->Integer( kMaxUInt-1 ) + 1 );
+}
+
+void StudyWorkers::RunWorkers( void* (*loop)( void* ), void** workerInput, const unsigned int nWorkers )
+{
+	pthread_attr_t attrib;
+	pthread_attr_init( &attrib );
+	pthread_attr_setdetachstate( &attrib, PTHREAD_CREATE_JOINABLE );
+
+	vector<pthread_t> threads( nWorkers );
+	for( unsigned int workerNum=0; workerNum< nWorkers; ++workerNum )
+	{
+		int status = pthread_create( &(threads[workerNum]), &attrib, loop, workerInput[workerNum] );
+		if( status )
+		{
+			cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
+			exit(-1);
+		}
+	}
+
+	pthread_attr_destroy( &attrib );
+
+	for( unsigned int workerNum=0; workerNum< nWorkers; ++workerNum )
+	{
+		pthread_join( threads[workerNum], NULL );
+	}
+}
+
+double StudyWorkers::ElapsedTime( const timespec& start, const timespec& stop )
+{
+	return (double)( stop.tv_sec - start.tv_sec ) + 1E-9 * (double)( stop.tv_nsec - start.tv_nsec );
+}
+
@@ -267,6 +267,75 @@ double SumPDF::Evaluate( DataPoint * NewDataPoint )
 	return termOne + termTwo;
 }
 
+void SumPDF::PrecomputeDerivedColumns( IDataSet* InputData )
+{
+	firstPDF->PrecomputeDerivedColumns( InputData );
+	secondPDF->PrecomputeDerivedColumns( InputData );
+}
+
+vector<string> SumPDF::GetAnalyticGradientParameters()
+{
+	if( this->GetNumericalNormalisation() ) return vector<string>();
+	return BasePDF::CombineAnalyticGradientParameters( firstPDF, secondPDF, vector<string>( 1, fractionName ) );
+}
+
+bool SumPDF::EvaluateGradient( DataPoint* NewDataPoint, const vector<string>& Names, double* output )
+{
+	if( Names.empty() ) return true;
+	vector<double> firstGradient( Names.size(), 0. ), secondGradient( Names.size(), 0. );
+	if( !firstPDF->EvaluateGradient( NewDataPoint, Names, &(firstGradient[0]) ) ) return false;
+	if( !secondPDF->EvaluateGradient( NewDataPoint, Names, &(secondGradient[0]) ) ) return false;
+
+	for( unsigned int i=0; i< Names.size(); ++i )
+	{
+		output[i] = firstGradient[i] * firstFraction + secondGradient[i] * ( 1 - firstFraction );
+		//	d/df ( f*A + (1-f)*B ) = A - B
+		if( Names[i] == fractionName ) output[i] += firstPDF->Evaluate( NewDataPoint ) - secondPDF->Evaluate( NewDataPoint );
+	}
+	return true;
+}
+
+bool SumPDF::IntegralGradient( DataPoint* NewDataPoint, PhaseSpaceBoundary* NewBoundary, const vector<string>& Names, double* output )
+{
+	if( Names.empty() ) return true;
+	if( this->GetNumericalNormalisation() ) return this->NoGradientDependence( Names, output );
+	vector<double> firstGradient( Names.size(), 0. ), secondGradient( Names.size(), 0. );
+	if( !firstPDF->IntegralGradient( NewDataPoint, NewBoundary, Names, &(firstGradient[0]) ) ) return false;
+	if( !secondPDF->IntegralGradient( NewDataPoint, NewBoundary, Names, &(secondGradient[0]) ) ) return false;
+
+	for( unsigned int i=0; i< Names.size(); ++i )
+	{
+		output[i] = firstGradient[i] * firstFraction * firstIntegralCorrection + secondGradient[i] * ( 1 - firstFraction ) * secondIntegralCorrection;
+		if( Names[i] == fractionName )
+		{
+			output[i] += firstPDF->Integral( NewDataPoint, NewBoundary ) * firstIntegralCorrection;
+			output[i] -= secondPDF->Integral( NewDataPoint, NewBoundary ) * secondIntegralCorrection;
+		}
+	}
+	return true;
+}
+
+//Return the function value for a range of events
+void SumPDF::EvaluateBatch( IDataSet* InputData, const unsigned int begin, const unsigned int end, double* output )
+{
+	if( end <= begin ) return;
+	const unsigned int nEvents = end - begin;
+	if( firstFraction > 1.0 || firstFraction < 0.0 )
+	{
+		cerr << "Requested impossible fraction: " << firstFraction << endl;
+		for( unsigned int i=0; i< nEvents; ++i ) output[i] = DBL_MAX;
+		return;
+	}
+	//Get the PDFs' values, weighted by firstFraction
+	vector<double> secondValues( nEvents, 0. );
+	firstPDF->EvaluateBatch( InputData, begin, end, output );
+	secondPDF->EvaluateBatch( InputData, begin, end, &(secondValues[0]) );
+	for( unsigned int i=0; i< nEvents; ++i )
+	{
+		output[i] = output[i] * firstFraction + secondValues[i] * ( 1 - firstFraction );
+	}
+}
+
 
 //Return a prototype data point
 vector<string> SumPDF::GetPrototypeDataPoint()
@@ -0,0 +1,268 @@
+/*!
+ * @class ThreadPool
+ *
+ * @brief A set of long-lived worker threads which are parked between evaluations
+ */
+
+///	RapidFit Headers
+#include "ThreadPool.h"
+///	System Headers
+#include <pthread.h>
+#include <time.h>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <vector>
+#include <string>
+
+using namespace::std;
+
+namespace
+{
+	//	Each worker stores its ThreadPool_Worker here so that it can find its own index without searching the pool
+	pthread_key_t workerKey;
+	pthread_once_t workerKeyOnce = PTHREAD_ONCE_INIT;
+
+	void MakeWorkerKey()
+	{
+		pthread_key_create( &workerKey, NULL );
+	}
+
+	double Seconds( const timespec& start, const timespec& end )
+	{
+		return (double)( end.tv_sec - start.tv_sec ) + 1E-9 * (double)( end.tv_nsec - start.tv_nsec );
+	}
+}
+
+ThreadPool::ThreadPool( const unsigned int input ) :
+	nThreads( input==0?1:input ), workers(), workerInfo(), poolLock(), wakeCondition(), doneCondition(), dispatchLock(),
+	generation(0), pending(0), shutdown(false), currentTask(NULL), currentInput(NULL), currentTasks(0), nextTask(0),
+	busyTime(), tasksRun(), batchTime(0.), batches(0)
+{
+	pthread_once( &workerKeyOnce, MakeWorkerKey );
+
+	busyTime.resize( nThreads, 0. );
+	tasksRun.resize( nThreads, 0 );
+
+	pthread_mutex_init( &poolLock, NULL );
+	pthread_mutex_init( &dispatchLock, NULL );
+	pthread_cond_init( &wakeCondition, NULL );
+	pthread_cond_init( &doneCondition, NULL );
+
+	workers.resize( nThreads );
+	workerInfo.resize( nThreads );
+
+	//	Workers HAVE to be joinable so that we can cleanly shut them down
+	pthread_attr_t attrib;
+	pthread_attr_init( &attrib );
+	pthread_attr_setdetachstate( &attrib, PTHREAD_CREATE_JOINABLE );
+
+	for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
+	{
+		workerInfo[threadnum].pool = this;
+		workerInfo[threadnum].index = threadnum;
+		int status = pthread_create( &(workers[threadnum]), &attrib, ThreadPool::WorkerLoop, (void*) &(workerInfo[threadnum]) );
+		if( status )
+		{
+			cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
+			exit(-1);
+		}
+	}
+
+	pthread_attr_destroy( &attrib );
+}
+
+ThreadPool::~ThreadPool()
+{
+	pthread_mutex_lock( &poolLock );
+	shutdown = true;
+	pthread_cond_broadcast( &wakeCondition );
+	pthread_mutex_unlock( &poolLock );
+
+	for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
+	{
+		int status = pthread_join( workers[threadnum], NULL );
+		if( status )
+		{
+			cerr << "Error Joining a Thread:\t" << threadnum << "\t:\t" << status << endl;
+		}
+	}
+
+	pthread_cond_destroy( &wakeCondition );
+	pthread_cond_destroy( &doneCondition );
+	pthread_mutex_destroy( &dispatchLock );
+	pthread_mutex_destroy( &poolLock );
+}
+
+unsigned int ThreadPool::GetNumThreads() const
+{
+	return nThreads;
+}
+
+bool ThreadPool::IsWorkerThread() const
+{
+	pthread_t self = pthread_self();
+	for( vector<pthread_t>::const_iterator worker_i = workers.begin(); worker_i != workers.end(); ++worker_i )
+	{
+		if( pthread_equal( self, *worker_i ) ) return true;
+	}
+	return false;
+}
+
+int ThreadPool::GetWorkerIndex() const
+{
+	pthread_once( &workerKeyOnce, MakeWorkerKey );
+	const ThreadPool_Worker* thisWorker = (const ThreadPool_Worker*) pthread_getspecific( workerKey );
+	if( thisWorker == NULL || thisWorker->pool != this ) return -1;
+	return (int) thisWorker->index;
+}
+
+vector<double> ThreadPool::GetBusyTimes() const
+{
+	return busyTime;
+}
+
+vector<unsigned long> ThreadPool::GetTaskCounts() const
+{
+	return tasksRun;
+}
+
+double ThreadPool::GetBatchTime() const
+{
+	return batchTime;
+}
+
+void ThreadPool::ResetStatistics()
+{
+	pthread_mutex_lock( &dispatchLock );
+	busyTime = vector<double>( nThreads, 0. );
+	tasksRun = vector<unsigned long>( nThreads, 0 );
+	batchTime = 0.;
+	batches = 0;
+	pthread_mutex_unlock( &dispatchLock );
+}
+
+void ThreadPool::PrintStatistics( const string& label ) const
+{
+	double totalBusy = 0., maxBusy = 0.;
+	for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
+	{
+		totalBusy += busyTime[threadnum];
+		if( busyTime[threadnum] > maxBusy ) maxBusy = busyTime[threadnum];
+	}
+
+	cout << label << ": " << nThreads << " workers ran " << batches << " batches in " << batchTime << "s" << endl;
+	for( unsigned int threadnum=0; threadnum< nThreads; ++threadnum )
+	{
+		cout << "\tWorker " << setw(3) << threadnum << ":\tbusy " << setw(12) << busyTime[threadnum] << "s\t";
+		if( batchTime > 0. ) cout << setw(6) << setprecision(4) << 100.*busyTime[threadnum]/batchTime << "%\t";
+		cout << tasksRun[threadnum] << " tasks" << endl;
+		cout << setprecision(6);
+	}
+	//	1 when every worker was busy for the same time, nThreads when one worker did everything
+	if( totalBusy > 0. ) cout << "\tSlowest worker / mean busy time:\t" << maxBusy / ( totalBusy / (double)nThreads ) << endl;
+}
+
+bool ThreadPool::Execute( void* (*task)( void* ), void** taskInput, const unsigned int nTasks )
+{
+	if( nTasks == 0 ) return true;
+
+	//	A worker submitting to its own pool would wait on itself forever
+	if( this->IsWorkerThread() ) return false;
+
+	//	Somebody else is using the pool, let the caller do the work another way
+	if( pthread_mutex_trylock( &dispatchLock ) != 0 ) return false;
+
+	timespec start, end;
+	clock_gettime( CLOCK_MONOTONIC, &start );
+
+	pthread_mutex_lock( &poolLock );
+
+	currentTask = task;
+	currentInput = taskInput;
+	currentTasks = nTasks;
+	nextTask = 0;
+	pending = nThreads;
+	++generation;
+
+	pthread_cond_broadcast( &wakeCondition );
+
+	//	Barrier, we CANNOT return to Minuit without the results from ALL workers
+	while( pending != 0 )
+	{
+		pthread_cond_wait( &doneCondition, &poolLock );
+	}
+
+	currentTask = NULL;
+	currentInput = NULL;
+	currentTasks = 0;
+
+	pthread_mutex_unlock( &poolLock );
+
+	clock_gettime( CLOCK_MONOTONIC, &end );
+	batchTime += Seconds( start, end );
+	++batches;
+
+	pthread_mutex_unlock( &dispatchLock );
+
+	return true;
+}
+
+void ThreadPool::RunTasks( const unsigned int index )
+{
+	timespec start, end;
+	clock_gettime( CLOCK_MONOTONIC, &start );
+
+	unsigned long thisTasks = 0;
+	while( true )
+	{
+		//	Claim the next task, whoever finishes first takes the next one
+		const unsigned int taskNum = __sync_fetch_and_add( &nextTask, 1U );
+		if( taskNum >= currentTasks ) break;
+		currentTask( currentInput[taskNum] );
+		++thisTasks;
+	}
+
+	clock_gettime( CLOCK_MONOTONIC, &end );
+
+	//	Only this worker touches its own entries while the batch runs
+	busyTime[index] += Seconds( start, end );
+	tasksRun[index] += thisTasks;
+}
+
+void* ThreadPool::WorkerLoop( void* input )
+{
+	ThreadPool_Worker* thisWorker = (ThreadPool_Worker*) input;
+	ThreadPool* thisPool = thisWorker->pool;
+
+	pthread_setspecific( workerKey, input );
+
+	unsigned long seenGeneration = 0;
+
+	while( true )
+	{
+		pthread_mutex_lock( &(thisPool->poolLock) );
+		while( !thisPool->shutdown && thisPool->generation == seenGeneration )
+		{
+			pthread_cond_wait( &(thisPool->wakeCondition), &(thisPool->poolLock) );
+		}
+		if( thisPool->shutdown )
+		{
+			pthread_mutex_unlock( &(thisPool->poolLock) );
+			break;
+		}
+		seenGeneration = thisPool->generation;
+		pthread_mutex_unlock( &(thisPool->poolLock) );
+
+		//	The batch description is not modified until every worker has reported back, so no lock is needed here
+		thisPool->RunTasks( thisWorker->index );
+
+		pthread_mutex_lock( &(thisPool->poolLock) );
+		--(thisPool->pending);
+		if( thisPool->pending == 0 ) pthread_cond_signal( &(thisPool->doneCondition) );
+		pthread_mutex_unlock( &(thisPool->poolLock) );
+	}
+
+	return NULL;
+}
+
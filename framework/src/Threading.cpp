@@ -123,6 +123,38 @@ vector<vector<DataPoint*> > Threading::divideData( IDataSet* input, int subsets
 	return output_datasets;
 }
 
+//	Share whole blocks between the subsets so that no block is split between two threads, nothing is read from the DataSet
+vector<pair<unsigned int,unsigned int> > Threading::divideRanges( IDataSet* input, int subsets, unsigned int blockSize )
+{
+	vector<pair<unsigned int,unsigned int> > output_ranges;
+	if( subsets <= 0 ) subsets = 1;
+	if( blockSize == 0 ) blockSize = 1;
+
+	const unsigned int nEvents = (unsigned) input->GetDataNumber();
+	const unsigned int nBlocks = ( nEvents + blockSize - 1 ) / blockSize;
+	for( unsigned int setnum = 0; setnum < (unsigned) subsets; ++setnum )
+	{
+		unsigned int begin = ( setnum * nBlocks / (unsigned) subsets ) * blockSize;
+		unsigned int end = ( ( setnum + 1 ) * nBlocks / (unsigned) subsets ) * blockSize;
+		if( begin > nEvents ) begin = nEvents;
+		if( end > nEvents ) end = nEvents;
+		output_ranges.push_back( make_pair( begin, end ) );
+	}
+
+	return output_ranges;
+}
+
+unsigned int Threading::EventsPerBlock()
+{
+	return 64;
+}
+
+pthread_mutex_t* Threading::RootIOLock()
+{
+	static pthread_mutex_t rootIOLock = PTHREAD_MUTEX_INITIALIZER;
+	return &rootIOLock;
+}
+
 //      Method to return a vector of data subset(s)
 vector<IDataSet*> Threading::divideDataSet( IDataSet* input, unsigned int subsets )
 {
@@ -12,20 +12,37 @@
 #include "StringProcessing.h"
 #include "AcceptanceSlice.h"
 #include "ClassLookUp.h"
+#include "DebugClass.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
 #include <vector>
 #include <string>
 
 using namespace::std;
 
+namespace
+{
+	//	The cached integrals are only reused for exactly the same arguments, compare the bits rather than the values
+	inline bool SameValue( const double first, const double second )
+	{
+		return memcmp( &first, &second, sizeof(double) ) == 0;
+	}
+}
+
 //............................................
 // Constructor 
 TimeAccRes::TimeAccRes( PDFConfigurator* configurator, bool quiet ) :
-	resolutionModel(NULL), timeAcc(NULL), _config( new PDFConfigurator( *configurator ) )
+	resolutionModel(NULL), timeAcc(NULL), _config( new PDFConfigurator( *configurator ) ),
+	useIntegralTables(false), resolutionClasses(0), resolutionClassMin(0.), resolutionClassMax(0.), resolutionClassTolerance(0.),
+	eventResolutionName( configurator->getName("eventResolution") ), resolutionParameterNames(), resolutionParameterValues(),
+	integralTables(), currentMeasurement(NULL), currentResolution(0.)
 {
 	this->ConfigTimeRes( configurator, quiet );
 	this->ConfigTimeAcc( configurator, quiet );
+	this->ConfigIntegralTables( configurator, quiet );
 }
 
 void TimeAccRes::ConfigTimeRes( PDFConfigurator* configurator, bool quiet )
@@ -78,19 +95,75 @@ void TimeAccRes::ConfigTimeAcc( PDFConfigurator* configurator, bool quiet )
 	}
 }
 
+void TimeAccRes::ConfigIntegralTables( PDFConfigurator* configurator, bool quiet )
+{
+	//	Integral tables are rebuilt from scratch for each instance
+	integralTables.clear();
+	resolutionParameterNames.clear();
+	resolutionParameterValues.clear();
+
+	useIntegralTables = configurator->isTrue( "UseTimeIntegralTables" );
+	if( !useIntegralTables ) return;
+
+	vector<string> parameterNames;
+	resolutionModel->addParameters( parameterNames );
+	for( unsigned int i=0; i< parameterNames.size(); ++i ) resolutionParameterNames.push_back( ObservableRef( parameterNames[i] ) );
+
+	if( !resolutionModel->isPerEvent() )
+	{
+		integralTables.resize( 1 );
+		if( !quiet ) cout << "TimeAccRes:: Caching the sliced time integrals for each set of resolution parameters" << endl;
+		return;
+	}
+
+	//	Per-event resolutions are binned into sigma classes, without any classes the exact integral is always used
+	const string classes = configurator->getConfigurationValue( "TimeResolutionClasses" );
+	resolutionClasses = classes.empty() ? 0 : (unsigned) atoi( classes.c_str() );
+	if( resolutionClasses == 0 )
+	{
+		if( !quiet ) cout << "TimeAccRes:: Per-event resolution and no TimeResolutionClasses, not caching the sliced time integrals" << endl;
+		return;
+	}
+
+	const string classMin = configurator->getConfigurationValue( "TimeResolutionClassMin" );
+	const string classMax = configurator->getConfigurationValue( "TimeResolutionClassMax" );
+	const string classTolerance = configurator->getConfigurationValue( "TimeResolutionClassTolerance" );
+	resolutionClassMin = classMin.empty() ? 0. : strtod( classMin.c_str(), NULL );
+	resolutionClassMax = classMax.empty() ? 0.1 : strtod( classMax.c_str(), NULL );
+	resolutionClassTolerance = classTolerance.empty() ? 1E-4 : strtod( classTolerance.c_str(), NULL );
+
+	if( resolutionClassMax <= resolutionClassMin || resolutionClassTolerance < 0. )
+	{
+		cerr << "TimeAccRes:: TimeResolutionClassMax must be above TimeResolutionClassMin and TimeResolutionClassTolerance must not be negative" << endl;
+		exit(-6531);
+	}
+
+	integralTables.resize( resolutionClasses );
+
+	if( !quiet )
+	{
+		cout << "TimeAccRes:: Caching the sliced time integrals in " << resolutionClasses << " sigma classes [" << resolutionClassMin << " < sigma < " << resolutionClassMax << "]";
+		cout << " with a tolerance of " << resolutionClassTolerance << endl;
+	}
+}
+
 TimeAccRes::~TimeAccRes()
 {
 	if( timeAcc != NULL ) delete timeAcc;
 	if( resolutionModel != NULL ) delete resolutionModel;
 }
 
-TimeAccRes::TimeAccRes( const TimeAccRes& input ) : resolutionModel(NULL), timeAcc(NULL), _config(NULL)
+TimeAccRes::TimeAccRes( const TimeAccRes& input ) : resolutionModel(NULL), timeAcc(NULL), _config(NULL),
+	useIntegralTables(false), resolutionClasses(0), resolutionClassMin(0.), resolutionClassMax(0.), resolutionClassTolerance(0.),
+	eventResolutionName( input.eventResolutionName ), resolutionParameterNames(), resolutionParameterValues(),
+	integralTables(), currentMeasurement(NULL), currentResolution(0.)
 {
 	if( input._config != NULL )
 	{
 		_config = new PDFConfigurator( *(input._config) );
 		this->ConfigTimeRes( _config, true );
 		this->ConfigTimeAcc( _config, true );
+		this->ConfigIntegralTables( _config, true );
 	}
 }
 
@@ -107,6 +180,23 @@ void TimeAccRes::addParameters( vector<string> & parameterNames )
 void TimeAccRes::setParameters( ParameterSet & parameters )
 {
 	resolutionModel->setParameters( parameters );
+
+	if( useIntegralTables )
+	{
+		//	The tables are only valid for the resolution parameters they were filled with
+		bool parametersChanged = resolutionParameterValues.size() != resolutionParameterNames.size();
+		resolutionParameterValues.resize( resolutionParameterNames.size(), 0. );
+		for( unsigned int i=0; i< resolutionParameterNames.size(); ++i )
+		{
+			const double thisValue = parameters.GetPhysicsParameter( resolutionParameterNames[i] )->GetValue();
+			if( !SameValue( thisValue, resolutionParameterValues[i] ) ) parametersChanged = true;
+			resolutionParameterValues[i] = thisValue;
+		}
+		if( parametersChanged )
+		{
+			for( unsigned int i=0; i< integralTables.size(); ++i ) integralTables[i].clear();
+		}
+	}
 	return;
 }
 
@@ -128,6 +218,8 @@ void TimeAccRes::addObservables( vector<string> & observableNames )
 void TimeAccRes::setObservables( DataPoint * measurement )
 {
 	resolutionModel->setObservables( measurement );
+	currentMeasurement = measurement;
+	if( resolutionClasses > 0 ) currentResolution = measurement->GetObservable( eventResolutionName )->GetValue();
 	return;
 }
 
@@ -142,155 +234,189 @@ double TimeAccRes::Exp( double time, double gamma )
 
 double TimeAccRes::ExpInt( double tlow, double thigh, double gamma )
 {
-	double returnable_ExpInt=0.;
-
-	double tlo_boundary = tlow;
-	double thi_boundary = thigh;
+	if( useIntegralTables ) return this->TabulatedIntegral( ExpIntegral, tlow, thigh, gamma, 0. ).first;
+	return this->SlicedIntegral( ExpIntegral, tlow, thigh, gamma, 0. ).first;
+}
 
-	double thisExpInt = 0.;
+double TimeAccRes::ExpSin( double time, double gamma, double dms )
+{
+	return resolutionModel->ExpSin( time, gamma, dms ) * timeAcc->getValue( time );
+}
 
-	double tlo=0.;
-	double thi=0.;
+double TimeAccRes::ExpSinInt( double tlow, double thigh, double gamma, double dms )
+{
+	if( useIntegralTables ) return this->TabulatedIntegral( ExpSinIntegral, tlow, thigh, gamma, dms ).first;
+	return this->SlicedIntegral( ExpSinIntegral, tlow, thigh, gamma, dms ).first;
+}
 
-	AcceptanceSlice* thisSlice = NULL;
+double TimeAccRes::ExpCos( double time, double gamma, double dms )
+{
+	return resolutionModel->ExpCos( time, gamma, dms ) * timeAcc->getValue( time );
+}
 
-	double slice_lo=0.,slice_hi=0.;
+double TimeAccRes::ExpCosInt( double tlow, double thigh, double gamma, double dms )
+{
+	if( useIntegralTables ) return this->TabulatedIntegral( ExpCosIntegral, tlow, thigh, gamma, dms ).first;
+	return this->SlicedIntegral( ExpCosIntegral, tlow, thigh, gamma, dms ).first;
+}
 
-	for( unsigned int islice = 0; islice < (unsigned) timeAcc->numberOfSlices(); ++islice )
-	{
-		thisSlice = timeAcc->getSlice(islice);
+pair<double,double> TimeAccRes::ExpCosSinInt( double tlow, double thigh, double gamma, double dms )
+{
+	if( useIntegralTables ) return this->TabulatedIntegral( ExpCosSinIntegral, tlow, thigh, gamma, dms );
+	return this->SlicedIntegral( ExpCosSinIntegral, tlow, thigh, gamma, dms );
+}
 
-		slice_lo = thisSlice->tlow();
-		slice_hi = thisSlice->thigh();
+pair<double,double> TimeAccRes::ExpCosSin( double time, double gamma, double dms )
+{
+	pair<double,double> thisPair = resolutionModel->ExpCosSin( time, gamma, dms );
+	thisPair.first *= timeAcc->getValue( time ); thisPair.second *= timeAcc->getValue( time );
+	return thisPair;
+}
 
-		tlo = tlo_boundary > slice_lo ? tlo_boundary : slice_lo;
-		thi = thi_boundary < slice_hi ? thi_boundary : slice_hi;
-		if( thi > tlo )
-		{
-			thisExpInt = resolutionModel->ExpInt( tlo, thi, gamma );
-			returnable_ExpInt += thisExpInt * thisSlice->height();
-		}
-	}
+void TimeAccRes::ExpBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, double* output )
+{
+	if( end <= begin ) return;
+	resolutionModel->ExpBatch( data, begin, end, time, gamma, output );
 
-	return returnable_ExpInt;
+	vector<double> acceptance( end-begin );
+	timeAcc->getValues( time, end-begin, &(acceptance[0]) );
+	for( unsigned int i=0; i< end-begin; ++i ) output[i] *= acceptance[i];
 }
 
-double TimeAccRes::ExpSin( double time, double gamma, double dms )
+void TimeAccRes::ExpCosSinBatch( IDataSet* data, const unsigned int begin, const unsigned int end, const double* time, const double gamma, const double dms,
+		double* outCos, double* outSin )
 {
-	return resolutionModel->ExpSin( time, gamma, dms ) * timeAcc->getValue( time );
+	if( end <= begin ) return;
+	resolutionModel->ExpCosSinBatch( data, begin, end, time, gamma, dms, outCos, outSin );
+
+	vector<double> acceptance( end-begin );
+	timeAcc->getValues( time, end-begin, &(acceptance[0]) );
+	for( unsigned int i=0; i< end-begin; ++i )
+	{
+		outCos[i] *= acceptance[i];
+		outSin[i] *= acceptance[i];
+	}
 }
 
-double TimeAccRes::ExpSinInt( double tlow, double thigh, double gamma, double dms )
+pair<double,double> TimeAccRes::SlicedIntegral( IntegralType type, double tlow, double thigh, double gamma, double dms )
 {
-	double returnable_ExpSinInt=0.;
-
-	double tlo_boundary = tlow;
-	double thi_boundary = thigh;
+	pair<double,double> returnable_Int=make_pair(0.,0.);
 
-	double thisExpSinInt = 0.;
+	pair<double,double> thisInt = make_pair(0.,0.);
 
 	double tlo=0.;
 	double thi=0.;
 
-	AcceptanceSlice* thisSlice = NULL;
-
-	double slice_lo=0.,slice_hi=0.;
-
 	for( unsigned int islice = 0; islice < (unsigned) timeAcc->numberOfSlices(); ++islice )
 	{
-		thisSlice = timeAcc->getSlice(islice);
+		AcceptanceSlice* thisSlice = timeAcc->getSlice(islice);
 
-		double slice_lo = thisSlice->tlow();
-		double slice_hi = thisSlice->thigh();
+		const double slice_lo = thisSlice->tlow();
+		const double slice_hi = thisSlice->thigh();
 
-		tlo = tlo_boundary > slice_lo ? tlo_boundary : slice_lo;
-		thi = thi_boundary < slice_hi ? thi_boundary : slice_hi;
+		tlo = tlow > slice_lo ? tlow : slice_lo;
+		thi = thigh < slice_hi ? thigh : slice_hi;
 		if( thi > tlo )
 		{
-			thisExpSinInt = resolutionModel->ExpSinInt( tlo, thi, gamma, dms );
-			returnable_ExpSinInt += thisExpSinInt * thisSlice->height();
+			switch( type )
+			{
+				case ExpIntegral:
+					thisInt.first = resolutionModel->ExpInt( tlo, thi, gamma );
+					break;
+				case ExpSinIntegral:
+					thisInt.first = resolutionModel->ExpSinInt( tlo, thi, gamma, dms );
+					break;
+				case ExpCosIntegral:
+					thisInt.first = resolutionModel->ExpCosInt( tlo, thi, gamma, dms );
+					break;
+				case ExpCosSinIntegral:
+					thisInt = resolutionModel->ExpCosSinInt( tlo, thi, gamma, dms );
+					break;
+			}
+			returnable_Int.first += thisInt.first * thisSlice->height();
+			returnable_Int.second += thisInt.second * thisSlice->height();
 		}
 	}
 
-	return returnable_ExpSinInt;
+	return returnable_Int;
 }
 
-double TimeAccRes::ExpCos( double time, double gamma, double dms )
+int TimeAccRes::ResolutionClass() const
 {
-	return resolutionModel->ExpCos( time, gamma, dms ) * timeAcc->getValue( time );
+	if( !resolutionModel->isPerEvent() ) return 0;
+	if( resolutionClasses == 0 ) return -1;
+	if( currentResolution < resolutionClassMin || currentResolution >= resolutionClassMax ) return -1;
+	const double classWidth = ( resolutionClassMax - resolutionClassMin ) / (double) resolutionClasses;
+	int thisClass = (int) ( ( currentResolution - resolutionClassMin ) / classWidth );
+	if( thisClass >= (int) resolutionClasses ) thisClass = (int) resolutionClasses-1;
+	return thisClass;
 }
 
-double TimeAccRes::ExpCosInt( double tlow, double thigh, double gamma, double dms )
+pair<double,double> TimeAccRes::TabulatedIntegral( IntegralType type, double tlow, double thigh, double gamma, double dms )
 {
-	double returnable_ExpCosInt=0.;
-
-	double tlo_boundary = tlow;
-	double thi_boundary = thigh;
-
-	double thisExpCosInt = 0.;
-
-	double tlo=0.;
-	double thi=0.;
+	const int thisClass = this->ResolutionClass();
+	if( thisClass < 0 ) return this->SlicedIntegral( type, tlow, thigh, gamma, dms );
 
-	AcceptanceSlice* thisSlice = NULL;
+	vector<SliceIntegral>& thisTable = integralTables[(unsigned)thisClass];
 
-	double slice_lo=0.,slice_hi=0.;
-
-	for( unsigned int islice = 0; islice < (unsigned) timeAcc->numberOfSlices(); ++islice )
+	for( vector<SliceIntegral>::const_iterator entry_i = thisTable.begin(); entry_i != thisTable.end(); ++entry_i )
 	{
-		thisSlice = timeAcc->getSlice(islice);
-
-		slice_lo = thisSlice->tlow();
-		slice_hi = thisSlice->thigh();
-
-		tlo = tlo_boundary > slice_lo ? tlo_boundary : slice_lo;
-		thi = thi_boundary < slice_hi ? thi_boundary : slice_hi;
-		if( thi > tlo )
+		if( entry_i->type == type && SameValue( entry_i->gamma, gamma ) && SameValue( entry_i->dms, dms ) && SameValue( entry_i->tlow, tlow ) && SameValue( entry_i->thigh, thigh ) )
 		{
-			thisExpCosInt = resolutionModel->ExpCosInt( tlo, thi, gamma, dms );
-			returnable_ExpCosInt += thisExpCosInt * thisSlice->height();
+			if( entry_i->usable ) return entry_i->value;
+			else return this->SlicedIntegral( type, tlow, thigh, gamma, dms );
 		}
 	}
 
-	return returnable_ExpCosInt;
-}
+	//	gamma and dms move with every step of the minimiser, so entries for old values are dropped rather than searched forever
+	if( thisTable.size() >= 16 ) thisTable.clear();
 
-pair<double,double> TimeAccRes::ExpCosSinInt( double tlow, double thigh, double gamma, double dms )
-{
-	pair<double,double> returnable_ExpCosSinInt=make_pair(0.,0.);
+	SliceIntegral newEntry;
+	newEntry.type = type;
+	newEntry.tlow = tlow; newEntry.thigh = thigh;
+	newEntry.gamma = gamma; newEntry.dms = dms;
+	newEntry.usable = true;
 
-	double tlo_boundary = tlow;
-	double thi_boundary = thigh;
+	if( !resolutionModel->isPerEvent() )
+	{
+		newEntry.value = this->SlicedIntegral( type, tlow, thigh, gamma, dms );
+	}
+	else
+	{
+		//	Evaluate the integral at the centre of the sigma class and check it against the exact integrals at the class edges
+		const double classWidth = ( resolutionClassMax - resolutionClassMin ) / (double) resolutionClasses;
+		const double classLow = resolutionClassMin + classWidth * (double) thisClass;
 
-	pair<double,double> thisExpCosSinInt = make_pair(0.,0.);
+		DataPoint classPoint( *currentMeasurement );
+		Observable* classResolution = classPoint.GetObservable( eventResolutionName );
 
-	double tlo=0.;
-	double thi=0.;
+		classResolution->ExternallySetValue( classLow + 0.5*classWidth );
+		resolutionModel->setObservables( &classPoint );
+		newEntry.value = this->SlicedIntegral( type, tlow, thigh, gamma, dms );
 
-	for( unsigned int islice = 0; islice < (unsigned) timeAcc->numberOfSlices(); ++islice )
-	{
-		AcceptanceSlice* thisSlice = timeAcc->getSlice(islice);
+		for( unsigned int edge=0; edge < 2; ++edge )
+		{
+			classResolution->ExternallySetValue( classLow + classWidth * (double) edge );
+			resolutionModel->setObservables( &classPoint );
+			const pair<double,double> edgeValue = this->SlicedIntegral( type, tlow, thigh, gamma, dms );
+
+			if( fabs( edgeValue.first - newEntry.value.first ) > resolutionClassTolerance * fabs( newEntry.value.first ) ||
+				fabs( edgeValue.second - newEntry.value.second ) > resolutionClassTolerance * fabs( newEntry.value.second ) )
+			{
+				newEntry.usable = false;
+			}
+		}
 
-		const double slice_lo = thisSlice->tlow();
-		const double slice_hi = thisSlice->thigh();
+		resolutionModel->setObservables( currentMeasurement );
 
-		tlo = tlo_boundary > slice_lo ? tlo_boundary : slice_lo;
-		thi = thi_boundary < slice_hi ? thi_boundary : slice_hi;
-		if( thi > tlo )
+		if( !newEntry.usable && DebugClass::DebugThisClass( "TimeAccRes" ) )
 		{
-			thisExpCosSinInt = resolutionModel->ExpCosSinInt( tlo, thi, gamma, dms );
-			thisExpCosSinInt.first *= thisSlice->height(); thisExpCosSinInt.second *= thisSlice->height();
-			returnable_ExpCosSinInt.first += thisExpCosSinInt.first; returnable_ExpCosSinInt.second += thisExpCosSinInt.second;
+			cout << "TimeAccRes:: sigma class " << thisClass << " fails the tolerance of " << resolutionClassTolerance << ", using the exact integral" << endl;
 		}
 	}
 
-	return returnable_ExpCosSinInt;
-}
+	thisTable.push_back( newEntry );
 
-pair<double,double> TimeAccRes::ExpCosSin( double time, double gamma, double dms )
-{
-	pair<double,double> thisPair = resolutionModel->ExpCosSin( time, gamma, dms );
-	thisPair.first *= timeAcc->getValue( time ); thisPair.second *= timeAcc->getValue( time );
-	return thisPair;
+	if( newEntry.usable ) return newEntry.value;
+	else return this->SlicedIntegral( type, tlow, thigh, gamma, dms );
 }
-
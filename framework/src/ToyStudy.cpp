@@ -9,21 +9,27 @@
 
 //	ROOT Headers
 #include "TString.h"
+#include "TRandom3.h"
 //	RapidFit Headers
 #include "ToyStudy.h"
 #include "FitAssembler.h"
 #include "I_XMLConfigReader.h"
 #include "StringProcessing.h"
 #include "ResultFormatter.h"
+#include "RapidFitRandom.h"
+#include "StudyWorkers.h"
+#include "Threading.h"
 //	System Headers
 #include <iostream>
+#include <pthread.h>
+#include <time.h>
 
 using namespace::std;
 
 //Constructor with correct arguments
 ToyStudy::ToyStudy( MinimiserConfiguration * TheMinimiser, FitFunctionConfiguration * TheFunction, ParameterSet* StudyParameters,
 		vector< PDFWithData* > PDFsAndData, vector< ConstraintFunction* > InputConstraints, int NumberStudies ) :
-		IStudy(), fixedNumToys(false), saveAllToys(false)
+		IStudy(), fixedNumToys(false), saveAllToys(false), numberWorkers(1)
 {
 	pdfsAndData = PDFsAndData;
 	studyParameters = StudyParameters;
@@ -61,6 +67,11 @@ void ToyStudy::setSaveAllToys()
 	saveAllToys = true;
 }
 
+void ToyStudy::SetNumberWorkers( unsigned int Input )
+{
+	numberWorkers = Input;
+}
+
 //Automate the toy study
 void ToyStudy::DoWholeStudy( int OutputLevel )
 {
@@ -81,6 +92,19 @@ void ToyStudy::DoWholeStudy( int OutputLevel )
 		pdfsAndData[i]->SetUseCache( false );
 	}
 
+	if( numberWorkers > 1 )
+	{
+		if( theMinimiser->GetMinimiserName() == "Minuit" )
+		{
+			cerr << "ToyStudy: TMinuit can only be used by one fit at a time, performing the study serially" << endl;
+		}
+		else
+		{
+			this->DoParallelStudy( OutputLevel );
+			return;
+		}
+	}
+
 	TString filename="filename_";
 
 	//Loop over all studies
@@ -123,6 +147,202 @@ void ToyStudy::DoWholeStudy( int OutputLevel )
 	}
 }
 
+//	State shared between all of the workers
+struct ToyStudy::ToyQueue
+{
+	pthread_mutex_t lock;			/*!	Protects everything below and any output to ROOT files		*/
+	int nextToy;				/*!	Number of the next toy to be started				*/
+	int numberStudies;			/*!	Number of toys to perform, increases when a fit falls over	*/
+	bool fixedNumToys;
+	bool saveAllToys;
+	int OutputLevel;
+	ParameterSet* studyParameters;
+	vector<FitResult*> results;		/*!	Results stored by toy number					*/
+	vector<double> realTimes;
+	vector<double> cpuTimes;
+};
+
+//	Everything owned by a single worker
+struct ToyStudy::ToyWorker
+{
+	ToyQueue* queue;
+	unsigned int workerNumber;
+	MinimiserConfiguration* theMinimiser;
+	FitFunctionConfiguration* theFunction;
+	vector<PDFWithData*> pdfsAndData;
+	vector<ConstraintFunction*> allConstraints;
+	TRandom3* frameworkRandom;		/*!	Used for the unique IDs of the objects made in this worker	*/
+};
+
+void* ToyStudy::ToyWorkerLoop( void* input )
+{
+	ToyWorker* worker = (ToyWorker*) input;
+	ToyQueue* queue = worker->queue;
+
+	RapidFitRandom::SetThreadFrameworkRandomFunction( worker->frameworkRandom );
+
+	TString filename="filename_";
+
+	while( true )
+	{
+		pthread_mutex_lock( &(queue->lock) );
+		if( queue->nextToy >= queue->numberStudies )
+		{
+			pthread_mutex_unlock( &(queue->lock) );
+			break;
+		}
+		const int studyIndex = queue->nextToy;
+		++(queue->nextToy);
+		cout << "\n\n\t\tStarting ToyStudy\t\t" << studyIndex+1 << "\tof:\t" << queue->numberStudies << "\ton worker:\t" << worker->workerNumber << endl;
+		pthread_mutex_unlock( &(queue->lock) );
+
+		//	Each toy is generated from its own stream so it doesn't matter which worker performs it
+		RapidFitRandomStream* toyRandom = RapidFitRandom::MakeRandomStream( (uint64_t) studyIndex );
+		RapidFitRandom::SetThreadRandomFunction( toyRandom );
+
+		timespec realStart, realStop, cpuStart, cpuStop;
+		clock_gettime( CLOCK_MONOTONIC, &realStart );
+		clock_gettime( CLOCK_THREAD_CPUTIME_ID, &cpuStart );
+
+		ParameterSet* thisSet = new ParameterSet( *(queue->studyParameters) );
+
+		FitResult* new_result = FitAssembler::DoSafeFit( worker->theMinimiser, worker->theFunction, thisSet, worker->pdfsAndData, worker->allConstraints, false, queue->OutputLevel );
+
+		delete thisSet;
+
+		clock_gettime( CLOCK_MONOTONIC, &realStop );
+		clock_gettime( CLOCK_THREAD_CPUTIME_ID, &cpuStop );
+
+		RapidFitRandom::SetThreadRandomFunction( NULL );
+		delete toyRandom;
+
+		TString this_filename = filename;
+		this_filename.Append("_S");
+		this_filename+=studyIndex;
+
+		for( unsigned int i=0; i< worker->pdfsAndData.size(); ++i )
+		{
+			TString this_filename2=this_filename;
+			this_filename2.Append("_D");
+			this_filename2+=i;
+			this_filename2.Append(".root");
+			if( queue->saveAllToys )
+			{
+				//	Save the DataSet which was fitted rather than generating another
+				//	Writing the file goes through gDirectory, the same as the ROOT and Foam I/O of the other workers
+				worker->pdfsAndData[i]->SetUseCache( true );
+				pthread_mutex_lock( Threading::RootIOLock() );
+				ResultFormatter::MakeRootDataFile( this_filename2.Data(), vector<IDataSet*>(1, worker->pdfsAndData[i]->GetDataSet()) );
+				pthread_mutex_unlock( Threading::RootIOLock() );
+				worker->pdfsAndData[i]->SetUseCache( false );
+			}
+			worker->pdfsAndData[i]->ClearCache();
+		}
+
+		pthread_mutex_lock( &(queue->lock) );
+
+		if( new_result->GetFitStatus() != 3 )
+		{
+			cerr << "Fit fell over!\t Requesting another fit." << endl;
+			if( !queue->fixedNumToys ) ++(queue->numberStudies);
+		}
+
+		if( queue->results.size() <= (unsigned) studyIndex )
+		{
+			queue->results.resize( (unsigned) studyIndex+1, NULL );
+			queue->realTimes.resize( (unsigned) studyIndex+1, 0. );
+			queue->cpuTimes.resize( (unsigned) studyIndex+1, 0. );
+		}
+		queue->results[(unsigned)studyIndex] = new_result;
+		queue->realTimes[(unsigned)studyIndex] = StudyWorkers::ElapsedTime( realStart, realStop );
+		queue->cpuTimes[(unsigned)studyIndex] = StudyWorkers::ElapsedTime( cpuStart, cpuStop );
+
+		pthread_mutex_unlock( &(queue->lock) );
+	}
+
+	RapidFitRandom::SetThreadFrameworkRandomFunction( NULL );
+
+	return NULL;
+}
+
+void ToyStudy::DoParallelStudy( int OutputLevel )
+{
+	cout << "ToyStudy: Performing " << numberStudies << " toys with " << numberWorkers << " workers, each using a single thread per fit" << endl;
+
+	ToyQueue queue;
+	pthread_mutex_init( &(queue.lock), NULL );
+	queue.nextToy = 0;
+	queue.numberStudies = numberStudies;
+	queue.fixedNumToys = fixedNumToys;
+	queue.saveAllToys = saveAllToys;
+	queue.OutputLevel = OutputLevel;
+	queue.studyParameters = studyParameters;
+
+	//	Fix the seed of the toy streams before any worker asks for one
+	RapidFitRandom::GetStreamSeed();
+
+	const bool addDirectory = StudyWorkers::DetachHistograms();
+
+	vector<ToyWorker*> workers;
+	for( unsigned int workerNum=0; workerNum< numberWorkers; ++workerNum )
+	{
+		ToyWorker* thisWorker = new ToyWorker();
+		thisWorker->queue = &queue;
+		thisWorker->workerNumber = workerNum;
+		thisWorker->theMinimiser = new MinimiserConfiguration( *theMinimiser );
+		thisWorker->theFunction = new FitFunctionConfiguration( *theFunction );
+		thisWorker->theFunction->SetThreads( 1 );
+		for( unsigned int i=0; i< pdfsAndData.size(); ++i )
+		{
+			thisWorker->pdfsAndData.push_back( new PDFWithData( *pdfsAndData[i] ) );
+			thisWorker->pdfsAndData.back()->SetUseCache( false );
+		}
+		for( unsigned int i=0; i< allConstraints.size(); ++i )
+		{
+			thisWorker->allConstraints.push_back( new ConstraintFunction( *allConstraints[i] ) );
+		}
+		thisWorker->frameworkRandom = StudyWorkers::MakeFrameworkRandom();
+		workers.push_back( thisWorker );
+	}
+
+	StudyWorkers::RunWorkers( ToyStudy::ToyWorkerLoop, (void**) &(workers[0]), numberWorkers );
+
+	StudyWorkers::RestoreHistograms( addDirectory );
+
+	for( unsigned int studyIndex=0; studyIndex< queue.results.size(); ++studyIndex )
+	{
+		allResults->AddFitResult( queue.results[studyIndex], false );
+		allResults->AddRealTime( queue.realTimes[studyIndex] );
+		allResults->AddCPUTime( queue.cpuTimes[studyIndex] );
+		#ifdef RAPIDFIT_USETGLTIMER
+		allResults->AddGLTime( queue.realTimes[studyIndex] );
+		#endif
+	}
+	numberStudies = queue.numberStudies;
+
+	while( !workers.empty() )
+	{
+		ToyWorker* thisWorker = workers.back();
+		while( !thisWorker->pdfsAndData.empty() )
+		{
+			delete thisWorker->pdfsAndData.back();
+			thisWorker->pdfsAndData.pop_back();
+		}
+		while( !thisWorker->allConstraints.empty() )
+		{
+			delete thisWorker->allConstraints.back();
+			thisWorker->allConstraints.pop_back();
+		}
+		delete thisWorker->theMinimiser;
+		delete thisWorker->theFunction;
+		delete thisWorker->frameworkRandom;
+		delete thisWorker;
+		workers.pop_back();
+	}
+
+	pthread_mutex_destroy( &(queue.lock) );
+}
+
 //Get the result of the toy study
 FitResultVector* ToyStudy::GetStudyResult()
 {
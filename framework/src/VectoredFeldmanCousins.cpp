@@ -1,18 +1,35 @@
 
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TString.h"
 #include "VectoredFeldmanCousins.h"
 #include "ClassLookUp.h"
 #include "FitAssembler.h"
 #include "ParameterSet.h"
+#include "PhysicsBottle.h"
 #include "RapidFitRandom.h"
+#include "ResultFormatter.h"
+#include "StudyWorkers.h"
+#include "Threading.h"
 #include <string>
+#include <sstream>
 #include <iomanip>
+#include <cmath>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
 
 using namespace::std;
 
 VectoredFeldmanCousins::VectoredFeldmanCousins( FitResultVector* input_GlobalResult, FitResultVector* ResultsForFC, unsigned int inputNuisenceModel, OutputConfiguration* new_makeOutput, MinimiserConfiguration* newMinimiser, FitFunctionConfiguration* newFunction, I_XMLConfigReader* new_xmlFile, vector< PDFWithData* > new_pdfsAndData ) : 
 	GlobalFitResult(), GlobalFitPhysicsParameters(), FitAtGridPoints(), cout_bak(NULL), cerr_bak(NULL), clog_bak(NULL), allPhaseSpaces(),
 	input_pdfsAndData(), controlled_parameters(), nuisenceModel(0), stored_pdfs(), stored_dataconfigs(), sWeighted_study(), sweight_error(), generate_n_events(0),
-	ParameterSetWithFreeParameters(), ParameterSetWithFixedParameters()
+	ParameterSetWithFreeParameters(), ParameterSetWithFixedParameters(), numberWorkers(1)
 {
 	cout_bak = cout.rdbuf();
 	cerr_bak = cerr.rdbuf();
@@ -153,15 +170,9 @@ void VectoredFeldmanCousins::InitalizeNewPDFWithData()
 //	Initialize ParameterSetWithFreeParameters and ParameterSetWithFixedParameters as copies of the input dataset
 void VectoredFeldmanCousins::InitializePhysicsParameters( ParameterSet* inputParameters )
 {
-	ParameterSet* temp_freeParam = new ParameterSet( *inputParameters );
-	ParameterSet* temp_fixedParam = new ParameterSet( *inputParameters );
-
-	vector<string>::iterator fixed_param_i = controlled_parameters.begin();
-	for( ; fixed_param_i != controlled_parameters.end(); ++fixed_param_i )
-	{
-		temp_fixedParam->GetPhysicsParameter( *fixed_param_i )->SetType( "Fixed" );
-		temp_freeParam->GetPhysicsParameter( *fixed_param_i )->SetType( "Free" );//Just to be explicit, even though this is expected to not be needed
-	}
+	ParameterSet* temp_freeParam = NULL;
+	ParameterSet* temp_fixedParam = NULL;
+	this->MakeGridPointParameters( inputParameters, temp_freeParam, temp_fixedParam );
 
 	if( ParameterSetWithFreeParameters != NULL ) delete ParameterSetWithFreeParameters;
 	ParameterSetWithFreeParameters = temp_freeParam;
@@ -169,21 +180,39 @@ void VectoredFeldmanCousins::InitializePhysicsParameters( ParameterSet* inputPar
 	ParameterSetWithFixedParameters = temp_fixedParam;
 }
 
+void VectoredFeldmanCousins::MakeGridPointParameters( ParameterSet* inputParameters, ParameterSet*& freeParameters, ParameterSet*& fixedParameters ) const
+{
+	freeParameters = new ParameterSet( *inputParameters );
+	fixedParameters = new ParameterSet( *inputParameters );
+
+	vector<string>::const_iterator fixed_param_i = controlled_parameters.begin();
+	for( ; fixed_param_i != controlled_parameters.end(); ++fixed_param_i )
+	{
+		fixedParameters->GetPhysicsParameter( *fixed_param_i )->SetType( "Fixed" );
+		freeParameters->GetPhysicsParameter( *fixed_param_i )->SetType( "Free" );//Just to be explicit, even though this is expected to not be needed
+	}
+}
+
 vector<IDataSet*> VectoredFeldmanCousins::GetNewDataSets( ParameterSet* input_params )
+{
+	return this->GetNewDataSets( input_params, pdfsAndData );
+}
+
+vector<IDataSet*> VectoredFeldmanCousins::GetNewDataSets( ParameterSet* input_params, vector<PDFWithData*> thesePDFsAndData )
 {
 	vector<IDataSet*> output_datasets;
 
 	vector<double>::iterator sWeight_errors = sweight_error.begin();
 	vector<double>::iterator wanted_events = generate_n_events.begin();
-	vector<PDFWithData*>::iterator pdfdat_i = pdfsAndData.begin();
+	vector<PDFWithData*>::iterator pdfdat_i = thesePDFsAndData.begin();
 	vector<PhaseSpaceBoundary*>::iterator phaseSpace_i = allPhaseSpaces.begin();
 
-	for( ; pdfdat_i != pdfsAndData.end(); ++pdfdat_i, ++wanted_events, ++phaseSpace_i )
+	for( ; pdfdat_i != thesePDFsAndData.end(); ++pdfdat_i, ++wanted_events, ++phaseSpace_i )
 	{
 		//vector<ParameterSet*> temp_vec( 1, input_params );
 		(*pdfdat_i)->SetPhysicsParameters( input_params );
 
-		TRandom3* new_rand = RapidFitRandom::GetRandomFunction();
+		TRandom* new_rand = RapidFitRandom::GetRandomFunction();
 
 		double num_wanted_events=-1;
 		if( sWeighted_study )
@@ -224,6 +253,19 @@ void VectoredFeldmanCousins::DoWholeStudy( int OutputLevel )
 		pdfsAndData[i]->ClearCache();
 	}
 
+	if( numberWorkers > 1 )
+	{
+		if( theMinimiser->GetMinimiserName() == "Minuit" )
+		{
+			cerr << "VectoredFeldmanCousins: TMinuit can only be used by one fit at a time, performing the study serially" << endl;
+		}
+		else
+		{
+			this->DoParallelStudy( OutputLevel );
+			return;
+		}
+	}
+
 	vector<FitResultVector*> temp_complete_vec;
 
 	for( unsigned int result_i=0; result_i < (unsigned)FitAtGridPoints->NumberResults(); ++result_i )
@@ -407,6 +449,477 @@ void VectoredFeldmanCousins::SetCommandLineParams( vector<string> input )
 	(void) input;
 }
 
+void VectoredFeldmanCousins::SetNumberWorkers( unsigned int Input )
+{
+	numberWorkers = Input;
+}
+
+//	Output of one (grid point, toy) task
+struct VectoredFeldmanCousins::FCTask
+{
+	FitResultVector* fixedResult;		/*!	Fit with the control parameter(s) fixed, NULL if the task failed	*/
+	FitResultVector* freeResult;		/*!	Fit with the control parameter(s) free, NULL if the task failed		*/
+};
+
+//	State shared between all of the workers
+struct VectoredFeldmanCousins::FCQueue
+{
+	pthread_mutex_t lock;			/*!	Protects everything below, ROOT files are written under Threading::RootIOLock()	*/
+	VectoredFeldmanCousins* study;
+	int OutputLevel;
+	vector<unsigned int> numberToys;	/*!	Number of toys to perform at each grid point, increases when a fit fails	*/
+	vector<unsigned int> nextToy;		/*!	Number of the next toy to be started at each grid point			*/
+	vector<ParameterSet*> freeParameters;	/*!	Parameters with the control parameter(s) free at each grid point		*/
+	vector<ParameterSet*> fixedParameters;	/*!	Parameters with the control parameter(s) fixed at each grid point		*/
+	vector<vector<FCTask> > tasks;		/*!	Results stored by grid point and toy number				*/
+	unsigned int tasksDone;
+	unsigned int tasksResumed;		/*!	Tasks read back from the files of an earlier run			*/
+};
+
+//	Everything owned by a single worker
+struct VectoredFeldmanCousins::FCWorker
+{
+	FCQueue* queue;
+	unsigned int workerNumber;
+	MinimiserConfiguration* theMinimiser;
+	FitFunctionConfiguration* theFunction;
+	vector<PDFWithData*> pdfsAndData;
+	vector<ConstraintFunction*> allConstraints;
+	TRandom3* frameworkRandom;		/*!	Used for the unique IDs of the objects made in this worker	*/
+};
+
+namespace
+{
+	//	Store a single fit along with its timing
+	FitResultVector* MakeTaskResult( const vector<string>& names, FitResult* result, const timespec& realStart, const timespec& realStop, const timespec& cpuStart, const timespec& cpuStop )
+	{
+		FitResultVector* output = new FitResultVector( names );
+		output->AddFitResult( result, false );
+		output->AddRealTime( StudyWorkers::ElapsedTime( realStart, realStop ) );
+		output->AddCPUTime( StudyWorkers::ElapsedTime( cpuStart, cpuStop ) );
+		#ifdef RAPIDFIT_USETGLTIMER
+		output->AddGLTime( StudyWorkers::ElapsedTime( realStart, realStop ) );
+		#endif
+		return output;
+	}
+
+	//	File holding the result of a single task
+	string TaskFileName( const unsigned int pointIndex, const unsigned int toyIndex )
+	{
+		stringstream fileName;
+		fileName << "FCTasks/FCTask_P" << pointIndex << "_T" << toyIndex << ".root";
+		return fileName.str();
+	}
+
+	bool TaskFileExists( const string& fileName )
+	{
+		struct stat fileStat;
+		return stat( fileName.c_str(), &fileStat ) == 0;
+	}
+
+	//	Read a single value from a branch written by ResultFormatter::AddBranch, the branches of fixed parameters aren't all written
+	template<class T> T ReadTaskValue( TTree* inputTree, const string& branchName, const Long64_t entry, const T defaultValue )
+	{
+		TBranch* thisBranch = inputTree->GetBranch( branchName.c_str() );
+		if( thisBranch == NULL ) return defaultValue;
+		T thisValue = defaultValue;
+		thisBranch->SetAddress( &thisValue );
+		thisBranch->GetEntry( entry );
+		thisBranch->ResetAddress();
+		return thisValue;
+	}
+}
+
+void* VectoredFeldmanCousins::FCWorkerLoop( void* input )
+{
+	FCWorker* worker = (FCWorker*) input;
+	FCQueue* queue = worker->queue;
+	VectoredFeldmanCousins* study = queue->study;
+
+	RapidFitRandom::SetThreadFrameworkRandomFunction( worker->frameworkRandom );
+
+	while( true )
+	{
+		pthread_mutex_lock( &(queue->lock) );
+		unsigned int pointIndex = 0;
+		while( pointIndex < queue->numberToys.size() && queue->nextToy[pointIndex] >= queue->numberToys[pointIndex] ) ++pointIndex;
+		if( pointIndex == queue->numberToys.size() )
+		{
+			pthread_mutex_unlock( &(queue->lock) );
+			break;
+		}
+		const unsigned int toyIndex = queue->nextToy[pointIndex];
+		++(queue->nextToy[pointIndex]);
+		cout << "Starting FC toy " << toyIndex+1 << " at grid point " << pointIndex+1 << " of: " << queue->numberToys.size() << "\ton worker:\t" << worker->workerNumber << endl;
+		pthread_mutex_unlock( &(queue->lock) );
+
+		//	Only successful tasks are written out, so a task with a file has already been done by an earlier run
+		const string taskFileName = TaskFileName( pointIndex, toyIndex );
+		if( TaskFileExists( taskFileName ) )
+		{
+			FitResultVector* fixedResult = NULL;
+			FitResultVector* freeResult = NULL;
+			pthread_mutex_lock( Threading::RootIOLock() );
+			const bool readOK = study->ReadTaskFile( taskFileName, fixedResult, freeResult );
+			pthread_mutex_unlock( Threading::RootIOLock() );
+
+			if( readOK )
+			{
+				pthread_mutex_lock( &(queue->lock) );
+				cout << "Read FC toy " << toyIndex+1 << " at grid point " << pointIndex+1 << " from: " << taskFileName << endl;
+				if( queue->tasks[pointIndex].size() <= toyIndex )
+				{
+					FCTask emptyTask;
+					emptyTask.fixedResult = NULL;
+					emptyTask.freeResult = NULL;
+					queue->tasks[pointIndex].resize( toyIndex+1, emptyTask );
+				}
+				queue->tasks[pointIndex][toyIndex].fixedResult = fixedResult;
+				queue->tasks[pointIndex][toyIndex].freeResult = freeResult;
+				++(queue->tasksDone);
+				++(queue->tasksResumed);
+				pthread_mutex_unlock( &(queue->lock) );
+				continue;
+			}
+
+			cerr << "VectoredFeldmanCousins: Cannot read " << taskFileName << ", performing this task again" << endl;
+		}
+
+		//	Each task is generated from its own stream so it doesn't matter which worker performs it
+		RapidFitRandomStream* taskRandom = RapidFitRandom::MakeRandomStream( ( (uint64_t) pointIndex << 32 ) | (uint64_t) toyIndex );
+		RapidFitRandom::SetThreadRandomFunction( taskRandom );
+
+		FitResult* InputResult = study->FitAtGridPoints->GetFitResult( (int)pointIndex );
+
+		ParameterSet* FittingParameterSetWithFreeParameters = study->getParameterSet( queue->freeParameters[pointIndex], InputResult->GetResultParameterSet() );
+		ParameterSet* FittingParameterSetWithFixedParameters = study->getParameterSet( queue->fixedParameters[pointIndex], InputResult->GetResultParameterSet() );
+
+		vector<IDataSet*> dataset_p = study->GetNewDataSets( FittingParameterSetWithFreeParameters, worker->pdfsAndData );
+		for( unsigned int i=0; i< worker->pdfsAndData.size(); ++i )
+		{
+			worker->pdfsAndData[i]->AddCachedData( dataset_p[i] );
+			worker->pdfsAndData[i]->SetUseCache( true );
+		}
+
+		timespec realStart, realStop, cpuStart, cpuStop;
+		clock_gettime( CLOCK_MONOTONIC, &realStart );
+		clock_gettime( CLOCK_THREAD_CPUTIME_ID, &cpuStart );
+
+		FitResult* fit1Result = FitAssembler::DoSafeFit( worker->theMinimiser, worker->theFunction, FittingParameterSetWithFixedParameters, worker->pdfsAndData, worker->allConstraints, true, queue->OutputLevel );
+		for( vector<string>::iterator param_i = study->controlled_parameters.begin(); param_i != study->controlled_parameters.end(); ++param_i )
+		{
+			fit1Result->GetResultParameterSet()->GetResultParameter( *param_i )->ForceType( "Fixed" );
+		}
+
+		clock_gettime( CLOCK_MONOTONIC, &realStop );
+		clock_gettime( CLOCK_THREAD_CPUTIME_ID, &cpuStop );
+
+		FitResultVector* fixedResult = MakeTaskResult( study->GlobalFitResult->GetAllNames(), fit1Result, realStart, realStop, cpuStart, cpuStop );
+		FitResult* fit2Result = NULL;
+		FitResultVector* freeResult = NULL;
+
+		//	Don't re-fit to a dataset if the first fit failed
+		if( fit1Result->GetFitStatus() == 3 )
+		{
+			clock_gettime( CLOCK_MONOTONIC, &realStart );
+			clock_gettime( CLOCK_THREAD_CPUTIME_ID, &cpuStart );
+
+			fit2Result = FitAssembler::DoSafeFit( worker->theMinimiser, worker->theFunction, FittingParameterSetWithFreeParameters, worker->pdfsAndData, worker->allConstraints, true, queue->OutputLevel );
+			for( vector<string>::iterator param_i = study->controlled_parameters.begin(); param_i != study->controlled_parameters.end(); ++param_i )
+			{
+				fit2Result->GetResultParameterSet()->GetResultParameter( *param_i )->ForceType( "Free" );
+			}
+
+			clock_gettime( CLOCK_MONOTONIC, &realStop );
+			clock_gettime( CLOCK_THREAD_CPUTIME_ID, &cpuStop );
+
+			freeResult = MakeTaskResult( study->GlobalFitResult->GetAllNames(), fit2Result, realStart, realStop, cpuStart, cpuStop );
+		}
+
+		for( unsigned int i=0; i< worker->pdfsAndData.size(); ++i )
+		{
+			worker->pdfsAndData[i]->ClearCache();
+		}
+
+		delete FittingParameterSetWithFreeParameters;
+		delete FittingParameterSetWithFixedParameters;
+
+		RapidFitRandom::SetThreadRandomFunction( NULL );
+		delete taskRandom;
+
+		const bool taskOK = ( fit2Result != NULL ) && ( fit2Result->GetFitStatus() == 3 );
+
+		//	Write this task out straight away so that an interrupted study can be resumed
+		if( taskOK )
+		{
+			pthread_mutex_lock( Threading::RootIOLock() );
+			study->WriteTaskFile( taskFileName, pointIndex, fixedResult, freeResult );
+			pthread_mutex_unlock( Threading::RootIOLock() );
+		}
+
+		pthread_mutex_lock( &(queue->lock) );
+
+		if( queue->tasks[pointIndex].size() <= toyIndex )
+		{
+			FCTask emptyTask;
+			emptyTask.fixedResult = NULL;
+			emptyTask.freeResult = NULL;
+			queue->tasks[pointIndex].resize( toyIndex+1, emptyTask );
+		}
+
+		if( !taskOK )
+		{
+			cout << "Fit FAILED at grid point " << pointIndex+1 << " for toy " << toyIndex+1 << ", requesting additional toy dataset" << endl;
+			++(queue->numberToys[pointIndex]);
+			delete fit1Result; delete fixedResult;
+			if( fit2Result != NULL ) { delete fit2Result; delete freeResult; }
+		}
+		else
+		{
+			queue->tasks[pointIndex][toyIndex].fixedResult = fixedResult;
+			queue->tasks[pointIndex][toyIndex].freeResult = freeResult;
+		}
+		++(queue->tasksDone);
+
+		pthread_mutex_unlock( &(queue->lock) );
+	}
+
+	RapidFitRandom::SetThreadFrameworkRandomFunction( NULL );
+
+	return NULL;
+}
+
+void VectoredFeldmanCousins::DoParallelStudy( int OutputLevel )
+{
+	const unsigned int numberPoints = (unsigned) FitAtGridPoints->NumberResults();
+	cout << "VectoredFeldmanCousins: Performing " << numberStudies << " toys at each of " << numberPoints << " grid points with " << numberWorkers << " workers, each using a single thread per fit" << endl;
+
+	FCQueue queue;
+	pthread_mutex_init( &(queue.lock), NULL );
+	queue.study = this;
+	queue.OutputLevel = OutputLevel;
+	queue.numberToys = vector<unsigned int>( numberPoints, (unsigned) numberStudies );
+	queue.nextToy = vector<unsigned int>( numberPoints, 0 );
+	queue.tasks = vector<vector<FCTask> >( numberPoints );
+	queue.tasksDone = 0;
+	queue.tasksResumed = 0;
+	for( unsigned int pointIndex=0; pointIndex< numberPoints; ++pointIndex )
+	{
+		ParameterSet* gridPointSet = FitAtGridPoints->GetFitResult( (int)pointIndex )->GetResultParameterSet()->GetDummyParameterSet();
+		ParameterSet* freeSet = NULL;
+		ParameterSet* fixedSet = NULL;
+		this->MakeGridPointParameters( gridPointSet, freeSet, fixedSet );
+		queue.freeParameters.push_back( freeSet );
+		queue.fixedParameters.push_back( fixedSet );
+		delete gridPointSet;
+	}
+
+	if( mkdir( "FCTasks", 0755 ) != 0 && errno != EEXIST )
+	{
+		cerr << "VectoredFeldmanCousins: Cannot create the directory FCTasks for the output of each task" << endl;
+		exit(-1);
+	}
+
+	//	Fix the seed of the task streams before any worker asks for one
+	RapidFitRandom::GetStreamSeed();
+
+	const bool addDirectory = StudyWorkers::DetachHistograms();
+
+	vector<FCWorker*> workers;
+	for( unsigned int workerNum=0; workerNum< numberWorkers; ++workerNum )
+	{
+		FCWorker* thisWorker = new FCWorker();
+		thisWorker->queue = &queue;
+		thisWorker->workerNumber = workerNum;
+		thisWorker->theMinimiser = new MinimiserConfiguration( *theMinimiser );
+		thisWorker->theFunction = new FitFunctionConfiguration( *theFunction );
+		thisWorker->theFunction->SetThreads( 1 );
+		for( unsigned int i=0; i< pdfsAndData.size(); ++i )
+		{
+			thisWorker->pdfsAndData.push_back( new PDFWithData( *pdfsAndData[i] ) );
+			thisWorker->pdfsAndData.back()->SetUseCache( false );
+		}
+		for( unsigned int i=0; i< allConstraints.size(); ++i )
+		{
+			thisWorker->allConstraints.push_back( new ConstraintFunction( *allConstraints[i] ) );
+		}
+		thisWorker->frameworkRandom = StudyWorkers::MakeFrameworkRandom();
+		workers.push_back( thisWorker );
+	}
+
+	StudyWorkers::RunWorkers( VectoredFeldmanCousins::FCWorkerLoop, (void**) &(workers[0]), numberWorkers );
+
+	StudyWorkers::RestoreHistograms( addDirectory );
+
+	cout << endl << "Finalizing all FC Results from " << queue.tasksDone << " tasks, " << queue.tasksResumed << " of which were read from FCTasks" << endl;
+
+	this->MergeTaskResults( queue );
+
+	while( !workers.empty() )
+	{
+		FCWorker* thisWorker = workers.back();
+		while( !thisWorker->pdfsAndData.empty() )
+		{
+			delete thisWorker->pdfsAndData.back();
+			thisWorker->pdfsAndData.pop_back();
+		}
+		while( !thisWorker->allConstraints.empty() )
+		{
+			delete thisWorker->allConstraints.back();
+			thisWorker->allConstraints.pop_back();
+		}
+		delete thisWorker->theMinimiser;
+		delete thisWorker->theFunction;
+		delete thisWorker->frameworkRandom;
+		delete thisWorker;
+		workers.pop_back();
+	}
+
+	for( unsigned int pointIndex=0; pointIndex< numberPoints; ++pointIndex )
+	{
+		delete queue.freeParameters[pointIndex];
+		delete queue.fixedParameters[pointIndex];
+	}
+
+	pthread_mutex_destroy( &(queue.lock) );
+}
+
+void VectoredFeldmanCousins::MergeTaskResults( const FCQueue& queue )
+{
+	const unsigned int numberPoints = (unsigned) queue.tasks.size();
+
+	//	Merge the tasks in the same order as the serial study
+	vector<FitResultVector*> temp_complete_vec;
+	for( unsigned int pointIndex=0; pointIndex< numberPoints; ++pointIndex )
+	{
+		vector<FitResultVector*> grid_pointResultVector;
+
+		grid_pointResultVector.push_back( GlobalFitResult );
+		FitResultVector* temp_gridpoint = new FitResultVector( GlobalFitResult->GetAllNames() );
+		temp_gridpoint->AddFitResult( FitAtGridPoints->GetFitResult( (int)pointIndex ), false );
+		temp_gridpoint->AddCPUTime( FitAtGridPoints->GetCPUTime( (int)pointIndex ) );
+		temp_gridpoint->AddRealTime( FitAtGridPoints->GetRealTime( (int)pointIndex ) );
+		temp_gridpoint->AddGLTime( FitAtGridPoints->GetGLTime( (int)pointIndex ) );
+		grid_pointResultVector.push_back( temp_gridpoint );
+
+		for( unsigned int toyIndex=0; toyIndex< queue.tasks[pointIndex].size(); ++toyIndex )
+		{
+			FCTask thisTask = queue.tasks[pointIndex][toyIndex];
+			if( thisTask.fixedResult == NULL || thisTask.freeResult == NULL ) continue;
+			grid_pointResultVector.push_back( GlobalFitResult );
+			grid_pointResultVector.push_back( thisTask.fixedResult );
+			grid_pointResultVector.push_back( GlobalFitResult );
+			grid_pointResultVector.push_back( thisTask.freeResult );
+		}
+
+		temp_complete_vec.push_back( new FitResultVector( grid_pointResultVector ) );
+	}
+	allResults = new FitResultVector( temp_complete_vec );
+}
+
+void VectoredFeldmanCousins::WriteTaskFile( const string& fileName, const unsigned int pointIndex, FitResultVector* fixedResult, FitResultVector* freeResult ) const
+{
+	//	Laid out as a single toy at a single grid point, the same as the output of a batch job
+	FitResultVector* gridPointResult = new FitResultVector( GlobalFitResult->GetAllNames() );
+	gridPointResult->AddFitResult( FitAtGridPoints->GetFitResult( (int)pointIndex ), false );
+	gridPointResult->AddCPUTime( FitAtGridPoints->GetCPUTime( (int)pointIndex ) );
+	gridPointResult->AddRealTime( FitAtGridPoints->GetRealTime( (int)pointIndex ) );
+	gridPointResult->AddGLTime( FitAtGridPoints->GetGLTime( (int)pointIndex ) );
+
+	vector<FitResultVector*> taskOutput;
+	taskOutput.push_back( GlobalFitResult );
+	taskOutput.push_back( gridPointResult );
+	taskOutput.push_back( GlobalFitResult );
+	taskOutput.push_back( fixedResult );
+	taskOutput.push_back( GlobalFitResult );
+	taskOutput.push_back( freeResult );
+	FitResultVector* taskResult = new FitResultVector( taskOutput );
+
+	//	Write to a temporary file first so that an interrupted write never looks like a finished task
+	stringstream tempName;
+	tempName << fileName << ".tmp" << getpid();
+	ResultFormatter::WriteFlatNtuple( tempName.str(), taskResult, xmlConfig->GetXML() );
+	if( rename( tempName.str().c_str(), fileName.c_str() ) != 0 )
+	{
+		cerr << "VectoredFeldmanCousins: Cannot write " << fileName << endl;
+		remove( tempName.str().c_str() );
+	}
+
+	delete taskResult;
+	delete gridPointResult;
+}
+
+bool VectoredFeldmanCousins::ReadTaskFile( const string& fileName, FitResultVector*& fixedResult, FitResultVector*& freeResult ) const
+{
+	TFile* inputFile = new TFile( fileName.c_str(), "READ" );
+	if( inputFile->IsZombie() )
+	{
+		delete inputFile;
+		return false;
+	}
+
+	//	Entries 3 and 5 are the fits with the control parameter(s) fixed and free, see WriteTaskFile
+	TTree* inputTree = (TTree*) inputFile->Get( "RapidFitResult" );
+	const bool readOK = ( inputTree != NULL ) && ( inputTree->GetEntries() == 6 );
+	if( readOK )
+	{
+		fixedResult = this->ReadTaskResult( inputTree, 3 );
+		freeResult = this->ReadTaskResult( inputTree, 5 );
+	}
+
+	inputFile->Close();
+	delete inputFile;
+
+	return readOK;
+}
+
+FitResultVector* VectoredFeldmanCousins::ReadTaskResult( TTree* inputTree, const Long64_t entry ) const
+{
+	//	The types and units aren't stored in the file, take them from the global fit
+	const vector<string> allNames = GlobalFitResult->GetAllNames();
+	ResultParameterSet* globalSet = GlobalFitResult->GetFitResult( 0 )->GetResultParameterSet();
+	ResultParameterSet* resultSet = new ResultParameterSet( allNames );
+
+	for( vector<string>::const_iterator name_i = allNames.begin(); name_i != allNames.end(); ++name_i )
+	{
+		const double value = ReadTaskValue( inputTree, *name_i+"_value", entry, 0. );
+		const double error = ReadTaskValue( inputTree, *name_i+"_error", entry, 0. );
+		const double originalValue = ReadTaskValue( inputTree, *name_i+"_gen", entry, value );
+		const double minimum = ReadTaskValue( inputTree, *name_i+"_min", entry, 0. );
+		const double maximum = ReadTaskValue( inputTree, *name_i+"_max", entry, 0. );
+		const double errorHigh = ReadTaskValue( inputTree, *name_i+"_errHi", entry, 0. );
+		const double errorLow = ReadTaskValue( inputTree, *name_i+"_errLo", entry, 0. );
+		const int fixed = ReadTaskValue( inputTree, *name_i+"_fix", entry, 0 );
+		const int scanned = ReadTaskValue( inputTree, *name_i+"_scan", entry, 0 );
+
+		ResultParameter* globalParam = globalSet->GetResultParameter( *name_i );
+		string type = globalParam->GetType();
+		if( fixed == 1 ) type = "Fixed";
+		else if( type == "Fixed" ) type = "Free";
+
+		resultSet->SetResultParameter( *name_i, value, originalValue, error, minimum, maximum, type, globalParam->GetUnit() );
+		ResultParameter* thisParam = resultSet->GetResultParameter( *name_i );
+		if( fabs( errorHigh ) > 0. || fabs( errorLow ) > 0. ) thisParam->SetAssymErrors( errorHigh, errorLow, error );
+		thisParam->SetScanStatus( scanned == 1 );
+	}
+
+	ParameterSet* resultParameters = resultSet->GetDummyParameterSet();
+	PhysicsBottle* resultBottle = new PhysicsBottle( resultParameters );
+	FitResult* thisResult = new FitResult( ReadTaskValue( inputTree, "NLL", entry, 0. ), resultSet, ReadTaskValue( inputTree, "Fit_Status", entry, -1 ), resultBottle );
+	delete resultBottle;
+	delete resultParameters;
+	delete resultSet;
+
+	FitResultVector* output = new FitResultVector( allNames );
+	output->AddFitResult( thisResult, false );
+	output->AddRealTime( ReadTaskValue( inputTree, "Fit_RealTime", entry, 0. ) );
+	output->AddCPUTime( ReadTaskValue( inputTree, "Fit_CPUTime", entry, 0. ) );
+	#ifdef RAPIDFIT_USETGLTIMER
+	output->AddGLTime( ReadTaskValue( inputTree, "Fit_GLTime", entry, 0. ) );
+	#endif
+	return output;
+}
+
 ParameterSet* VectoredFeldmanCousins::getParameterSet( ParameterSet* inputSet, ResultParameterSet* inputResult )
 {
 	// Model 1 nuisence parameters are not changed
@@ -425,7 +938,7 @@ ParameterSet* VectoredFeldmanCousins::getParameterSet( ParameterSet* inputSet, R
 			ResultParameter* thisResult = inputResult->GetResultParameter( *param_i );
 			if( thisParameter->GetType() != "Fixed" && !thisResult->GetScanStatus() )
 			{
-				TRandom3* rand_gen = RapidFitRandom::GetRandomFunction();
+				TRandom* rand_gen = RapidFitRandom::GetRandomFunction();
 				double new_value = rand_gen->Gaus( thisResult->GetValue(), thisResult->GetError() );
 				thisParameter->SetBlindedValue( new_value );
 				thisParameter->SetStepSize( thisResult->GetError() );
@@ -369,6 +369,7 @@ FitFunctionConfiguration * XMLObjectGenerator::MakeFitFunction( XMLTag * Functio
 		string Trace_FileName;
 		string Strategy;
 		int Threads = -1;
+		int ChunkSize = 0;
 		bool integratorTest = true;
 		bool NormaliseWeights = false;
 		bool SingleNormaliseWeights = false;
@@ -422,6 +423,10 @@ FitFunctionConfiguration * XMLObjectGenerator::MakeFitFunction( XMLTag * Functio
 				{
 					Threads = XMLTag::GetIntegerValue( functionInfo[childIndex] );
 				}
+				else if ( functionInfo[childIndex]->GetName() == "ChunkSize" )
+				{
+					ChunkSize = XMLTag::GetIntegerValue( functionInfo[childIndex] );
+				}
 				else if ( functionInfo[childIndex]->GetName() == "SetIntegratorTest" )
 				{
 					integratorTest = XMLTag::GetBooleanValue( functionInfo[childIndex] );
@@ -481,6 +486,7 @@ FitFunctionConfiguration * XMLObjectGenerator::MakeFitFunction( XMLTag * Functio
 
 		if( !RapidRun::isGridified() ) returnable_function->SetThreads( Threads );
 		else returnable_function->SetThreads( 1 );
+		if( ChunkSize > 0 ) returnable_function->SetChunkSize( (unsigned)ChunkSize );
 		returnable_function->SetNormaliseWeights( NormaliseWeights );
 		returnable_function->SetSingleNormaliseWeights( SingleNormaliseWeights );
 		returnable_function->SetIntegratorTest( integratorTest );
@@ -498,6 +504,18 @@ FitFunctionConfiguration * XMLObjectGenerator::MakeFitFunction( XMLTag * Functio
 	}
 }
 
+//Number of parameter points to keep the Normalisation for, 0 is off
+unsigned int XMLObjectGenerator::GetNormalisationCacheSize( XMLTag* InputTag )
+{
+	int normalisationCacheSize = XMLTag::GetIntegerValue( InputTag );
+	if( normalisationCacheSize < 0 )
+	{
+		cerr << "NormalisationCache must be >= 0, not " << normalisationCacheSize << endl;
+		exit(-5624);
+	}
+	return (unsigned) normalisationCacheSize;
+}
+
 //Create a PDF from an appropriate xml tag
 IPDF * XMLObjectGenerator::GetNamedPDF( XMLTag * InputTag, PhaseSpaceBoundary* InputBoundary, XMLTag* overloadConfigurator, ParameterSet* thisParameterSet, bool print )
 {
@@ -529,6 +547,7 @@ IPDF * XMLObjectGenerator::GetNamedPDF( XMLTag * InputTag, PhaseSpaceBoundary* I
 	unsigned int appendParamNum=0;
 	unsigned int configParamNum=0;
 	unsigned int subParamNum=0;
+	unsigned int normalisationCacheSize=0;
 
 	//Load the PDF configuration
 	for ( unsigned int configIndex = 0; configIndex < pdfConfig.size(); ++configIndex )
@@ -588,6 +607,10 @@ IPDF * XMLObjectGenerator::GetNamedPDF( XMLTag * InputTag, PhaseSpaceBoundary* I
 			configurator->AddFractionName( XMLTag::GetStringValue( pdfConfig[configIndex] ) );
 			++configParamNum;
 		}
+		else if ( pdfConfig[configIndex]->GetName() == "NormalisationCache" )
+		{
+			normalisationCacheSize = XMLObjectGenerator::GetNormalisationCacheSize( pdfConfig[configIndex] );
+		}
 		else if( pdfConfig[configIndex]->GetName() == "PDF" || pdfConfig[configIndex]->GetName() == "SumPDF" || pdfConfig[configIndex]->GetName() == "NormalisedSumPDF" || pdfConfig[configIndex]->GetName() == "ProdPDF" )
 		{
 			IPDF* thisPDF = XMLObjectGenerator::GetPDF( pdfConfig[configIndex], InputBoundary, overloadConfigurator, thisParameterSet, false );
@@ -642,6 +665,10 @@ IPDF * XMLObjectGenerator::GetNamedPDF( XMLTag * InputTag, PhaseSpaceBoundary* I
 		{
 			configurator->SetPDFLabel( XMLTag::GetStringValue( pdfConfig[configIndex] ) );
 		}
+		else if ( pdfConfig[configIndex]->GetName() == "NormalisationCache" )
+		{
+			normalisationCacheSize = XMLObjectGenerator::GetNormalisationCacheSize( pdfConfig[configIndex] );
+		}
 		else
 		{
 			cerr << "(1b)Unrecognised PDF configuration: " << pdfConfig[configIndex]->GetName() << endl;
@@ -654,6 +681,12 @@ IPDF * XMLObjectGenerator::GetNamedPDF( XMLTag * InputTag, PhaseSpaceBoundary* I
 	//Check if the name is recognised as a PDF
 	returnable_NamedPDF = ClassLookUp::LookUpPDFName( name, configurator );
 
+	if( normalisationCacheSize > 0 )
+	{
+		cout << "Keeping the Normalisation of " << name << " for up to " << normalisationCacheSize << " parameter points" << endl;
+		returnable_NamedPDF->SetNormalisationCacheSize( normalisationCacheSize );
+	}
+
 	return returnable_NamedPDF;
 }
 
@@ -764,7 +797,7 @@ DataSetConfiguration * XMLObjectGenerator::MakeDataSetConfiguration( XMLTag * Da
 			{
 				cutString = XMLTag::GetStringValue( dataComponents[dataIndex] );
 			}
-			else if ( name == "FileName" || name == "NTuplePath" )
+			else if ( name == "FileName" || name == "NTuplePath" || name == "Storage" || name == "CacheDirectory" || name == "GeneratorThreads" )
 			{
 				argumentNames.push_back(name);
 				dataArguments.push_back( XMLTag::GetStringValue( dataComponents[dataIndex] ) );
@@ -1568,7 +1601,7 @@ PDFWithData * XMLObjectGenerator::GetPDFWithData( XMLTag * DataTag, XMLTag * Fit
 			{
 				cutString = XMLTag::GetStringValue( dataComponents[dataIndex] );
 			}
-			else if ( name == "FileName" || name == "NTuplePath" )
+			else if ( name == "FileName" || name == "NTuplePath" || name == "Storage" || name == "CacheDirectory" || name == "GeneratorThreads" )
 			{
 				argumentNames.push_back(name);
 				dataArguments.push_back( XMLTag::GetStringValue( dataComponents[dataIndex] ) );
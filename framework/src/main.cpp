@@ -30,6 +30,7 @@
 #include "main.h"
 #include "DataSetConfiguration.h"
 #include "IPDF.h"
+#include "BasePDF.h"
 #include "IDataSet.h"
 #include "MemoryDataSet.h"
 #include "StringProcessing.h"
@@ -49,6 +50,8 @@
 #include "ResultFormatter.h"
 #include "MultiDimChi2.h"
 #include "RapidFitRandom.h"
+#include "AcceptReject.h"
+#include "Threading.h"
 ///  System Headers
 #include <string>
 #include <vector>
@@ -59,6 +62,8 @@
 #include <iomanip>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
 
 using namespace::std;
 
@@ -149,6 +154,11 @@ int RapidFit( vector<string> input )
 		exit(0);
 	}
 
+	if( thisConfig->testFaddeevaFlag )
+	{
+		exit( testFaddeeva( thisConfig ) );
+	}
+
 	if( DebugClass::DebugThisClass( "main" ) )
 	{
 		cout << endl;
@@ -194,6 +204,12 @@ int RapidFit( vector<string> input )
 	//	2)
 	else if( thisConfig->testIntegratorFlag && thisConfig->configFileNameFlag) testIntegrator( thisConfig );
 
+	else if( thisConfig->testIntegratorThreadsFlag && thisConfig->configFileNameFlag ) main_fitResult = testIntegratorThreads( thisConfig );
+
+	else if( thisConfig->testCacheDependenciesFlag && thisConfig->configFileNameFlag ) main_fitResult = testCacheDependencies( thisConfig );
+
+	else if( thisConfig->benchmarkAcceptRejectFlag && thisConfig->configFileNameFlag ) main_fitResult = benchmarkAcceptReject( thisConfig );
+
 	//	3)
 	else if( thisConfig->calculateAcceptanceWeights && thisConfig->configFileNameFlag ) calculateAcceptanceWeights( thisConfig );
 	else if( thisConfig->calculateAcceptanceCoefficients && thisConfig->configFileNameFlag ) calculateAcceptanceCoefficients( thisConfig );
@@ -265,6 +281,9 @@ int PerformJackKnife( RapidFitConfiguration* config )
 
 int Perform2DLLScan( RapidFitConfiguration* config )
 {
+	if( config->scanWorkers > 0 ) ScanStudies::SetNumberWorkers( (unsigned) config->scanWorkers );
+	if( config->adaptiveContourFits > 0 ) ScanStudies::SetAdaptiveContour( (unsigned) config->adaptiveContourFits, config->adaptiveContourLevels );
+
 	vector<pair<string, string> > _2DLLscanList = config->makeOutput->Get2DScanList();
 
 	unsigned int initial_scan=0;
@@ -336,6 +355,8 @@ int Perform2DLLScan( RapidFitConfiguration* config )
 
 int PerformLLScan( RapidFitConfiguration* config )
 {
+	if( config->scanWorkers > 0 ) ScanStudies::SetNumberWorkers( (unsigned) config->scanWorkers );
+
 	vector<FitResultVector*> scanSoloResults;
 
 	//  Store
@@ -902,6 +923,7 @@ int PerformFCStudy( RapidFitConfiguration* config )
 	VectoredFeldmanCousins* new_study =
 		new VectoredFeldmanCousins( config->GlobalFitResult, config->_2DResultForFC, config->Nuisencemodel, config->makeOutput, config->theMinimiser, config->theFunction, config->xmlFile, config->pdfsAndData );
 	if( config->numberRepeatsFlag ) new_study->SetNumRepeats( config->numberRepeats );
+	if( config->toyWorkers > 1 ) new_study->SetNumberWorkers( (unsigned) config->toyWorkers );
 	new_study->DoWholeStudy( config->OutputLevel2 );
 	FitResultVector* study_output = new_study->GetStudyResult();
 
@@ -964,6 +986,7 @@ int PerformToyStudy( RapidFitConfiguration* config )
 
 	if( config->fixedTotalToys ) newStudy->SetFixedNumberToys();
 	if( config->saveAllToys ) newStudy->setSaveAllToys();
+	if( config->toyWorkers > 1 ) newStudy->SetNumberWorkers( (unsigned) config->toyWorkers );
 
 	if( config->OutputLevelSet == false ) config->OutputLevel = -999;
 
@@ -1368,6 +1391,303 @@ int testIntegrator( RapidFitConfiguration* config )
 	return 0;
 }
 
+namespace
+{
+	//	Input and output of one thread in testIntegratorThreads
+	struct IntegratorTestThread
+	{
+		RapidFitIntegrator* integrator;
+		PhaseSpaceBoundary* boundary;
+		vector<DataPoint*> points;
+		vector<string> dontIntegrate;
+		vector<double> results;
+	};
+
+	void* IntegratorTestTask( void* input )
+	{
+		IntegratorTestThread* thisThread = (IntegratorTestThread*) input;
+		for( unsigned int i=0; i< thisThread->points.size(); ++i )
+		{
+			thisThread->results.push_back( thisThread->integrator->NumericallyIntegrateDataPoint( thisThread->points[i], thisThread->boundary, thisThread->dontIntegrate ) );
+		}
+		return NULL;
+	}
+
+	//	Run every thread at once and return the largest relative difference of any result to the single threaded reference
+	double RunIntegratorTestThreads( vector<IntegratorTestThread>& threadData, const vector<double>& referenceValues )
+	{
+		vector<pthread_t> threads( threadData.size() );
+		for( unsigned int t=0; t< threadData.size(); ++t )
+		{
+			int status = pthread_create( &threads[t], NULL, IntegratorTestTask, (void*) &threadData[t] );
+			if( status )
+			{
+				cerr << "ERROR:\tfrom pthread_create()\t" << status << "\t...Exiting\n" << endl;
+				exit(-1);
+			}
+		}
+		for( unsigned int t=0; t< threadData.size(); ++t ) pthread_join( threads[t], NULL );
+
+		double thisDeviation = 0.;
+		for( unsigned int t=0; t< threadData.size(); ++t )
+		{
+			for( unsigned int j=0; j< referenceValues.size(); ++j )
+			{
+				double difference = fabs( threadData[t].results[j] - referenceValues[j] );
+				if( fabs( referenceValues[j] ) > 0. ) difference /= fabs( referenceValues[j] );
+				if( !( difference <= thisDeviation ) ) thisDeviation = difference;
+			}
+		}
+		return thisDeviation;
+	}
+
+	//	Each thread integrates its own copy of the first numberEvents events of the DataSet
+	vector<IntegratorTestThread> MakeIntegratorTestThreads( const unsigned int numberThreads, IDataSet* quickDataSet, const unsigned int numberEvents, const vector<string>& dontIntegrate )
+	{
+		vector<IntegratorTestThread> threadData( numberThreads );
+		for( unsigned int t=0; t< numberThreads; ++t )
+		{
+			threadData[t].integrator = NULL;
+			threadData[t].boundary = new PhaseSpaceBoundary( *quickDataSet->GetBoundary() );
+			threadData[t].dontIntegrate = dontIntegrate;
+			for( unsigned int j=0; j< numberEvents; ++j )
+			{
+				threadData[t].points.push_back( new DataPoint( *quickDataSet->GetDataPoint( (int)j ) ) );
+			}
+		}
+		return threadData;
+	}
+
+	void DeleteIntegratorTestThreads( vector<IntegratorTestThread>& threadData )
+	{
+		for( unsigned int t=0; t< threadData.size(); ++t )
+		{
+			while( !threadData[t].points.empty() )
+			{
+				delete threadData[t].points.back();
+				threadData[t].points.pop_back();
+			}
+			delete threadData[t].boundary;
+		}
+		threadData.clear();
+	}
+}
+
+int testIntegratorThreads( RapidFitConfiguration* config )
+{
+	const unsigned int numberThreads = Threading::numCores() > 8 ? (unsigned) Threading::numCores() : 8;
+	const unsigned int maxEvents = 50;
+	double maxDeviation = 0.;
+
+	vector<PDFWithData*> PDFinXML = config->xmlFile->GetPDFsAndData();
+	for( unsigned int i=0; i< PDFinXML.size(); ++i )
+	{
+		PDFWithData * quickData = PDFinXML[i];
+		quickData->SetPhysicsParameters( config->xmlFile->GetFitParameters() );
+		IPDF* thisPDF = quickData->GetPDF();
+		IDataSet* quickDataSet = quickData->GetDataSet();
+		PhaseSpaceBoundary* thisBoundary = quickDataSet->GetBoundary();
+		RapidFitIntegratorConfig* integratorConfig = thisPDF->GetPDFIntegrator()->GetIntegratorConfig();
+		vector<string> dontIntegrate = thisPDF->GetDoNotIntegrateList();
+
+		unsigned int numberEvents = (unsigned) quickDataSet->GetDataNumber();
+		if( numberEvents > maxEvents ) numberEvents = maxEvents;
+
+		cout << endl << "Integrating " << numberEvents << " events of " << thisPDF->GetName() << " in 1 and " << numberThreads << " threads" << endl << endl;
+
+		//	Reference values from a single thread
+		RapidFitIntegrator* reference = new RapidFitIntegrator( thisPDF, true );
+		reference->SetUpIntegrator( integratorConfig );
+		reference->ForceTestStatus( true );
+		vector<double> referenceValues;
+		for( unsigned int j=0; j< numberEvents; ++j )
+		{
+			referenceValues.push_back( reference->NumericallyIntegrateDataPoint( quickDataSet->GetDataPoint( (int)j ), thisBoundary, dontIntegrate ) );
+		}
+		delete reference;
+
+		//	Every thread integrates the same events with its own PDF and integrator, as the threaded FitFunctions do
+		vector<IntegratorTestThread> threadData = MakeIntegratorTestThreads( numberThreads, quickDataSet, numberEvents, dontIntegrate );
+		vector<IPDF*> threadPDFs;
+		for( unsigned int t=0; t< numberThreads; ++t )
+		{
+			threadPDFs.push_back( ClassLookUp::CopyPDF( thisPDF ) );
+			threadData[t].integrator = new RapidFitIntegrator( threadPDFs.back(), true );
+			threadData[t].integrator->SetUpIntegrator( integratorConfig );
+			threadData[t].integrator->ForceTestStatus( true );
+		}
+
+		const double ownDeviation = RunIntegratorTestThreads( threadData, referenceValues );
+
+		for( unsigned int t=0; t< numberThreads; ++t )
+		{
+			delete threadData[t].integrator;
+			delete threadPDFs[t];
+		}
+		DeleteIntegratorTestThreads( threadData );
+
+		//	Every thread integrates the same events with one shared PDF and integrator
+		IPDF* sharedPDF = ClassLookUp::CopyPDF( thisPDF );
+		RapidFitIntegrator* sharedIntegrator = new RapidFitIntegrator( sharedPDF, true );
+		sharedIntegrator->SetUpIntegrator( integratorConfig );
+		sharedIntegrator->ForceTestStatus( true );
+
+		threadData = MakeIntegratorTestThreads( numberThreads, quickDataSet, numberEvents, dontIntegrate );
+		for( unsigned int t=0; t< numberThreads; ++t ) threadData[t].integrator = sharedIntegrator;
+
+		const double sharedDeviation = RunIntegratorTestThreads( threadData, referenceValues );
+
+		DeleteIntegratorTestThreads( threadData );
+		delete sharedIntegrator;
+		delete sharedPDF;
+
+		cout << thisPDF->GetName() << ": largest relative difference to a single thread: " << ownDeviation << " with an integrator per thread, ";
+		cout << sharedDeviation << " with one shared integrator" << endl;
+		if( !( ownDeviation <= maxDeviation ) ) maxDeviation = ownDeviation;
+		if( !( sharedDeviation <= maxDeviation ) ) maxDeviation = sharedDeviation;
+	}
+	while( !PDFinXML.empty() )
+	{
+		if( PDFinXML.back() != NULL ) delete PDFinXML.back();
+		PDFinXML.pop_back();
+	}
+
+	if( maxDeviation < 1E-10 )
+	{
+		cout << "Threaded Integrator Test Passed" << endl;
+		return 0;
+	}
+	cerr << "Threaded Integrator Test FAILED, largest relative difference: " << maxDeviation << endl;
+	return 1;
+}
+
+int testFaddeeva( RapidFitConfiguration* config )
+{
+	(void) config;
+	//	Compare the batch Faddeeva function used by the resolution models to RooMath
+	double maxDeviation = Mathematics::TestFaddeevaBatch();
+	if( maxDeviation < 1E-10 )
+	{
+		cout << "Faddeeva Test Passed" << endl;
+		return 0;
+	}
+	cerr << "Faddeeva Test FAILED, largest relative difference: " << maxDeviation << endl;
+	return 1;
+}
+
+int testCacheDependencies( RapidFitConfiguration* config )
+{
+	unsigned int failures = 0;
+
+	vector<PDFWithData*> PDFinXML = config->xmlFile->GetPDFsAndData();
+	for( unsigned int i=0; i< PDFinXML.size(); ++i )
+	{
+		PDFWithData * quickData = PDFinXML[i];
+		quickData->SetPhysicsParameters( config->xmlFile->GetFitParameters() );
+		IPDF* thisPDF = quickData->GetPDF();
+		BasePDF* thisBasePDF = dynamic_cast<BasePDF*>( thisPDF );
+		IDataSet* quickDataSet = quickData->GetDataSet();
+		PhaseSpaceBoundary* thisBoundary = quickDataSet->GetBoundary();
+		DataPoint* thisPoint = quickDataSet->GetDataPoint( 0 );
+
+		thisPDF->Integral( thisPoint, thisBoundary );
+		if( thisBasePDF == NULL || !thisBasePDF->CacheValid( thisPoint, thisBoundary ) )
+		{
+			cout << thisPDF->GetName() << " doesn't cache its Normalisation, skipping" << endl;
+			continue;
+		}
+
+		ParameterSet startingParameters( *thisPDF->GetPhysicsParameters() );
+		vector<string> dependencies = thisBasePDF->GetCacheDependencies();
+		vector<string> parameterNames = thisPDF->GetPrototypeParameterSet();
+
+		//	Move each parameter on its own, the cached Normalisation must survive unless the PDF said it depends on that parameter
+		for( unsigned int j=0; j< parameterNames.size(); ++j )
+		{
+			ParameterSet movedParameters( startingParameters );
+			PhysicsParameter* thisParameter = movedParameters.GetPhysicsParameter( parameterNames[j] );
+			thisParameter->SetBlindedValue( thisParameter->GetBlindedValue() + 1E-3 * ( fabs( thisParameter->GetBlindedValue() ) + 1. ) );
+			thisPDF->UpdatePhysicsParameters( &movedParameters );
+
+			const bool declared = StringProcessing::VectorContains( &dependencies, &(parameterNames[j]) ) != -1;
+			const bool kept = thisBasePDF->CacheValid( thisPoint, thisBoundary );
+			if( kept == declared )
+			{
+				cerr << thisPDF->GetName() << ": moving " << parameterNames[j] << ( declared ? " kept" : " dropped" ) << " the cached Normalisation" << endl;
+				++failures;
+			}
+
+			thisPDF->UpdatePhysicsParameters( &startingParameters );
+			thisPDF->Integral( thisPoint, thisBoundary );
+		}
+
+		cout << thisPDF->GetName() << ": the Normalisation depends on " << dependencies.size() << " of " << parameterNames.size() << " parameters" << endl;
+	}
+	while( !PDFinXML.empty() )
+	{
+		if( PDFinXML.back() != NULL ) delete PDFinXML.back();
+		PDFinXML.pop_back();
+	}
+
+	if( failures == 0 )
+	{
+		cout << "Cache Dependencies Test Passed" << endl;
+		return 0;
+	}
+	cerr << "Cache Dependencies Test FAILED for " << failures << " parameters" << endl;
+	return 1;
+}
+
+//	Time generating events with one AcceptReject generator
+double TimeAcceptReject( PhaseSpaceBoundary* boundary, IPDF* pdf, int numberEvents, bool batched, unsigned int threads )
+{
+	AcceptReject* generator = new AcceptReject( boundary, pdf );
+	generator->SetNumberThreads( threads );
+
+	struct timespec start, stop;
+	clock_gettime( CLOCK_MONOTONIC, &start );
+	int generated = batched ? generator->GenerateData( numberEvents ) : generator->GenerateDataUnbatched( numberEvents );
+	clock_gettime( CLOCK_MONOTONIC, &stop );
+
+	delete generator;
+
+	double seconds = double( stop.tv_sec - start.tv_sec ) + 1E-9 * double( stop.tv_nsec - start.tv_nsec );
+	return seconds > 0. ? double(generated) / seconds : 0.;
+}
+
+int benchmarkAcceptReject( RapidFitConfiguration* config )
+{
+	vector<PDFWithData*> PDFinXML = config->xmlFile->GetPDFsAndData();
+	for( unsigned int i=0; i< PDFinXML.size(); ++i )
+	{
+		PDFWithData * quickData = PDFinXML[i];
+		quickData->SetPhysicsParameters( config->xmlFile->GetFitParameters() );
+		IPDF* thisPDF = quickData->GetPDF();
+		PhaseSpaceBoundary* thisBoundary = quickData->GetPhaseSpaceBoundary();
+
+		int numberEvents = (int) quickData->GetDataSetConfig()->GetNumberEvents();
+		if( numberEvents <= 0 ) numberEvents = 10000;
+		unsigned int numberThreads = (unsigned) Threading::numCores();
+
+		cout << endl << "Benchmarking AcceptReject with " << thisPDF->GetName() << " generating " << numberEvents << " events" << endl << endl;
+
+		double unbatchedRate = TimeAcceptReject( thisBoundary, thisPDF, numberEvents, false, 1 );
+		double batchedRate = TimeAcceptReject( thisBoundary, thisPDF, numberEvents, true, 1 );
+		double threadedRate = numberThreads > 1 ? TimeAcceptReject( thisBoundary, thisPDF, numberEvents, true, numberThreads ) : batchedRate;
+
+		cout << endl << thisPDF->GetName() << ":" << endl;
+		cout << "	One trial at a time:\t\t" << unbatchedRate << " events/s" << endl;
+		cout << "	Batched, 1 thread:\t\t" << batchedRate << " events/s" << endl;
+		cout << "	Batched, " << numberThreads << " threads:\t\t" << threadedRate << " events/s" << endl;
+	}
+	while( !PDFinXML.empty() )
+	{
+		if( PDFinXML.back() != NULL ) delete PDFinXML.back();
+		PDFinXML.pop_back();
+	}
+	return 0;
+}
+
 int saveOneDataSet( RapidFitConfiguration* config )
 {
 	//Make a file containing toy data from the PDF
@@ -12,6 +12,7 @@
 //#ifndef __CINT__
 #include "BasePDF.h"
 #include "SlicedAcceptance.h"
+#include "DerivedColumn.h"
 #include "TFile.h"
 #include <iostream>
 #include <fstream>
@@ -25,6 +26,7 @@ class Bd2JpsiKstar_sWave : public BasePDF
 {
 	public:
 		Bd2JpsiKstar_sWave(PDFConfigurator*);
+		Bd2JpsiKstar_sWave( const Bd2JpsiKstar_sWave& );
 		~Bd2JpsiKstar_sWave();
 
 		//Calculate the PDF value
@@ -34,6 +36,10 @@ class Bd2JpsiKstar_sWave : public BasePDF
 		//Return a list of parameters not to be integrated
                 virtual vector<string> GetDoNotIntegrateList();
 		double angularFactor();
+		double angularFactor( double, double, double ) const;
+
+		//Calculate the angular functions and angular distribution of every event before the fit
+		void PrecomputeDerivedColumns( IDataSet* );
 
 	protected:
 		//Calculate the PDF normalisation
@@ -156,6 +162,12 @@ class Bd2JpsiKstar_sWave : public BasePDF
 		void getTimeDependentAmplitudes( double&, double&, double&, double&, double&, double&, double&, double&, double&, double&);
 		void getTimeAmplitudeIntegrals(double&, double&, double&, double&, double&, double&, double&, double&, double&, double&);
 		bool useFlatAngularDistribution;
+
+		//The ten angular functions followed by the angular distribution, these only depend on the observables
+		string angularHistogramFile;
+		DerivedColumn * angularTerms;
+		const double * angularValues;
+		void MakeDerivedColumns();
 };
 
 #endif
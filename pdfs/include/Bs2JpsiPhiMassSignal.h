@@ -21,6 +21,9 @@ class Bs2JpsiPhiMassSignal : public BasePDF
 		//Calculate the PDF value
 		double Evaluate(DataPoint*);
 
+		//Calculate the PDF value for a range of events
+		void EvaluateBatch( IDataSet*, const unsigned int begin, const unsigned int end, double* output );
+
 		vector<string> PDFComponents();
 		double EvaluateComponent( DataPoint*, ComponentRef* );
 
@@ -18,6 +18,7 @@
 #include "IResolutionModel.h"
 #include "IMistagCalib.h"
 #include "AngularAcceptance.h"
+#include "DerivedColumn.h"
 #include "Mathematics.h"
 #include <iostream>
 #include <cstdlib>
@@ -42,6 +43,9 @@ class Bs2JpsiPhi_Signal_v8 : public BasePDF
 		virtual double EvaluateForNumericIntegral(DataPoint*);
 		virtual double Evaluate(DataPoint*);
 		virtual double EvaluateTimeOnly(DataPoint*);
+
+		//Calculate the PDF value for a range of events, the time factors of every event are calculated together
+		void EvaluateBatch( IDataSet*, const unsigned int begin, const unsigned int end, double* output );
 		virtual bool SetPhysicsParameters(ParameterSet*);
 		virtual vector<string> GetDoNotIntegrateList();
 
@@ -49,6 +53,14 @@ class Bs2JpsiPhi_Signal_v8 : public BasePDF
 
 		double EvaluateComponent( DataPoint* input, ComponentRef* );
 
+		//Calculate the angular terms and angular acceptance of every event once before the fit
+		void PrecomputeDerivedColumns( IDataSet* );
+
+		//The amplitude parameters have analytic derivatives, everything else is left to the numerical derivatives
+		vector<string> GetAnalyticGradientParameters();
+		bool EvaluateGradient( DataPoint*, const vector<string>& Names, double* output );
+		bool IntegralGradient( DataPoint*, PhaseSpaceBoundary*, const vector<string>& Names, double* output );
+
 	protected:
 		//Calculate the PDF normalisation
 		virtual double Normalisation(DataPoint*, PhaseSpaceBoundary*);
@@ -231,6 +243,19 @@ class Bs2JpsiPhi_Signal_v8 : public BasePDF
 		AngularAcceptance * angAcc;
 		bool _angAccIgnoreNumerator;
 
+		// Parameter independent per-event angular quantities, these are calculated once per event and stored in the DataPoint
+		void MakeDerivedColumns( const string angAccFile );
+		void SetAngularTerms( DataPoint* );
+		DerivedColumn * angularTerms;
+		DerivedColumn * angularAcceptanceWeight;
+
+		//Are the analytic derivatives valid for the current configuration
+		bool AnalyticGradientAvailable() const;
+		//Derivatives of A0, AP, AT, AS and ASint wrt one amplitude parameter, false if this isn't possible
+		bool AmplitudeGradient( const string& Name, double* dAmplitudes ) const;
+		//Derivatives of the 10 amplitude products in the order used by diffXsecNorm1
+		void AmplitudeProductGradient( const double* dAmplitudes, double* dProducts ) const;
+
 		// Other things calculated later on the fly
 		double tlo, thi;
 
@@ -243,6 +268,7 @@ class Bs2JpsiPhi_Signal_v8 : public BasePDF
 		mutable double intExpH_stored;
 		mutable double intExpSin_stored;
 		mutable double intExpCos_stored;
+		bool _timeFactorsFromBatch;	//	expL_stored etc. have already been filled by EvaluateBatch
 		void preCalculateTimeFactors();
 		void preCalculateTimeIntegrals();
 
@@ -18,6 +18,7 @@
 #include "IResolutionModel.h"
 #include "IMistagCalib.h"
 #include "AngularAcceptance.h"
+#include "DerivedColumn.h"
 #include "Mathematics.h"
 #include <iostream>
 #include <cstdlib>
@@ -49,6 +50,9 @@ class Bs2JpsiPhi_Signal_v8a : public BasePDF
 
 		double EvaluateComponent( DataPoint* input, ComponentRef* );
 
+		//Calculate the angular terms and angular acceptance of every event once before the fit
+		void PrecomputeDerivedColumns( IDataSet* );
+
 	protected:
 		//Calculate the PDF normalisation
 		virtual double Normalisation(DataPoint*, PhaseSpaceBoundary*);
@@ -231,6 +235,12 @@ class Bs2JpsiPhi_Signal_v8a : public BasePDF
 		AngularAcceptance * angAcc;
 		bool _angAccIgnoreNumerator;
 
+		// Parameter independent per-event angular quantities, these are calculated once per event and stored in the DataPoint
+		void MakeDerivedColumns( const string angAccFile );
+		void SetAngularTerms( DataPoint* );
+		DerivedColumn * angularTerms;
+		DerivedColumn * angularAcceptanceWeight;
+
 		// Other things calculated later on the fly
 		double tlo, thi;
 
@@ -23,6 +23,9 @@ class Exponential : public BasePDF
 		//Calculate the PDF value
 		double Evaluate(DataPoint*);
 
+		//Calculate the PDF value for a range of events
+		void EvaluateBatch( IDataSet*, const unsigned int begin, const unsigned int end, double* output );
+
 	protected:
 		//Calculate the PDF normalisation
 		double Normalisation(DataPoint*, PhaseSpaceBoundary*);
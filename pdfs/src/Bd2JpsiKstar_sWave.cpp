@@ -12,6 +12,7 @@
 #include "Bd2JpsiKstar_sWave.h"
 #include "Mathematics.h"
 #include "SlicedAcceptance.h"
+#include "DerivedColumn.h"
 #include <iostream>
 #include <fstream>
 #include "math.h"
@@ -65,7 +66,8 @@ Bd2JpsiKstar_sWave::Bd2JpsiKstar_sWave(PDFConfigurator* configurator ) :
 	, gamma(), Azero_sq(), Apara_sq(), Aperp_sq(), As_sq(), AzeroApara(), AzeroAperp(), AparaAperp(), AparaAs(), AperpAs(), AzeroAs(),
 	delta_zero(), delta_para(), delta_perp(), delta_s(), omega(), timeRes(), timeRes1(), timeRes2(), timeRes1Frac(), angAccI1(), angAccI2(),
 	angAccI3(), angAccI4(), angAccI5(), angAccI6(), angAccI7(), angAccI8(), angAccI9(), angAccI10(), Ap_sq(), Ap(), time(), cosTheta(), phi(),
-	cosPsi(), KstarFlavour(), tlo(), thi(), useFlatAngularDistribution(true)
+	cosPsi(), KstarFlavour(), tlo(), thi(), useFlatAngularDistribution(true),
+	angularHistogramFile(), angularTerms(NULL), angularValues(NULL)
 {
 	MakePrototypes();
 	_useTimeAcceptance = configurator->isTrue( "UseTimeAcceptance" ) ;
@@ -83,6 +85,7 @@ Bd2JpsiKstar_sWave::Bd2JpsiKstar_sWave(PDFConfigurator* configurator ) :
 //AILSA
 	//Find name of histogram needed to define 3-D angular distribution
         string fileName = configurator->getConfigurationValue( "AngularDistributionHistogram" ) ;
+        angularHistogramFile = fileName;
 
         //Initialise depending upon whether configuration parameter was found
         if( fileName == "" )
@@ -217,9 +220,88 @@ Bd2JpsiKstar_sWave::Bd2JpsiKstar_sWave(PDFConfigurator* configurator ) :
                 cout << "Finishing processing histo" << endl;
         }
 
+	this->MakeDerivedColumns();
 }
 // END AILSA
 
+Bd2JpsiKstar_sWave::Bd2JpsiKstar_sWave( const Bd2JpsiKstar_sWave& copy ) : BasePDF( (BasePDF) copy ),
+	cachedAzeroAzeroIntB( copy.cachedAzeroAzeroIntB ), cachedAparaAparaIntB( copy.cachedAparaAparaIntB ),
+	cachedAperpAperpIntB( copy.cachedAperpAperpIntB ), cachedAparaAperpIntB( copy.cachedAparaAperpIntB ),
+	cachedAzeroAparaIntB( copy.cachedAzeroAparaIntB ), cachedAzeroAperpIntB( copy.cachedAzeroAperpIntB ), cachedAsAsIntB( copy.cachedAsAsIntB ),
+	cachedAparaAsIntB( copy.cachedAparaAsIntB ), cachedAperpAsIntB( copy.cachedAperpAsIntB ), cachedAzeroAsIntB( copy.cachedAzeroAsIntB ),
+	AzeroAzeroB( copy.AzeroAzeroB ), AparaAparaB( copy.AparaAparaB ), AperpAperpB( copy.AperpAperpB ), AsAsB( copy.AsAsB ),
+	ImAparaAperpB( copy.ImAparaAperpB ), ReAzeroAparaB( copy.ReAzeroAparaB ), ImAzeroAperpB( copy.ImAzeroAperpB ), ReAparaAsB( copy.ReAparaAsB ),
+	ImAperpAsB( copy.ImAperpAsB ), ReAzeroAsB( copy.ReAzeroAsB ), cachedSinDeltaPerpPara( copy.cachedSinDeltaPerpPara ),
+	cachedCosDeltaPara( copy.cachedCosDeltaPara ), cachedSinDeltaPerp( copy.cachedSinDeltaPerp ), cachedCosDeltaParaS( copy.cachedCosDeltaParaS ),
+	cachedSinDeltaPerpS( copy.cachedSinDeltaPerpS ), cachedCosDeltaS( copy.cachedCosDeltaS ), cachedAzero( copy.cachedAzero ),
+	cachedApara( copy.cachedApara ), cachedAperp( copy.cachedAperp ), cachedAs( copy.cachedAs ), gammaName( copy.gammaName ), As_sqName( copy.As_sqName ),
+	delta_zeroName( copy.delta_zeroName ), Azero_sqName( copy.Azero_sqName ), Apara_sqName( copy.Apara_sqName ), Aperp_sqName( copy.Aperp_sqName ),
+	delta_paraName( copy.delta_paraName ), delta_perpName( copy.delta_perpName ), delta_sName( copy.delta_sName ), angAccI1Name( copy.angAccI1Name ),
+	angAccI2Name( copy.angAccI2Name ), angAccI3Name( copy.angAccI3Name ), angAccI4Name( copy.angAccI4Name ), angAccI5Name( copy.angAccI5Name ),
+	angAccI6Name( copy.angAccI6Name ), angAccI7Name( copy.angAccI7Name ), angAccI8Name( copy.angAccI8Name ), angAccI9Name( copy.angAccI9Name ),
+	angAccI10Name( copy.angAccI10Name ), timeRes1Name( copy.timeRes1Name ), timeRes2Name( copy.timeRes2Name ),
+	timeRes1FractionName( copy.timeRes1FractionName ), normalisationCacheValid( copy.normalisationCacheValid ),
+	evaluationCacheValid( copy.evaluationCacheValid ), timeName( copy.timeName ), cosThetaName( copy.cosThetaName ), phiName( copy.phiName ),
+	cosPsiName( copy.cosPsiName ), KstarFlavourName( copy.KstarFlavourName ), timeconstraintName( copy.timeconstraintName ), gamma( copy.gamma ),
+	Azero_sq( copy.Azero_sq ), Apara_sq( copy.Apara_sq ), Aperp_sq( copy.Aperp_sq ), As_sq( copy.As_sq ), AzeroApara( copy.AzeroApara ),
+	AzeroAperp( copy.AzeroAperp ), AparaAperp( copy.AparaAperp ), AparaAs( copy.AparaAs ), AperpAs( copy.AperpAs ), AzeroAs( copy.AzeroAs ),
+	delta_zero( copy.delta_zero ), delta_para( copy.delta_para ), delta_perp( copy.delta_perp ), delta_s( copy.delta_s ), omega( copy.omega ),
+	timeRes( copy.timeRes ), timeRes1( copy.timeRes1 ), timeRes2( copy.timeRes2 ), timeRes1Frac( copy.timeRes1Frac ), angAccI1( copy.angAccI1 ),
+	angAccI2( copy.angAccI2 ), angAccI3( copy.angAccI3 ), angAccI4( copy.angAccI4 ), angAccI5( copy.angAccI5 ), angAccI6( copy.angAccI6 ),
+	angAccI7( copy.angAccI7 ), angAccI8( copy.angAccI8 ), angAccI9( copy.angAccI9 ), angAccI10( copy.angAccI10 ), Ap_sq( copy.Ap_sq ), Ap( copy.Ap ),
+	_useTimeAcceptance( copy._useTimeAcceptance ), timeAcc( copy.timeAcc ), tlo( copy.tlo ), thi( copy.thi ), time( copy.time ),
+	cosTheta( copy.cosTheta ), phi( copy.phi ), cosPsi( copy.cosPsi ), KstarFlavour( copy.KstarFlavour ), histo( copy.histo ), xaxis( copy.xaxis ),
+	yaxis( copy.yaxis ), zaxis( copy.zaxis ), nxbins( copy.nxbins ), nybins( copy.nybins ), nzbins( copy.nzbins ), xmin( copy.xmin ), xmax( copy.xmax ),
+	ymin( copy.ymin ), ymax( copy.ymax ), zmin( copy.zmin ), zmax( copy.zmax ), deltax( copy.deltax ), deltay( copy.deltay ), deltaz( copy.deltaz ),
+	total_num_entries( copy.total_num_entries ), useFlatAngularDistribution( copy.useFlatAngularDistribution ),
+	angularHistogramFile( copy.angularHistogramFile ), angularTerms( NULL ), angularValues( NULL )
+{
+	this->MakeDerivedColumns();
+}
+
+namespace
+{
+	//	The angular functions and the angular distribution from the histogram only depend on the angles of each event
+	class Bd2JpsiKstar_sWave_AngularColumn : public DerivedColumn
+	{
+		public:
+			Bd2JpsiKstar_sWave_AngularColumn( const string Name, const Bd2JpsiKstar_sWave* PDF ) :
+				DerivedColumn( Name, 11 ), pdf( PDF ), cosThetaName( "cosTheta" ), phiName( "phi" ), cosPsiName( "cosPsi" )
+			{}
+
+		protected:
+			void Calculate( DataPoint* input, double* output ) const
+			{
+				const double cosTheta = input->GetObservable( cosThetaName )->GetValue();
+				const double phi = input->GetObservable( phiName )->GetValue();
+				const double cosPsi = input->GetObservable( cosPsiName )->GetValue();
+				Mathematics::getBs2JpsiPhiAngularFunctionsWithSwave( output[0], output[1], output[2], output[3], output[4],
+						output[5], output[6], output[7], output[8], output[9], cosTheta, phi, cosPsi );
+				output[10] = pdf->angularFactor( cosTheta, phi, cosPsi );
+			}
+
+		private:
+			Bd2JpsiKstar_sWave_AngularColumn( const Bd2JpsiKstar_sWave_AngularColumn& );
+			Bd2JpsiKstar_sWave_AngularColumn& operator= ( const Bd2JpsiKstar_sWave_AngularColumn& );
+
+			const Bd2JpsiKstar_sWave* pdf;
+			ObservableRef cosThetaName, phiName, cosPsiName;
+	};
+}
+
+//Construct the per-event angular quantities which only depend on the observables
+void Bd2JpsiKstar_sWave::MakeDerivedColumns()
+{
+	string angularName = "Bd2JpsiKstar_sWave::Angular(" + string(cosThetaName) + ";" + string(phiName) + ";" + string(cosPsiName) + ";" + angularHistogramFile + ")";
+	angularTerms = new Bd2JpsiKstar_sWave_AngularColumn( angularName, this );
+}
+
+//Calculate the angular terms of every event before the fit
+void Bd2JpsiKstar_sWave::PrecomputeDerivedColumns( IDataSet* input )
+{
+	angularTerms->Precompute( input );
+}
+
 
 //Make the data point and parameter set
 void Bd2JpsiKstar_sWave::MakePrototypes()
@@ -263,6 +345,7 @@ void Bd2JpsiKstar_sWave::MakePrototypes()
 //Destructor
 Bd2JpsiKstar_sWave::~Bd2JpsiKstar_sWave()
 {
+	if( angularTerms != NULL ) delete angularTerms;
 }
 
 //Not only set the physics parameters, but indicate that the cache is no longer valid
@@ -325,6 +408,7 @@ double Bd2JpsiKstar_sWave::Evaluate(DataPoint * measurement)
 	phi      = measurement->GetObservable( phiName )->GetValue();
 	cosPsi   = measurement->GetObservable( cosPsiName )->GetValue();
 	KstarFlavour = measurement->GetObservable( KstarFlavourName )->GetValue();
+	angularValues = angularTerms->GetValues( measurement );
 
 	//cout << gamma << " " << Aperp_sq << " " << Azero_sq << endl;
 
@@ -369,35 +453,36 @@ double Bd2JpsiKstar_sWave::Evaluate(DataPoint * measurement)
 double Bd2JpsiKstar_sWave::buildPDFnumerator()
 {
 	// The angular functions f1->f6 as defined in roadmap Table 1.(same for Kstar)
-	double f1, f2, f3, f4, f5, f6, f7, f8, f9, f10;
-	Mathematics::getBs2JpsiPhiAngularFunctionsWithSwave( f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, cosTheta, phi, cosPsi );
+	// These are precomputed for each event, see MakeDerivedColumns
+	const double f1 = angularValues[0], f2 = angularValues[1], f3 = angularValues[2], f4 = angularValues[3], f5 = angularValues[4];
+	const double f6 = angularValues[5], f7 = angularValues[6], f8 = angularValues[7], f9 = angularValues[8], f10 = angularValues[9];
 
 	// The time dependent amplitudes as defined in roadmap Eqns 48 -> 59  //No tagging so only need 2 (h± pg 72)
 	// First for the B
-	double AzeroAzeroB, AparaAparaB, AperpAperpB, AsAsB;
-	double ImAparaAperpB, ReAzeroAparaB, ImAzeroAperpB;
-	double ReAparaAsB, ImAperpAsB, ReAzeroAsB;
+	double AzeroAzero, AparaApara, AperpAperp, AsAs;
+	double ImAparaAperp, ReAzeroApara, ImAzeroAperp;
+	double ReAparaAs, ImAperpAs, ReAzeroAs;
 
-	getTimeDependentAmplitudes( AzeroAzeroB, AparaAparaB, AperpAperpB
-			, ImAparaAperpB, ReAzeroAparaB, ImAzeroAperpB
-			, AsAsB, ReAparaAsB, ImAperpAsB, ReAzeroAsB
+	getTimeDependentAmplitudes( AzeroAzero, AparaApara, AperpAperp
+			, ImAparaAperp, ReAzeroApara, ImAzeroAperp
+			, AsAs, ReAparaAs, ImAperpAs, ReAzeroAs
 			);
 
 	//q() tags the K* flavour - it changes the sign of f4, f6 and f9
-	double v1 = f1 * AzeroAzeroB
-		+ f2 * AparaAparaB
-		+ f3 * AperpAperpB
-		+ f4 * ImAparaAperpB * q()
-		+ f5 * ReAzeroAparaB
-		+ f6 * ImAzeroAperpB * q()
-		+ f7 * AsAsB
-		+ f8 * ReAparaAsB
-		+ f9 * ImAperpAsB * q()
-		+ f10 * ReAzeroAsB
+	double v1 = f1 * AzeroAzero
+		+ f2 * AparaApara
+		+ f3 * AperpAperp
+		+ f4 * ImAparaAperp * q()
+		+ f5 * ReAzeroApara
+		+ f6 * ImAzeroAperp * q()
+		+ f7 * AsAs
+		+ f8 * ReAparaAs
+		+ f9 * ImAperpAs * q()
+		+ f10 * ReAzeroAs
 		;
 	if( useTimeAcceptance() ) v1  = v1 * timeAcc->getValue(time);
 	
-	v1  *=  angularFactor();
+	v1  *=  angularValues[10];
 	return v1;
 }
 
@@ -721,6 +806,11 @@ return;
 
 //Angular distribution function
 double Bd2JpsiKstar_sWave::angularFactor( )
+{
+	return this->angularFactor( cosTheta, phi, cosPsi );
+}
+
+double Bd2JpsiKstar_sWave::angularFactor( double thisCosTheta, double thisPhi, double thisCosPsi ) const
 {
         double returnValue=0.;
 
@@ -733,9 +823,9 @@ double Bd2JpsiKstar_sWave::angularFactor( )
         }
         else {
                 //Find global bin number for values of angles, find number of entries per bin, divide by volume per bin and normalise with total number of entries in the histogram
-                xbin = xaxis->FindFixBin( cosPsi ); if( xbin > nxbins ) xbin = nxbins;
-                ybin = yaxis->FindFixBin( cosTheta ); if( ybin > nybins ) ybin = nybins;
-                zbin = zaxis->FindFixBin( phi ); if( zbin > nzbins ) zbin = nzbins;
+                xbin = xaxis->FindFixBin( thisCosPsi ); if( xbin > nxbins ) xbin = nxbins;
+                ybin = yaxis->FindFixBin( thisCosTheta ); if( ybin > nybins ) ybin = nybins;
+                zbin = zaxis->FindFixBin( thisPhi ); if( zbin > nzbins ) zbin = nzbins;
 
                 globalbin = histo->GetBin( xbin, ybin, zbin );
                 num_entries_bin = histo->GetBinContent(globalbin);
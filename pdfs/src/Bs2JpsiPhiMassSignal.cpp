@@ -8,6 +8,7 @@
  */
 
 #include "Bs2JpsiPhiMassSignal.h"
+#include "ColumnarDataSet.h"
 #include <iostream>
 #include "math.h"
 #include "TMath.h"
@@ -27,6 +28,9 @@ Bs2JpsiPhiMassSignal::Bs2JpsiPhiMassSignal(PDFConfigurator* configurator) :
 {
 	MakePrototypes();
 
+	//	Both Gaussians are normalised over the whole mass range, so moving a mass-shape parameter never invalidates the Normalisation
+	this->SetCacheDependencies( vector<string>() );
+
 	plotComponents = configurator->isTrue( "PlotComponents" );
 }
 
@@ -153,3 +157,58 @@ double Bs2JpsiPhiMassSignal::Normalisation(PhaseSpaceBoundary * boundary)
 	return 1.0;
 }
 
+//Calculate the function value for a range of events, reading the mass column directly when the data is columnar
+void Bs2JpsiPhiMassSignal::EvaluateBatch( IDataSet* InputData, const unsigned int begin, const unsigned int end, double* output )
+{
+	if( end <= begin ) return;
+
+	// Get the physics parameters
+	double f_sig_m1  = allParameters.GetPhysicsParameter( f_sig_m1Name )->GetValue();
+	double sigma_m1 = allParameters.GetPhysicsParameter( sigma_m1Name )->GetValue();
+	double sigma_m2 = allParameters.GetPhysicsParameter( sigma_m2Name )->GetValue();
+	double m_Bs = allParameters.GetPhysicsParameter( m_BsName )->GetValue();
+
+	//	A single Gaussian is the same as no second component
+	if( f_sig_m1 > 0.9999 ) f_sig_m1 = 1.;
+
+	double frac1 = f_sig_m1, frac2 = 1. - f_sig_m1;
+	if( componentIndex == 1 ) frac2 = 0.;
+	else if( componentIndex == 2 ) frac1 = 0.;
+
+	const double factor1 = frac1/(sigma_m1*sqrt(2.*TMath::Pi()));
+	const double factor2 = frac2/(sigma_m2*sqrt(2.*TMath::Pi()));
+	const double scale1 = -1./( 2. * sigma_m1 * sigma_m1 );
+	const double scale2 = -1./( 2. * sigma_m2 * sigma_m2 );
+	const bool useFirst = ( componentIndex != 2 );
+	const bool useSecond = ( componentIndex != 1 ) && ( f_sig_m1 < 1. );
+
+	const unsigned int nEvents = end - begin;
+	vector<double> massValues;
+	const double* mass = NULL;
+
+	ColumnarDataSet* columnarData = dynamic_cast<ColumnarDataSet*>( InputData );
+	if( columnarData != NULL ) mass = columnarData->GetColumn( recoMassName );
+
+	if( mass != NULL )
+	{
+		mass += begin;
+	}
+	else
+	{
+		massValues.resize( nEvents );
+		for( unsigned int i=0; i< nEvents; ++i )
+		{
+			massValues[i] = InputData->GetDataPoint( (int)(begin+i) )->GetObservable( recoMassName )->GetValue();
+		}
+		mass = &(massValues[0]);
+	}
+
+	for( unsigned int i=0; i< nEvents; ++i )
+	{
+		const double deltaMsq = ( mass[i] - m_Bs )*( mass[i] - m_Bs );
+		double returnValue = 0.;
+		if( useFirst ) returnValue += factor1 * exp( deltaMsq * scale1 );
+		if( useSecond ) returnValue += factor2 * exp( deltaMsq * scale2 );
+		output[i] = returnValue;
+	}
+}
@@ -11,10 +11,14 @@
 #include "Mathematics.h"
 #include "TimeAccRes.h"
 #include "Bs2JpsiPhi_Angluar_Terms.h"
+#include "FunctionDerivedColumn.h"
+#include "AngularAcceptanceColumn.h"
 #include "Bs2JpsiPhi_Signal_v8.h"
 #include "SimpleMistagCalib.h"
 #include "CombinedMistagCalib.h"
 #include "MistagCalib3fb.h"
+#include "StringProcessing.h"
+#include "ColumnarDataSet.h"
 
 #include <iostream>
 #include <cmath>
@@ -83,8 +87,9 @@ Bs2JpsiPhi_Signal_v8::Bs2JpsiPhi_Signal_v8(PDFConfigurator* configurator) : Base
 	_gamma(), dgam(), Aperp_sq(), Apara_sq(), Azero_sq(), As_sq(), delta_para(),
 	delta_perp(), delta_zero(), delta_s(), delta_perp_Minus_para(), delta_perp_Minus_zero(), delta_ms(), phi_s(), _cosphis(), _sinphis(), 
 	angAccI1(), angAccI2(), angAccI3(), angAccI4(), angAccI5(), angAccI6(), angAccI7(), angAccI8(), angAccI9(), angAccI10(),
+	angularTerms(NULL), angularAcceptanceWeight(NULL),
 	tlo(), thi(), expL_stored(), expH_stored(), expSin_stored(), expCos_stored(),
-	intExpL_stored(), intExpH_stored(), intExpSin_stored(), intExpCos_stored(),//, timeAcc(NULL),
+	intExpL_stored(), intExpH_stored(), intExpSin_stored(), intExpCos_stored(), _timeFactorsFromBatch(false),//, timeAcc(NULL),
 	CachedA1(), CachedA2(), CachedA3(), CachedA4(), CachedA5(), CachedA6(), CachedA7(), CachedA8(), CachedA9(), CachedA10(),
 	_fitDirectlyForApara(false), performingComponentProjection(false), _useDoubleTres(false), _useTripleTres(false), _useNewPhisres(false), resolutionModel(NULL),
 	_useBetaParameter(false), _useMultiplePhis(false), RequireInterference(true)
@@ -166,6 +171,8 @@ Bs2JpsiPhi_Signal_v8::Bs2JpsiPhi_Signal_v8(PDFConfigurator* configurator) : Base
 		angAccI10 = angAcc->af10();
 	}
 
+	this->MakeDerivedColumns( angAccFile );
+
 	this->SetNumericalNormalisation( false );
 
 	resolutionModel = new TimeAccRes( configurator, isCopy );
@@ -201,6 +208,8 @@ Bs2JpsiPhi_Signal_v8::Bs2JpsiPhi_Signal_v8(PDFConfigurator* configurator) : Base
 Bs2JpsiPhi_Signal_v8::~Bs2JpsiPhi_Signal_v8()
 {
 	//if( timeAcc != NULL ) delete timeAcc;
+	if( angularTerms != NULL ) delete angularTerms;
+	if( angularAcceptanceWeight != NULL ) delete angularAcceptanceWeight;
 	if( angAcc != NULL ) delete angAcc;
 	if( resolutionModel != NULL ) delete resolutionModel;
 	if( _mistagCalibModel != NULL ) delete _mistagCalibModel;
@@ -282,6 +291,14 @@ void Bs2JpsiPhi_Signal_v8::MakePrototypes()
 	if( _useBetaParameter ) parameterNames.push_back( BetaName );
 
 	allParameters = ParameterSet(parameterNames);
+
+	//	cosdpar is only carried so that it can be fitted separately, the Normalisation doesn't depend on it
+	vector<string> normalisationNames;
+	for( vector<string>::const_iterator name_i = parameterNames.begin(); name_i != parameterNames.end(); ++name_i )
+	{
+		if( !( _useCosDpar && *name_i == cosdparName.Name() ) ) normalisationNames.push_back( *name_i );
+	}
+	this->SetCacheDependencies( normalisationNames );
 }
 
 
@@ -456,6 +473,242 @@ bool Bs2JpsiPhi_Signal_v8::SetPhysicsParameters( ParameterSet* NewParameterSet )
 	return result;
 }
 
+//.............................................................
+//Construct the per-event angular quantities which only depend on the observables
+void Bs2JpsiPhi_Signal_v8::MakeDerivedColumns( const string angAccFile )
+{
+	vector<string> angularObservables;
+	vector<FunctionDerivedColumn::ObservableFunction> angularFunctions;
+	string angularName;
+	string acceptanceName;
+	string first, second, third;
+
+	if( !_useHelicityBasis )
+	{
+		angularObservables.push_back( cosThetaName );
+		angularObservables.push_back( cosPsiName );
+		angularObservables.push_back( phiName );
+
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorA0A0 );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorAPAP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorATAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorASAS );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorImAPAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorReA0AP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorImA0AT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorReASAP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorImASAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorReASA0 );
+
+		angularName = "Bs2JpsiPhi_Angular_Terms::Transversity(";
+
+		//	The acceptance is evaluated as getValue( cosPsi, cosTheta, phi ) in this basis
+		first = cosPsiName; second = cosThetaName; third = phiName;
+	}
+	else
+	{
+		angularObservables.push_back( cthetakName );
+		angularObservables.push_back( cthetalName );
+		angularObservables.push_back( phihName );
+
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorA0A0 );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorAPAP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorATAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorASAS );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorImAPAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorReA0AP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorImA0AT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorReASAP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorImASAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorReASA0 );
+
+		angularName = "Bs2JpsiPhi_Angular_Terms::Helicity(";
+
+		first = cthetakName; second = cthetalName; third = phihName;
+	}
+
+	for( unsigned int i=0; i< angularObservables.size(); ++i )
+	{
+		angularName.append( angularObservables[i] ); angularName.append( ";" );
+	}
+	angularName.append( ")" );
+
+	acceptanceName = "AngularAcceptance(" + angAccFile + ";" + (_useHelicityBasis?"Helicity":"Transversity") + ";" + (_angAccIgnoreNumerator?"IgnoreNumerator":"") + ";" + first + ";" + second + ";" + third + ")";
+
+	angularTerms = new FunctionDerivedColumn( angularName, angularObservables, angularFunctions );
+	angularAcceptanceWeight = new AngularAcceptanceColumn( acceptanceName, angAcc, first, second, third );
+}
+
+//.............................................................
+//Calculate the angular terms and angular acceptance of every event before the fit
+void Bs2JpsiPhi_Signal_v8::PrecomputeDerivedColumns( IDataSet* input )
+{
+	angularTerms->Precompute( input );
+	angularAcceptanceWeight->Precompute( input );
+}
+
+//.............................................................
+//Read the angular terms for this event, these are only calculated the first time the event is seen
+void Bs2JpsiPhi_Signal_v8::SetAngularTerms( DataPoint* measurement )
+{
+	const double* angularValues = angularTerms->GetValues( measurement );
+
+	A0A0_value = angularValues[0];
+	APAP_value = angularValues[1];
+	ATAT_value = angularValues[2];
+	ASAS_value = angularValues[3];
+	ImAPAT_value = angularValues[4];
+	ReA0AP_value = angularValues[5];
+	ImA0AT_value = angularValues[6];
+	ReASAP_value = angularValues[7];
+	ImASAT_value = angularValues[8];
+	ReASA0_value = angularValues[9];
+}
+
+//.............................................................
+//The analytic derivatives assume the analytic normalisation and the full PDF (not a component) are being used
+bool Bs2JpsiPhi_Signal_v8::AnalyticGradientAvailable() const
+{
+	if( _numericIntegralForce || _numericIntegralTimeOnly ) return false;
+	if( _usePlotComponents || _usePlotAllComponents || performingComponentProjection ) return false;
+	return !this->GetNumericalNormalisation();
+}
+
+vector<string> Bs2JpsiPhi_Signal_v8::GetAnalyticGradientParameters()
+{
+	vector<string> analyticParameters;
+	if( !this->AnalyticGradientAvailable() ) return analyticParameters;
+	analyticParameters.push_back( Azero_sqName );
+	analyticParameters.push_back( Aperp_sqName );
+	if( _fitDirectlyForApara ) analyticParameters.push_back( Apara_sqName );
+	analyticParameters.push_back( As_sqName );
+	analyticParameters.push_back( CspName );
+	return analyticParameters;
+}
+
+//.............................................................
+//Derivatives of { A0, AP, AT, AS, ASint } wrt one of the amplitude parameters
+bool Bs2JpsiPhi_Signal_v8::AmplitudeGradient( const string& Name, double* dAmplitudes ) const
+{
+	for( unsigned int i=0; i< 5; ++i ) dAmplitudes[i] = 0.;
+
+	if( Name == string(Azero_sqName) || Name == string(Aperp_sqName) )
+	{
+		const bool isZero = ( Name == string(Azero_sqName) );
+		const double thisA = isZero ? A0() : AT();
+		if( thisA <= 0. ) return false;
+		dAmplitudes[ isZero ? 0 : 2 ] = 0.5 / thisA;
+		//	Apara_sq = 1 - Azero_sq - Aperp_sq unless it is fitted directly
+		if( !_fitDirectlyForApara )
+		{
+			if( AP() <= 0. ) return false;
+			dAmplitudes[1] = -0.5 / AP();
+		}
+		return true;
+	}
+	else if( _fitDirectlyForApara && Name == string(Apara_sqName) )
+	{
+		if( AP() <= 0. ) return false;
+		dAmplitudes[1] = 0.5 / AP();
+		return true;
+	}
+	else if( Name == string(As_sqName) )
+	{
+		//	As_sq = F_s / ( 1 - F_s )  =>  dAs_sq/dF_s = ( 1 + As_sq )^2
+		if( AS() <= 0. ) return false;
+		dAmplitudes[3] = 0.5 * ( 1. + As_sq ) * ( 1. + As_sq ) / AS();
+		dAmplitudes[4] = dAmplitudes[3] * Csp;
+		return true;
+	}
+	else if( Name == string(CspName) )
+	{
+		dAmplitudes[4] = AS();
+		return true;
+	}
+	return false;
+}
+
+void Bs2JpsiPhi_Signal_v8::AmplitudeProductGradient( const double* dAmplitudes, double* dProducts ) const
+{
+	const double dA0 = dAmplitudes[0], dAP = dAmplitudes[1], dAT = dAmplitudes[2], dAS = dAmplitudes[3], dASint = dAmplitudes[4];
+
+	dProducts[0] = 2. * A0() * dA0;
+	dProducts[1] = 2. * AP() * dAP;
+	dProducts[2] = 2. * AT() * dAT;
+
+	dProducts[3] = dAP * AT() + AP() * dAT;
+	dProducts[4] = dA0 * AP() + A0() * dAP;
+	dProducts[5] = dA0 * AT() + A0() * dAT;
+
+	dProducts[6] = 2. * AS() * dAS;
+
+	dProducts[7] = dASint * AP() + ASint() * dAP;
+	dProducts[8] = dASint * AT() + ASint() * dAT;
+	dProducts[9] = dASint * A0() + ASint() * dA0;
+}
+
+//.............................................................
+//Derivative of Evaluate wrt the amplitude parameters, the cross section is linear in each of the 10 amplitude products
+bool Bs2JpsiPhi_Signal_v8::EvaluateGradient( DataPoint* measurement, const vector<string>& Names, double* output )
+{
+	if( !this->AnalyticGradientAvailable() ) return this->NoGradientDependence( Names, output );
+
+	vector<string> dependsOn = this->GetPrototypeParameterSet();
+
+	//	This sets up the angular terms and time factors for this event
+	this->Evaluate( measurement );
+
+	const double angAcceptanceFactor = angularAcceptanceWeight->GetValues( measurement )[0];
+
+	const double angularValues[10] = { A0A0_value, APAP_value, ATAT_value, ImAPAT_value, ReA0AP_value, ImA0AT_value,
+					ASAS_value, ReASAP_value, ImASAT_value, ReASA0_value };
+
+	const double timeFactors[10] = { timeFactorA0A0(), timeFactorAPAP(), timeFactorATAT(), timeFactorImAPAT(), timeFactorReA0AP(), timeFactorImA0AT(),
+					timeFactorASAS(), timeFactorReASAP(), timeFactorImASAT(), timeFactorReASA0() };
+
+	double dAmplitudes[5];
+	double dProducts[10];
+	for( unsigned int i=0; i< Names.size(); ++i )
+	{
+		output[i] = 0.;
+		if( StringProcessing::VectorContains( &dependsOn, &(Names[i]) ) == -1 ) continue;
+		if( !this->AmplitudeGradient( Names[i], dAmplitudes ) ) return false;
+		this->AmplitudeProductGradient( dAmplitudes, dProducts );
+		for( unsigned int j=0; j< 10; ++j ) output[i] += dProducts[j] * angularValues[j] * timeFactors[j];
+		output[i] *= angAcceptanceFactor;
+	}
+	return true;
+}
+
+//.............................................................
+//Derivative of Normalisation wrt the amplitude parameters, this follows diffXsecNorm1
+bool Bs2JpsiPhi_Signal_v8::IntegralGradient( DataPoint* measurement, PhaseSpaceBoundary* boundary, const vector<string>& Names, double* output )
+{
+	if( !this->AnalyticGradientAvailable() ) return this->NoGradientDependence( Names, output );
+
+	vector<string> dependsOn = this->GetPrototypeParameterSet();
+
+	//	This sets up the time integrals for this event
+	this->Normalisation( measurement, boundary );
+
+	const double angularIntegrals[10] = { angAccI1, angAccI2, angAccI3, angAccI4, angAccI5, angAccI6, angAccI7, angAccI8, angAccI9, angAccI10 };
+
+	const double timeIntegrals[10] = { timeFactorA0A0Int(), timeFactorAPAPInt(), timeFactorATATInt(), timeFactorImAPATInt(), timeFactorReA0APInt(),
+					timeFactorImA0ATInt(), timeFactorASASInt(), timeFactorReASAPInt(), timeFactorImASATInt(), timeFactorReASA0Int() };
+
+	double dAmplitudes[5];
+	double dProducts[10];
+	for( unsigned int i=0; i< Names.size(); ++i )
+	{
+		output[i] = 0.;
+		if( StringProcessing::VectorContains( &dependsOn, &(Names[i]) ) == -1 ) continue;
+		if( !this->AmplitudeGradient( Names[i], dAmplitudes ) ) return false;
+		this->AmplitudeProductGradient( dAmplitudes, dProducts );
+		for( unsigned int j=0; j< 10; ++j ) output[i] += dProducts[j] * timeIntegrals[j] * angularIntegrals[j];
+	}
+	return true;
+}
+
 //.............................................................
 //Calculate the PDF value for a given set of observables for use by numeric integral
 double Bs2JpsiPhi_Signal_v8::EvaluateForNumericIntegral(DataPoint * measurement)
@@ -479,42 +732,7 @@ double Bs2JpsiPhi_Signal_v8::Evaluate(DataPoint * measurement)
 
 	_eventIsTagged = _mistagCalibModel->eventIsTagged();
 
-	vector<double> angularData;
-
-	if( !_useHelicityBasis )
-	{
-		angularData.push_back( measurement->GetObservable( cosThetaName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cosPsiName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phiName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::TangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASA0( angularData );
-	}
-	else
-	{
-		angularData.push_back( measurement->GetObservable( cthetakName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cthetalName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phihName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::HangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASA0( angularData );
-	}
+	this->SetAngularTerms( measurement );
 
 	// Get observables into member variables
 	t = measurement->GetObservable( timeName )->GetValue() ; // - timeOffset ;
@@ -529,7 +747,7 @@ double Bs2JpsiPhi_Signal_v8::Evaluate(DataPoint * measurement)
 		ctheta_k   = thetaK_obs->GetValue();
 		phi_h      = hphi_obs->GetValue();
 		ctheta_l   = thetaL_obs->GetValue();
-		angAcceptanceFactor = angAcc->getValue( thetaK_obs, thetaL_obs, hphi_obs );  // Histogram is generated in PDF basis!
+		angAcceptanceFactor = angularAcceptanceWeight->GetValues( measurement )[0];  // Histogram is generated in PDF basis!
 		//cout << angAcceptanceFactor << endl;
 	}
 	else
@@ -540,7 +758,7 @@ double Bs2JpsiPhi_Signal_v8::Evaluate(DataPoint * measurement)
 		ctheta_tr = theta_obs->GetValue();
 		phi_tr    = phi_obs->GetValue();
 		ctheta_1  = psi_obs->GetValue();
-		angAcceptanceFactor = angAcc->getValue( psi_obs, theta_obs, phi_obs );
+		angAcceptanceFactor = angularAcceptanceWeight->GetValues( measurement )[0];
 	}
 
 	//Cache amplitues and angles terms used in cross section
@@ -582,6 +800,44 @@ double Bs2JpsiPhi_Signal_v8::Evaluate(DataPoint * measurement)
 }
 
 
+//.............................................................
+//Calculate the PDF value for a range of events
+//The resolution model calculates the time factors of all of the events at once, the rest of the PDF is evaluated event by event
+
+void Bs2JpsiPhi_Signal_v8::EvaluateBatch( IDataSet* InputData, const unsigned int begin, const unsigned int end, double* output )
+{
+	if( end <= begin ) return;
+
+	const unsigned int nEvents = end - begin;
+	vector<double> timeValues;
+	const double* times = ColumnarDataSet::ReadColumn( InputData, timeName, begin, end, timeValues );
+
+	vector<double> expL( nEvents ), expH( nEvents ), expCos( nEvents, 0. ), expSin( nEvents, 0. );
+	resolutionModel->ExpBatch( InputData, begin, end, times, gamma_l(), &(expL[0]) );
+	resolutionModel->ExpBatch( InputData, begin, end, times, gamma_h(), &(expH[0]) );
+	if( RequireInterference ) resolutionModel->ExpCosSinBatch( InputData, begin, end, times, gamma(), delta_ms, &(expCos[0]), &(expSin[0]) );
+
+	_timeFactorsFromBatch = true;
+	try
+	{
+		for( unsigned int i=0; i< nEvents; ++i )
+		{
+			expL_stored = expL[i];
+			expH_stored = expH[i];
+			expCos_stored = expCos[i];
+			expSin_stored = expSin[i];
+			output[i] = this->Evaluate( InputData->GetDataPoint( (int)(begin+i) ) );
+		}
+	}
+	catch(...)
+	{
+		_timeFactorsFromBatch = false;
+		throw;
+	}
+	_timeFactorsFromBatch = false;
+}
+
+
 //.............................................................
 //Calculate the PDF value for a given set of observables
 
@@ -594,42 +850,7 @@ double Bs2JpsiPhi_Signal_v8::EvaluateTimeOnly(DataPoint * measurement)
 
 	_eventIsTagged = _mistagCalibModel->eventIsTagged();
 
-	vector<double> angularData;
-
-	if( !_useHelicityBasis )
-	{
-		angularData.push_back( measurement->GetObservable( cosThetaName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cosPsiName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phiName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::TangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASA0( angularData );
-	}
-	else
-	{
-		angularData.push_back( measurement->GetObservable( cthetakName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cthetalName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phihName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::HangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASA0( angularData );
-	}
+	this->SetAngularTerms( measurement );
 
 	// Get observables into member variables
 	t = measurement->GetObservable( timeName )->GetValue() ; // - timeOffset ;
@@ -709,13 +930,20 @@ double Bs2JpsiPhi_Signal_v8::Normalisation(DataPoint * measurement, PhaseSpaceBo
 // Pre calculate the time integrals : this is becaue these functions are called many times for each event due to the 10 angular terms
 void Bs2JpsiPhi_Signal_v8::preCalculateTimeFactors()
 {
-	expL_stored = resolutionModel->Exp( t, gamma_l() );
-	expH_stored = resolutionModel->Exp( t, gamma_h() );
+	//	EvaluateBatch has already calculated these for this event
+	if( !_timeFactorsFromBatch )
+	{
+		expL_stored = resolutionModel->Exp( t, gamma_l() );
+		expH_stored = resolutionModel->Exp( t, gamma_h() );
+	}
 
 	if( _eventIsTagged && RequireInterference )
 	{
-		expSin_stored = resolutionModel->ExpSin( t, gamma(), delta_ms );
-		expCos_stored = resolutionModel->ExpCos( t, gamma(), delta_ms );
+		if( !_timeFactorsFromBatch )
+		{
+			expSin_stored = resolutionModel->ExpSin( t, gamma(), delta_ms );
+			expCos_stored = resolutionModel->ExpCos( t, gamma(), delta_ms );
+		}
 		//pair<double,double> thesePair = resolutionModel->ExpCosSin( t, gamma(), delta_ms );
 		//expSin_stored = thesePair.second; expCos_stored = thesePair.first;
 	}
@@ -11,6 +11,8 @@
 #include "Mathematics.h"
 #include "TimeAccRes.h"
 #include "Bs2JpsiPhi_Angluar_Terms.h"
+#include "FunctionDerivedColumn.h"
+#include "AngularAcceptanceColumn.h"
 #include "Bs2JpsiPhi_Signal_v8a.h"
 #include "SimpleMistagCalib.h"
 #include "CombinedMistagCalib.h"
@@ -83,6 +85,7 @@ Bs2JpsiPhi_Signal_v8a::Bs2JpsiPhi_Signal_v8a(PDFConfigurator* configurator) : Ba
 	_gamma(), dgam(), Aperp_sq(), Apara_sq(), Azero_sq(), As_sq(), delta_para(),
 	delta_perp(), delta_zero(), delta_s(), delta_perp_Minus_para(), delta_perp_Minus_zero(), delta_ms(), phi_s(), _cosphis(), _sinphis(), 
 	angAccI1(), angAccI2(), angAccI3(), angAccI4(), angAccI5(), angAccI6(), angAccI7(), angAccI8(), angAccI9(), angAccI10(),
+	angularTerms(NULL), angularAcceptanceWeight(NULL),
 	tlo(), thi(), expL_stored(), expH_stored(), expSin_stored(), expCos_stored(),
 	intExpL_stored(), intExpH_stored(), intExpSin_stored(), intExpCos_stored(),//, timeAcc(NULL),
 	CachedA1(), CachedA2(), CachedA3(), CachedA4(), CachedA5(), CachedA6(), CachedA7(), CachedA8(), CachedA9(), CachedA10(),
@@ -166,6 +169,8 @@ Bs2JpsiPhi_Signal_v8a::Bs2JpsiPhi_Signal_v8a(PDFConfigurator* configurator) : Ba
 		angAccI10 = angAcc->af10();
 	}
 
+	this->MakeDerivedColumns( angAccFile );
+
 	this->SetNumericalNormalisation( false );
 
 	resolutionModel = new TimeAccRes( configurator, isCopy );
@@ -201,6 +206,8 @@ Bs2JpsiPhi_Signal_v8a::Bs2JpsiPhi_Signal_v8a(PDFConfigurator* configurator) : Ba
 Bs2JpsiPhi_Signal_v8a::~Bs2JpsiPhi_Signal_v8a()
 {
 	//if( timeAcc != NULL ) delete timeAcc;
+	if( angularTerms != NULL ) delete angularTerms;
+	if( angularAcceptanceWeight != NULL ) delete angularAcceptanceWeight;
 	if( angAcc != NULL ) delete angAcc;
 	if( resolutionModel != NULL ) delete resolutionModel;
 	if( _mistagCalibModel != NULL ) delete _mistagCalibModel;
@@ -456,6 +463,98 @@ bool Bs2JpsiPhi_Signal_v8a::SetPhysicsParameters( ParameterSet* NewParameterSet
 	return result;
 }
 
+//.............................................................
+//Construct the per-event angular quantities which only depend on the observables
+void Bs2JpsiPhi_Signal_v8a::MakeDerivedColumns( const string angAccFile )
+{
+	vector<string> angularObservables;
+	vector<FunctionDerivedColumn::ObservableFunction> angularFunctions;
+	string angularName;
+	string acceptanceName;
+	string first, second, third;
+
+	if( !_useHelicityBasis )
+	{
+		angularObservables.push_back( cosThetaName );
+		angularObservables.push_back( cosPsiName );
+		angularObservables.push_back( phiName );
+
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorA0A0 );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorAPAP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorATAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorASAS );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorImAPAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorReA0AP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorImA0AT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorReASAP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorImASAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::TangleFactorReASA0 );
+
+		angularName = "Bs2JpsiPhi_Angular_Terms::Transversity(";
+
+		//	The acceptance is evaluated as getValue( cosPsi, cosTheta, phi ) in this basis
+		first = cosPsiName; second = cosThetaName; third = phiName;
+	}
+	else
+	{
+		angularObservables.push_back( cthetakName );
+		angularObservables.push_back( cthetalName );
+		angularObservables.push_back( phihName );
+
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorA0A0 );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorAPAP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorATAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorASAS );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorImAPAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorReA0AP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorImA0AT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorReASAP );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorImASAT );
+		angularFunctions.push_back( Bs2JpsiPhi_Angular_Terms::HangleFactorReASA0 );
+
+		angularName = "Bs2JpsiPhi_Angular_Terms::Helicity(";
+
+		first = cthetakName; second = cthetalName; third = phihName;
+	}
+
+	for( unsigned int i=0; i< angularObservables.size(); ++i )
+	{
+		angularName.append( angularObservables[i] ); angularName.append( ";" );
+	}
+	angularName.append( ")" );
+
+	acceptanceName = "AngularAcceptance(" + angAccFile + ";" + (_useHelicityBasis?"Helicity":"Transversity") + ";" + (_angAccIgnoreNumerator?"IgnoreNumerator":"") + ";" + first + ";" + second + ";" + third + ")";
+
+	angularTerms = new FunctionDerivedColumn( angularName, angularObservables, angularFunctions );
+	angularAcceptanceWeight = new AngularAcceptanceColumn( acceptanceName, angAcc, first, second, third );
+}
+
+//.............................................................
+//Calculate the angular terms and angular acceptance of every event before the fit
+void Bs2JpsiPhi_Signal_v8a::PrecomputeDerivedColumns( IDataSet* input )
+{
+	angularTerms->Precompute( input );
+	angularAcceptanceWeight->Precompute( input );
+}
+
+//.............................................................
+//Read the angular terms for this event, these are only calculated the first time the event is seen
+void Bs2JpsiPhi_Signal_v8a::SetAngularTerms( DataPoint* measurement )
+{
+	const double* angularValues = angularTerms->GetValues( measurement );
+
+	A0A0_value = angularValues[0];
+	APAP_value = angularValues[1];
+	ATAT_value = angularValues[2];
+	ASAS_value = angularValues[3];
+	ImAPAT_value = angularValues[4];
+	ReA0AP_value = angularValues[5];
+	ImA0AT_value = angularValues[6];
+	ReASAP_value = angularValues[7];
+	ImASAT_value = angularValues[8];
+	ReASA0_value = angularValues[9];
+}
+
 //.............................................................
 //Calculate the PDF value for a given set of observables for use by numeric integral
 double Bs2JpsiPhi_Signal_v8a::EvaluateForNumericIntegral(DataPoint * measurement)
@@ -479,42 +578,7 @@ double Bs2JpsiPhi_Signal_v8a::Evaluate(DataPoint * measurement)
 
 	_eventIsTagged = _mistagCalibModel->eventIsTagged();
 
-	vector<double> angularData;
-
-	if( !_useHelicityBasis )
-	{
-		angularData.push_back( measurement->GetObservable( cosThetaName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cosPsiName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phiName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::TangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASA0( angularData );
-	}
-	else
-	{
-		angularData.push_back( measurement->GetObservable( cthetakName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cthetalName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phihName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::HangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASA0( angularData );
-	}
+	this->SetAngularTerms( measurement );
 
 	// Get observables into member variables
 	t = measurement->GetObservable( timeName )->GetValue() ; // - timeOffset ;
@@ -529,7 +593,7 @@ double Bs2JpsiPhi_Signal_v8a::Evaluate(DataPoint * measurement)
 		ctheta_k   = thetaK_obs->GetValue();
 		phi_h      = hphi_obs->GetValue();
 		ctheta_l   = thetaL_obs->GetValue();
-		angAcceptanceFactor = angAcc->getValue( thetaK_obs, thetaL_obs, hphi_obs );  // Histogram is generated in PDF basis!
+		angAcceptanceFactor = angularAcceptanceWeight->GetValues( measurement )[0];  // Histogram is generated in PDF basis!
 		//cout << angAcceptanceFactor << endl;
 	}
 	else
@@ -540,7 +604,7 @@ double Bs2JpsiPhi_Signal_v8a::Evaluate(DataPoint * measurement)
 		ctheta_tr = theta_obs->GetValue();
 		phi_tr    = phi_obs->GetValue();
 		ctheta_1  = psi_obs->GetValue();
-		angAcceptanceFactor = angAcc->getValue( psi_obs, theta_obs, phi_obs );
+		angAcceptanceFactor = angularAcceptanceWeight->GetValues( measurement )[0];
 	}
 
 	//Cache amplitues and angles terms used in cross section
@@ -594,42 +658,7 @@ double Bs2JpsiPhi_Signal_v8a::EvaluateTimeOnly(DataPoint * measurement)
 
 	_eventIsTagged = _mistagCalibModel->eventIsTagged();
 
-	vector<double> angularData;
-
-	if( !_useHelicityBasis )
-	{
-		angularData.push_back( measurement->GetObservable( cosThetaName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cosPsiName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phiName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::TangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::TangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::TangleFactorReASA0( angularData );
-	}
-	else
-	{
-		angularData.push_back( measurement->GetObservable( cthetakName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( cthetalName )->GetValue() );
-		angularData.push_back( measurement->GetObservable( phihName )->GetValue() );
-
-		A0A0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorA0A0( angularData );
-		APAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorAPAP( angularData );
-		ATAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorATAT( angularData );
-		ASAS_value = Bs2JpsiPhi_Angular_Terms::HangleFactorASAS( angularData );
-		ImAPAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImAPAT( angularData );
-		ReA0AP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReA0AP( angularData );
-		ImA0AT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImA0AT( angularData );
-		ReASAP_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASAP( angularData );
-		ImASAT_value = Bs2JpsiPhi_Angular_Terms::HangleFactorImASAT( angularData );
-		ReASA0_value = Bs2JpsiPhi_Angular_Terms::HangleFactorReASA0( angularData );
-	}
+	this->SetAngularTerms( measurement );
 
 	// Get observables into member variables
 	t = measurement->GetObservable( timeName )->GetValue() ; // - timeOffset ;
@@ -10,6 +10,7 @@
 #include "Exponential.h"
 #include "Mathematics.h"
 #include "TimeAccRes.h"
+#include "ColumnarDataSet.h"
 #include <iostream>
 #include <cmath>
 
@@ -124,9 +125,22 @@ double Exponential::Evaluate(DataPoint * measurement)
 	Observable* timeObs = measurement->GetObservable( timeName );
 	time = timeObs->GetValue();
 
+	resolutionModel->setObservables( measurement );
+
 	return resolutionModel->Exp( time, gamma );
 }
 
+//Calculate the function value for a range of events
+void Exponential::EvaluateBatch( IDataSet* InputData, const unsigned int begin, const unsigned int end, double* output )
+{
+	if( end <= begin ) return;
+
+	vector<double> timeValues;
+	const double* times = ColumnarDataSet::ReadColumn( InputData, timeName, begin, end, timeValues );
+
+	resolutionModel->ExpBatch( InputData, begin, end, times, gamma, output );
+}
+
 double Exponential::Normalisation( DataPoint * measurement, PhaseSpaceBoundary * boundary )
 {
 	IConstraint* timeC = boundary->GetConstraint( timeConst );